@@ -0,0 +1,69 @@
+@import Foundation;
+
+/**
+ Collects benchmark timings and writes them out as JSON, so that results can be compared between library versions.
+
+ @discussion Each benchmark is calibrated to run enough iterations per sample to be measurable, warmed up, and then
+ sampled several times. Results are reported in nanoseconds per operation. Values that aren’t timings, e.g. payload sizes,
+ can be recorded alongside them.
+
+ The report is written to the path in the `XEXTENSIONITEM_BENCHMARK_OUTPUT` environment variable if set, or to
+ `XExtensionItemBenchmarks.json` in the temporary directory otherwise.
+ */
+@interface BenchmarkReport : NSObject
+
+/**
+ The report that every benchmark in this target records into.
+ */
++ (instancetype)sharedReport;
+
+/**
+ Measure a block and record the result.
+
+ @param name       Benchmark name, e.g. `decoding`.
+ @param parameters Payload size and other inputs that the result should be keyed on.
+ @param block      A single operation to measure.
+ */
+- (void)measure:(NSString *)name parameters:(NSDictionary *)parameters block:(void (^)(void))block;
+
+/**
+ Measure a block that needs fresh state for every operation, and record the result.
+
+ @param name       Benchmark name, e.g. `time-to-sheet-ready`.
+ @param parameters Payload size and other inputs that the result should be keyed on.
+ @param setup      Called before every operation. Not included in the measurement.
+ @param block      A single operation to measure.
+ */
+- (void)measure:(NSString *)name parameters:(NSDictionary *)parameters setup:(void (^)(void))setup block:(void (^)(void))block;
+
+/**
+ Measure a block that processes several items, e.g. every payload in a corpus, and record the result along with the
+ number of items processed per second.
+
+ @param name       Benchmark name, e.g. `corpus-replay`.
+ @param parameters Payload size and other inputs that the result should be keyed on.
+ @param itemCount  Number of items that a single operation processes.
+ @param block      A single operation to measure.
+ */
+- (void)measure:(NSString *)name parameters:(NSDictionary *)parameters itemCount:(NSUInteger)itemCount block:(void (^)(void))block;
+
+/**
+ Record a value that isn’t a timing, e.g. the size of an encoded payload, so that it can be compared along with timings.
+
+ @param name       Benchmark name, e.g. `user-info-archive-size`.
+ @param parameters Payload size and other inputs that the result should be keyed on.
+ @param value      Value to record.
+ @param unit       Unit of the value, e.g. `bytes`.
+ */
+- (void)record:(NSString *)name parameters:(NSDictionary *)parameters value:(double)value unit:(NSString *)unit;
+
+/**
+ Write every result recorded so far.
+
+ @param error Set if the report couldn’t be written.
+
+ @return URL that the report was written to, or `nil` on failure.
+ */
+- (NSURL *)writeWithError:(NSError **)error;
+
+@end
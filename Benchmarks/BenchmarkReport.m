@@ -0,0 +1,215 @@
+@import UIKit;
+#import "BenchmarkReport.h"
+#import <mach/mach_time.h>
+
+static NSString * const OutputPathEnvironmentKey = @"XEXTENSIONITEM_BENCHMARK_OUTPUT";
+static NSString * const DefaultOutputFileName = @"XExtensionItemBenchmarks.json";
+static NSUInteger const SchemaVersion = 1;
+static NSUInteger const SampleCount = 10;
+static uint64_t const MinimumSampleNanoseconds = 10 * NSEC_PER_MSEC;
+static NSUInteger const MaximumIterations = 1 << 20;
+static NSUInteger const MaximumIterationsWithSetup = 1 << 8; // Operations are timed individually, so fewer are needed
+
+@interface BenchmarkReport ()
+
+@property (nonatomic) NSMutableArray *results;
+
+@end
+
+@implementation BenchmarkReport
+
+#pragma mark - Initialization
+
++ (instancetype)sharedReport {
+    static BenchmarkReport *sharedReport;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedReport = [[self alloc] init];
+    });
+
+    return sharedReport;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _results = [[NSMutableArray alloc] init];
+    }
+
+    return self;
+}
+
+#pragma mark - BenchmarkReport
+
+- (void)measure:(NSString *)name parameters:(NSDictionary *)parameters block:(void (^)(void))block {
+    [self measure:name parameters:parameters setup:nil block:block];
+}
+
+- (void)measure:(NSString *)name parameters:(NSDictionary *)parameters setup:(void (^)(void))setup block:(void (^)(void))block {
+    [self measure:name parameters:parameters setup:setup itemCount:0 block:block];
+}
+
+- (void)measure:(NSString *)name parameters:(NSDictionary *)parameters itemCount:(NSUInteger)itemCount block:(void (^)(void))block {
+    [self measure:name parameters:parameters setup:nil itemCount:itemCount block:block];
+}
+
+- (void)record:(NSString *)name parameters:(NSDictionary *)parameters value:(double)value unit:(NSString *)unit {
+    NSDictionary *result = @{
+        @"name": name,
+        @"parameters": parameters ?: @{},
+        @"value": @(value),
+        @"unit": unit
+    };
+
+    @synchronized (self) {
+        [self.results addObject:result];
+    }
+
+    NSLog(@"%@ %@: %.0f %@", name, parameters, value, unit);
+}
+
+- (NSURL *)writeWithError:(NSError **)error {
+    NSDictionary *report;
+
+    @synchronized (self) {
+        report = @{
+            @"schemaVersion": @(SchemaVersion),
+            @"date": [[[NSISO8601DateFormatter alloc] init] stringFromDate:[NSDate date]],
+            @"environment": environment(),
+            @"results": [self.results copy]
+        };
+    }
+
+    NSData *data = [NSJSONSerialization dataWithJSONObject:report
+                                                   options:NSJSONWritingPrettyPrinted | NSJSONWritingSortedKeys
+                                                     error:error];
+
+    NSURL *outputURL = outputFileURL();
+
+    if (!data || ![data writeToURL:outputURL options:NSDataWritingAtomic error:error]) {
+        return nil;
+    }
+
+    return outputURL;
+}
+
+#pragma mark - Private
+
+/*
+ `itemCount` is `0` for benchmarks that don’t report throughput.
+ */
+- (void)measure:(NSString *)name
+     parameters:(NSDictionary *)parameters
+          setup:(void (^)(void))setup
+      itemCount:(NSUInteger)itemCount
+          block:(void (^)(void))block {
+    NSUInteger iterations = calibratedIterations(setup, block);
+
+    // Warm up caches and lazily initialized state before sampling
+    nanosecondsForIterations(setup, block, iterations);
+
+    NSMutableArray *samples = [[NSMutableArray alloc] initWithCapacity:SampleCount];
+
+    for (NSUInteger i = 0; i < SampleCount; i++) {
+        [samples addObject:@((double)nanosecondsForIterations(setup, block, iterations) / iterations)];
+    }
+
+    [samples sortUsingSelector:@selector(compare:)];
+
+    NSMutableDictionary *result = [@{
+        @"name": name,
+        @"parameters": parameters ?: @{},
+        @"iterations": @(iterations),
+        @"samples": @(SampleCount),
+        @"nanosecondsPerOperation": @{
+            @"min": samples.firstObject,
+            @"median": samples[SampleCount / 2],
+            @"mean": [samples valueForKeyPath:@"@avg.self"],
+            @"max": samples.lastObject
+        }
+    } mutableCopy];
+
+    if (itemCount > 0) {
+        result[@"itemsPerSecond"] = @(itemCount * NSEC_PER_SEC / [samples[SampleCount / 2] doubleValue]);
+    }
+
+    @synchronized (self) {
+        [self.results addObject:[result copy]];
+    }
+
+    NSLog(@"%@ %@: %.0f ns/op", name, parameters, [samples[SampleCount / 2] doubleValue]);
+}
+
+static NSUInteger calibratedIterations(void (^setup)(void), void (^block)(void)) {
+    NSUInteger iterations = 1;
+    NSUInteger maximumIterations = setup ? MaximumIterationsWithSetup : MaximumIterations;
+
+    while (iterations < maximumIterations && nanosecondsForIterations(setup, block, iterations) < MinimumSampleNanoseconds) {
+        iterations *= 2;
+    }
+
+    return iterations;
+}
+
+static uint64_t nanosecondsForIterations(void (^setup)(void), void (^block)(void), NSUInteger iterations) {
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+
+    uint64_t elapsedTime = 0;
+
+    if (setup) {
+        // Time each operation on its own, so that setup isn’t included
+        for (NSUInteger i = 0; i < iterations; i++) {
+            @autoreleasepool {
+                setup();
+
+                uint64_t startTime = mach_absolute_time();
+                block();
+                elapsedTime += mach_absolute_time() - startTime;
+            }
+        }
+    }
+    else {
+        uint64_t startTime = mach_absolute_time();
+
+        for (NSUInteger i = 0; i < iterations; i++) {
+            @autoreleasepool {
+                block();
+            }
+        }
+
+        elapsedTime = mach_absolute_time() - startTime;
+    }
+
+    return elapsedTime * timebase.numer / timebase.denom;
+}
+
+static NSDictionary *environment(void) {
+    UIDevice *device = [UIDevice currentDevice];
+
+    return @{
+        @"systemName": device.systemName,
+        @"systemVersion": device.systemVersion,
+        @"model": device.model,
+#ifdef DEBUG
+        @"configuration": @"debug"
+#else
+        @"configuration": @"release"
+#endif
+    };
+}
+
+static NSURL *outputFileURL(void) {
+    NSString *path = [NSProcessInfo processInfo].environment[OutputPathEnvironmentKey];
+
+    if (path.length > 0) {
+        return [NSURL fileURLWithPath:path];
+    }
+
+    return [[NSURL fileURLWithPath:NSTemporaryDirectory() isDirectory:YES] URLByAppendingPathComponent:DefaultOutputFileName];
+}
+
+@end
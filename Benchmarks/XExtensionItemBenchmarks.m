@@ -0,0 +1,545 @@
+@import UIKit;
+@import XCTest;
+#import <malloc/malloc.h>
+#import "BenchmarkReport.h"
+#import "XExtensionItem.h"
+#import "XExtensionItemTumblrParameters.h"
+
+/**
+ Custom parameters with an arbitrary number of keys, to vary payload size.
+ */
+@interface DictionaryParameters : NSObject <XExtensionItemCustomParameters>
+@end
+
+@implementation DictionaryParameters {
+    NSDictionary *_dictionary;
+}
+
+- (instancetype)initWithDictionary:(NSDictionary *)dictionary {
+    self = [super init];
+    if (self) {
+        _dictionary = [dictionary copy];
+    }
+
+    return self;
+}
+
+- (NSDictionary *)dictionaryRepresentation {
+    return _dictionary;
+}
+
+@end
+
+@interface XExtensionItemBenchmarks : XCTestCase
+@end
+
+@implementation XExtensionItemBenchmarks
+
++ (void)tearDown {
+    NSError *error;
+    NSURL *outputURL = [[BenchmarkReport sharedReport] writeWithError:&error];
+
+    if (outputURL) {
+        NSLog(@"Benchmark results written to %@", outputURL.path);
+    }
+    else {
+        NSLog(@"Benchmark results couldn’t be written: %@", error);
+    }
+
+    [super tearDown];
+}
+
+- (void)testPayloadAssembly {
+    for (NSDictionary *payloadSize in payloadSizes()) {
+        for (NSNumber *encoding in @[@(XExtensionItemParameterEncodingDictionary), @(XExtensionItemParameterEncodingBinary)]) {
+            XExtensionItemSource *itemSource = itemSourceWithPayloadSize(payloadSize);
+            itemSource.parameterEncoding = encoding.integerValue;
+
+            [[BenchmarkReport sharedReport] measure:@"payload-assembly" parameters:parametersWithEncoding(payloadSize, encoding.integerValue) block:^{
+                [itemSource removeCachedExtensionItems];
+                (void)[itemSource extensionItemForActivityType:nil];
+            }];
+        }
+    }
+}
+
+- (void)testDecoding {
+    for (NSDictionary *payloadSize in payloadSizes()) {
+        for (NSNumber *encoding in @[@(XExtensionItemParameterEncodingDictionary), @(XExtensionItemParameterEncodingBinary)]) {
+            XExtensionItemSource *itemSource = itemSourceWithPayloadSize(payloadSize);
+            itemSource.parameterEncoding = encoding.integerValue;
+
+            NSExtensionItem *extensionItem = [itemSource extensionItemForActivityType:nil];
+
+            [[BenchmarkReport sharedReport] measure:@"decoding" parameters:parametersWithEncoding(payloadSize, encoding.integerValue) block:^{
+                XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:extensionItem];
+                (void)xExtensionItem.tags;
+                (void)xExtensionItem.referrer;
+            }];
+        }
+    }
+}
+
+/*
+ Archiving an item’s `userInfo`, approximating what the system does to send it across the process boundary. The size of
+ the archive is recorded too, so that encodings can be compared by size as well as by time.
+ */
+- (void)testUserInfoArchiving {
+    for (NSDictionary *payloadSize in payloadSizes()) {
+        for (NSNumber *encoding in @[@(XExtensionItemParameterEncodingDictionary), @(XExtensionItemParameterEncodingBinary)]) {
+            XExtensionItemSource *itemSource = itemSourceWithPayloadSize(payloadSize);
+            itemSource.parameterEncoding = encoding.integerValue;
+
+            NSDictionary *userInfo = [itemSource extensionItemForActivityType:nil].userInfo;
+            NSDictionary *parameters = parametersWithEncoding(payloadSize, encoding.integerValue);
+
+            [[BenchmarkReport sharedReport] measure:@"user-info-archiving" parameters:parameters block:^{
+                (void)[NSKeyedArchiver archivedDataWithRootObject:userInfo requiringSecureCoding:NO error:nil];
+            }];
+
+            NSData *archive = [NSKeyedArchiver archivedDataWithRootObject:userInfo requiringSecureCoding:NO error:nil];
+            [[BenchmarkReport sharedReport] record:@"user-info-archive-size" parameters:parameters value:archive.length unit:@"bytes"];
+        }
+    }
+}
+
+- (void)testTypeSafeDictionaryValuesLookups {
+    for (NSDictionary *payloadSize in payloadSizes()) {
+        NSDictionary *dictionary = customParameterDictionary([payloadSize[@"customParameters"] unsignedIntegerValue]);
+        NSArray *keys = [dictionary.allKeys sortedArrayUsingSelector:@selector(compare:)];
+        XExtensionItemTypeSafeDictionaryValues *values = [[XExtensionItemTypeSafeDictionaryValues alloc] initWithDictionary:dictionary];
+
+        [[BenchmarkReport sharedReport] measure:@"type-safe-dictionary-values-lookups" parameters:payloadSize block:^{
+            for (NSString *key in keys) {
+                (void)[values stringForKey:key];
+                (void)[values numberForKey:key];
+                (void)[values URLForKey:key];
+            }
+        }];
+    }
+}
+
+/*
+ Wrapping custom parameters and reading two of them, copying the dictionary, borrowing it, or borrowing it and reading
+ both values in a single batch.
+ */
+- (void)testTypeSafeDictionaryValuesConstruction {
+    NSDictionary *schema = @{ @"benchmark-parameter-0": [NSString class], @"benchmark-parameter-1": [NSNumber class] };
+
+    for (NSDictionary *payloadSize in payloadSizes()) {
+        NSDictionary *dictionary = customParameterDictionary([payloadSize[@"customParameters"] unsignedIntegerValue]);
+
+        for (NSString *mode in @[@"copying", @"borrowing", @"batched"]) {
+            NSMutableDictionary *parameters = [payloadSize mutableCopy];
+            parameters[@"mode"] = mode;
+
+            [[BenchmarkReport sharedReport] measure:@"type-safe-dictionary-values-construction" parameters:parameters block:^{
+                if ([mode isEqualToString:@"batched"]) {
+                    (void)[[[XExtensionItemTypeSafeDictionaryValues alloc] initWithDictionaryNoCopy:dictionary] valuesForSchema:schema];
+                }
+                else {
+                    XExtensionItemTypeSafeDictionaryValues *values = [mode isEqualToString:@"copying"]
+                        ? [[XExtensionItemTypeSafeDictionaryValues alloc] initWithDictionary:dictionary]
+                        : [[XExtensionItemTypeSafeDictionaryValues alloc] initWithDictionaryNoCopy:dictionary];
+
+                    (void)[values stringForKey:@"benchmark-parameter-0"];
+                    (void)[values numberForKey:@"benchmark-parameter-1"];
+                }
+            }];
+        }
+    }
+}
+
+/*
+ Resolving the type identifiers of attached files, by asking the file system for every one of them and through the
+ cache that item sources use.
+ */
+- (void)testTypeIdentifierResolution {
+    NSURL *directoryURL = [[NSURL fileURLWithPath:NSTemporaryDirectory() isDirectory:YES] URLByAppendingPathComponent:[NSUUID UUID].UUIDString
+                                                                                                            isDirectory:YES];
+    // A few thousand, so that the directory is large enough for file system lookups to cost what they do in real containers
+    NSArray *fileURLs = benchmarkFileURLs(directoryURL, 3000);
+    XExtensionItemTypeIdentifierCache *cache = [[XExtensionItemTypeIdentifierCache alloc] init];
+
+    [[BenchmarkReport sharedReport] measure:@"type-identifier-resolution" parameters:@{ @"cached": @NO } itemCount:fileURLs.count block:^{
+        for (NSURL *fileURL in fileURLs) {
+            NSString *typeIdentifier;
+            [[NSURL fileURLWithPath:fileURL.path] getResourceValue:&typeIdentifier forKey:NSURLTypeIdentifierKey error:nil];
+        }
+    }];
+
+    [[BenchmarkReport sharedReport] measure:@"type-identifier-resolution" parameters:@{ @"cached": @YES } itemCount:fileURLs.count block:^{
+        (void)[cache typeIdentifiersForFileURLsInArray:fileURLs];
+    }];
+
+    [[NSFileManager defaultManager] removeItemAtURL:directoryURL error:nil];
+}
+
+- (void)testReferrerRoundTrip {
+    XExtensionItemReferrer *referrer = benchmarkReferrer();
+
+    [[BenchmarkReport sharedReport] measure:@"referrer-round-trip" parameters:nil block:^{
+        (void)[[XExtensionItemReferrer alloc] initWithDictionary:referrer.dictionaryRepresentation];
+    }];
+}
+
+- (void)testTumblrParametersRoundTrip {
+    XExtensionItemTumblrParameters *tumblrParameters = benchmarkTumblrParameters();
+
+    [[BenchmarkReport sharedReport] measure:@"tumblr-parameters-round-trip" parameters:nil block:^{
+        (void)[[XExtensionItemTumblrParameters alloc] initWithDictionary:tumblrParameters.dictionaryRepresentation];
+    }];
+}
+
+- (void)testHashing {
+    XExtensionItemReferrer *referrer = benchmarkReferrer();
+    XExtensionItemTumblrParameters *tumblrParameters = benchmarkTumblrParameters();
+
+    XExtensionItemReferrer *equalReferrer = benchmarkReferrer();
+
+    [[BenchmarkReport sharedReport] measure:@"referrer-hash" parameters:nil block:^{
+        (void)referrer.hash;
+    }];
+
+    [[BenchmarkReport sharedReport] measure:@"referrer-equality" parameters:nil block:^{
+        (void)[referrer isEqual:equalReferrer];
+    }];
+
+    [[BenchmarkReport sharedReport] measure:@"tumblr-parameters-hash" parameters:nil block:^{
+        (void)tumblrParameters.hash;
+    }];
+}
+
+/*
+ Building the same extension items from item sources that each set (and build a `userInfo` dictionary around) the common
+ parameters, or from a group that sets them once. Besides the time taken, records how many allocations, and how many
+ bytes, the built items keep alive.
+ */
+- (void)testItemSourceGroups {
+    for (NSNumber *itemSourceCount in @[@1, @50, @500]) {
+        NSUInteger count = itemSourceCount.unsignedIntegerValue;
+
+        for (NSNumber *grouped in @[@NO, @YES]) {
+            NSArray *(^buildExtensionItems)(void) = ^NSArray *{
+                return grouped.boolValue ? groupedExtensionItems(count) : independentExtensionItems(count);
+            };
+
+            NSDictionary *parameters = @{ @"itemSources": itemSourceCount, @"grouped": grouped };
+
+            [[BenchmarkReport sharedReport] measure:@"item-source-group" parameters:parameters itemCount:count block:^{
+                (void)buildExtensionItems();
+            }];
+
+            @autoreleasepool {
+                malloc_statistics_t before = mallocStatistics();
+                NSArray *extensionItems;
+
+                @autoreleasepool {
+                    extensionItems = buildExtensionItems();
+                }
+
+                malloc_statistics_t after = mallocStatistics();
+
+                [[BenchmarkReport sharedReport] record:@"item-source-group-allocations" parameters:parameters
+                                                 value:(double)after.blocks_in_use - before.blocks_in_use unit:@"allocations"];
+                [[BenchmarkReport sharedReport] record:@"item-source-group-memory" parameters:parameters
+                                                 value:(double)after.size_in_use - before.size_in_use unit:@"bytes"];
+
+                (void)extensionItems.count;
+            }
+        }
+    }
+}
+
+/*
+ The work done on the main thread between the user tapping a share button and the sheet having everything it needs for
+ the predicted activity types, with and without preparing payloads while the button was visible.
+ */
+- (void)testTimeToSheetReady {
+    NSArray *activityTypes = @[UIActivityTypePostToFacebook, UIActivityTypeMail, @"com.tumblr.tumblr.share-extension"];
+    CGSize thumbnailSize = CGSizeMake(120, 120);
+
+    for (NSDictionary *payloadSize in payloadSizes()) {
+        for (NSNumber *prepared in @[@NO, @YES]) {
+            XExtensionItemSource *itemSource = itemSourceWithPayloadSize(payloadSize);
+            itemSource.thumbnailProvider = ^UIImage *(CGSize suggestedSize, NSString *activityType) {
+                return [[[UIGraphicsImageRenderer alloc] initWithSize:suggestedSize] imageWithActions:^(UIGraphicsImageRendererContext *context) {
+                    [[UIColor blueColor] setFill];
+                    [context fillRect:CGRectMake(0, 0, suggestedSize.width, suggestedSize.height)];
+                }];
+            };
+
+            NSMutableDictionary *parameters = [payloadSize mutableCopy];
+            parameters[@"prepared"] = prepared;
+
+            [[BenchmarkReport sharedReport] measure:@"time-to-sheet-ready" parameters:parameters setup:^{
+                [itemSource removeCachedExtensionItems];
+                [itemSource.thumbnailCache removeAllThumbnails];
+
+                if (prepared.boolValue) {
+                    __block BOOL finished = NO;
+
+                    [itemSource prepareForActivityTypes:activityTypes thumbnailSize:thumbnailSize completion:^(NSArray *preparedActivityTypes) {
+                        finished = YES;
+                    }];
+
+                    // The completion block is called on the main queue, so keep it running until then
+                    while (!finished) {
+                        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate distantFuture]];
+                    }
+                }
+            } block:^{
+                for (NSString *activityType in activityTypes) {
+                    (void)[itemSource activityViewController:nil thumbnailImageForActivityType:activityType suggestedSize:thumbnailSize];
+                    (void)[itemSource activityViewController:nil itemForActivityType:activityType];
+                }
+            }];
+        }
+    }
+}
+
+/*
+ Decoding recorded payloads, one at a time and as a whole corpus. Replays the corpus in the directory in the
+ `XEXTENSIONITEM_CORPUS` environment variable, e.g. one recorded from a real application with `XExtensionItemCorpus`, or
+ one recorded from the benchmark payloads otherwise.
+ */
+- (void)testCorpusReplay {
+    NSArray *recordings = benchmarkCorpus().recordings;
+    XCTAssertGreaterThan(recordings.count, 0);
+
+    for (XExtensionItemCorpusRecording *recording in recordings) {
+        NSDictionary *parameters = @{
+            @"recording": recording.fileURL.lastPathComponent,
+            @"activityType": recording.activityType ?: @"",
+            @"direction": recording.direction == XExtensionItemCorpusDirectionSent ? @"sent" : @"received",
+            @"bytes": @(recording.byteCount)
+        };
+
+        [[BenchmarkReport sharedReport] measure:@"corpus-replay-item" parameters:parameters block:^{
+            replayRecording(recording);
+        }];
+    }
+
+    [[BenchmarkReport sharedReport] measure:@"corpus-replay"
+                                 parameters:@{ @"recordings": @(recordings.count), @"bytes": [recordings valueForKeyPath:@"@sum.byteCount"] }
+                                  itemCount:recordings.count
+                                      block:^{
+        for (XExtensionItemCorpusRecording *recording in recordings) {
+            replayRecording(recording);
+        }
+    }];
+}
+
+- (void)testActivityRouteLookup {
+    XExtensionItemActivityRoutingTable *table = [XExtensionItemActivityRoutingTable defaultTable];
+
+    // Extension item, raw item, and unknown routes
+    for (NSString *activityType in @[UIActivityTypePostToFacebook, UIActivityTypeMail, @"com.tumblr.tumblr.share-extension"]) {
+        [[BenchmarkReport sharedReport] measure:@"activity-route-lookup" parameters:@{ @"activityType": activityType } block:^{
+            (void)[table routeForActivityType:activityType];
+        }];
+    }
+}
+
+#pragma mark - Private
+
+static NSArray *payloadSizes(void) {
+    return @[
+        @{ @"tags": @1, @"customParameters": @1, @"attachments": @0 },
+        @{ @"tags": @10, @"customParameters": @10, @"attachments": @5 },
+        @{ @"tags": @100, @"customParameters": @100, @"attachments": @50 }
+    ];
+}
+
+static NSDictionary *parametersWithEncoding(NSDictionary *payloadSize, XExtensionItemParameterEncoding encoding) {
+    NSMutableDictionary *parameters = [payloadSize mutableCopy];
+    parameters[@"encoding"] = encoding == XExtensionItemParameterEncodingBinary ? @"binary" : @"dictionary";
+
+    return [parameters copy];
+}
+
+static XExtensionItemSource *itemSourceWithPayloadSize(NSDictionary *payloadSize) {
+    NSUInteger tagCount = [payloadSize[@"tags"] unsignedIntegerValue];
+    NSUInteger customParameterCount = [payloadSize[@"customParameters"] unsignedIntegerValue];
+    NSUInteger attachmentCount = [payloadSize[@"attachments"] unsignedIntegerValue];
+
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithURL:[NSURL URLWithString:@"http://tumblr.com"]];
+    itemSource.title = @"Benchmark";
+    itemSource.sourceURL = [NSURL URLWithString:@"http://tumblr.com/post/1"];
+    itemSource.referrer = benchmarkReferrer();
+
+    NSMutableArray *tags = [[NSMutableArray alloc] initWithCapacity:tagCount];
+    NSMutableArray *attachments = [[NSMutableArray alloc] initWithCapacity:attachmentCount];
+
+    for (NSUInteger i = 0; i < tagCount; i++) {
+        [tags addObject:[NSString stringWithFormat:@"tag-%lu", (unsigned long)i]];
+    }
+
+    for (NSUInteger i = 0; i < attachmentCount; i++) {
+        [attachments addObject:[NSString stringWithFormat:@"attachment-%lu", (unsigned long)i]];
+    }
+
+    itemSource.tags = tags;
+    itemSource.additionalAttachments = attachments;
+
+    [itemSource addCustomParameters:benchmarkTumblrParameters()];
+    [itemSource addCustomParameters:[[DictionaryParameters alloc] initWithDictionary:customParameterDictionary(customParameterCount)]];
+
+    return itemSource;
+}
+
+static NSArray *independentExtensionItems(NSUInteger count) {
+    NSArray *tags = groupTags();
+    NSAttributedString *contentText = groupContentText();
+    NSMutableArray *extensionItems = [[NSMutableArray alloc] initWithCapacity:count];
+
+    for (XExtensionItemSource *itemSource in itemSourcesWithCount(count)) {
+        itemSource.tags = tags;
+        itemSource.referrer = benchmarkReferrer();
+        itemSource.attributedContentText = contentText;
+        [itemSource addCustomParameters:benchmarkTumblrParameters()];
+
+        [extensionItems addObject:[itemSource extensionItemForActivityType:nil]];
+    }
+
+    return [extensionItems copy];
+}
+
+static NSArray *groupedExtensionItems(NSUInteger count) {
+    XExtensionItemSourceGroup *group = [[XExtensionItemSourceGroup alloc] initWithItemSources:itemSourcesWithCount(count)];
+    group.tags = groupTags();
+    group.referrer = benchmarkReferrer();
+    group.attributedContentText = groupContentText();
+    [group addCustomParameters:benchmarkTumblrParameters()];
+
+    return [group extensionItemsForActivityType:nil];
+}
+
+static NSArray *groupTags(void) {
+    return @[@"photography", @"landscape", @"mountains", @"travel"];
+}
+
+static NSAttributedString *groupContentText(void) {
+    return [[NSAttributedString alloc] initWithString:@"Shared from Tumblr"];
+}
+
+/*
+ Statistics for every malloc zone, which include the objects that Foundation allocates.
+ */
+static malloc_statistics_t mallocStatistics(void) {
+    malloc_statistics_t statistics;
+    malloc_zone_statistics(NULL, &statistics);
+
+    return statistics;
+}
+
+static NSArray *itemSourcesWithCount(NSUInteger count) {
+    NSMutableArray *itemSources = [[NSMutableArray alloc] initWithCapacity:count];
+
+    for (NSUInteger i = 0; i < count; i++) {
+        NSURL *URL = [NSURL URLWithString:[NSString stringWithFormat:@"http://tumblr.com/post/%lu", (unsigned long)i]];
+        [itemSources addObject:[[XExtensionItemSource alloc] initWithURL:URL]];
+    }
+
+    return [itemSources copy];
+}
+
+/*
+ A mix of strings, numbers, and URLs.
+ */
+static NSDictionary *customParameterDictionary(NSUInteger count) {
+    NSMutableDictionary *dictionary = [[NSMutableDictionary alloc] initWithCapacity:count];
+
+    for (NSUInteger i = 0; i < count; i++) {
+        NSString *key = [NSString stringWithFormat:@"benchmark-parameter-%lu", (unsigned long)i];
+
+        switch (i % 3) {
+            case 0:
+                dictionary[key] = [NSString stringWithFormat:@"value-%lu", (unsigned long)i];
+                break;
+            case 1:
+                dictionary[key] = @(i);
+                break;
+            default:
+                dictionary[key] = [NSURL URLWithString:[NSString stringWithFormat:@"http://tumblr.com/%lu", (unsigned long)i]];
+                break;
+        }
+    }
+
+    return [dictionary copy];
+}
+
+/*
+ A mix of files with declared extensions, which the cache never looks up on disk, and files without, which it only looks
+ up once.
+ */
+static NSArray *benchmarkFileURLs(NSURL *directoryURL, NSUInteger count) {
+    [[NSFileManager defaultManager] createDirectoryAtURL:directoryURL withIntermediateDirectories:YES attributes:nil error:nil];
+
+    NSArray *extensions = @[@"png", @"jpg", @"mp4", @"txt", @"pdf", @"gif", @""];
+    NSMutableArray *fileURLs = [[NSMutableArray alloc] initWithCapacity:count];
+
+    for (NSUInteger i = 0; i < count; i++) {
+        NSString *extension = extensions[i % extensions.count];
+        NSString *name = [NSString stringWithFormat:@"file-%lu", (unsigned long)i];
+        NSURL *fileURL = [directoryURL URLByAppendingPathComponent:extension.length > 0 ? [name stringByAppendingPathExtension:extension] : name];
+
+        [[NSData dataWithBytes:"abc" length:3] writeToURL:fileURL atomically:NO];
+        [fileURLs addObject:fileURL];
+    }
+
+    return [fileURLs copy];
+}
+
+static XExtensionItemCorpus *benchmarkCorpus(void) {
+    NSString *path = [NSProcessInfo processInfo].environment[@"XEXTENSIONITEM_CORPUS"];
+
+    if (path.length > 0) {
+        return [[XExtensionItemCorpus alloc] initWithDirectoryURL:[NSURL fileURLWithPath:path isDirectory:YES]];
+    }
+
+    NSURL *directoryURL = [[NSURL fileURLWithPath:NSTemporaryDirectory() isDirectory:YES] URLByAppendingPathComponent:[NSUUID UUID].UUIDString
+                                                                                                            isDirectory:YES];
+    XExtensionItemCorpus *corpus = [[XExtensionItemCorpus alloc] initWithDirectoryURL:directoryURL];
+    NSArray *activityTypes = @[UIActivityTypePostToFacebook, UIActivityTypeMail, @"com.tumblr.tumblr.share-extension"];
+
+    for (NSDictionary *payloadSize in payloadSizes()) {
+        NSError *error;
+
+        if (![corpus recordItemSource:itemSourceWithPayloadSize(payloadSize) activityTypes:activityTypes error:&error]) {
+            NSLog(@"Benchmark corpus couldn’t be recorded: %@", error);
+        }
+    }
+
+    return corpus;
+}
+
+/*
+ What an extension does with an item it receives.
+ */
+static void replayRecording(XExtensionItemCorpusRecording *recording) {
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:recording.extensionItem];
+    (void)xExtensionItem.title;
+    (void)xExtensionItem.tags;
+    (void)xExtensionItem.sourceURL;
+    (void)xExtensionItem.referrer;
+    (void)xExtensionItem.userInfo;
+    (void)[xExtensionItem customParametersOfClass:[XExtensionItemTumblrParameters class]];
+}
+
+static XExtensionItemReferrer *benchmarkReferrer(void) {
+    return [[XExtensionItemReferrer alloc] initWithAppName:@"Tumblr"
+                                                appStoreID:@"305343404"
+                                              googlePlayID:@"com.tumblr"
+                                                    webURL:[NSURL URLWithString:@"http://tumblr.com/post/1"]
+                                                 iOSAppURL:[NSURL URLWithString:@"tumblr://post/1"]
+                                             androidAppURL:[NSURL URLWithString:@"tumblr://post/1"]];
+}
+
+static XExtensionItemTumblrParameters *benchmarkTumblrParameters(void) {
+    return [[XExtensionItemTumblrParameters alloc] initWithCustomURLPathComponent:@"benchmark"
+                                                                requestedPostType:XExtensionItemTumblrPostTypePhoto
+                                                                      consumerKey:@"consumer-key"];
+}
+
+@end
@@ -1,4 +1,5 @@
 #import "ShareViewController.h"
+#import <MobileCoreServices/MobileCoreServices.h>
 #import <XExtensionItem/XExtensionItem.h>
 #import <XExtensionItem/XExtensionItemTumblrParameters.h>
 
@@ -18,15 +19,16 @@
         NSLog(@"XExtensionItem: %@", xExtensionItem);
         
         /*
-         Look through each extension item’s attachments array and load each attachments’ items.
+         Load each attachment once, as the type that this extension would most like to receive it as. Loading every 
+         registered type of every attachment decodes representations that will never be used, and can easily exceed 
+         the extension’s memory limit.
          */
-        for (NSItemProvider *itemProvider in xExtensionItem.attachments) {
-            for (NSString *typeIdentifier in itemProvider.registeredTypeIdentifiers) {
-                [itemProvider loadItemForTypeIdentifier:typeIdentifier options:nil completionHandler:^(id <NSSecureCoding> attachmentItem, NSError *error) {
-                    NSLog(@"Attachment item: %@", attachmentItem);
-                }];
-            }
-        }
+        [xExtensionItem loadAttachmentsWithPreferredTypeIdentifiers:@[(NSString *)kUTTypeImage, (NSString *)kUTTypeURL, (NSString *)kUTTypePlainText]
+                                                      resultHandler:^(XExtensionItemAttachmentLoadResult *result) {
+            NSLog(@"Attachment item: %@", result.item);
+        } completionHandler:^(NSArray *results, NSTimeInterval duration) {
+            NSLog(@"Loaded %lu attachments in %.3f seconds", (unsigned long)results.count, duration);
+        }];
         
         /*
          Pull out some generic parameters.
@@ -35,10 +37,10 @@
         NSLog(@"Referrer: %@", xExtensionItem.referrer);
         
         /*
-         Pull out custom parameter values by initializing a custom parameter class with the extension item’s `userInfo` 
-         dictionary.
+         Pull out custom parameter values by asking the extension item for an instance of the custom parameter class, 
+         which is decoded from its `userInfo` dictionary the first time it’s requested.
          */
-        XExtensionItemTumblrParameters *tumblrParameters = [[XExtensionItemTumblrParameters alloc] initWithDictionary:xExtensionItem.userInfo];
+        XExtensionItemTumblrParameters *tumblrParameters = [xExtensionItem customParametersOfClass:[XExtensionItemTumblrParameters class]];
         
         NSLog(@"Tumblr custom URL path component: %@", tumblrParameters.customURLPathComponent);
     }
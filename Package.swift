@@ -29,6 +29,11 @@ let package = Package(
             dependencies: ["XExtensionItem"],
             path: "XExtensionItem/Custom/Tumblr",
             publicHeadersPath: "include"
+        ),
+        .testTarget(
+            name: "XExtensionItemBenchmarks",
+            dependencies: ["XExtensionItem", "XExtensionItemCustom"],
+            path: "Benchmarks"
         )
     ]
 )
@@ -0,0 +1,61 @@
+@import UIKit;
+@import XCTest;
+#import "XExtensionItem.h"
+
+static NSString * const CustomActivityType = @"com.irace.me.CustomActivity";
+
+@interface XExtensionItemActivityRoutingTableTests : XCTestCase
+@end
+
+@implementation XExtensionItemActivityRoutingTableTests
+
+- (void)testDefaultTableIsShared {
+    XCTAssertEqual([XExtensionItemActivityRoutingTable defaultTable], [XExtensionItemActivityRoutingTable defaultTable]);
+}
+
+- (void)testDefaultTableRoutesSystemActivities {
+    XExtensionItemActivityRoutingTable *table = [XExtensionItemActivityRoutingTable defaultTable];
+
+    XCTAssertEqual(XExtensionItemActivityRouteRawItem, [table routeForActivityType:UIActivityTypeMail]);
+    XCTAssertEqual(XExtensionItemActivityRouteRawItem, [table routeForActivityType:UIActivityTypeAirDrop]);
+    XCTAssertEqual(XExtensionItemActivityRouteExtensionItem, [table routeForActivityType:UIActivityTypePostToTwitter]);
+    XCTAssertEqual(XExtensionItemActivityRouteExtensionItem, [table routeForActivityType:UIActivityTypePostToFacebook]);
+}
+
+- (void)testUnknownRouteForUnlistedActivity {
+    XExtensionItemActivityRoutingTable *table = [XExtensionItemActivityRoutingTable defaultTable];
+
+    XCTAssertEqual(XExtensionItemActivityRouteUnknown, [table routeForActivityType:CustomActivityType]);
+    XCTAssertEqual(XExtensionItemActivityRouteUnknown, [table routeForActivityType:nil]);
+}
+
+- (void)testAddedRoutesTakePrecedence {
+    XExtensionItemActivityRoutingTable *table = [[XExtensionItemActivityRoutingTable defaultTable] tableByAddingRoutes:@{
+        UIActivityTypeMail: @(XExtensionItemActivityRouteExtensionItem),
+        CustomActivityType: @(XExtensionItemActivityRouteRawItem)
+    }];
+
+    XCTAssertEqual(XExtensionItemActivityRouteExtensionItem, [table routeForActivityType:UIActivityTypeMail]);
+    XCTAssertEqual(XExtensionItemActivityRouteRawItem, [table routeForActivityType:CustomActivityType]);
+    XCTAssertEqual(XExtensionItemActivityRouteRawItem, [[XExtensionItemActivityRoutingTable defaultTable] routeForActivityType:UIActivityTypeMail]);
+}
+
+- (void)testItemSourceUsesRoutingTableOverrides {
+    NSString *text = @"Foo";
+
+    XExtensionItemSource *source = [[XExtensionItemSource alloc] initWithString:text];
+    source.activityRoutingTable = [[XExtensionItemActivityRoutingTable defaultTable] tableByAddingRoutes:@{
+        CustomActivityType: @(XExtensionItemActivityRouteRawItem)
+    }];
+
+    UIActivityViewController *controller = [[UIActivityViewController alloc] initWithActivityItems:@[] applicationActivities:@[]];
+
+    XCTAssertEqualObjects(text, [source activityViewController:controller itemForActivityType:CustomActivityType]);
+    XCTAssertTrue([[source activityViewController:controller itemForActivityType:UIActivityTypePostToTwitter] isKindOfClass:[NSExtensionItem class]]);
+
+    source.activityRoutingTable = nil;
+
+    XCTAssertEqual([XExtensionItemActivityRoutingTable defaultTable], source.activityRoutingTable);
+}
+
+@end
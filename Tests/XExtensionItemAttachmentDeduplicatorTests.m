@@ -0,0 +1,166 @@
+@import MobileCoreServices;
+@import UIKit;
+@import XCTest;
+#import "XExtensionItem.h"
+#import "XExtensionItemTestHelpers.h"
+
+@interface XExtensionItemAttachmentDeduplicatorTests : XCTestCase
+
+@property (nonatomic) XExtensionItemAttachmentDeduplicator *deduplicator;
+@property (nonatomic) NSURL *fileURL;
+
+@end
+
+@implementation XExtensionItemAttachmentDeduplicatorTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.deduplicator = [[XExtensionItemAttachmentDeduplicator alloc] init];
+    self.fileURL = [NSURL fileURLWithPath:[[NSBundle bundleForClass:self.class] pathForResource:@"mountain" ofType:@"png"]];
+}
+
+- (void)testDuplicatesByIdentityAndFilePath {
+    NSItemProvider *itemProvider = [[NSItemProvider alloc] initWithItem:@"foo" typeIdentifier:(NSString *)kUTTypePlainText];
+    NSData *data = [@"bar" dataUsingEncoding:NSUTF8StringEncoding];
+
+    NSArray *attachments = @[
+        self.fileURL,
+        itemProvider,
+        data,
+        [NSURL fileURLWithPath:self.fileURL.path],
+        [[NSItemProvider alloc] initWithItem:@"foo" typeIdentifier:(NSString *)kUTTypePlainText],
+        itemProvider,
+        [[XExtensionItemStreamingAttachment alloc] initWithFileURL:self.fileURL typeIdentifier:nil],
+        data,
+        [NSData dataWithData:data]
+    ];
+
+    NSIndexSet *duplicateIndexes = [self.deduplicator indexesOfDuplicatesInAttachments:attachments
+                                                                               options:XExtensionItemAttachmentDeduplicationIdentity | XExtensionItemAttachmentDeduplicationFilePath];
+
+    NSMutableIndexSet *expected = [[NSMutableIndexSet alloc] init];
+    [expected addIndex:3];
+    [expected addIndex:5];
+    [expected addIndex:6];
+    [expected addIndex:7];
+
+    XCTAssertEqualObjects(expected, duplicateIndexes);
+    XCTAssertEqual(4, self.deduplicator.duplicateCount);
+
+    unsigned long long fileSize = [[[NSFileManager defaultManager] attributesOfItemAtPath:self.fileURL.path error:nil] fileSize];
+    XCTAssertEqual(fileSize * 2 + data.length, self.deduplicator.savedByteCount);
+}
+
+- (void)testIdentityOnlyIgnoresFilePaths {
+    NSArray *attachments = @[self.fileURL, [NSURL fileURLWithPath:self.fileURL.path], self.fileURL];
+
+    NSIndexSet *duplicateIndexes = [self.deduplicator indexesOfDuplicatesInAttachments:attachments
+                                                                               options:XExtensionItemAttachmentDeduplicationIdentity];
+
+    XCTAssertEqualObjects([NSIndexSet indexSetWithIndex:2], duplicateIndexes);
+}
+
+- (void)testDuplicatesByContentHash {
+    NSData *fileData = [NSData dataWithContentsOfURL:self.fileURL];
+
+    NSMutableData *sameSizeData = [fileData mutableCopy];
+    ((uint8_t *)sameSizeData.mutableBytes)[0] ^= 0xFF;
+
+    NSArray *attachments = @[
+        self.fileURL,
+        [[NSItemProvider alloc] initWithItem:fileData typeIdentifier:(NSString *)kUTTypePNG],
+        sameSizeData,
+        [NSData dataWithData:fileData],
+        [@"foo" dataUsingEncoding:NSUTF8StringEncoding]
+    ];
+
+    NSIndexSet *duplicateIndexes = [self.deduplicator indexesOfDuplicatesInAttachments:attachments
+                                                                               options:XExtensionItemAttachmentDeduplicationContentHash];
+
+    XCTAssertEqualObjects([NSIndexSet indexSetWithIndex:3], duplicateIndexes);
+    XCTAssertEqual(fileData.length, self.deduplicator.savedByteCount);
+
+    // Only the three attachments of the same size were hashed
+    XCTAssertEqual(3, self.deduplicator.hashCount);
+}
+
+- (void)testHashesAreCached {
+    NSData *data = [NSData dataWithContentsOfURL:self.fileURL];
+    NSArray *attachments = @[self.fileURL, data];
+
+    XCTAssertEqualObjects([NSIndexSet indexSetWithIndex:1],
+                          [self.deduplicator indexesOfDuplicatesInAttachments:attachments options:XExtensionItemAttachmentDeduplicationContentHash]);
+    XCTAssertEqual(2, self.deduplicator.hashCount);
+
+    XCTAssertEqualObjects([NSIndexSet indexSetWithIndex:1],
+                          [self.deduplicator indexesOfDuplicatesInAttachments:attachments options:XExtensionItemAttachmentDeduplicationContentHash]);
+    XCTAssertEqual(2, self.deduplicator.hashCount);
+
+    [self.deduplicator removeAllHashes];
+
+    [self.deduplicator indexesOfDuplicatesInAttachments:attachments options:XExtensionItemAttachmentDeduplicationContentHash];
+    XCTAssertEqual(4, self.deduplicator.hashCount);
+}
+
+- (void)testAttachmentsOverMaximumAreNotHashed {
+    NSData *data = [NSData dataWithContentsOfURL:self.fileURL];
+    self.deduplicator.maximumHashedByteCount = data.length - 1;
+
+    NSIndexSet *duplicateIndexes = [self.deduplicator indexesOfDuplicatesInAttachments:@[self.fileURL, data]
+                                                                               options:XExtensionItemAttachmentDeduplicationContentHash];
+
+    XCTAssertEqual(0, duplicateIndexes.count);
+    XCTAssertEqual(0, self.deduplicator.hashCount);
+}
+
+#pragma mark - XExtensionItemSource
+
+- (void)testItemSourceLeavesOutAttachmentsDuplicatingMainItem {
+    NSItemProvider *itemProvider = [[NSItemProvider alloc] initWithItem:@"foo" typeIdentifier:(NSString *)kUTTypePlainText];
+
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithURL:self.fileURL];
+    itemSource.additionalAttachments = @[[NSURL fileURLWithPath:self.fileURL.path], itemProvider, itemProvider];
+
+    NSExtensionItem *expected = [[NSExtensionItem alloc] init];
+    expected.attachments = @[[[NSItemProvider alloc] initWithItem:self.fileURL typeIdentifier:(NSString *)kUTTypePNG], itemProvider];
+
+    XExtensionItemAssertEqualItems(expected, itemSource.facebookItem);
+}
+
+- (void)testItemSourceLeavesOutAttachmentsWithMainItemContents {
+    NSData *data = [NSData dataWithContentsOfURL:self.fileURL];
+
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithData:data typeIdentifier:(NSString *)kUTTypePNG];
+    itemSource.additionalAttachments = @[self.fileURL];
+
+    XCTAssertEqual(2, [itemSource.facebookItem attachments].count);
+
+    itemSource.attachmentDeduplication |= XExtensionItemAttachmentDeduplicationContentHash;
+
+    XCTAssertEqual(1, [itemSource.facebookItem attachments].count);
+}
+
+- (void)testItemSourceKeepsDuplicatesWithoutDeduplication {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithURL:self.fileURL];
+    itemSource.additionalAttachments = @[self.fileURL];
+    itemSource.attachmentDeduplication = XExtensionItemAttachmentDeduplicationNone;
+
+    XCTAssertEqual(2, [itemSource.facebookItem attachments].count);
+}
+
+- (void)testSavedBytesAreReportedToMetricsSink {
+    XExtensionItemMetricsRecorder *recorder = [[XExtensionItemMetricsRecorder alloc] init];
+    [XExtensionItemMetrics setSink:recorder];
+
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithURL:self.fileURL];
+    itemSource.additionalAttachments = @[[NSURL fileURLWithPath:self.fileURL.path]];
+    (void)itemSource.facebookItem;
+
+    [XExtensionItemMetrics setSink:nil];
+
+    unsigned long long fileSize = [[[NSFileManager defaultManager] attributesOfItemAtPath:self.fileURL.path error:nil] fileSize];
+    XCTAssertEqual((int64_t)fileSize, [recorder totalForCounter:XExtensionItemMetricsCounterDeduplicatedBytes]);
+}
+
+@end
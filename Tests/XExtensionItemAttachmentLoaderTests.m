@@ -0,0 +1,163 @@
+@import MobileCoreServices;
+@import XCTest;
+#import "XExtensionItem.h"
+
+@interface XExtensionItemAttachmentLoaderTests : XCTestCase
+@end
+
+@implementation XExtensionItemAttachmentLoaderTests
+
+- (void)testOnlyMostPreferredTypeIsLoaded {
+    __block NSUInteger imageLoadCount = 0;
+    __block NSUInteger textLoadCount = 0;
+
+    NSItemProvider *itemProvider = [[NSItemProvider alloc] init];
+    [itemProvider registerItemForTypeIdentifier:(NSString *)kUTTypePNG loadHandler:^(NSItemProviderCompletionHandler completionHandler, Class expectedValueClass, NSDictionary *options) {
+        imageLoadCount++;
+        completionHandler([NSData data], nil);
+    }];
+    [itemProvider registerItemForTypeIdentifier:(NSString *)kUTTypePlainText loadHandler:^(NSItemProviderCompletionHandler completionHandler, Class expectedValueClass, NSDictionary *options) {
+        textLoadCount++;
+        completionHandler(@"text", nil);
+    }];
+
+    NSArray *results = [self resultsOfLoadingItemProviders:@[itemProvider]
+                                  preferredTypeIdentifiers:@[(NSString *)kUTTypeImage, (NSString *)kUTTypePlainText]
+                                    maximumConcurrentLoads:2];
+
+    XCTAssertEqual(results.count, 1);
+    XCTAssertEqualObjects((NSString *)kUTTypeImage, [results.firstObject typeIdentifier]);
+    XCTAssertEqual(imageLoadCount, 1);
+    XCTAssertEqual(textLoadCount, 0);
+}
+
+- (void)testNonConformingAndDuplicateItemProvidersAreSkipped {
+    NSItemProvider *stringProvider = [[NSItemProvider alloc] initWithItem:@"text" typeIdentifier:(NSString *)kUTTypePlainText];
+    NSItemProvider *URLProvider = [[NSItemProvider alloc] initWithItem:[NSURL URLWithString:@"http://tumblr.com"] typeIdentifier:(NSString *)kUTTypeURL];
+
+    NSArray *results = [self resultsOfLoadingItemProviders:@[stringProvider, URLProvider, stringProvider]
+                                  preferredTypeIdentifiers:@[(NSString *)kUTTypePlainText]
+                                    maximumConcurrentLoads:2];
+
+    XCTAssertEqual(results.count, 1);
+    XCTAssertEqual([results.firstObject index], 0);
+    XCTAssertEqualObjects(@"text", [results.firstObject item]);
+}
+
+- (void)testConcurrentLoadsAreLimited {
+    __block NSUInteger activeLoads = 0;
+    __block NSUInteger peakActiveLoads = 0;
+
+    NSMutableArray *itemProviders = [[NSMutableArray alloc] init];
+
+    for (NSUInteger i = 0; i < 8; i++) {
+        NSItemProvider *itemProvider = [[NSItemProvider alloc] init];
+        [itemProvider registerItemForTypeIdentifier:(NSString *)kUTTypePlainText loadHandler:^(NSItemProviderCompletionHandler completionHandler, Class expectedValueClass, NSDictionary *options) {
+            @synchronized (itemProviders) {
+                activeLoads++;
+                peakActiveLoads = MAX(peakActiveLoads, activeLoads);
+            }
+
+            [NSThread sleepForTimeInterval:0.05];
+
+            @synchronized (itemProviders) {
+                activeLoads--;
+            }
+
+            completionHandler(@"text", nil);
+        }];
+
+        [itemProviders addObject:itemProvider];
+    }
+
+    NSArray *results = [self resultsOfLoadingItemProviders:itemProviders
+                                  preferredTypeIdentifiers:@[(NSString *)kUTTypePlainText]
+                                    maximumConcurrentLoads:3];
+
+    XCTAssertEqual(results.count, 8);
+    XCTAssertLessThanOrEqual(peakActiveLoads, 3);
+}
+
+- (void)testResultsAreDeliveredInOrderOfArrival {
+    NSItemProvider *slowProvider = [[NSItemProvider alloc] init];
+    [slowProvider registerItemForTypeIdentifier:(NSString *)kUTTypePlainText loadHandler:^(NSItemProviderCompletionHandler completionHandler, Class expectedValueClass, NSDictionary *options) {
+        [NSThread sleepForTimeInterval:0.3];
+        completionHandler(@"slow", nil);
+    }];
+
+    NSItemProvider *fastProvider = [[NSItemProvider alloc] initWithItem:@"fast" typeIdentifier:(NSString *)kUTTypePlainText];
+
+    NSArray *results = [self resultsOfLoadingItemProviders:@[slowProvider, fastProvider]
+                                  preferredTypeIdentifiers:@[(NSString *)kUTTypePlainText]
+                                    maximumConcurrentLoads:2];
+
+    XCTAssertEqualObjects((@[@"fast", @"slow"]), [results valueForKey:@"item"]);
+    XCTAssertGreaterThanOrEqual([results.lastObject loadDuration], 0.3);
+}
+
+- (void)testCancelledLoaderDoesNotCallHandlers {
+    NSItemProvider *itemProvider = [[NSItemProvider alloc] init];
+    [itemProvider registerItemForTypeIdentifier:(NSString *)kUTTypePlainText loadHandler:^(NSItemProviderCompletionHandler completionHandler, Class expectedValueClass, NSDictionary *options) {
+        [NSThread sleepForTimeInterval:0.1];
+        completionHandler(@"text", nil);
+    }];
+
+    XExtensionItemAttachmentLoader *loader = [[XExtensionItemAttachmentLoader alloc] initWithItemProviders:@[itemProvider]
+                                                                                  preferredTypeIdentifiers:@[(NSString *)kUTTypePlainText]];
+
+    [loader loadWithResultHandler:^(XExtensionItemAttachmentLoadResult *result) {
+        XCTFail(@"Result handler should not be called");
+    } completionHandler:^(NSArray *results, NSTimeInterval duration) {
+        XCTFail(@"Completion handler should not be called");
+    }];
+
+    [loader cancel];
+
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.3]];
+}
+
+- (void)testExtensionItemLoadsAttachments {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithURL:[NSURL URLWithString:@"http://tumblr.com"]];
+    itemSource.additionalAttachments = @[@"text"];
+
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:[itemSource extensionItemForActivityType:nil]];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Load attachments"];
+    NSMutableArray *deliveredResults = [[NSMutableArray alloc] init];
+
+    [xExtensionItem loadAttachmentsWithPreferredTypeIdentifiers:@[(NSString *)kUTTypeURL, (NSString *)kUTTypePlainText] resultHandler:^(XExtensionItemAttachmentLoadResult *result) {
+        XCTAssertTrue([NSThread isMainThread]);
+        [deliveredResults addObject:result];
+    } completionHandler:^(NSArray *results, NSTimeInterval duration) {
+        XCTAssertEqualObjects(deliveredResults, results);
+        XCTAssertEqual(results.count, 2);
+        XCTAssertGreaterThanOrEqual(duration, 0);
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+}
+
+#pragma mark - Private
+
+- (NSArray *)resultsOfLoadingItemProviders:(NSArray *)itemProviders
+                  preferredTypeIdentifiers:(NSArray *)preferredTypeIdentifiers
+                    maximumConcurrentLoads:(NSUInteger)maximumConcurrentLoads {
+    XExtensionItemAttachmentLoader *loader = [[XExtensionItemAttachmentLoader alloc] initWithItemProviders:itemProviders
+                                                                                  preferredTypeIdentifiers:preferredTypeIdentifiers];
+    loader.maximumConcurrentLoads = maximumConcurrentLoads;
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Load attachments"];
+    __block NSArray *loadedResults;
+
+    [loader loadWithResultHandler:nil completionHandler:^(NSArray *results, NSTimeInterval duration) {
+        loadedResults = results;
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+
+    return loadedResults;
+}
+
+@end
@@ -0,0 +1,149 @@
+@import MobileCoreServices;
+@import UIKit;
+@import XCTest;
+#import "XExtensionItem.h"
+#import "XExtensionItemTestHelpers.h"
+
+@interface XExtensionItemCorpusTests : XCTestCase
+
+@property (nonatomic) NSURL *directoryURL;
+@property (nonatomic) XExtensionItemCorpus *corpus;
+
+@end
+
+@implementation XExtensionItemCorpusTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.directoryURL = [[NSURL fileURLWithPath:NSTemporaryDirectory() isDirectory:YES] URLByAppendingPathComponent:[NSUUID UUID].UUIDString isDirectory:YES];
+    self.corpus = [[XExtensionItemCorpus alloc] initWithDirectoryURL:self.directoryURL];
+}
+
+- (void)tearDown {
+    [[NSFileManager defaultManager] removeItemAtURL:self.directoryURL error:nil];
+
+    [super tearDown];
+}
+
+- (void)testRecordedItemSourceDecodesInAnotherCorpusInstance {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@"foo"];
+    itemSource.title = @"Title";
+    itemSource.attributedContentText = [[NSAttributedString alloc] initWithString:@"Content text"];
+    itemSource.tags = @[@"bar", @"baz"];
+    itemSource.referrer = [[XExtensionItemReferrer alloc] initWithAppName:@"Tumblr" appStoreID:@"305343404" googlePlayID:nil webURL:nil iOSAppURL:nil androidAppURL:nil];
+    itemSource.userInfo = @{ @"qux": @"quux" };
+
+    NSError *error;
+    NSArray *recorded = [self.corpus recordItemSource:itemSource activityTypes:@[UIActivityTypePostToFacebook, UIActivityTypeMail] error:&error];
+    XCTAssertEqual(2, recorded.count, @"%@", error);
+
+    NSArray *recordings = [[[XExtensionItemCorpus alloc] initWithDirectoryURL:self.directoryURL] recordings];
+    XCTAssertEqualObjects((@[UIActivityTypePostToFacebook, UIActivityTypeMail]), [recordings valueForKey:@"activityType"]);
+
+    XExtensionItemCorpusRecording *recording = recordings.firstObject;
+    XCTAssertEqual(XExtensionItemCorpusDirectionSent, recording.direction);
+    XCTAssertNotNil(recording.recordDate);
+    XCTAssertGreaterThan(recording.byteCount, 0);
+
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:recording.extensionItem];
+    XCTAssertEqualObjects(@"Title", xExtensionItem.title);
+    XCTAssertEqualObjects(@"Content text", xExtensionItem.attributedContentText.string);
+    XCTAssertEqualObjects(itemSource.tags, xExtensionItem.tags);
+    XCTAssertEqualObjects(itemSource.referrer, xExtensionItem.referrer);
+    XCTAssertEqualObjects(@"quux", xExtensionItem.userInfo[@"qux"]);
+}
+
+- (void)testReceivedItemIsRecorded {
+    NSExtensionItem *extensionItem = [[NSExtensionItem alloc] init];
+    extensionItem.attributedTitle = [[NSAttributedString alloc] initWithString:@"Title"];
+
+    NSError *error;
+    XExtensionItemCorpusRecording *recording = [self.corpus recordExtensionItem:extensionItem
+                                                                    activityType:nil
+                                                                       direction:XExtensionItemCorpusDirectionReceived
+                                                                           error:&error];
+    XCTAssertNotNil(recording, @"%@", error);
+
+    XExtensionItemCorpusRecording *readRecording = self.corpus.recordings.firstObject;
+    XCTAssertEqualObjects(recording.fileURL, readRecording.fileURL);
+    XCTAssertEqual(XExtensionItemCorpusDirectionReceived, readRecording.direction);
+    XCTAssertNil(readRecording.activityType);
+    XCTAssertEqualObjects(@"Title", readRecording.extensionItem.attributedTitle.string);
+}
+
+- (void)testAttachmentTypeIdentifiersAreRecorded {
+    NSItemProvider *itemProvider = [[NSItemProvider alloc] initWithItem:@"foo" typeIdentifier:(NSString *)kUTTypePlainText];
+    [itemProvider registerItemForTypeIdentifier:(NSString *)kUTTypeURL loadHandler:^(NSItemProviderCompletionHandler completionHandler, Class expectedClass, NSDictionary *options) {
+        completionHandler([NSURL URLWithString:@"http://tumblr.com"], nil);
+    }];
+
+    NSExtensionItem *extensionItem = [[NSExtensionItem alloc] init];
+    extensionItem.attachments = @[itemProvider, [[NSItemProvider alloc] initWithItem:@"bar" typeIdentifier:(NSString *)kUTTypeHTML]];
+
+    [self.corpus recordExtensionItem:extensionItem activityType:nil direction:XExtensionItemCorpusDirectionReceived error:nil];
+
+    NSArray *attachments = [self.corpus.recordings.firstObject extensionItem].attachments;
+    XCTAssertEqual(2, attachments.count);
+    XCTAssertEqualObjects(itemProvider.registeredTypeIdentifiers, [attachments.firstObject registeredTypeIdentifiers]);
+    XCTAssertEqualObjects(@[(NSString *)kUTTypeHTML], [attachments.lastObject registeredTypeIdentifiers]);
+}
+
+- (void)testRecordingsAreInRecordOrder {
+    NSMutableArray *titles = [[NSMutableArray alloc] init];
+
+    for (NSUInteger i = 0; i < 20; i++) {
+        NSString *title = [NSString stringWithFormat:@"%lu", (unsigned long)i];
+        [titles addObject:title];
+
+        NSExtensionItem *extensionItem = [[NSExtensionItem alloc] init];
+        extensionItem.attributedTitle = [[NSAttributedString alloc] initWithString:title];
+
+        [self.corpus recordExtensionItem:extensionItem activityType:nil direction:XExtensionItemCorpusDirectionReceived error:nil];
+    }
+
+    XCTAssertEqualObjects(titles, [self.corpus.recordings valueForKeyPath:@"extensionItem.attributedTitle.string"]);
+}
+
+- (void)testUnreadableFilesAreSkipped {
+    NSExtensionItem *extensionItem = [[NSExtensionItem alloc] init];
+    extensionItem.attributedTitle = [[NSAttributedString alloc] initWithString:@"Title"];
+
+    XExtensionItemCorpusRecording *recording = [self.corpus recordExtensionItem:extensionItem activityType:nil direction:XExtensionItemCorpusDirectionSent error:nil];
+
+    NSURL *corruptFileURL = [self.directoryURL URLByAppendingPathComponent:@"00000000000000000-corrupt.xeitem"];
+    [[@"foo" dataUsingEncoding:NSUTF8StringEncoding] writeToURL:corruptFileURL atomically:YES];
+    [[@"bar" dataUsingEncoding:NSUTF8StringEncoding] writeToURL:[self.directoryURL URLByAppendingPathComponent:@"notes.txt"] atomically:YES];
+
+    NSArray *recordings = self.corpus.recordings;
+    XCTAssertEqual(1, recordings.count);
+    XCTAssertEqualObjects(recording.fileURL, [recordings.firstObject fileURL]);
+}
+
+- (void)testSetsAndNullAreRecorded {
+    NSExtensionItem *extensionItem = [[NSExtensionItem alloc] init];
+    extensionItem.userInfo = @{ @"foo": [NSSet setWithObject:@"bar"], @"baz": [NSNull null] };
+
+    NSError *error;
+    XCTAssertNotNil([self.corpus recordExtensionItem:extensionItem activityType:nil direction:XExtensionItemCorpusDirectionReceived error:&error], @"%@", error);
+
+    NSDictionary *userInfo = [self.corpus.recordings.firstObject extensionItem].userInfo;
+    XCTAssertEqualObjects([NSSet setWithObject:@"bar"], userInfo[@"foo"]);
+    XCTAssertEqualObjects([NSNull null], userInfo[@"baz"]);
+}
+
+- (void)testItemsThatCantBeArchivedFailToRecord {
+    NSExtensionItem *extensionItem = [[NSExtensionItem alloc] init];
+    extensionItem.userInfo = @{ @"foo": [NSTimeZone timeZoneForSecondsFromGMT:0] };
+
+    NSError *error;
+    XCTAssertNil([self.corpus recordExtensionItem:extensionItem activityType:nil direction:XExtensionItemCorpusDirectionSent error:&error]);
+    XCTAssertNotNil(error);
+    XCTAssertEqual(0, self.corpus.recordings.count);
+}
+
+- (void)testEmptyDirectoryHasNoRecordings {
+    XCTAssertEqualObjects(@[], self.corpus.recordings);
+}
+
+@end
@@ -0,0 +1,382 @@
+@import UIKit;
+@import XCTest;
+#import <mach/mach.h>
+#import "XExtensionItem.h"
+
+static NSUInteger const FuzzIterationCount = 500;
+
+/*
+ For a whole fuzzing run rather than each iteration, so that a slow or busy test machine doesn’t fail a single iteration
+ that happens to be descheduled.
+ */
+static CFTimeInterval const MaximumFuzzingDecodingDuration = 20;
+
+/*
+ How much the process may grow by over a whole fuzzing run. Far above what payloads within the fuzzing limits need, but
+ far below what decoding an unbounded payload would.
+ */
+static uint64_t const MaximumFuzzingResidentSizeGrowth = 64 * 1024 * 1024;
+
+@interface XExtensionItemDecodingLimitsTests : XCTestCase
+
+@property (nonatomic) CFTimeInterval fuzzingDecodingDuration;
+@property (nonatomic) uint64_t fuzzingBaselineResidentSize;
+@property (nonatomic) uint64_t fuzzingPeakResidentSize;
+
+@end
+
+@implementation XExtensionItemDecodingLimitsTests
+
+- (void)testDefaultLimitsAcceptPayloadsWrittenBySource {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@""];
+    itemSource.tags = @[@"foo", @"bar"];
+    itemSource.userInfo = @{ @"foo": @{ @"bar": @[@1, @"baz"] } };
+
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:extensionItemFromSource(itemSource)];
+    XCTAssertEqualObjects(itemSource.tags, xExtensionItem.tags);
+    XCTAssertEqualObjects(itemSource.userInfo[@"foo"], xExtensionItem.userInfo[@"foo"]);
+    XCTAssertEqual(0, xExtensionItem.decodingIssues.count);
+}
+
+- (void)testLongStringsAreTruncatedAndReported {
+    XExtensionItemDecodingLimits *limits = [XExtensionItemDecodingLimits defaultLimits];
+    limits.maximumStringLength = 5;
+
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:extensionItemWithUserInfo(@{ @"foo": @{ @"bar": @"bazbazbaz" } })
+                                                                    decodingLimits:limits];
+    XCTAssertEqualObjects(@"bazba", xExtensionItem.userInfo[@"foo"][@"bar"]);
+
+    XExtensionItemDecodingIssue *issue = xExtensionItem.decodingIssues.firstObject;
+    XCTAssertEqual(1, xExtensionItem.decodingIssues.count);
+    XCTAssertEqual(XExtensionItemDecodingIssueKindTruncated, issue.kind);
+    XCTAssertEqualObjects(@"foo.bar", issue.keyPath);
+    XCTAssertEqual(5, issue.limit);
+    XCTAssertEqual(9, issue.count);
+}
+
+- (void)testStringsAreNotTruncatedInsideComposedCharacters {
+    XExtensionItemDecodingLimits *limits = [XExtensionItemDecodingLimits defaultLimits];
+    limits.maximumStringLength = 3;
+
+    // The emoji is a surrogate pair starting at index 2
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:extensionItemWithUserInfo(@{ @"foo": @"ab😀cd" })
+                                                                    decodingLimits:limits];
+    XCTAssertEqualObjects(@"ab", xExtensionItem.userInfo[@"foo"]);
+}
+
+- (void)testTagsAreTruncated {
+    NSMutableArray *tags = [[NSMutableArray alloc] init];
+
+    for (NSUInteger i = 0; i < 300; i++) {
+        [tags addObject:[NSString stringWithFormat:@"tag%lu", (unsigned long)i]];
+    }
+
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@""];
+    itemSource.tags = tags;
+
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:extensionItemFromSource(itemSource)];
+    XCTAssertEqualObjects([tags subarrayWithRange:NSMakeRange(0, 250)], xExtensionItem.tags);
+    XCTAssertEqual(1, xExtensionItem.decodingIssues.count);
+    XCTAssertEqualObjects(@"x-extension-item.tags", [xExtensionItem.decodingIssues.firstObject keyPath]);
+}
+
+- (void)testLargeCollectionsAreTruncated {
+    XExtensionItemDecodingLimits *limits = [XExtensionItemDecodingLimits defaultLimits];
+    limits.maximumCollectionCount = 3;
+
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:extensionItemWithUserInfo(@{ @"foo": @[@1, @2, @3, @4, @5] })
+                                                                    decodingLimits:limits];
+    XCTAssertEqualObjects((@[@1, @2, @3]), xExtensionItem.userInfo[@"foo"]);
+    XCTAssertEqual(XExtensionItemDecodingIssueKindTruncated, [xExtensionItem.decodingIssues.firstObject kind]);
+}
+
+- (void)testDeeplyNestedCollectionsAreDropped {
+    id nested = @"foo";
+
+    for (NSUInteger i = 0; i < 10000; i++) {
+        nested = (i % 2) ? @[nested] : @{ @"foo": nested };
+    }
+
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:extensionItemWithUserInfo(@{ @"nested": nested })];
+    XCTAssertEqual(8, nestingDepth(xExtensionItem.userInfo));
+
+    XExtensionItemDecodingIssue *issue = xExtensionItem.decodingIssues.firstObject;
+    XCTAssertEqual(1, xExtensionItem.decodingIssues.count);
+    XCTAssertEqual(XExtensionItemDecodingIssueKindDropped, issue.kind);
+    XCTAssertEqual(9, issue.count);
+}
+
+- (void)testLargeUserInfoIsRejected {
+    XExtensionItemDecodingLimits *limits = [XExtensionItemDecodingLimits defaultLimits];
+    limits.maximumUserInfoByteCount = 1024;
+    limits.maximumStringLength = 16;
+
+    NSDictionary *userInfo = @{ @"x-extension-item": @{ @"tags": @[@"foo"] }, @"long": @"stringstringstring", @"data": [NSMutableData dataWithLength:2048] };
+
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:extensionItemWithUserInfo(userInfo) decodingLimits:limits];
+    XCTAssertEqualObjects(@{}, xExtensionItem.userInfo);
+    XCTAssertEqual(0, xExtensionItem.tags.count);
+
+    // Issues found before the limit was exceeded aren’t reported, since none of userInfo is kept
+    XExtensionItemDecodingIssue *issue = xExtensionItem.decodingIssues.firstObject;
+    XCTAssertEqual(1, xExtensionItem.decodingIssues.count);
+    XCTAssertEqual(XExtensionItemDecodingIssueKindRejected, issue.kind);
+    XCTAssertEqualObjects(@"", issue.keyPath);
+    XCTAssertEqual(1024, issue.limit);
+}
+
+- (void)testLargeBinaryParametersAreRejected {
+    XExtensionItemDecodingLimits *limits = [XExtensionItemDecodingLimits defaultLimits];
+    limits.maximumBinaryParametersByteCount = 16;
+
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@""];
+    itemSource.tags = @[@"foo", @"bar", @"baz"];
+    itemSource.parameterEncoding = XExtensionItemParameterEncodingBinary;
+
+    NSExtensionItem *item = extensionItemFromSource(itemSource);
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:item decodingLimits:limits];
+    XCTAssertEqual(0, xExtensionItem.tags.count);
+
+    XExtensionItemDecodingIssue *issue = xExtensionItem.decodingIssues.firstObject;
+    XCTAssertEqual(XExtensionItemDecodingIssueKindRejected, issue.kind);
+    XCTAssertEqualObjects(@"x-extension-item-binary", issue.keyPath);
+    XCTAssertEqual([item.userInfo[@"x-extension-item-binary"] length], issue.count);
+}
+
+- (void)testLimitsAreCopied {
+    XExtensionItemDecodingLimits *limits = [XExtensionItemDecodingLimits defaultLimits];
+
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:extensionItemWithUserInfo(@{ @"foo": @"bar" }) decodingLimits:limits];
+    limits.maximumStringLength = 1;
+
+    XCTAssertEqualObjects(@"bar", xExtensionItem.userInfo[@"foo"]);
+}
+
+#pragma mark - Fuzzing
+
+- (void)testFuzzedUserInfoIsDecodedWithinLimits {
+    uint32_t seed = 0x5EED;
+    XExtensionItemDecodingLimits *limits = fuzzingLimits();
+
+    [self beginFuzzing];
+
+    for (NSUInteger i = 0; i < FuzzIterationCount; i++) {
+        @autoreleasepool {
+            NSDictionary *userInfo = @{ @"fuzz": randomValue(&seed, 0), @"x-extension-item": randomValue(&seed, 0) };
+
+            [self assertExtensionItem:extensionItemWithUserInfo(userInfo) isDecodedWithinLimits:limits iteration:i];
+        }
+    }
+
+    [self assertFuzzingStayedWithinBudget];
+}
+
+- (void)testFuzzedBinaryParametersAreDecodedWithinLimits {
+    uint32_t seed = 0xB1AB;
+    XExtensionItemDecodingLimits *limits = fuzzingLimits();
+
+    [self beginFuzzing];
+
+    for (NSUInteger i = 0; i < FuzzIterationCount; i++) {
+        @autoreleasepool {
+            XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@""];
+            itemSource.tags = randomTags(&seed);
+            itemSource.userInfo = @{ @"fuzz": randomValue(&seed, 0) };
+            itemSource.parameterEncoding = XExtensionItemParameterEncodingBinary;
+
+            NSMutableDictionary *userInfo = [extensionItemFromSource(itemSource).userInfo mutableCopy];
+            userInfo[@"x-extension-item-binary"] = mutatedData(&seed, userInfo[@"x-extension-item-binary"]);
+
+            [self assertExtensionItem:extensionItemWithUserInfo(userInfo) isDecodedWithinLimits:limits iteration:i];
+        }
+    }
+
+    [self assertFuzzingStayedWithinBudget];
+}
+
+- (void)beginFuzzing {
+    self.fuzzingDecodingDuration = 0;
+    self.fuzzingBaselineResidentSize = residentSize();
+    self.fuzzingPeakResidentSize = self.fuzzingBaselineResidentSize;
+}
+
+- (void)assertExtensionItem:(NSExtensionItem *)item isDecodedWithinLimits:(XExtensionItemDecodingLimits *)limits iteration:(NSUInteger)iteration {
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:item decodingLimits:limits];
+
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    NSDictionary *userInfo = xExtensionItem.userInfo;
+    NSArray *tags = xExtensionItem.tags;
+    (void)xExtensionItem.sourceURL;
+    (void)xExtensionItem.referrer;
+    self.fuzzingDecodingDuration += CFAbsoluteTimeGetCurrent() - start;
+    self.fuzzingPeakResidentSize = MAX(self.fuzzingPeakResidentSize, residentSize());
+
+    XCTAssertTrue(isWithinLimits(userInfo, 1, limits), @"Iteration %lu", (unsigned long)iteration);
+    XCTAssertLessThanOrEqual(tags.count, limits.maximumTagCount, @"Iteration %lu", (unsigned long)iteration);
+
+    // The bounding pass counts every byte that this estimate does, plus collection and number overhead
+    XCTAssertLessThanOrEqual([XExtensionItemPayload estimatedByteCountOfValue:userInfo], limits.maximumUserInfoByteCount,
+                             @"Iteration %lu", (unsigned long)iteration);
+}
+
+- (void)assertFuzzingStayedWithinBudget {
+    XCTAssertLessThan(self.fuzzingDecodingDuration, MaximumFuzzingDecodingDuration);
+    XCTAssertLessThan(self.fuzzingPeakResidentSize - self.fuzzingBaselineResidentSize, MaximumFuzzingResidentSizeGrowth);
+}
+
+#pragma mark - Private
+
+static NSExtensionItem *extensionItemWithUserInfo(NSDictionary *userInfo) {
+    NSExtensionItem *item = [[NSExtensionItem alloc] init];
+    item.userInfo = userInfo;
+    return item;
+}
+
+static uint64_t residentSize(void) {
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) {
+        return 0;
+    }
+
+    return info.resident_size;
+}
+
+static NSExtensionItem *extensionItemFromSource(XExtensionItemSource *itemSource) {
+    return [itemSource activityViewController:[[UIActivityViewController alloc] initWithActivityItems:@[] applicationActivities:@[]]
+                          itemForActivityType:UIActivityTypePostToFacebook];
+}
+
+/*
+ Lower than the defaults, so that random payloads regularly exceed them.
+ */
+static XExtensionItemDecodingLimits *fuzzingLimits(void) {
+    XExtensionItemDecodingLimits *limits = [XExtensionItemDecodingLimits defaultLimits];
+    limits.maximumUserInfoByteCount = 64 * 1024;
+    limits.maximumNestingDepth = 4;
+    limits.maximumCollectionCount = 16;
+    limits.maximumStringLength = 256;
+    limits.maximumTagCount = 8;
+    return limits;
+}
+
+static NSUInteger nestingDepth(id value) {
+    NSUInteger depth = 0;
+
+    if ([value isKindOfClass:[NSArray class]] || [value isKindOfClass:[NSDictionary class]]) {
+        for (id element in ([value isKindOfClass:[NSDictionary class]] ? [value allValues] : value)) {
+            depth = MAX(depth, nestingDepth(element));
+        }
+
+        depth++;
+    }
+
+    return depth;
+}
+
+static BOOL isWithinLimits(id value, NSUInteger depth, XExtensionItemDecodingLimits *limits) {
+    if ([value isKindOfClass:[NSString class]]) {
+        return ((NSString *)value).length <= limits.maximumStringLength;
+    }
+    else if ([value isKindOfClass:[NSArray class]] || [value isKindOfClass:[NSDictionary class]]) {
+        if (depth > limits.maximumNestingDepth || [value count] > limits.maximumCollectionCount) {
+            return NO;
+        }
+
+        if ([value isKindOfClass:[NSDictionary class]]) {
+            for (id key in value) {
+                if (!isWithinLimits(key, depth, limits) || !isWithinLimits(value[key], depth + 1, limits)) {
+                    return NO;
+                }
+            }
+        }
+        else {
+            for (id element in value) {
+                if (!isWithinLimits(element, depth + 1, limits)) {
+                    return NO;
+                }
+            }
+        }
+    }
+
+    return YES;
+}
+
+/*
+ xorshift32, so that failures can be reproduced from the seed.
+ */
+static uint32_t randomNumber(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/*
+ Collections nest deeper than the fuzzing limits allow, but are kept small enough that payloads don’t grow exponentially.
+ */
+static id randomValue(uint32_t *seed, NSUInteger depth) {
+    switch (randomNumber(seed) % (depth < 6 ? 7 : 4)) {
+        case 0:
+            return @(randomNumber(seed));
+        case 1:
+            return [@"" stringByPaddingToLength:randomNumber(seed) % 512 withString:@"x😀" startingAtIndex:0];
+        case 2:
+            return [NSURL URLWithString:[@"http://tumblr.com/" stringByPaddingToLength:randomNumber(seed) % 512 withString:@"a" startingAtIndex:0]];
+        case 3:
+            return [NSMutableData dataWithLength:randomNumber(seed) % 8192];
+        case 4:
+        case 5: {
+            NSMutableArray *array = [[NSMutableArray alloc] init];
+
+            for (NSUInteger i = randomNumber(seed) % 8; i > 0; i--) {
+                [array addObject:randomValue(seed, depth + 1)];
+            }
+
+            return array;
+        }
+        default: {
+            NSMutableDictionary *dictionary = [[NSMutableDictionary alloc] init];
+
+            for (NSUInteger i = randomNumber(seed) % 8; i > 0; i--) {
+                dictionary[[@"" stringByPaddingToLength:randomNumber(seed) % 300 withString:@"k" startingAtIndex:0]] = randomValue(seed, depth + 1);
+            }
+
+            return dictionary;
+        }
+    }
+}
+
+static NSArray *randomTags(uint32_t *seed) {
+    NSMutableArray *tags = [[NSMutableArray alloc] init];
+
+    for (NSUInteger i = randomNumber(seed) % 32; i > 0; i--) {
+        [tags addObject:[@"" stringByPaddingToLength:randomNumber(seed) % 512 withString:@"t" startingAtIndex:0]];
+    }
+
+    return tags;
+}
+
+static NSData *mutatedData(uint32_t *seed, NSData *data) {
+    NSMutableData *mutatedData = [data mutableCopy];
+
+    switch (randomNumber(seed) % 3) {
+        case 0:
+            mutatedData.length = mutatedData.length ? randomNumber(seed) % mutatedData.length : 0;
+            break;
+        case 1:
+            for (NSUInteger i = randomNumber(seed) % 8; i > 0 && mutatedData.length; i--) {
+                ((uint8_t *)mutatedData.mutableBytes)[randomNumber(seed) % mutatedData.length] = (uint8_t)randomNumber(seed);
+            }
+            break;
+        default:
+            break;
+    }
+
+    return mutatedData;
+}
+
+@end
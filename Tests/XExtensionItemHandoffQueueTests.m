@@ -0,0 +1,260 @@
+@import MobileCoreServices;
+@import UIKit;
+@import XCTest;
+#import "XExtensionItem.h"
+#import "XExtensionItemTestHelpers.h"
+
+@interface XExtensionItemHandoffQueueTests : XCTestCase
+
+@property (nonatomic) NSURL *directoryURL;
+@property (nonatomic) XExtensionItemHandoffQueue *queue;
+
+@end
+
+@implementation XExtensionItemHandoffQueueTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.directoryURL = [[NSURL fileURLWithPath:NSTemporaryDirectory() isDirectory:YES] URLByAppendingPathComponent:[NSUUID UUID].UUIDString isDirectory:YES];
+    self.queue = [[XExtensionItemHandoffQueue alloc] initWithDirectoryURL:self.directoryURL];
+}
+
+- (void)tearDown {
+    [[NSFileManager defaultManager] removeItemAtURL:self.directoryURL error:nil];
+
+    [super tearDown];
+}
+
+- (void)testEnqueuedItemIsPendingInAnotherQueueInstance {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@"foo"];
+    itemSource.title = @"Title";
+    itemSource.attributedContentText = [[NSAttributedString alloc] initWithString:@"Content text"];
+    itemSource.tags = @[@"bar", @"baz"];
+    itemSource.userInfo = @{ @"qux": @"quux" };
+
+    XExtensionItemHandoffEntry *enqueuedEntry = [self enqueueItemSource:itemSource preferredTypeIdentifiers:@[(NSString *)kUTTypePlainText]];
+    XCTAssertNotNil(enqueuedEntry);
+
+    NSArray *entries = [[[XExtensionItemHandoffQueue alloc] initWithDirectoryURL:self.directoryURL] pendingEntries];
+    XCTAssertEqual(1, entries.count);
+
+    XExtensionItemHandoffEntry *entry = entries.firstObject;
+    XCTAssertEqualObjects(enqueuedEntry.identifier, entry.identifier);
+    XCTAssertEqualObjects(@"Title", entry.extensionItem.title);
+    XCTAssertEqualObjects(@"Content text", entry.extensionItem.attributedContentText.string);
+    XCTAssertEqualObjects(itemSource.tags, entry.extensionItem.tags);
+    XCTAssertEqualObjects(@"quux", entry.extensionItem.userInfo[@"qux"]);
+
+    XExtensionItemAssertEqualItemProviderArrays(entry.extensionItem.attachments,
+                                                 @[[[NSItemProvider alloc] initWithItem:@"foo" typeIdentifier:(NSString *)kUTTypePlainText]]);
+}
+
+- (void)testFileAttachmentsAreCopied {
+    NSURL *fileURL = [NSURL fileURLWithPath:[[NSBundle bundleForClass:self.class] pathForResource:@"mountain" ofType:@"png"]];
+
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithURL:fileURL];
+    XExtensionItemHandoffEntry *entry = [self enqueueItemSource:itemSource preferredTypeIdentifiers:@[(NSString *)kUTTypeImage]];
+
+    NSURL *copiedFileURL = entry.attachmentFileURLs.firstObject;
+    XCTAssertEqual(1, entry.attachmentFileURLs.count);
+    XCTAssertTrue([copiedFileURL.path hasPrefix:self.directoryURL.path]);
+    XCTAssertEqualObjects([NSData dataWithContentsOfURL:fileURL], [NSData dataWithContentsOfURL:copiedFileURL]);
+    XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:fileURL.path]);
+}
+
+- (void)testItemWithUnencodableParametersIsNotEnqueued {
+    NSExtensionItem *extensionItem = [[NSExtensionItem alloc] init];
+    extensionItem.userInfo = @{ @"foo": @"bar", @"baz": [NSSet setWithObject:@"qux"] };
+    extensionItem.attachments = @[[[NSItemProvider alloc] initWithItem:@"foo" typeIdentifier:(NSString *)kUTTypePlainText]];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Enqueue extension item"];
+
+    [self.queue enqueueExtensionItem:[[XExtensionItem alloc] initWithExtensionItem:extensionItem]
+            preferredTypeIdentifiers:@[(NSString *)kUTTypePlainText]
+                   completionHandler:^(XExtensionItemHandoffEntry *entry, NSError *error) {
+        XCTAssertNil(entry);
+        XCTAssertEqualObjects(@[@"baz"], error.userInfo[XExtensionItemHandoffQueueUnencodableKeysErrorKey]);
+
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30 handler:nil];
+
+    XCTAssertEqual(0, self.queue.pendingEntries.count);
+    XCTAssertEqual(0, [self copiedAttachmentCountExcludingEntry:nil]);
+}
+
+- (void)testDrainRemovesProcessedEntries {
+    NSMutableArray *identifiers = [[NSMutableArray alloc] init];
+
+    for (NSString *string in @[@"foo", @"bar", @"baz"]) {
+        [identifiers addObject:[self enqueueItemSource:[[XExtensionItemSource alloc] initWithString:string]
+                                preferredTypeIdentifiers:@[(NSString *)kUTTypePlainText]].identifier];
+    }
+
+    NSUInteger removedCount = [self.queue drainWithHandler:^BOOL(XExtensionItemHandoffEntry *entry) {
+        return [entry.identifier isEqual:identifiers[1]];
+    }];
+
+    XCTAssertEqual(1, removedCount);
+    XCTAssertEqualObjects((@[identifiers[0], identifiers[2]]), [self.queue.pendingEntries valueForKey:@"identifier"]);
+
+    removedCount = [self.queue drainWithHandler:^BOOL(XExtensionItemHandoffEntry *entry) {
+        return YES;
+    }];
+
+    XCTAssertEqual(2, removedCount);
+    XCTAssertEqual(0, self.queue.pendingEntries.count);
+
+    // Emptying the queue empties the log, and removed entries’ attachments are deleted
+    NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:[self logFileURL].path error:nil];
+    XCTAssertEqual(0, attributes.fileSize);
+
+    for (NSString *identifier in identifiers) {
+        XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:[[self attachmentsDirectoryURL] URLByAppendingPathComponent:identifier].path]);
+    }
+}
+
+- (void)testDrainDoesntDeleteAttachmentsOfEnqueueInProgress {
+    XExtensionItemHandoffEntry *drainedEntry = [self enqueueItemSource:[[XExtensionItemSource alloc] initWithString:@"foo"]
+                                              preferredTypeIdentifiers:@[(NSString *)kUTTypePlainText]];
+
+    // The second attachment doesn’t load until the queue has been drained
+    dispatch_semaphore_t drained = dispatch_semaphore_create(0);
+    NSItemProvider *blockedItemProvider = [[NSItemProvider alloc] init];
+    [blockedItemProvider registerItemForTypeIdentifier:(NSString *)kUTTypePlainText loadHandler:^(NSItemProviderCompletionHandler completionHandler, Class expectedClass, NSDictionary *options) {
+        dispatch_semaphore_wait(drained, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC));
+        completionHandler(@"baz", nil);
+    }];
+
+    NSExtensionItem *extensionItem = [[NSExtensionItem alloc] init];
+    extensionItem.attachments = @[[[NSItemProvider alloc] initWithItem:@"bar" typeIdentifier:(NSString *)kUTTypePlainText], blockedItemProvider];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Enqueue extension item"];
+    __block XExtensionItemHandoffEntry *enqueuedEntry;
+
+    [self.queue enqueueExtensionItem:[[XExtensionItem alloc] initWithExtensionItem:extensionItem]
+            preferredTypeIdentifiers:@[(NSString *)kUTTypePlainText]
+                   completionHandler:^(XExtensionItemHandoffEntry *entry, NSError *error) {
+        XCTAssertNil(error);
+        enqueuedEntry = entry;
+
+        [expectation fulfill];
+    }];
+
+    // Wait for the first attachment to be copied
+    NSDate *timeoutDate = [NSDate dateWithTimeIntervalSinceNow:10];
+
+    while ([self copiedAttachmentCountExcludingEntry:drainedEntry] == 0 && [timeoutDate timeIntervalSinceNow] > 0) {
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+
+    XCTAssertEqual(1, [self.queue drainWithHandler:^BOOL(XExtensionItemHandoffEntry *entry) {
+        return YES;
+    }]);
+
+    dispatch_semaphore_signal(drained);
+    [self waitForExpectationsWithTimeout:30 handler:nil];
+
+    XCTAssertEqual(2, enqueuedEntry.attachmentFileURLs.count);
+
+    for (NSURL *fileURL in enqueuedEntry.attachmentFileURLs) {
+        XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:fileURL.path]);
+    }
+}
+
+- (void)testEmptyingQueueDeletesOnlyOldAbandonedAttachments {
+    XExtensionItemHandoffEntry *entry = [self enqueueItemSource:[[XExtensionItemSource alloc] initWithString:@"foo"]
+                                       preferredTypeIdentifiers:@[(NSString *)kUTTypePlainText]];
+
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSURL *oldDirectoryURL = [[self attachmentsDirectoryURL] URLByAppendingPathComponent:@"old" isDirectory:YES];
+    NSURL *recentDirectoryURL = [[self attachmentsDirectoryURL] URLByAppendingPathComponent:@"recent" isDirectory:YES];
+
+    [fileManager createDirectoryAtURL:oldDirectoryURL withIntermediateDirectories:YES attributes:nil error:nil];
+    [fileManager createDirectoryAtURL:recentDirectoryURL withIntermediateDirectories:YES attributes:nil error:nil];
+    [fileManager setAttributes:@{ NSFileModificationDate: [NSDate dateWithTimeIntervalSinceNow:-2 * 24 * 60 * 60] } ofItemAtPath:oldDirectoryURL.path error:nil];
+
+    XCTAssertTrue([self.queue removeEntry:entry error:nil]);
+
+    XCTAssertFalse([fileManager fileExistsAtPath:oldDirectoryURL.path]);
+    XCTAssertTrue([fileManager fileExistsAtPath:recentDirectoryURL.path]);
+}
+
+- (void)testPartlyWrittenRecordIsDiscarded {
+    [self enqueueItemSource:[[XExtensionItemSource alloc] initWithString:@"foo"] preferredTypeIdentifiers:@[(NSString *)kUTTypePlainText]];
+
+    // A header promising more payload than was written, as if the process was terminated mid-write
+    uint32_t header[2] = { CFSwapInt32HostToLittle(1000), 0 };
+    NSMutableData *partlyWrittenRecord = [NSMutableData dataWithBytes:header length:sizeof(header)];
+    [partlyWrittenRecord increaseLengthBy:10];
+    [self appendToLog:partlyWrittenRecord];
+
+    XCTAssertEqual(1, self.queue.pendingEntries.count);
+
+    [self enqueueItemSource:[[XExtensionItemSource alloc] initWithString:@"bar"] preferredTypeIdentifiers:@[(NSString *)kUTTypePlainText]];
+
+    XCTAssertEqual(2, self.queue.pendingEntries.count);
+}
+
+- (void)testRecordsFailingTheirChecksumAreIgnored {
+    [self enqueueItemSource:[[XExtensionItemSource alloc] initWithString:@"foo"] preferredTypeIdentifiers:@[(NSString *)kUTTypePlainText]];
+
+    [self enqueueItemSource:[[XExtensionItemSource alloc] initWithString:@"bar"] preferredTypeIdentifiers:@[(NSString *)kUTTypePlainText]];
+
+    NSMutableData *log = [[NSData dataWithContentsOfURL:[self logFileURL]] mutableCopy];
+    ((uint8_t *)log.mutableBytes)[log.length - 1] ^= 0xFF;
+    [log writeToURL:[self logFileURL] atomically:YES];
+
+    XCTAssertEqual(1, self.queue.pendingEntries.count);
+}
+
+#pragma mark - Private
+
+- (XExtensionItemHandoffEntry *)enqueueItemSource:(XExtensionItemSource *)itemSource preferredTypeIdentifiers:(NSArray *)preferredTypeIdentifiers {
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:itemSource.facebookItem];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Enqueue extension item"];
+    __block XExtensionItemHandoffEntry *enqueuedEntry;
+
+    [self.queue enqueueExtensionItem:xExtensionItem preferredTypeIdentifiers:preferredTypeIdentifiers completionHandler:^(XExtensionItemHandoffEntry *entry, NSError *error) {
+        XCTAssertNil(error);
+        enqueuedEntry = entry;
+
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30 handler:nil];
+
+    return enqueuedEntry;
+}
+
+- (NSURL *)logFileURL {
+    return [self.directoryURL URLByAppendingPathComponent:@"queue.log"];
+}
+
+- (NSURL *)attachmentsDirectoryURL {
+    return [self.directoryURL URLByAppendingPathComponent:@"Attachments" isDirectory:YES];
+}
+
+- (NSUInteger)copiedAttachmentCountExcludingEntry:(XExtensionItemHandoffEntry *)entry {
+    NSUInteger count = 0;
+
+    for (NSString *identifier in [[NSFileManager defaultManager] contentsOfDirectoryAtPath:[self attachmentsDirectoryURL].path error:nil]) {
+        if (![identifier isEqualToString:entry.identifier]) {
+            count += [[NSFileManager defaultManager] contentsOfDirectoryAtPath:[[self attachmentsDirectoryURL] URLByAppendingPathComponent:identifier].path error:nil].count;
+        }
+    }
+
+    return count;
+}
+
+- (void)appendToLog:(NSData *)data {
+    NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingToURL:[self logFileURL] error:nil];
+    [fileHandle seekToEndOfFile];
+    [fileHandle writeData:data];
+    [fileHandle closeFile];
+}
+
+@end
@@ -0,0 +1,159 @@
+@import MobileCoreServices;
+@import XCTest;
+#import "XExtensionItem.h"
+
+@interface XExtensionItemMetricsTests : XCTestCase
+
+@property (nonatomic) XExtensionItemMetricsRecorder *recorder;
+
+@end
+
+@implementation XExtensionItemMetricsTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.recorder = [[XExtensionItemMetricsRecorder alloc] init];
+    [XExtensionItemMetrics setSink:self.recorder];
+}
+
+- (void)tearDown {
+    [XExtensionItemMetrics setSink:nil];
+
+    [super tearDown];
+}
+
+- (void)testNoEventsWithoutSink {
+    [XExtensionItemMetrics setSink:nil];
+
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithURL:[NSURL URLWithString:@"http://tumblr.com"]];
+    [itemSource activityViewController:[self activityViewController] itemForActivityType:UIActivityTypePostToFacebook];
+
+    XCTAssertEqual(self.recorder.events.count, 0);
+}
+
+- (void)testReplacingSinkWhileRecording {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithURL:[NSURL URLWithString:@"http://tumblr.com"]];
+    itemSource.tags = @[@"foo"];
+
+    dispatch_apply(8, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t iteration) {
+        for (NSUInteger i = 0; i < 500; i++) {
+            if (iteration == 0) {
+                // Each replaced sink is released as soon as no event is being sent to it
+                [XExtensionItemMetrics setSink:i % 2 == 0 ? [[XExtensionItemMetricsRecorder alloc] init] : nil];
+            }
+            else {
+                [itemSource removeCachedExtensionItems];
+                [itemSource activityViewController:nil itemForActivityType:UIActivityTypePostToFacebook];
+            }
+        }
+    });
+
+    [XExtensionItemMetrics setSink:self.recorder];
+    [self.recorder removeAllEvents];
+
+    [itemSource activityViewController:nil itemForActivityType:UIActivityTypePostToFacebook];
+    XCTAssertEqualObjects(@[XExtensionItemMetricsSpanItemForActivityType], self.recorder.completedSpanNames);
+}
+
+- (void)testItemForActivityTypeSpanAndCounters {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithURL:[NSURL URLWithString:@"http://tumblr.com"]];
+    itemSource.additionalAttachments = @[@"text", [NSURL URLWithString:@"http://apple.com"]];
+    itemSource.tags = @[@"foo"];
+
+    [itemSource activityViewController:[self activityViewController] itemForActivityType:UIActivityTypePostToFacebook];
+
+    XCTAssertEqualObjects(@[XExtensionItemMetricsSpanItemForActivityType], self.recorder.completedSpanNames);
+    XCTAssertEqual([self.recorder totalForCounter:XExtensionItemMetricsCounterAttachmentCount], 3);
+    XCTAssertGreaterThan([self.recorder totalForCounter:XExtensionItemMetricsCounterPayloadKeyCount], 0);
+}
+
+- (void)testActivityItemBlockSpanIsNestedInItemForActivityTypeSpan {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithPlaceholderItem:@"placeholder" typeIdentifier:nil itemBlock:^id(NSString *activityType) {
+        return @"item";
+    }];
+
+    [itemSource activityViewController:[self activityViewController] itemForActivityType:UIActivityTypeMail];
+
+    NSArray *events = self.recorder.events;
+
+    XCTAssertEqual(events.count, 4);
+    XCTAssertEqualObjects(XExtensionItemMetricsSpanItemForActivityType, [events[0] name]);
+    XCTAssertEqualObjects(XExtensionItemMetricsSpanActivityItemBlock, [events[1] name]);
+    XCTAssertEqualObjects(XExtensionItemMetricsSpanActivityItemBlock, [events[2] name]);
+    XCTAssertEqualObjects(XExtensionItemMetricsSpanItemForActivityType, [events[3] name]);
+    XCTAssertEqual([events[1] identifier], [events[2] identifier]);
+    XCTAssertNotEqual([events[0] identifier], [events[1] identifier]);
+}
+
+- (void)testThumbnailProviderSpanOnlyOnCacheMiss {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithURL:[NSURL URLWithString:@"http://tumblr.com"]];
+    itemSource.thumbnailProvider = ^UIImage *(CGSize suggestedSize, NSString *activityType) {
+        return [[UIImage alloc] init];
+    };
+
+    [itemSource activityViewController:[self activityViewController] thumbnailImageForActivityType:UIActivityTypeMail suggestedSize:CGSizeMake(100, 100)];
+    [itemSource activityViewController:[self activityViewController] thumbnailImageForActivityType:UIActivityTypeMail suggestedSize:CGSizeMake(100, 100)];
+
+    XCTAssertEqualObjects(@[XExtensionItemMetricsSpanThumbnailProvider], self.recorder.completedSpanNames);
+}
+
+- (void)testDecodingSpanAndCounters {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithURL:[NSURL URLWithString:@"http://tumblr.com"]];
+    itemSource.tags = @[@"foo"];
+    NSExtensionItem *extensionItem = [itemSource extensionItemForActivityType:nil];
+
+    [self.recorder removeAllEvents];
+
+    (void)[[XExtensionItem alloc] initWithExtensionItem:extensionItem].userInfo;
+
+    XCTAssertEqualObjects(@[XExtensionItemMetricsSpanDecoding], self.recorder.completedSpanNames);
+    XCTAssertEqual([self.recorder totalForCounter:XExtensionItemMetricsCounterPayloadKeyCount], (int64_t)extensionItem.userInfo.count);
+    XCTAssertEqual([self.recorder totalForCounter:XExtensionItemMetricsCounterAttachmentCount], 1);
+    XCTAssertEqual([self.recorder durationsForSpan:XExtensionItemMetricsSpanDecoding].count, 1);
+}
+
+- (void)testReadingAttachmentsDoesNotDecodeParameters {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithURL:[NSURL URLWithString:@"http://tumblr.com"]];
+    itemSource.tags = @[@"foo"];
+    itemSource.referrer = [[XExtensionItemReferrer alloc] initWithAppName:@"Tumblr" appStoreID:nil googlePlayID:nil webURL:nil iOSAppURL:nil androidAppURL:nil];
+    NSExtensionItem *extensionItem = [itemSource extensionItemForActivityType:nil];
+
+    [self.recorder removeAllEvents];
+
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:extensionItem];
+    XCTAssertEqual(xExtensionItem.attachments.count, 1);
+    XCTAssertEqual(self.recorder.events.count, 0);
+
+    XCTAssertEqualObjects(@[@"foo"], xExtensionItem.tags);
+    XCTAssertEqualObjects(@"Tumblr", xExtensionItem.referrer.appName);
+    XCTAssertEqualObjects((@[XExtensionItemMetricsSpanDecoding, XExtensionItemMetricsSpanDecoding]), self.recorder.completedSpanNames);
+}
+
+- (void)testAttachmentLoadSpansAndBytes {
+    NSData *firstData = [@"abcdef" dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *secondData = [@"ghi" dataUsingEncoding:NSUTF8StringEncoding];
+
+    XExtensionItemAttachmentLoader *loader = [[XExtensionItemAttachmentLoader alloc] initWithItemProviders:@[[[NSItemProvider alloc] initWithItem:firstData typeIdentifier:(NSString *)kUTTypeData],
+                                                                                                             [[NSItemProvider alloc] initWithItem:secondData typeIdentifier:(NSString *)kUTTypeData]]
+                                                                                  preferredTypeIdentifiers:@[(NSString *)kUTTypeData]];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Load attachments"];
+
+    [loader loadWithResultHandler:nil completionHandler:^(NSArray *results, NSTimeInterval duration) {
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+
+    XCTAssertEqualObjects((@[XExtensionItemMetricsSpanAttachmentLoad, XExtensionItemMetricsSpanAttachmentLoad]), self.recorder.completedSpanNames);
+    XCTAssertEqual([self.recorder totalForCounter:XExtensionItemMetricsCounterBytes], (int64_t)(firstData.length + secondData.length));
+}
+
+#pragma mark - Private
+
+- (UIActivityViewController *)activityViewController {
+    return [[UIActivityViewController alloc] initWithActivityItems:@[] applicationActivities:@[]];
+}
+
+@end
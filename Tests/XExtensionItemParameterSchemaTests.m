@@ -0,0 +1,208 @@
+@import XCTest;
+#import "XExtensionItem.h"
+#import "XExtensionItemTumblrParameters.h"
+
+static NSString * const IdentifierKey = @"identifier";
+static NSString * const CountKey = @"count";
+static NSString * const EnabledKey = @"enabled";
+static NSString * const CreatedKey = @"created";
+
+/**
+ A schema-backed parameters class exercising required, scalar, and defaulted fields.
+ */
+@interface SchemaParameters : NSObject <XExtensionItemSchemaParameters>
+
+@property (nonatomic, copy) NSString *identifier;
+@property (nonatomic) NSUInteger count;
+@property (nonatomic) BOOL enabled;
+@property (nonatomic) NSDate *created;
+
+@end
+
+@implementation SchemaParameters
+
++ (NSArray *)parameterFields {
+    return @[
+        [XExtensionItemParameterField requiredFieldWithKey:IdentifierKey propertyName:@"identifier" type:XExtensionItemParameterTypeString],
+        [XExtensionItemParameterField optionalFieldWithKey:CountKey propertyName:@"count" type:XExtensionItemParameterTypeUnsignedInteger defaultValue:@3],
+        [XExtensionItemParameterField optionalFieldWithKey:EnabledKey propertyName:@"enabled" type:XExtensionItemParameterTypeBool defaultValue:@YES],
+        [XExtensionItemParameterField optionalFieldWithKey:CreatedKey propertyName:@"created" type:XExtensionItemParameterTypeDate],
+    ];
+}
+
+- (instancetype)initWithDictionary:(NSDictionary *)dictionary {
+    self = [super init];
+    if (self && ![[XExtensionItemParameterSchema schemaForClass:[self class]] decodeDictionary:dictionary intoObject:self]) {
+        return nil;
+    }
+
+    return self;
+}
+
+- (NSDictionary *)dictionaryRepresentation {
+    return [[XExtensionItemParameterSchema schemaForClass:[self class]] dictionaryRepresentationOfObject:self];
+}
+
+- (BOOL)isEqual:(id)object {
+    return [[XExtensionItemParameterSchema schemaForClass:[self class]] isObject:self equalToObject:object];
+}
+
+- (NSUInteger)hash {
+    return [[XExtensionItemParameterSchema schemaForClass:[self class]] hashOfObject:self];
+}
+
+@end
+
+@interface XExtensionItemParameterSchemaTests : XCTestCase
+@end
+
+@implementation XExtensionItemParameterSchemaTests
+
+- (void)testSchemaIsCachedPerClass {
+    XCTAssertEqual([XExtensionItemParameterSchema schemaForClass:[SchemaParameters class]],
+                   [XExtensionItemParameterSchema schemaForClass:[SchemaParameters class]]);
+}
+
+- (void)testRoundTrip {
+    NSDate *created = [NSDate dateWithTimeIntervalSince1970:1000];
+    NSDictionary *dictionary = @{ IdentifierKey: @"abc", CountKey: @7, EnabledKey: @NO, CreatedKey: created };
+
+    SchemaParameters *parameters = [[SchemaParameters alloc] initWithDictionary:dictionary];
+
+    XCTAssertEqualObjects(@"abc", parameters.identifier);
+    XCTAssertEqual(7, parameters.count);
+    XCTAssertFalse(parameters.enabled);
+    XCTAssertEqualObjects(created, parameters.created);
+    XCTAssertEqualObjects(dictionary, parameters.dictionaryRepresentation);
+}
+
+- (void)testMissingOptionalFieldsUseDefaultValues {
+    SchemaParameters *parameters = [[SchemaParameters alloc] initWithDictionary:@{ IdentifierKey: @"abc" }];
+
+    XCTAssertEqual(3, parameters.count);
+    XCTAssertTrue(parameters.enabled);
+    XCTAssertNil(parameters.created);
+    XCTAssertNil(parameters.dictionaryRepresentation[CreatedKey]);
+}
+
+- (void)testMistypedValuesAreTreatedAsMissing {
+    SchemaParameters *parameters = [[SchemaParameters alloc] initWithDictionary:@{ IdentifierKey: @"abc", CountKey: @"7", CreatedKey: @1 }];
+
+    XCTAssertEqual(3, parameters.count);
+    XCTAssertNil(parameters.created);
+}
+
+- (void)testMissingRequiredFieldFailsDecoding {
+    XCTAssertNil([[SchemaParameters alloc] initWithDictionary:@{ CountKey: @7 }]);
+    XCTAssertNil([[SchemaParameters alloc] initWithDictionary:@{ IdentifierKey: @7 }]);
+}
+
+- (void)testEqualityAndHashCoverEveryField {
+    SchemaParameters *parameters = [[SchemaParameters alloc] initWithDictionary:@{ IdentifierKey: @"abc", CountKey: @7 }];
+    SchemaParameters *equalParameters = [[SchemaParameters alloc] initWithDictionary:@{ IdentifierKey: @"abc", CountKey: @7 }];
+    SchemaParameters *otherParameters = [[SchemaParameters alloc] initWithDictionary:@{ IdentifierKey: @"abc", CountKey: @8 }];
+
+    XCTAssertEqualObjects(parameters, equalParameters);
+    XCTAssertEqual(parameters.hash, equalParameters.hash);
+    XCTAssertNotEqualObjects(parameters, otherParameters);
+}
+
+- (void)testReferrersWithOnlyNilFieldsAreEqual {
+    XCTAssertEqualObjects([[XExtensionItemReferrer alloc] init], [[XExtensionItemReferrer alloc] init]);
+}
+
+- (void)testReferrerEqualityConsidersAllFields {
+    XExtensionItemReferrer *referrer = [[XExtensionItemReferrer alloc] initWithAppName:@"Tumblr"
+                                                                            appStoreID:@"12345"
+                                                                          googlePlayID:nil
+                                                                                webURL:[NSURL URLWithString:@"http://tumblr.com/post/1"]
+                                                                             iOSAppURL:nil
+                                                                         androidAppURL:nil];
+
+    XExtensionItemReferrer *otherReferrer = [[XExtensionItemReferrer alloc] initWithAppName:@"Tumblr"
+                                                                                 appStoreID:@"12345"
+                                                                               googlePlayID:nil
+                                                                                     webURL:[NSURL URLWithString:@"http://tumblr.com/post/2"]
+                                                                                  iOSAppURL:nil
+                                                                              androidAppURL:nil];
+
+    XCTAssertNotEqualObjects(referrer, otherReferrer);
+    XCTAssertEqualObjects(referrer, [[XExtensionItemReferrer alloc] initWithDictionary:referrer.dictionaryRepresentation]);
+}
+
+- (void)testEqualReferrersAreInterned {
+    XExtensionItemReferrer *referrer = [[XExtensionItemReferrer alloc] initWithAppName:@"Tumblr"
+                                                                            appStoreID:@"12345"
+                                                                          googlePlayID:nil
+                                                                                webURL:nil
+                                                                             iOSAppURL:nil
+                                                                         androidAppURL:nil];
+
+    XExtensionItemReferrer *equalReferrer = [[XExtensionItemReferrer alloc] initWithAppName:@"Tumblr"
+                                                                                 appStoreID:@"12345"
+                                                                               googlePlayID:nil
+                                                                                     webURL:nil
+                                                                                  iOSAppURL:nil
+                                                                              androidAppURL:nil];
+
+    XCTAssertEqual(referrer, equalReferrer);
+    XCTAssertEqual(referrer, [[XExtensionItemReferrer alloc] initWithDictionary:referrer.dictionaryRepresentation]);
+    XCTAssertEqual(referrer.dictionaryRepresentation, equalReferrer.dictionaryRepresentation);
+}
+
+- (void)testReferrersFromSameBundleAreInterned {
+    NSBundle *bundle = [NSBundle bundleForClass:[self class]];
+
+    XExtensionItemReferrer *referrer = [[XExtensionItemReferrer alloc] initWithAppNameFromBundle:bundle appStoreID:nil googlePlayID:nil webURL:nil iOSAppURL:nil androidAppURL:nil];
+    XExtensionItemReferrer *equalReferrer = [[XExtensionItemReferrer alloc] initWithAppNameFromBundle:bundle appStoreID:nil googlePlayID:nil webURL:nil iOSAppURL:nil androidAppURL:nil];
+
+    XCTAssertNotNil(referrer.appName);
+    XCTAssertEqual(referrer, equalReferrer);
+}
+
+- (void)testReferrersDifferingInAnyFieldAreNotEqual {
+    NSURL *URL = [NSURL URLWithString:@"http://tumblr.com"];
+    NSArray *referrers = @[
+        [[XExtensionItemReferrer alloc] initWithAppName:@"Tumblr" appStoreID:nil googlePlayID:nil webURL:nil iOSAppURL:nil androidAppURL:nil],
+        [[XExtensionItemReferrer alloc] initWithAppName:nil appStoreID:@"Tumblr" googlePlayID:nil webURL:nil iOSAppURL:nil androidAppURL:nil],
+        [[XExtensionItemReferrer alloc] initWithAppName:nil appStoreID:nil googlePlayID:@"Tumblr" webURL:nil iOSAppURL:nil androidAppURL:nil],
+        [[XExtensionItemReferrer alloc] initWithAppName:nil appStoreID:nil googlePlayID:nil webURL:URL iOSAppURL:nil androidAppURL:nil],
+        [[XExtensionItemReferrer alloc] initWithAppName:nil appStoreID:nil googlePlayID:nil webURL:nil iOSAppURL:URL androidAppURL:nil],
+        [[XExtensionItemReferrer alloc] initWithAppName:nil appStoreID:nil googlePlayID:nil webURL:nil iOSAppURL:nil androidAppURL:URL],
+    ];
+
+    XCTAssertEqual([NSSet setWithArray:referrers].count, referrers.count);
+}
+
+- (void)testTumblrParametersRoundTrip {
+    XExtensionItemTumblrParameters *parameters = [[XExtensionItemTumblrParameters alloc] initWithCustomURLPathComponent:@"pancakes"
+                                                                                                      requestedPostType:XExtensionItemTumblrPostTypeQuote
+                                                                                                            consumerKey:@"key"];
+
+    XCTAssertEqualObjects(parameters, [[XExtensionItemTumblrParameters alloc] initWithDictionary:parameters.dictionaryRepresentation]);
+}
+
+- (void)testTumblrConvenienceInitializerKeepsArguments {
+    XExtensionItemTumblrParameters *parameters = [[XExtensionItemTumblrParameters alloc] initWithCustomURLPathComponent:@"pancakes"
+                                                                                                            consumerKey:@"key"];
+
+    XCTAssertEqualObjects(@"pancakes", parameters.customURLPathComponent);
+    XCTAssertEqualObjects(@"key", parameters.consumerKey);
+    XCTAssertEqual(XExtensionItemTumblrPostTypeAny, parameters.requestedPostType);
+}
+
+- (void)testTumblrCorrelationIdentifierRoundTrip {
+    XExtensionItemTumblrParameters *parameters = [[XExtensionItemTumblrParameters alloc] initWithCustomURLPathComponent:nil
+                                                                                                      requestedPostType:XExtensionItemTumblrPostTypeAny
+                                                                                                            consumerKey:nil
+                                                                                                  correlationIdentifier:@"correlation"];
+
+    XCTAssertEqualObjects(@"correlation", parameters.dictionaryRepresentation[@"com.tumblr.tumblr.correlation-identifier"]);
+    XCTAssertEqualObjects(parameters, [[XExtensionItemTumblrParameters alloc] initWithDictionary:parameters.dictionaryRepresentation]);
+}
+
+- (void)testTumblrRequestedPostTypeDefaultsToAny {
+    XCTAssertEqual(XExtensionItemTumblrPostTypeAny, [[XExtensionItemTumblrParameters alloc] initWithDictionary:@{}].requestedPostType);
+}
+
+@end
@@ -0,0 +1,226 @@
+@import MobileCoreServices;
+@import UIKit;
+@import XCTest;
+#import "XExtensionItem.h"
+#import "XExtensionItemTestHelpers.h"
+
+@interface XExtensionItemPayloadCompactionTests : XCTestCase
+@end
+
+@implementation XExtensionItemPayloadCompactionTests
+
+#pragma mark - Estimation
+
+- (void)testEstimatedByteCountOfValues {
+    XCTAssertEqual(1024, [XExtensionItemPayload estimatedByteCountOfValue:[NSMutableData dataWithLength:1024]]);
+    XCTAssertEqual(6, [XExtensionItemPayload estimatedByteCountOfValue:@"foo"]);
+    XCTAssertEqual(6, [XExtensionItemPayload estimatedByteCountOfValue:[[NSAttributedString alloc] initWithString:@"foo"]]);
+    XCTAssertEqual(18, [XExtensionItemPayload estimatedByteCountOfValue:@{ @"foo": @[@"bar", @"baz"] }]);
+    XCTAssertEqual(0, [XExtensionItemPayload estimatedByteCountOfValue:[[NSItemProvider alloc] initWithItem:@"foo" typeIdentifier:(NSString *)kUTTypePlainText]]);
+
+    // Files are passed by reference
+    NSURL *fileURL = [NSURL fileURLWithPath:[[NSBundle bundleForClass:self.class] pathForResource:@"mountain" ofType:@"png"]];
+    XCTAssertEqual(fileURL.absoluteString.length * sizeof(unichar), [XExtensionItemPayload estimatedByteCountOfValue:fileURL]);
+}
+
+- (void)testEstimatedPayloadByteCount {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithData:[NSMutableData dataWithLength:1024] typeIdentifier:(NSString *)kUTTypePNG];
+    NSUInteger byteCount = [itemSource estimatedPayloadByteCountForActivityType:UIActivityTypePostToFacebook];
+
+    itemSource.additionalAttachments = @[@"foo"];
+    itemSource.attributedContentText = [[NSAttributedString alloc] initWithString:@"bar"];
+
+    XCTAssertGreaterThanOrEqual(byteCount, 1024);
+    XCTAssertEqual(byteCount + 12, [itemSource estimatedPayloadByteCountForActivityType:UIActivityTypePostToFacebook]);
+}
+
+#pragma mark - Compaction steps
+
+- (void)testPayloadWithinBudgetIsLeftAlone {
+    XExtensionItemPayload *payload = [self payloadWithMainItem:@"foo" additionalAttachments:@[@"bar"] contentText:@"baz"];
+
+    XCTAssertNil([payload compactToByteBudget:18 steps:@[[[XExtensionItemDropAttachmentsCompactionStep alloc] init]]]);
+    XCTAssertEqualObjects(@[@"bar"], payload.additionalAttachments);
+}
+
+- (void)testStepsRunInOrderUntilPayloadFits {
+    NSString *longText = [@"" stringByPaddingToLength:1000 withString:@"a" startingAtIndex:0];
+    XExtensionItemPayload *payload = [self payloadWithMainItem:[NSMutableData dataWithLength:10000]
+                                         additionalAttachments:@[[@"" stringByPaddingToLength:100 withString:@"b" startingAtIndex:0]]
+                                                   contentText:longText];
+    XCTAssertEqual(12200, payload.estimatedByteCount);
+
+    // Falls short of the budget, so that text has to be truncated as well
+    XExtensionItemTranscodeDataCompactionStep *transcodeStep = [[XExtensionItemTranscodeDataCompactionStep alloc] initWithTranscoder:^NSData *(NSData *data, NSString *typeIdentifier, unsigned long long maximumByteCount) {
+        XCTAssertEqualObjects((NSString *)kUTTypePNG, typeIdentifier);
+        XCTAssertEqual(1000, maximumByteCount);
+
+        return [NSMutableData dataWithLength:2000];
+    }];
+    transcodeStep.minimumByteCount = 0;
+
+    NSArray *steps = @[[[XExtensionItemDropAttachmentsCompactionStep alloc] init], transcodeStep, [[XExtensionItemTruncateTextCompactionStep alloc] init]];
+    XExtensionItemPayloadCompactionReport *report = [payload compactToByteBudget:3000 steps:steps];
+
+    XCTAssertEqualObjects((@[@(XExtensionItemPayloadCompactionActionKindDroppedAttachment),
+                             @(XExtensionItemPayloadCompactionActionKindTranscodedData),
+                             @(XExtensionItemPayloadCompactionActionKindTruncatedText)]), [report.actions valueForKey:@"kind"]);
+    XCTAssertEqual(12200, report.originalByteCount);
+    XCTAssertEqual(3000, report.byteCount);
+    XCTAssertTrue(report.isWithinBudget);
+
+    XCTAssertEqual(0, payload.additionalAttachments.count);
+    XCTAssertEqual(2000, ((NSData *)payload.mainItem).length);
+    XCTAssertEqual(500, payload.attributedContentText.length);
+}
+
+- (void)testLaterStepsDontRunOncePayloadFits {
+    XExtensionItemPayload *payload = [self payloadWithMainItem:@"foo" additionalAttachments:@[@"bar", @"baz"] contentText:@"qux"];
+
+    XExtensionItemPayloadCompactionReport *report = [payload compactToByteBudget:18
+                                                                           steps:@[[[XExtensionItemDropAttachmentsCompactionStep alloc] init],
+                                                                                   [[XExtensionItemTruncateTextCompactionStep alloc] init]]];
+
+    XCTAssertEqual(1, report.actions.count);
+    XCTAssertEqualObjects(@"baz", [report.actions.firstObject item]);
+    XCTAssertEqualObjects(@[@"bar"], payload.additionalAttachments);
+    XCTAssertEqualObjects(@"qux", payload.attributedContentText.string);
+}
+
+- (void)testTranscoderIsOnlyGivenLargeData {
+    __block NSUInteger transcodeCount = 0;
+
+    XExtensionItemTranscodeDataCompactionStep *transcodeStep = [[XExtensionItemTranscodeDataCompactionStep alloc] initWithTranscoder:^NSData *(NSData *data, NSString *typeIdentifier, unsigned long long maximumByteCount) {
+        transcodeCount++;
+
+        return [NSMutableData dataWithLength:maximumByteCount];
+    }];
+    transcodeStep.minimumByteCount = 2048;
+
+    NSData *smallData = [NSMutableData dataWithLength:1024];
+    XExtensionItemPayload *payload = [self payloadWithMainItem:smallData additionalAttachments:@[[NSMutableData dataWithLength:4096]] contentText:nil];
+
+    XExtensionItemPayloadCompactionReport *report = [payload compactToByteBudget:2048 steps:@[transcodeStep]];
+
+    XCTAssertEqual(1, transcodeCount);
+    XCTAssertEqual(smallData, payload.mainItem);
+    XCTAssertEqual(1024, [payload.additionalAttachments.firstObject length]);
+    XCTAssertTrue(report.isWithinBudget);
+}
+
+- (void)testTruncationDoesntSplitComposedCharacters {
+    XExtensionItemPayload *payload = [self payloadWithMainItem:nil additionalAttachments:nil contentText:@"👍👍👍"];
+
+    [payload compactToByteBudget:8 steps:@[[[XExtensionItemTruncateTextCompactionStep alloc] init]]];
+
+    XCTAssertEqualObjects(@"👍…", payload.attributedContentText.string);
+}
+
+- (void)testTruncationKeepsAttributes {
+    NSDictionary *attributes = @{ NSForegroundColorAttributeName: [UIColor redColor] };
+    XExtensionItemPayload *payload = [self payloadWithMainItem:nil additionalAttachments:nil contentText:nil];
+    payload.attributedContentText = [[NSAttributedString alloc] initWithString:@"foobar" attributes:attributes];
+
+    [payload compactToByteBudget:8 steps:@[[[XExtensionItemTruncateTextCompactionStep alloc] init]]];
+
+    XCTAssertEqualObjects([[NSAttributedString alloc] initWithString:@"foo…" attributes:attributes], payload.attributedContentText);
+}
+
+#pragma mark - XExtensionItemSource
+
+- (void)testItemSourceCompactsPayloadsOverBudget {
+    NSString *longString = [@"" stringByPaddingToLength:1000 withString:@"a" startingAtIndex:0];
+
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@"foo"];
+    itemSource.additionalAttachments = @[@"bar", longString];
+    itemSource.payloadByteBudget = [itemSource estimatedPayloadByteCountForActivityType:UIActivityTypePostToFacebook] - 1000;
+
+    NSMutableArray *reports = [[NSMutableArray alloc] init];
+    itemSource.payloadCompactionHandler = ^(XExtensionItemPayloadCompactionReport *report) {
+        [reports addObject:report];
+    };
+
+    NSExtensionItem *expected = [[NSExtensionItem alloc] init];
+    expected.attachments = @[[[NSItemProvider alloc] initWithItem:@"foo" typeIdentifier:(NSString *)kUTTypePlainText],
+                             [[NSItemProvider alloc] initWithItem:@"bar" typeIdentifier:(NSString *)kUTTypePlainText]];
+
+    XExtensionItemAssertEqualItems(expected, itemSource.facebookItem);
+    XCTAssertEqual(1, reports.count);
+    XCTAssertEqualObjects(UIActivityTypePostToFacebook, [reports.firstObject activityType]);
+    XCTAssertEqualObjects(longString, [[reports.firstObject actions].firstObject item]);
+
+    // Compacted payloads are cached like any other
+    (void)itemSource.facebookItem;
+    XCTAssertEqual(1, reports.count);
+}
+
+- (void)testItemSourceHandsDataToTranscoder {
+    __block NSData *transcodedData;
+
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithData:[NSMutableData dataWithLength:100 * 1024] typeIdentifier:(NSString *)kUTTypePNG];
+    itemSource.payloadCompactionSteps = @[[[XExtensionItemTranscodeDataCompactionStep alloc] initWithTranscoder:^NSData *(NSData *data, NSString *typeIdentifier, unsigned long long maximumByteCount) {
+        transcodedData = [NSMutableData dataWithLength:maximumByteCount];
+        return transcodedData;
+    }]];
+    itemSource.payloadByteBudget = [itemSource estimatedPayloadByteCountForActivityType:UIActivityTypePostToFacebook] - 80 * 1024;
+
+    NSExtensionItem *actual = itemSource.facebookItem;
+    XCTAssertEqual(20 * 1024, transcodedData.length);
+
+    NSExtensionItem *expected = [[NSExtensionItem alloc] init];
+    expected.attachments = @[[[NSItemProvider alloc] initWithItem:transcodedData typeIdentifier:(NSString *)kUTTypePNG]];
+
+    XExtensionItemAssertEqualItems(expected, actual);
+}
+
+- (void)testItemSourceTruncatesContentText {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@"foo"];
+    itemSource.attributedContentText = [[NSAttributedString alloc] initWithString:[@"" stringByPaddingToLength:500 withString:@"a" startingAtIndex:0]];
+    itemSource.payloadByteBudget = [itemSource estimatedPayloadByteCountForActivityType:UIActivityTypePostToFacebook] - 400;
+
+    NSAttributedString *contentText = [itemSource.facebookItem attributedContentText];
+    XCTAssertEqual(300, contentText.length);
+    XCTAssertTrue([contentText.string hasSuffix:@"…"]);
+}
+
+- (void)testAttachmentsWithoutEstimatedSizeSurviveTextTruncation {
+    NSArray *itemProviders = @[[[NSItemProvider alloc] initWithItem:@"bar" typeIdentifier:(NSString *)kUTTypePlainText],
+                               [[NSItemProvider alloc] initWithItem:@"baz" typeIdentifier:(NSString *)kUTTypePlainText]];
+
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@"foo"];
+    itemSource.additionalAttachments = itemProviders;
+    itemSource.attributedContentText = [[NSAttributedString alloc] initWithString:[@"" stringByPaddingToLength:500 withString:@"a" startingAtIndex:0]];
+    itemSource.payloadByteBudget = [itemSource estimatedPayloadByteCountForActivityType:UIActivityTypePostToFacebook] - 400;
+
+    NSMutableArray *reports = [[NSMutableArray alloc] init];
+    itemSource.payloadCompactionHandler = ^(XExtensionItemPayloadCompactionReport *report) {
+        [reports addObject:report];
+    };
+
+    NSExtensionItem *item = itemSource.facebookItem;
+    XCTAssertEqual(3, item.attachments.count);
+    XCTAssertEqual(300, item.attributedContentText.length);
+    XCTAssertEqualObjects(@[@(XExtensionItemPayloadCompactionActionKindTruncatedText)], [[reports.firstObject actions] valueForKey:@"kind"]);
+}
+
+- (void)testPayloadBudgetForActivityType {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@"foo"];
+    itemSource.additionalAttachments = @[@"bar"];
+    [itemSource setPayloadByteBudget:1 forActivityType:UIActivityTypePostToTwitter];
+
+    XCTAssertEqual(2, [itemSource.facebookItem attachments].count);
+    XCTAssertEqual(1, [[itemSource activityViewController:nil itemForActivityType:UIActivityTypePostToTwitter] attachments].count);
+}
+
+#pragma mark - Private
+
+- (XExtensionItemPayload *)payloadWithMainItem:(id)mainItem additionalAttachments:(NSArray *)additionalAttachments contentText:(NSString *)contentText {
+    return [[XExtensionItemPayload alloc] initWithActivityType:nil
+                                                      mainItem:mainItem
+                                                typeIdentifier:(NSString *)kUTTypePNG
+                                         additionalAttachments:additionalAttachments
+                                         attributedContentText:contentText ? [[NSAttributedString alloc] initWithString:contentText] : nil
+                                                      userInfo:nil];
+}
+
+@end
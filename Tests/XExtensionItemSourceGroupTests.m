@@ -0,0 +1,156 @@
+@import XCTest;
+#import "CustomParameters.h"
+#import "XExtensionItem.h"
+
+@interface XExtensionItemSourceGroupTests : XCTestCase
+@end
+
+@implementation XExtensionItemSourceGroupTests
+
+- (void)testGroupParametersApplyToEveryItemSource {
+    XExtensionItemSourceGroup *group = [self groupWithItemSourceCount:3];
+    group.tags = @[@"foo", @"bar"];
+    group.referrer = [[XExtensionItemReferrer alloc] initWithAppName:@"Tumblr"
+                                                          appStoreID:@"12345"
+                                                        googlePlayID:nil
+                                                              webURL:nil
+                                                           iOSAppURL:nil
+                                                       androidAppURL:nil];
+
+    for (NSExtensionItem *extensionItem in [group extensionItemsForActivityType:nil]) {
+        XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:extensionItem];
+
+        XCTAssertEqualObjects(group.tags, xExtensionItem.tags);
+        XCTAssertEqualObjects(group.referrer, xExtensionItem.referrer);
+    }
+}
+
+- (void)testItemSourcesWithoutOverridesShareUserInfo {
+    XExtensionItemSourceGroup *group = [self groupWithItemSourceCount:3];
+    group.tags = @[@"foo"];
+
+    NSArray *extensionItems = [group extensionItemsForActivityType:nil];
+
+    XCTAssertEqual([extensionItems[0] userInfo][@"x-extension-item"], [extensionItems[1] userInfo][@"x-extension-item"]);
+    XCTAssertEqual([extensionItems[1] userInfo][@"x-extension-item"], [extensionItems[2] userInfo][@"x-extension-item"]);
+}
+
+- (void)testItemSourceOverridesTakePrecedence {
+    XExtensionItemSourceGroup *group = [self groupWithItemSourceCount:2];
+    group.tags = @[@"foo"];
+
+    XExtensionItemSource *itemSource = group.itemSources.lastObject;
+    itemSource.tags = @[@"bar"];
+    itemSource.sourceURL = [NSURL URLWithString:@"http://tumblr.com"];
+
+    NSArray *extensionItems = [group extensionItemsForActivityType:nil];
+    XExtensionItem *sharedItem = [[XExtensionItem alloc] initWithExtensionItem:extensionItems[0]];
+    XExtensionItem *overridingItem = [[XExtensionItem alloc] initWithExtensionItem:extensionItems[1]];
+
+    XCTAssertEqualObjects(@[@"foo"], sharedItem.tags);
+    XCTAssertNil(sharedItem.sourceURL);
+    XCTAssertEqualObjects(@[@"bar"], overridingItem.tags);
+    XCTAssertEqualObjects(itemSource.sourceURL, overridingItem.sourceURL);
+}
+
+- (void)testCustomParametersAreMerged {
+    CustomParameters *groupParameters = [[CustomParameters alloc] init];
+    groupParameters.customParameter = @"Group";
+
+    XExtensionItemSourceGroup *group = [self groupWithItemSourceCount:2];
+    [group addCustomParameters:groupParameters];
+
+    CustomParameters *itemSourceParameters = [[CustomParameters alloc] init];
+    itemSourceParameters.customParameter = @"Item source";
+    [group.itemSources.lastObject addCustomParameters:itemSourceParameters];
+
+    NSArray *extensionItems = [group extensionItemsForActivityType:nil];
+
+    XCTAssertEqualObjects(groupParameters, [[CustomParameters alloc] initWithDictionary:[extensionItems[0] userInfo]]);
+    XCTAssertEqualObjects(itemSourceParameters, [[CustomParameters alloc] initWithDictionary:[extensionItems[1] userInfo]]);
+}
+
+- (void)testContentTextForActivityType {
+    XExtensionItemSourceGroup *group = [self groupWithItemSourceCount:2];
+    group.attributedContentText = [[NSAttributedString alloc] initWithString:@"Default"];
+    [group setAttributedContentText:[[NSAttributedString alloc] initWithString:@"Twitter"] forActivityType:UIActivityTypePostToTwitter];
+
+    XExtensionItemSource *itemSource = group.itemSources.lastObject;
+    itemSource.attributedContentText = [[NSAttributedString alloc] initWithString:@"Item source"];
+
+    NSArray *twitterItems = [group extensionItemsForActivityType:UIActivityTypePostToTwitter];
+    NSArray *mailItems = [group extensionItemsForActivityType:UIActivityTypeMail];
+
+    XCTAssertEqualObjects(@"Twitter", [twitterItems[0] attributedContentText].string);
+    XCTAssertEqualObjects(@"Default", [mailItems[0] attributedContentText].string);
+    XCTAssertEqualObjects(@"Item source", [twitterItems[1] attributedContentText].string);
+}
+
+- (void)testChangingGroupParametersInvalidatesCachedItems {
+    XExtensionItemSourceGroup *group = [self groupWithItemSourceCount:1];
+    group.tags = @[@"foo"];
+
+    NSExtensionItem *firstItem = [group extensionItemsForActivityType:nil].firstObject;
+    group.tags = @[@"bar"];
+    NSExtensionItem *secondItem = [group extensionItemsForActivityType:nil].firstObject;
+
+    XCTAssertNotEqual(firstItem, secondItem);
+    XCTAssertEqualObjects(@[@"bar"], [[XExtensionItem alloc] initWithExtensionItem:secondItem].tags);
+}
+
+- (void)testChangingGroupParametersWhileBuildingDoesntLeaveStaleItems {
+    XExtensionItemSourceGroup *group = [self groupWithItemSourceCount:4];
+    NSArray *itemSources = group.itemSources;
+
+    for (NSUInteger generation = 0; generation < 100; generation++) {
+        NSArray *tags = @[[NSString stringWithFormat:@"tag-%lu", (unsigned long)generation]];
+        dispatch_group_t builds = dispatch_group_create();
+
+        // Builds that read the previous tags may still be running when they change
+        for (XExtensionItemSource *itemSource in itemSources) {
+            dispatch_group_async(builds, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+                (void)[itemSource extensionItemForActivityType:nil];
+            });
+        }
+
+        group.tags = tags;
+        dispatch_group_wait(builds, DISPATCH_TIME_FOREVER);
+
+        for (XExtensionItemSource *itemSource in itemSources) {
+            XCTAssertEqualObjects(tags, [[XExtensionItem alloc] initWithExtensionItem:[itemSource extensionItemForActivityType:nil]].tags);
+        }
+    }
+}
+
+- (void)testItemSourceKeepsParametersOfLatestGroup {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@"Post"];
+
+    XExtensionItemSourceGroup *firstGroup = [[XExtensionItemSourceGroup alloc] initWithItemSources:@[itemSource]];
+    firstGroup.tags = @[@"first"];
+
+    XExtensionItemSourceGroup *secondGroup = [[XExtensionItemSourceGroup alloc] initWithItemSources:@[itemSource]];
+    secondGroup.tags = @[@"second"];
+
+    firstGroup.tags = @[@"changed"];
+
+    XCTAssertEqualObjects(@[@"second"], [[XExtensionItem alloc] initWithExtensionItem:[itemSource extensionItemForActivityType:nil]].tags);
+}
+
+#pragma mark - Private
+
+- (XExtensionItemSourceGroup *)groupWithItemSourceCount:(NSUInteger)count {
+    return [[XExtensionItemSourceGroup alloc] initWithItemSources:itemSourcesWithCount(count)];
+}
+
+static NSArray *itemSourcesWithCount(NSUInteger count) {
+    NSMutableArray *itemSources = [[NSMutableArray alloc] initWithCapacity:count];
+
+    for (NSUInteger i = 0; i < count; i++) {
+        NSURL *URL = [NSURL URLWithString:[NSString stringWithFormat:@"http://tumblr.com/post/%lu", (unsigned long)i]];
+        [itemSources addObject:[[XExtensionItemSource alloc] initWithURL:URL]];
+    }
+
+    return [itemSources copy];
+}
+
+@end
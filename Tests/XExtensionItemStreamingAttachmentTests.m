@@ -0,0 +1,290 @@
+@import MobileCoreServices;
+@import UIKit;
+@import XCTest;
+#import <mach/mach.h>
+#import "XExtensionItem.h"
+
+/**
+ An input stream that produces a given number of bytes without ever holding more than a single read’s worth in memory,
+ and keeps track of the process’s resident memory as it goes.
+ */
+@interface SyntheticInputStream : NSInputStream
+
+@property (nonatomic, readonly) unsigned long long length;
+@property (nonatomic, readonly) unsigned long long position;
+@property (nonatomic, readonly) uint64_t peakResidentSize;
+
+- (instancetype)initWithLength:(unsigned long long)length;
+
+@end
+
+@implementation SyntheticInputStream {
+    NSStreamStatus _streamStatus;
+}
+
+- (instancetype)initWithLength:(unsigned long long)length {
+    self = [super init];
+    if (self) {
+        _length = length;
+        _streamStatus = NSStreamStatusNotOpen;
+    }
+
+    return self;
+}
+
+- (void)open {
+    _streamStatus = NSStreamStatusOpen;
+}
+
+- (void)close {
+    _streamStatus = NSStreamStatusClosed;
+}
+
+- (NSStreamStatus)streamStatus {
+    return _streamStatus;
+}
+
+- (NSError *)streamError {
+    return nil;
+}
+
+- (BOOL)hasBytesAvailable {
+    return self.position < self.length;
+}
+
+- (NSInteger)read:(uint8_t *)buffer maxLength:(NSUInteger)maxLength {
+    NSUInteger count = (NSUInteger)MIN((unsigned long long)maxLength, self.length - self.position);
+
+    for (NSUInteger i = 0; i < count; i++) {
+        buffer[i] = (uint8_t)((self.position + i) % 251);
+    }
+
+    _position += count;
+    _peakResidentSize = MAX(_peakResidentSize, residentSize());
+
+    if (_position == _length) {
+        _streamStatus = NSStreamStatusAtEnd;
+    }
+
+    return (NSInteger)count;
+}
+
+- (BOOL)getBuffer:(uint8_t **)buffer length:(NSUInteger *)length {
+    return NO;
+}
+
+- (id)propertyForKey:(NSStreamPropertyKey)key {
+    return nil;
+}
+
+- (BOOL)setProperty:(id)property forKey:(NSStreamPropertyKey)key {
+    return NO;
+}
+
+- (void)scheduleInRunLoop:(NSRunLoop *)runLoop forMode:(NSRunLoopMode)mode {
+}
+
+- (void)removeFromRunLoop:(NSRunLoop *)runLoop forMode:(NSRunLoopMode)mode {
+}
+
+static uint64_t residentSize(void) {
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) {
+        return 0;
+    }
+
+    return info.resident_size;
+}
+
+@end
+
+@interface XExtensionItemStreamingAttachmentTests : XCTestCase
+@end
+
+@implementation XExtensionItemStreamingAttachmentTests
+
+- (void)testStreamIsSpooledToFileOnDemand {
+    NSData *data = [@"streaming attachment" dataUsingEncoding:NSUTF8StringEncoding];
+    __block NSUInteger providerCallCount = 0;
+
+    XExtensionItemStreamingAttachment *attachment = [[XExtensionItemStreamingAttachment alloc] initWithInputStreamProvider:^NSInputStream *{
+        providerCallCount++;
+        return [[NSInputStream alloc] initWithData:data];
+    } typeIdentifier:(NSString *)kUTTypePlainText];
+
+    XCTAssertEqual(providerCallCount, 0);
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:attachment.fileURL.path]);
+
+    NSURL *fileURL = [attachment spooledFileURLWithError:nil];
+    [attachment spooledFileURLWithError:nil];
+
+    XCTAssertEqual(providerCallCount, 1);
+    XCTAssertEqualObjects(@"txt", fileURL.pathExtension);
+    XCTAssertEqualObjects(data, [NSData dataWithContentsOfURL:fileURL]);
+}
+
+- (void)testSpooledFileIsRemovedOnDeallocation {
+    NSURL *fileURL;
+
+    @autoreleasepool {
+        XExtensionItemStreamingAttachment *attachment = [[XExtensionItemStreamingAttachment alloc] initWithInputStreamProvider:^NSInputStream *{
+            return [[NSInputStream alloc] initWithData:[NSData dataWithBytes:"abc" length:3]];
+        } typeIdentifier:(NSString *)kUTTypeData];
+
+        fileURL = [attachment spooledFileURLWithError:nil];
+        XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:fileURL.path]);
+    }
+
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:fileURL.path]);
+}
+
+- (void)testFailedSpoolReportsError {
+    XExtensionItemStreamingAttachment *attachment = [[XExtensionItemStreamingAttachment alloc] initWithInputStreamProvider:^NSInputStream *{
+        return [[NSInputStream alloc] initWithURL:[NSURL fileURLWithPath:@"/nonexistent/file"]];
+    } typeIdentifier:(NSString *)kUTTypeData];
+
+    NSError *error;
+    XCTAssertNil([attachment spooledFileURLWithError:&error]);
+    XCTAssertNotNil(error);
+}
+
+- (void)testExtensionReadsStreamingAttachmentAsStream {
+    NSData *data = [@"streaming attachment" dataUsingEncoding:NSUTF8StringEncoding];
+
+    XExtensionItemStreamingAttachment *attachment = [[XExtensionItemStreamingAttachment alloc] initWithInputStreamProvider:^NSInputStream *{
+        return [[NSInputStream alloc] initWithData:data];
+    } typeIdentifier:(NSString *)kUTTypePlainText];
+
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithStreamingAttachment:attachment];
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:[itemSource extensionItemForActivityType:nil]];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Load input stream"];
+
+    BOOL found = [xExtensionItem loadInputStreamForTypeIdentifier:(NSString *)kUTTypePlainText completionHandler:^(NSInputStream *inputStream, NSError *error) {
+        XCTAssertNil(error);
+        XCTAssertEqualObjects(data, contentsOfStream(inputStream));
+        [expectation fulfill];
+    }];
+
+    XCTAssertTrue(found);
+    XCTAssertFalse([xExtensionItem loadInputStreamForTypeIdentifier:(NSString *)kUTTypeImage completionHandler:^(NSInputStream *inputStream, NSError *error) {
+        XCTFail(@"Completion handler should not be called");
+    }]);
+
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+}
+
+- (void)testStreamingAttachmentCanBeAdditionalAttachment {
+    NSURL *fileURL = [[NSBundle bundleForClass:[self class]] URLForResource:@"mountain" withExtension:@"png"];
+
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@"foo"];
+    itemSource.additionalAttachments = @[[[XExtensionItemStreamingAttachment alloc] initWithFileURL:fileURL typeIdentifier:nil]];
+
+    NSExtensionItem *item = [itemSource extensionItemForActivityType:nil];
+
+    XCTAssertEqual(item.attachments.count, 2);
+    XCTAssertTrue([item.attachments[1] hasItemConformingToTypeIdentifier:(NSString *)kUTTypePNG]);
+}
+
+- (void)testRawActivityDoesntSpoolInline {
+    __block NSUInteger streamCount = 0;
+
+    XExtensionItemStreamingAttachment *attachment = [[XExtensionItemStreamingAttachment alloc] initWithInputStreamProvider:^NSInputStream *{
+        streamCount++;
+        return [[NSInputStream alloc] initWithData:[NSData dataWithBytes:"abc" length:3]];
+    } typeIdentifier:(NSString *)kUTTypeData];
+
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithStreamingAttachment:attachment];
+    UIActivityViewController *controller = [[UIActivityViewController alloc] initWithActivityItems:@[] applicationActivities:@[]];
+
+    id activityItem = [itemSource activityViewController:controller itemForActivityType:UIActivityTypeMail];
+
+    XCTAssertTrue([activityItem isKindOfClass:[NSItemProvider class]]);
+    XCTAssertTrue([activityItem hasItemConformingToTypeIdentifier:(NSString *)kUTTypeData]);
+    XCTAssertEqual(0, streamCount);
+    XCTAssertFalse(attachment.isSpooled);
+}
+
+- (void)testRawActivityReceivesFileURLSpooledByPreparation {
+    XExtensionItemStreamingAttachment *attachment = [[XExtensionItemStreamingAttachment alloc] initWithInputStreamProvider:^NSInputStream *{
+        return [[NSInputStream alloc] initWithData:[NSData dataWithBytes:"abc" length:3]];
+    } typeIdentifier:(NSString *)kUTTypeData];
+
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithStreamingAttachment:attachment];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Prepare"];
+
+    [itemSource prepareForActivityTypes:@[UIActivityTypeMail] thumbnailSize:CGSizeZero completion:^(NSArray *preparedActivityTypes) {
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+
+    UIActivityViewController *controller = [[UIActivityViewController alloc] initWithActivityItems:@[] applicationActivities:@[]];
+    NSURL *fileURL = [itemSource activityViewController:controller itemForActivityType:UIActivityTypeMail];
+
+    XCTAssertEqualObjects(attachment.fileURL, fileURL);
+    XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:fileURL.path]);
+}
+
+- (void)testLargeAttachmentKeepsResidentMemoryBounded {
+    unsigned long long length = 500ULL * 1024 * 1024;
+    uint64_t allowedGrowth = 32ULL * 1024 * 1024;
+
+    __block SyntheticInputStream *producerStream;
+
+    XExtensionItemStreamingAttachment *attachment = [[XExtensionItemStreamingAttachment alloc] initWithInputStreamProvider:^NSInputStream *{
+        producerStream = [[SyntheticInputStream alloc] initWithLength:length];
+        return producerStream;
+    } typeIdentifier:(NSString *)kUTTypeMPEG4];
+
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithStreamingAttachment:attachment];
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:[itemSource extensionItemForActivityType:nil]];
+
+    uint64_t baselineResidentSize = residentSize();
+    __block uint64_t peakConsumerResidentSize = 0;
+    __block unsigned long long bytesRead = 0;
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Read large attachment"];
+
+    [xExtensionItem loadInputStreamForTypeIdentifier:(NSString *)kUTTypeMPEG4 completionHandler:^(NSInputStream *inputStream, NSError *error) {
+        XCTAssertNil(error);
+
+        uint8_t *buffer = malloc(XExtensionItemStreamingAttachmentChunkSize);
+        NSInteger result;
+
+        while ((result = [inputStream read:buffer maxLength:XExtensionItemStreamingAttachmentChunkSize]) > 0) {
+            bytesRead += (unsigned long long)result;
+            peakConsumerResidentSize = MAX(peakConsumerResidentSize, residentSize());
+        }
+
+        free(buffer);
+        [inputStream close];
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:300 handler:nil];
+
+    XCTAssertEqual(bytesRead, length);
+    XCTAssertLessThan(producerStream.peakResidentSize, baselineResidentSize + allowedGrowth);
+    XCTAssertLessThan(peakConsumerResidentSize, baselineResidentSize + allowedGrowth);
+}
+
+#pragma mark - Private
+
+static NSData *contentsOfStream(NSInputStream *inputStream) {
+    NSMutableData *data = [[NSMutableData alloc] init];
+    uint8_t buffer[1024];
+    NSInteger result;
+
+    while ((result = [inputStream read:buffer maxLength:sizeof(buffer)]) > 0) {
+        [data appendBytes:buffer length:(NSUInteger)result];
+    }
+
+    [inputStream close];
+
+    return [data copy];
+}
+
+@end
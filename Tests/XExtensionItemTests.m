@@ -4,6 +4,7 @@
 #import "CustomParameters.h"
 #import "XExtensionItem.h"
 #import "XExtensionItemTestHelpers.h"
+#import "XExtensionItemTumblrParameters.h"
 
 @interface XExtensionItemTests : XCTestCase
 @end
@@ -480,6 +481,39 @@
     XCTAssertEqualObjects(inputCustomParameters, outputCustomParameters);
 }
 
+- (void)testCustomParametersOfClass {
+    CustomParameters *inputCustomParameters = [[CustomParameters alloc] init];
+    inputCustomParameters.customParameter = @"Value";
+    
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@""];
+    [itemSource addCustomParameters:inputCustomParameters];
+    
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:itemSource.facebookItem];
+    CustomParameters *outputCustomParameters = [xExtensionItem customParametersOfClass:[CustomParameters class]];
+    
+    XCTAssertEqualObjects(inputCustomParameters, outputCustomParameters);
+    XCTAssertEqual(outputCustomParameters, [xExtensionItem customParametersOfClass:[CustomParameters class]]);
+}
+
+- (void)testConcurrentParameterDecoding {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@""];
+    itemSource.tags = @[@"foo", @"bar"];
+    
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:itemSource.facebookItem];
+    NSMutableSet *decodedTags = [[NSMutableSet alloc] init];
+    
+    dispatch_apply(16, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t iteration) {
+        NSArray *tags = xExtensionItem.tags;
+        
+        @synchronized (decodedTags) {
+            [decodedTags addObject:[NSValue valueWithNonretainedObject:tags]];
+        }
+    });
+    
+    XCTAssertEqual(decodedTags.count, 1);
+    XCTAssertEqualObjects(itemSource.tags, xExtensionItem.tags);
+}
+
 - (void)testUserInfoAndCustomParameters {
     XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@""];
     itemSource.userInfo = @{ @"foo": @"bar" };
@@ -502,6 +536,323 @@
     XCTAssertEqualObjects(inputCustomParameters, outputCustomParameters);
 }
 
+- (void)testCustomParametersCollisionsAreReported {
+    NSMutableArray *collidingKeys = [[NSMutableArray alloc] init];
+    
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@""];
+    itemSource.parameterCollisionHandler = ^(NSArray *keys) {
+        [collidingKeys addObjectsFromArray:keys];
+    };
+    
+    CustomParameters *customParameters = [[CustomParameters alloc] init];
+    customParameters.customParameter = @"Value";
+    
+    [itemSource addCustomParameters:customParameters];
+    XCTAssertEqual(collidingKeys.count, 0);
+    
+    [itemSource addCustomParameters:customParameters];
+    XCTAssertEqualObjects(collidingKeys, @[@"CustomParameterKey"]);
+}
+
+- (void)testUserInfoCollisionsAreReported {
+    NSMutableSet *collidingKeys = [[NSMutableSet alloc] init];
+    
+    CustomParameters *customParameters = [[CustomParameters alloc] init];
+    customParameters.customParameter = @"Value";
+    
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@""];
+    itemSource.userInfo = @{ @"CustomParameterKey": @"Other value", @"x-extension-item-tags": @"Tag", @"foo": @"bar" };
+    itemSource.parameterCollisionHandler = ^(NSArray *keys) {
+        [collidingKeys addObjectsFromArray:keys];
+    };
+    [itemSource addCustomParameters:customParameters];
+    
+    (void)itemSource.facebookItem;
+    
+    XCTAssertEqualObjects(collidingKeys, ([NSSet setWithObjects:@"CustomParameterKey", @"x-extension-item-tags", nil]));
+}
+
+- (void)testCustomParametersOfClassOnlyReceiveTheirNamespace {
+    XExtensionItemTumblrParameters *inputTumblrParameters = [[XExtensionItemTumblrParameters alloc] initWithCustomURLPathComponent:@"pancakes"
+                                                                                                                       consumerKey:@"key"];
+    
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@""];
+    itemSource.userInfo = @{ @"foo": @"bar" };
+    [itemSource addCustomParameters:inputTumblrParameters];
+    
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:itemSource.facebookItem];
+    XExtensionItemTumblrParameters *outputTumblrParameters = [xExtensionItem customParametersOfClass:[XExtensionItemTumblrParameters class]];
+    
+    XCTAssertEqualObjects(inputTumblrParameters, outputTumblrParameters);
+    XCTAssertEqualObjects(@"com.tumblr.tumblr.", [[XExtensionItemCustomParametersRegistry defaultRegistry] keyNamespaceForClass:[XExtensionItemTumblrParameters class]]);
+}
+
+- (void)testRegistryPartitionsByLongestNamespace {
+    XExtensionItemCustomParametersRegistry *registry = [[XExtensionItemCustomParametersRegistry alloc] init];
+    [registry registerClass:[CustomParameters class] forKeyNamespace:@"com.example."];
+    [registry registerClass:[XExtensionItemTumblrParameters class] forKeyNamespace:@"com.example.nested."];
+    
+    NSDictionary *partitions = [registry partitionDictionary:@{
+        @"com.example.a": @1,
+        @"com.example.nested.b": @2,
+        @"com.example.": @3,
+        @"com.other.c": @4,
+        @5: @5
+    }];
+    
+    XCTAssertEqualObjects(partitions, (@{
+        @"com.example.": @{ @"com.example.a": @1 },
+        @"com.example.nested.": @{ @"com.example.nested.b": @2 }
+    }));
+    XCTAssertEqual(registry.generation, 2);
+}
+
+#pragma mark - Caching
+
+- (void)testExtensionItemIsCachedPerActivityType {
+    __block NSUInteger itemBlockCallCount = 0;
+
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithPlaceholderItem:@"placeholder" typeIdentifier:nil itemBlock:^id(NSString *activityType) {
+        itemBlockCallCount++;
+        return @"foo";
+    }];
+
+    id firstItem = itemSource.facebookItem;
+    id secondItem = itemSource.facebookItem;
+
+    XCTAssertEqual(firstItem, secondItem);
+    XCTAssertEqual(firstItem, [itemSource extensionItemForActivityType:UIActivityTypePostToFacebook]);
+    XCTAssertEqual(itemBlockCallCount, 1);
+
+    [itemSource activityViewController:[[self class] activityViewController] itemForActivityType:UIActivityTypePostToTwitter];
+
+    XCTAssertEqual(itemBlockCallCount, 2);
+}
+
+- (void)testSettingParametersInvalidatesCachedExtensionItems {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@""];
+    itemSource.tags = @[@"foo"];
+
+    id cachedItem = itemSource.facebookItem;
+
+    itemSource.tags = @[@"bar"];
+
+    XCTAssertNotEqual(cachedItem, itemSource.facebookItem);
+    XCTAssertEqualObjects(@[@"bar"], [[XExtensionItem alloc] initWithExtensionItem:itemSource.facebookItem].tags);
+}
+
+- (void)testSettingActivitySpecificValuesOnlyInvalidatesThatActivity {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@""];
+
+    id facebookItem = itemSource.facebookItem;
+    id twitterItem = [itemSource activityViewController:[[self class] activityViewController] itemForActivityType:UIActivityTypePostToTwitter];
+
+    [itemSource setAttributedContentText:[[NSAttributedString alloc] initWithString:@"Foo"] forActivityType:UIActivityTypePostToTwitter];
+    [itemSource setAdditionalAttachments:@[@"Bar"] forActivityType:UIActivityTypePostToTwitter];
+
+    XCTAssertEqual(facebookItem, itemSource.facebookItem);
+    XCTAssertNotEqual(twitterItem, [itemSource activityViewController:[[self class] activityViewController] itemForActivityType:UIActivityTypePostToTwitter]);
+
+    itemSource.attributedContentText = [[NSAttributedString alloc] initWithString:@"Baz"];
+
+    XCTAssertNotEqual(facebookItem, itemSource.facebookItem);
+}
+
+- (void)testRemoveCachedExtensionItems {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@""];
+
+    id cachedItem = itemSource.facebookItem;
+
+    [itemSource removeCachedExtensionItems];
+
+    XCTAssertNotEqual(cachedItem, itemSource.facebookItem);
+}
+
+#pragma mark - Asynchronous items
+
+- (void)testAsynchronousInitializerThrowsIfBlockIsNil {
+    XCTAssertThrows([[XExtensionItemSource alloc] initWithPlaceholderItem:@"placeholder" typeIdentifier:nil asynchronousItemBlock:nil]);
+}
+
+- (void)testPlaceholderIsReturnedImmediatelyWhileSlowProviderRuns {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithPlaceholderItem:@"placeholder" typeIdentifier:nil asynchronousItemBlock:slowAsynchronousProvidingBlock(@"foo", 0.5)];
+
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    id placeholder = [itemSource activityViewControllerPlaceholderItem:[[self class] activityViewController]];
+    CFTimeInterval timeToFirstResponse = CFAbsoluteTimeGetCurrent() - start;
+
+    XCTAssertEqualObjects(@"placeholder", placeholder);
+    XCTAssertLessThan(timeToFirstResponse, 0.05);
+
+    XCTAssertEqualObjects(@"foo", [itemSource activityViewController:[[self class] activityViewController] itemForActivityType:UIActivityTypeMail]);
+}
+
+- (void)testPrefetchedItemIsReadyWhenActivityIsChosen {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithPlaceholderItem:@"placeholder" typeIdentifier:nil asynchronousItemBlock:slowAsynchronousProvidingBlock(@"foo", 0.2)];
+    [itemSource activityViewControllerPlaceholderItem:[[self class] activityViewController]];
+
+    // Simulate the user taking a moment to pick an activity
+    [NSThread sleepForTimeInterval:0.3];
+
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    id item = [itemSource activityViewController:[[self class] activityViewController] itemForActivityType:UIActivityTypeMail];
+
+    XCTAssertEqualObjects(@"foo", item);
+    XCTAssertLessThan(CFAbsoluteTimeGetCurrent() - start, 0.05);
+}
+
+- (void)testPlaceholderIsProvidedWhenDeadlineElapses {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithPlaceholderItem:@"placeholder" typeIdentifier:nil asynchronousItemBlock:slowAsynchronousProvidingBlock(@"foo", 2)];
+    itemSource.asynchronousItemTimeout = 0.1;
+
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    id item = [itemSource activityViewController:[[self class] activityViewController] itemForActivityType:UIActivityTypeMail];
+    CFTimeInterval elapsed = CFAbsoluteTimeGetCurrent() - start;
+
+    XCTAssertEqualObjects(@"placeholder", item);
+    XCTAssertLessThan(elapsed, 1);
+}
+
+- (void)testExtensionItemBuiltAroundPlaceholderIsNotCached {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithPlaceholderItem:@"placeholder" typeIdentifier:nil asynchronousItemBlock:slowAsynchronousProvidingBlock(@"foo", 0.3)];
+    itemSource.asynchronousItemTimeout = 0;
+
+    id firstItem = itemSource.facebookItem;
+
+    [NSThread sleepForTimeInterval:0.5];
+
+    XCTAssertNotEqual(firstItem, itemSource.facebookItem);
+    XCTAssertEqual(itemSource.facebookItem, itemSource.facebookItem);
+}
+
+- (void)testCancellationIsObservedByProvider {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Provider observes cancellation"];
+
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithPlaceholderItem:@"placeholder" typeIdentifier:nil asynchronousItemBlock:^(XExtensionItemAsynchronousItemCompletionBlock completion, BOOL (^isCancelled)(void)) {
+        while (!isCancelled()) {
+            [NSThread sleepForTimeInterval:0.01];
+        }
+
+        completion(@"foo");
+        [expectation fulfill];
+    }];
+
+    [itemSource prefetchAsynchronousItem];
+    [itemSource cancelAsynchronousItem];
+
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+}
+
+static XExtensionItemAsynchronousProvidingBlock slowAsynchronousProvidingBlock(id item, NSTimeInterval delay) {
+    return ^(XExtensionItemAsynchronousItemCompletionBlock completion, BOOL (^isCancelled)(void)) {
+        [NSThread sleepForTimeInterval:delay];
+        completion(item);
+    };
+}
+
+#pragma mark - Binary parameters
+
+- (void)testBinaryParameterEncoding {
+    CustomParameters *inputCustomParameters = [[CustomParameters alloc] init];
+    inputCustomParameters.customParameter = @"Value";
+    
+    XExtensionItemSource *itemSource = itemSourceWithParameters(0);
+    itemSource.userInfo = @{ @"foo": @"bar" };
+    itemSource.parameterEncoding = XExtensionItemParameterEncodingBinary;
+    [itemSource addCustomParameters:inputCustomParameters];
+    
+    NSExtensionItem *item = itemSource.facebookItem;
+    XCTAssertNil(item.userInfo[@"x-extension-item"]);
+    XCTAssertNil(item.userInfo[@"foo"]);
+    XCTAssertTrue([item.userInfo[@"x-extension-item-binary"] isKindOfClass:[NSData class]]);
+    
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:item];
+    XCTAssertEqualObjects(itemSource.tags, xExtensionItem.tags);
+    XCTAssertEqualObjects(itemSource.sourceURL, xExtensionItem.sourceURL);
+    XCTAssertEqualObjects(itemSource.referrer, xExtensionItem.referrer);
+    XCTAssertEqualObjects(@"bar", xExtensionItem.userInfo[@"foo"]);
+    XCTAssertNil(xExtensionItem.userInfo[@"x-extension-item-binary"]);
+    XCTAssertEqualObjects(inputCustomParameters, [[CustomParameters alloc] initWithDictionary:xExtensionItem.userInfo]);
+}
+
+- (void)testDictionaryAndBinaryParameterEncodingKeepsDictionaryForOlderConsumers {
+    XExtensionItemSource *itemSource = itemSourceWithParameters(0);
+    itemSource.parameterEncoding = XExtensionItemParameterEncodingDictionaryAndBinary;
+    
+    NSExtensionItem *item = itemSource.facebookItem;
+    XCTAssertEqualObjects(itemSource.tags, item.userInfo[@"x-extension-item"][@"tags"]);
+    XCTAssertNotNil(item.userInfo[@"x-extension-item-binary"]);
+}
+
+- (void)testUnencodableValuesAreKeptInDictionary {
+    UIColor *color = [UIColor redColor];
+    
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@""];
+    itemSource.userInfo = @{ @"color": color, @"foo": @"bar" };
+    itemSource.parameterEncoding = XExtensionItemParameterEncodingBinary;
+    
+    NSExtensionItem *item = itemSource.facebookItem;
+    XCTAssertEqualObjects(color, item.userInfo[@"color"]);
+    XCTAssertNil(item.userInfo[@"foo"]);
+    
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:item];
+    XCTAssertEqualObjects(color, xExtensionItem.userInfo[@"color"]);
+    XCTAssertEqualObjects(@"bar", xExtensionItem.userInfo[@"foo"]);
+}
+
+- (void)testMalformedOrUnsupportedBinaryParametersFallBackToDictionary {
+    XExtensionItemSource *itemSource = itemSourceWithParameters(0);
+    itemSource.parameterEncoding = XExtensionItemParameterEncodingDictionaryAndBinary;
+    
+    NSDictionary *userInfo = itemSource.facebookItem.userInfo;
+    NSData *binaryParameters = userInfo[@"x-extension-item-binary"];
+    
+    NSMutableData *futureVersion = [binaryParameters mutableCopy];
+    ((uint8_t *)futureVersion.mutableBytes)[3] = 0xFF;
+    
+    NSData *truncated = [binaryParameters subdataWithRange:NSMakeRange(0, binaryParameters.length / 2)];
+    
+    for (NSData *data in @[futureVersion, truncated, [NSData data]]) {
+        NSMutableDictionary *mutableUserInfo = [userInfo mutableCopy];
+        mutableUserInfo[@"x-extension-item-binary"] = data;
+        
+        NSExtensionItem *item = [[NSExtensionItem alloc] init];
+        item.userInfo = mutableUserInfo;
+        
+        XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:item];
+        XCTAssertEqualObjects(itemSource.tags, xExtensionItem.tags);
+        XCTAssertEqualObjects(itemSource.referrer, xExtensionItem.referrer);
+    }
+}
+
+- (void)testBinaryParameterEncodingIsSmallerThanDictionary {
+    XExtensionItemSource *itemSource = itemSourceWithParameters(0);
+    NSData *dictionaryArchive = archivedUserInfo(itemSource.facebookItem.userInfo);
+    
+    itemSource.parameterEncoding = XExtensionItemParameterEncodingBinary;
+    NSData *binaryArchive = archivedUserInfo(itemSource.facebookItem.userInfo);
+    
+    XCTAssertLessThan(binaryArchive.length, dictionaryArchive.length);
+}
+
+static XExtensionItemSource *itemSourceWithParameters(NSUInteger index) {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@""];
+    itemSource.tags = @[@"foo", @"bar", [NSString stringWithFormat:@"tag-%lu", (unsigned long)index]];
+    itemSource.sourceURL = [NSURL URLWithString:[NSString stringWithFormat:@"http://tumblr.com/post/%lu", (unsigned long)index]];
+    itemSource.referrer = [[XExtensionItemReferrer alloc] initWithAppName:@"Tumblr"
+                                                               appStoreID:@"12345"
+                                                             googlePlayID:@"54321"
+                                                                   webURL:[NSURL URLWithString:@"http://bryan.io/a94kan4"]
+                                                                iOSAppURL:[NSURL URLWithString:@"tumblr://a94kan4"]
+                                                            androidAppURL:[NSURL URLWithString:@"tumblr://a94kan4"]];
+    return itemSource;
+}
+
+static NSData *archivedUserInfo(NSDictionary *userInfo) {
+    // Approximates what the system sends across the process boundary
+    return [NSKeyedArchiver archivedDataWithRootObject:userInfo requiringSecureCoding:NO error:nil];
+}
+
 #pragma mark - Misc.
 
 + (UIActivityViewController *)activityViewController {
@@ -547,4 +898,175 @@
     XCTAssertNoThrow([xExtensionItem.referrer.androidAppURL absoluteString]);
 }
 
+- (void)testUnknownParameterKeysAreIgnored {
+    NSExtensionItem *item = [[NSExtensionItem alloc] init];
+    item.userInfo = @{
+                      @"x-extension-item": @{
+                              @"tags": @[@"foo"],
+                              @"some-future-parameter": @"bar",
+                              @"referrer-name": @"Tumblr"
+                              }
+                      };
+
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:item];
+    XCTAssertEqualObjects(@[@"foo"], xExtensionItem.tags);
+    XCTAssertEqualObjects(@"Tumblr", xExtensionItem.referrer.appName);
+}
+
+#pragma mark - Preparation
+
+- (void)testPreparedExtensionItemsAreCached {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@""];
+    itemSource.tags = @[@"foo"];
+    itemSource.thumbnailProvider = ^UIImage *(CGSize suggestedSize, NSString *activityType) {
+        return [[[UIGraphicsImageRenderer alloc] initWithSize:suggestedSize] imageWithActions:^(UIGraphicsImageRendererContext *context) {}];
+    };
+    
+    NSArray *activityTypes = @[UIActivityTypePostToFacebook, @"com.example.extension"];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Prepared"];
+    
+    [itemSource prepareForActivityTypes:activityTypes thumbnailSize:CGSizeMake(100, 100) completion:^(NSArray *preparedActivityTypes) {
+        XCTAssertTrue([NSThread isMainThread]);
+        XCTAssertEqualObjects(activityTypes, preparedActivityTypes);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:1 handler:nil];
+    
+    NSExtensionItem *preparedItem = [itemSource extensionItemForActivityType:UIActivityTypePostToFacebook];
+    XCTAssertEqual(preparedItem, [itemSource activityViewController:nil itemForActivityType:UIActivityTypePostToFacebook]);
+    
+    NSUInteger missCount = itemSource.thumbnailCache.missCount;
+    [itemSource activityViewController:nil thumbnailImageForActivityType:UIActivityTypePostToFacebook suggestedSize:CGSizeMake(100, 100)];
+    XCTAssertEqual(missCount, itemSource.thumbnailCache.missCount);
+}
+
+- (void)testPreparationStopsAtMemoryBudget {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@""];
+    itemSource.additionalAttachments = @[[NSMutableData dataWithLength:1024]];
+    itemSource.preparationMemoryBudget = 1536;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Prepared"];
+    
+    [itemSource setAttributedContentText:[[NSAttributedString alloc] initWithString:@"Longer content text"] forActivityType:@"com.example.first"];
+    
+    [itemSource prepareForActivityTypes:@[@"com.example.first", @"com.example.second"] thumbnailSize:CGSizeZero completion:^(NSArray *preparedActivityTypes) {
+        XCTAssertEqualObjects(@[@"com.example.first"], preparedActivityTypes);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:1 handler:nil];
+}
+
+- (void)testPreparedItemsInvalidatedWhileBuildingAreDiscarded {
+    __block XExtensionItemSource *itemSource;
+    __block BOOL changed = NO;
+    
+    itemSource = [[XExtensionItemSource alloc] initWithPlaceholderItem:@"" typeIdentifier:(NSString *)kUTTypePlainText itemBlock:^id(NSString *activityType) {
+        if (!changed) {
+            changed = YES;
+            itemSource.title = @"Changed while preparing";
+        }
+        
+        return @"";
+    }];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Prepared"];
+    
+    [itemSource prepareForActivityTypes:@[@"com.example.first", @"com.example.second"] thumbnailSize:CGSizeZero completion:^(NSArray *preparedActivityTypes) {
+        XCTAssertEqualObjects(@[@"com.example.second"], preparedActivityTypes);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:1 handler:nil];
+    
+    XCTAssertEqualObjects(@"Changed while preparing", [itemSource extensionItemForActivityType:@"com.example.first"].attributedTitle.string);
+    itemSource = nil;
+}
+
+#pragma mark - Thread safety
+
+- (void)testConcurrentChangesWhileBuildingExtensionItems {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@""];
+    NSArray *activityTypes = @[UIActivityTypePostToFacebook, UIActivityTypeMail, @"com.example.extension"];
+    
+    NSObject *countLock = [[NSObject alloc] init];
+    __block NSUInteger builtItemCount = 0;
+    __block NSUInteger inconsistentItemCount = 0;
+    
+    dispatch_apply(32, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t iteration) {
+        for (NSUInteger i = 0; i < 200; i++) {
+            NSString *activityType = activityTypes[i % activityTypes.count];
+            
+            if (iteration % 2 == 0) {
+                NSString *value = [NSString stringWithFormat:@"%zu-%lu", iteration, (unsigned long)i];
+                
+                // Set together, so every item must contain either both or neither of them
+                itemSource.userInfo = @{ @"first": value, @"second": value };
+                
+                itemSource.title = value;
+                itemSource.tags = @[value];
+                itemSource.additionalAttachments = @[value];
+                [itemSource setAttributedContentText:[[NSAttributedString alloc] initWithString:value] forActivityType:activityType];
+                
+                CustomParameters *customParameters = [[CustomParameters alloc] init];
+                customParameters.customParameter = value;
+                [itemSource addCustomParameters:customParameters];
+            }
+            else {
+                NSExtensionItem *item = [itemSource extensionItemForActivityType:activityType];
+                id first = item.userInfo[@"first"];
+                id second = item.userInfo[@"second"];
+                
+                @synchronized (countLock) {
+                    builtItemCount++;
+                    
+                    if (first != second && ![first isEqual:second]) {
+                        inconsistentItemCount++;
+                    }
+                }
+            }
+        }
+    });
+    
+    XCTAssertEqual(builtItemCount, 16 * 200);
+    XCTAssertEqual(inconsistentItemCount, 0);
+    
+    // Once writers are done, items reflect the last change
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:[itemSource extensionItemForActivityType:nil]];
+    XCTAssertEqualObjects(xExtensionItem.title, itemSource.title);
+    XCTAssertEqualObjects(xExtensionItem.tags, itemSource.tags);
+}
+
+- (void)testGroupChangesWhileBuildingExtensionItems {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@""];
+    XExtensionItemSourceGroup *group = [[XExtensionItemSourceGroup alloc] initWithItemSources:@[itemSource]];
+    
+    NSObject *countLock = [[NSObject alloc] init];
+    __block NSUInteger inconsistentItemCount = 0;
+    
+    dispatch_apply(8, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t iteration) {
+        for (NSInteger i = 1; i <= 200; i++) {
+            if (iteration == 0) {
+                // Tags always change first, so every item must have the same generation of both, or newer tags
+                group.tags = @[[@(i) stringValue]];
+                group.referrer = [[XExtensionItemReferrer alloc] initWithAppName:[@(i) stringValue] appStoreID:nil googlePlayID:nil webURL:nil iOSAppURL:nil androidAppURL:nil];
+            }
+            else {
+                XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:[itemSource extensionItemForActivityType:nil]];
+                NSInteger tagsGeneration = [xExtensionItem.tags.firstObject integerValue];
+                NSInteger referrerGeneration = [xExtensionItem.referrer.appName integerValue];
+                
+                if (referrerGeneration != tagsGeneration && referrerGeneration != tagsGeneration - 1) {
+                    @synchronized (countLock) {
+                        inconsistentItemCount++;
+                    }
+                }
+            }
+        }
+    });
+    
+    XCTAssertEqual(inconsistentItemCount, 0);
+}
+
 @end
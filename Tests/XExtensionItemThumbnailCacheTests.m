@@ -0,0 +1,209 @@
+@import UIKit;
+@import XCTest;
+#import "XExtensionItem.h"
+
+@interface XExtensionItemThumbnailCacheTests : XCTestCase
+@end
+
+@implementation XExtensionItemThumbnailCacheTests
+
+- (void)testRepeatedRequestIsServedFromCache {
+    __block NSUInteger providerCallCount = 0;
+
+    XExtensionItemThumbnailCache *cache = [[XExtensionItemThumbnailCache alloc] init];
+    UIImage *(^provider)(CGSize, NSString *) = ^UIImage *(CGSize suggestedSize, NSString *activityType) {
+        providerCallCount++;
+        return imageOfSize(suggestedSize);
+    };
+
+    UIImage *first = [cache thumbnailForActivityType:UIActivityTypeMail size:CGSizeMake(100, 100) provider:provider];
+    UIImage *second = [cache thumbnailForActivityType:UIActivityTypeMail size:CGSizeMake(100, 100) provider:provider];
+
+    XCTAssertEqual(first, second);
+    XCTAssertEqual(providerCallCount, 1);
+    XCTAssertEqual(cache.hitCount, 1);
+    XCTAssertEqual(cache.missCount, 1);
+}
+
+- (void)testNearbySizesShareBucket {
+    __block NSUInteger providerCallCount = 0;
+    __block CGSize renderedSize = CGSizeZero;
+
+    XExtensionItemThumbnailCache *cache = [[XExtensionItemThumbnailCache alloc] init];
+    UIImage *(^provider)(CGSize, NSString *) = ^UIImage *(CGSize suggestedSize, NSString *activityType) {
+        providerCallCount++;
+        renderedSize = suggestedSize;
+        return imageOfSize(suggestedSize);
+    };
+
+    [cache thumbnailForActivityType:UIActivityTypeMail size:CGSizeMake(100, 90) provider:provider];
+    [cache thumbnailForActivityType:UIActivityTypeMail size:CGSizeMake(120, 110) provider:provider];
+
+    XCTAssertEqual(providerCallCount, 1);
+    XCTAssertTrue(CGSizeEqualToSize(CGSizeMake(128, 128), renderedSize));
+}
+
+- (void)testSmallerSizeIsDownscaledFromLargestRendering {
+    __block NSUInteger providerCallCount = 0;
+
+    XExtensionItemThumbnailCache *cache = [[XExtensionItemThumbnailCache alloc] init];
+    UIImage *(^provider)(CGSize, NSString *) = ^UIImage *(CGSize suggestedSize, NSString *activityType) {
+        providerCallCount++;
+        return imageOfSize(suggestedSize);
+    };
+
+    [cache thumbnailForActivityType:UIActivityTypeMail size:CGSizeMake(500, 500) provider:provider];
+    UIImage *small = [cache thumbnailForActivityType:UIActivityTypeMail size:CGSizeMake(60, 60) provider:provider];
+
+    XCTAssertEqual(providerCallCount, 1);
+    XCTAssertEqual(cache.downscaleCount, 1);
+    XCTAssertLessThanOrEqual(small.size.width, 64);
+    XCTAssertLessThanOrEqual(small.size.height, 64);
+}
+
+- (void)testDownscaledThumbnailCoversNonSquareRequest {
+    __block NSUInteger providerCallCount = 0;
+
+    XExtensionItemThumbnailCache *cache = [[XExtensionItemThumbnailCache alloc] init];
+    UIImage *(^provider)(CGSize, NSString *) = ^UIImage *(CGSize suggestedSize, NSString *activityType) {
+        providerCallCount++;
+        return imageOfSize(suggestedSize);
+    };
+
+    [cache thumbnailForActivityType:UIActivityTypeMail size:CGSizeMake(500, 500) provider:provider];
+    UIImage *wide = [cache thumbnailForActivityType:UIActivityTypeMail size:CGSizeMake(120, 30) provider:provider];
+
+    XCTAssertEqual(providerCallCount, 1);
+    XCTAssertGreaterThanOrEqual(wide.size.width, 120);
+    XCTAssertGreaterThanOrEqual(wide.size.height, 30);
+}
+
+- (void)testRenderingThatDoesntCoverRequestIsNotDownscaled {
+    __block NSUInteger providerCallCount = 0;
+
+    // Ignores the suggested size, so the largest bucket’s rendering is smaller than the bucket itself
+    XExtensionItemThumbnailCache *cache = [[XExtensionItemThumbnailCache alloc] init];
+    UIImage *(^provider)(CGSize, NSString *) = ^UIImage *(CGSize suggestedSize, NSString *activityType) {
+        providerCallCount++;
+        return imageOfSize(CGSizeMake(64, 64));
+    };
+
+    [cache thumbnailForActivityType:UIActivityTypeMail size:CGSizeMake(500, 500) provider:provider];
+    [cache thumbnailForActivityType:UIActivityTypeMail size:CGSizeMake(120, 30) provider:provider];
+
+    XCTAssertEqual(providerCallCount, 2);
+    XCTAssertEqual(cache.downscaleCount, 0);
+}
+
+- (void)testThumbnailsAreCachedPerActivityType {
+    __block NSUInteger providerCallCount = 0;
+
+    XExtensionItemThumbnailCache *cache = [[XExtensionItemThumbnailCache alloc] init];
+    UIImage *(^provider)(CGSize, NSString *) = ^UIImage *(CGSize suggestedSize, NSString *activityType) {
+        providerCallCount++;
+        return imageOfSize(suggestedSize);
+    };
+
+    [cache thumbnailForActivityType:UIActivityTypeMail size:CGSizeMake(100, 100) provider:provider];
+    [cache thumbnailForActivityType:UIActivityTypePostToTwitter size:CGSizeMake(100, 100) provider:provider];
+
+    XCTAssertEqual(providerCallCount, 2);
+}
+
+- (void)testRemoveAllThumbnails {
+    __block NSUInteger providerCallCount = 0;
+
+    XExtensionItemThumbnailCache *cache = [[XExtensionItemThumbnailCache alloc] init];
+    UIImage *(^provider)(CGSize, NSString *) = ^UIImage *(CGSize suggestedSize, NSString *activityType) {
+        providerCallCount++;
+        return imageOfSize(suggestedSize);
+    };
+
+    [cache thumbnailForActivityType:UIActivityTypeMail size:CGSizeMake(100, 100) provider:provider];
+    [cache removeAllThumbnails];
+    [cache thumbnailForActivityType:UIActivityTypeMail size:CGSizeMake(100, 100) provider:provider];
+
+    XCTAssertEqual(providerCallCount, 2);
+}
+
+- (void)testRenderingByOlderProviderGenerationIsNotServed {
+    XExtensionItemThumbnailCache *cache = [[XExtensionItemThumbnailCache alloc] init];
+    UIImage *newImage = imageOfSize(CGSizeMake(128, 128));
+    UIImage *oldImage = imageOfSize(CGSizeMake(128, 128));
+
+    XCTAssertEqual(newImage, [cache thumbnailForActivityType:UIActivityTypeMail size:CGSizeMake(100, 100) providerGeneration:1 provider:^UIImage *(CGSize suggestedSize, NSString *activityType) {
+        return newImage;
+    }]);
+
+    XCTAssertEqual(oldImage, [cache thumbnailForActivityType:UIActivityTypeMail size:CGSizeMake(100, 100) providerGeneration:0 provider:^UIImage *(CGSize suggestedSize, NSString *activityType) {
+        return oldImage;
+    }]);
+
+    XCTAssertEqual(newImage, [cache thumbnailForActivityType:UIActivityTypeMail size:CGSizeMake(100, 100) providerGeneration:1 provider:nil]);
+    XCTAssertNil([cache thumbnailForActivityType:UIActivityTypeMail size:CGSizeMake(100, 100) providerGeneration:0 provider:nil]);
+}
+
+- (void)testReplacedProviderStillRenderingDoesntRepopulateCache {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@""];
+    UIActivityViewController *controller = [[UIActivityViewController alloc] initWithActivityItems:@[] applicationActivities:@[]];
+
+    dispatch_semaphore_t renderingStarted = dispatch_semaphore_create(0);
+    dispatch_semaphore_t finishRendering = dispatch_semaphore_create(0);
+
+    itemSource.thumbnailProvider = ^UIImage *(CGSize suggestedSize, NSString *activityType) {
+        dispatch_semaphore_signal(renderingStarted);
+        dispatch_semaphore_wait(finishRendering, DISPATCH_TIME_FOREVER);
+        return imageOfSize(suggestedSize);
+    };
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Old provider finished rendering"];
+
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+        [itemSource activityViewController:controller thumbnailImageForActivityType:UIActivityTypeMail suggestedSize:CGSizeMake(100, 100)];
+        [expectation fulfill];
+    });
+
+    dispatch_semaphore_wait(renderingStarted, DISPATCH_TIME_FOREVER);
+
+    UIImage *newImage = imageOfSize(CGSizeMake(128, 128));
+    itemSource.thumbnailProvider = ^UIImage *(CGSize suggestedSize, NSString *activityType) {
+        return newImage;
+    };
+
+    dispatch_semaphore_signal(finishRendering);
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+
+    XCTAssertEqual(newImage, [itemSource activityViewController:controller thumbnailImageForActivityType:UIActivityTypeMail suggestedSize:CGSizeMake(100, 100)]);
+}
+
+- (void)testItemSourceCachesProvidedThumbnails {
+    __block NSUInteger providerCallCount = 0;
+
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@""];
+    itemSource.thumbnailProvider = ^UIImage *(CGSize suggestedSize, NSString *activityType) {
+        providerCallCount++;
+        return imageOfSize(suggestedSize);
+    };
+
+    UIActivityViewController *controller = [[UIActivityViewController alloc] initWithActivityItems:@[] applicationActivities:@[]];
+
+    [itemSource activityViewController:controller thumbnailImageForActivityType:UIActivityTypeMail suggestedSize:CGSizeMake(100, 100)];
+    [itemSource activityViewController:controller thumbnailImageForActivityType:UIActivityTypeMail suggestedSize:CGSizeMake(100, 100)];
+
+    XCTAssertEqual(providerCallCount, 1);
+    XCTAssertEqual(itemSource.thumbnailCache.hitCount, 1);
+}
+
+#pragma mark - Private
+
+static UIImage *imageOfSize(CGSize size) {
+    UIGraphicsImageRendererFormat *format = [UIGraphicsImageRendererFormat preferredFormat];
+    format.scale = 1;
+
+    return [[[UIGraphicsImageRenderer alloc] initWithSize:size format:format] imageWithActions:^(UIGraphicsImageRendererContext *context) {
+        [[UIColor redColor] setFill];
+        [context fillRect:CGRectMake(0, 0, size.width, size.height)];
+    }];
+}
+
+@end
@@ -0,0 +1,81 @@
+@import MobileCoreServices;
+@import UIKit;
+@import XCTest;
+#import "XExtensionItem.h"
+#import "XExtensionItemTestHelpers.h"
+#import "XExtensionItemTumblrParameters.h"
+
+@interface XExtensionItemTraceTests : XCTestCase
+@end
+
+@implementation XExtensionItemTraceTests
+
+- (void)testTraceRecordsEveryPhaseInOrder {
+    UIActivityViewController *activityViewController = [[UIActivityViewController alloc] initWithActivityItems:@[] applicationActivities:@[]];
+
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@"foo"];
+    itemSource.tracingEnabled = YES;
+
+    (void)[itemSource activityViewControllerPlaceholderItem:activityViewController];
+    NSExtensionItem *item = [itemSource activityViewController:activityViewController itemForActivityType:UIActivityTypePostToFacebook];
+
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:item];
+    XExtensionItemTrace *trace = xExtensionItem.trace;
+    XCTAssertEqualObjects(itemSource.traceCorrelationIdentifier, trace.correlationIdentifier);
+    XCTAssertEqualObjects(UIActivityTypePostToFacebook, trace.activityType);
+
+    XCTAssertGreaterThan(trace.sheetOpenTime, 0);
+    XCTAssertLessThanOrEqual(trace.sheetOpenTime, trace.itemBuiltTime);
+    XCTAssertLessThanOrEqual(trace.itemBuiltTime, trace.providerDoneTime);
+    XCTAssertLessThanOrEqual(trace.providerDoneTime, trace.receiveTime);
+    XCTAssertEqual(0, trace.attachmentsLoadedTime);
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Load attachments"];
+
+    [xExtensionItem loadAttachmentsWithPreferredTypeIdentifiers:@[(NSString *)kUTTypePlainText] resultHandler:nil completionHandler:^(NSArray *results, NSTimeInterval duration) {
+        XCTAssertLessThanOrEqual(trace.receiveTime, trace.attachmentsLoadedTime);
+
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30 handler:nil];
+}
+
+- (void)testTracedItemKeepsPayload {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@"foo"];
+    itemSource.title = @"Title";
+    itemSource.tags = @[@"bar"];
+    itemSource.tracingEnabled = YES;
+
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:itemSource.facebookItem];
+    XCTAssertEqualObjects(@"Title", xExtensionItem.title);
+    XCTAssertEqualObjects(@[@"bar"], xExtensionItem.tags);
+    XCTAssertEqual(1, xExtensionItem.attachments.count);
+
+    // Cached items are traced as they’re handed out, rather than changed
+    XCTAssertNil([itemSource extensionItemForActivityType:UIActivityTypePostToFacebook].userInfo[@"x-extension-item-trace"]);
+}
+
+- (void)testTraceIsNilUnlessEnabled {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@"foo"];
+
+    NSExtensionItem *item = itemSource.facebookItem;
+    XCTAssertNil(item.userInfo[@"x-extension-item-trace"]);
+    XCTAssertNil([[XExtensionItem alloc] initWithExtensionItem:item].trace);
+}
+
+- (void)testCorrelationIdentifierCanBePassedToTumblr {
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithString:@"foo"];
+    itemSource.tracingEnabled = YES;
+    [itemSource addCustomParameters:[[XExtensionItemTumblrParameters alloc] initWithCustomURLPathComponent:nil
+                                                                         requestedPostType:XExtensionItemTumblrPostTypeAny
+                                                                               consumerKey:nil
+                                                                     correlationIdentifier:itemSource.traceCorrelationIdentifier]];
+
+    XExtensionItem *xExtensionItem = [[XExtensionItem alloc] initWithExtensionItem:itemSource.facebookItem];
+    XExtensionItemTumblrParameters *tumblrParameters = [xExtensionItem customParametersOfClass:[XExtensionItemTumblrParameters class]];
+
+    XCTAssertEqualObjects(xExtensionItem.trace.correlationIdentifier, tumblrParameters.correlationIdentifier);
+}
+
+@end
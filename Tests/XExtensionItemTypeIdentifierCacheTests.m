@@ -0,0 +1,104 @@
+@import MobileCoreServices;
+@import XCTest;
+#import "XExtensionItem.h"
+
+@interface XExtensionItemTypeIdentifierCacheTests : XCTestCase
+
+@property (nonatomic) NSURL *directoryURL;
+
+@end
+
+@implementation XExtensionItemTypeIdentifierCacheTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.directoryURL = [[NSURL fileURLWithPath:NSTemporaryDirectory() isDirectory:YES] URLByAppendingPathComponent:[NSUUID UUID].UUIDString isDirectory:YES];
+    [[NSFileManager defaultManager] createDirectoryAtURL:self.directoryURL withIntermediateDirectories:YES attributes:nil error:nil];
+}
+
+- (void)tearDown {
+    [[NSFileManager defaultManager] removeItemAtURL:self.directoryURL error:nil];
+
+    [super tearDown];
+}
+
+- (void)testDeclaredExtensionIsResolvedWithoutFileSystemLookup {
+    XExtensionItemTypeIdentifierCache *cache = [[XExtensionItemTypeIdentifierCache alloc] init];
+
+    // The file doesn’t need to exist for its extension to be resolved
+    NSURL *fileURL = [self.directoryURL URLByAppendingPathComponent:@"image.PNG"];
+
+    XCTAssertEqualObjects((NSString *)kUTTypePNG, [cache typeIdentifierForFileURL:fileURL]);
+    XCTAssertEqual(cache.extensionHitCount, 1);
+    XCTAssertEqual(cache.missCount, 0);
+}
+
+- (void)testFileWithoutDeclaredExtensionIsLookedUpOnce {
+    XExtensionItemTypeIdentifierCache *cache = [[XExtensionItemTypeIdentifierCache alloc] init];
+    NSURL *fileURL = [self createFileNamed:@"no-extension"];
+
+    NSString *typeIdentifier = [cache typeIdentifierForFileURL:fileURL];
+    XCTAssertEqualObjects(typeIdentifier, [cache typeIdentifierForFileURL:fileURL]);
+
+    XCTAssertNotNil(typeIdentifier);
+    XCTAssertEqual(cache.missCount, 1);
+    XCTAssertEqual(cache.fileHitCount, 1);
+}
+
+- (void)testModifiedFileIsLookedUpAgain {
+    XExtensionItemTypeIdentifierCache *cache = [[XExtensionItemTypeIdentifierCache alloc] init];
+    NSURL *fileURL = [self createFileNamed:@"no-extension"];
+
+    [cache typeIdentifierForFileURL:fileURL];
+
+    [[NSFileManager defaultManager] setAttributes:@{ NSFileModificationDate: [NSDate dateWithTimeIntervalSinceNow:60] }
+                                     ofItemAtPath:fileURL.path
+                                            error:nil];
+
+    [cache typeIdentifierForFileURL:fileURL];
+
+    XCTAssertEqual(cache.missCount, 2);
+}
+
+- (void)testMissingFileIsNotResolved {
+    XExtensionItemTypeIdentifierCache *cache = [[XExtensionItemTypeIdentifierCache alloc] init];
+
+    XCTAssertNil([cache typeIdentifierForFileURL:[self.directoryURL URLByAppendingPathComponent:@"missing"]]);
+    XCTAssertNil([cache typeIdentifierForFileURL:[NSURL URLWithString:@"http://tumblr.com/image.png"]]);
+}
+
+- (void)testBatchResolutionIgnoresOtherItems {
+    XExtensionItemTypeIdentifierCache *cache = [[XExtensionItemTypeIdentifierCache alloc] init];
+    NSURL *textURL = [self.directoryURL URLByAppendingPathComponent:@"text.txt"];
+    NSURL *imageURL = [self.directoryURL URLByAppendingPathComponent:@"image.jpg"];
+
+    NSDictionary *typeIdentifiers = [cache typeIdentifiersForFileURLsInArray:@[textURL, @"string", [NSURL URLWithString:@"http://tumblr.com"], imageURL, textURL]];
+
+    XCTAssertEqualObjects((@{ textURL: (NSString *)kUTTypePlainText, imageURL: (NSString *)kUTTypeJPEG }), typeIdentifiers);
+    XCTAssertEqual(cache.extensionHitCount, 2);
+}
+
+- (void)testItemSourceResolvesFileAttachmentsThroughSharedCache {
+    XExtensionItemTypeIdentifierCache *cache = [XExtensionItemTypeIdentifierCache sharedCache];
+    NSURL *fileURL = [self createFileNamed:@"attachment.txt"];
+
+    NSUInteger extensionHitCount = cache.extensionHitCount;
+
+    XExtensionItemSource *itemSource = [[XExtensionItemSource alloc] initWithURL:fileURL];
+    itemSource.additionalAttachments = @[fileURL];
+    [itemSource extensionItemForActivityType:nil];
+
+    XCTAssertGreaterThan(cache.extensionHitCount, extensionHitCount);
+}
+
+#pragma mark - Private
+
+- (NSURL *)createFileNamed:(NSString *)name {
+    NSURL *fileURL = [self.directoryURL URLByAppendingPathComponent:name];
+    [[NSData dataWithBytes:"abc" length:3] writeToURL:fileURL atomically:NO];
+
+    return fileURL;
+}
+
+@end
@@ -70,6 +70,74 @@ static NSString * const Key = @"key";
     XCTAssertNil([safeDictionaryValuesWithSingleEntryForKeyConstant(@1) dataForKey:Key]);
 }
 
+- (void)testDateForKeyReturnsNilForValueOfWrongType {
+    XCTAssertNil([safeDictionaryValuesWithSingleEntryForKeyConstant(@1) dateForKey:Key]);
+}
+
+- (void)testBoolForKeyReturnsDefaultForValueOfWrongType {
+    XCTAssertTrue([safeDictionaryValuesWithSingleEntryForKeyConstant(@"NO") boolForKey:Key defaultValue:YES]);
+}
+
+#pragma mark - Typed accessors
+
+- (void)testBoolForKey {
+    XCTAssertTrue([safeDictionaryValuesWithSingleEntryForKeyConstant(@YES) boolForKey:Key defaultValue:NO]);
+    XCTAssertFalse([safeDictionaryValuesWithSingleEntryForKeyConstant(@NO) boolForKey:Key defaultValue:YES]);
+}
+
+- (void)testDoubleForKey {
+    XCTAssertEqual(1.5, [safeDictionaryValuesWithSingleEntryForKeyConstant(@1.5) doubleForKey:Key defaultValue:0]);
+    XCTAssertEqual(2.5, [safeDictionaryValuesWithSingleEntryForKeyConstant(@"1.5") doubleForKey:Key defaultValue:2.5]);
+}
+
+- (void)testDateForKey {
+    NSDate *date = [NSDate dateWithTimeIntervalSince1970:1000];
+    
+    XCTAssertEqualObjects(date, [safeDictionaryValuesWithSingleEntryForKeyConstant(date) dateForKey:Key]);
+}
+
+- (void)testKeysWithLeadingAtSignAreLookedUpLiterally {
+    XExtensionItemTypeSafeDictionaryValues *values = [[XExtensionItemTypeSafeDictionaryValues alloc] initWithDictionary:@{ @"@count": @"foo" }];
+    
+    XCTAssertEqualObjects(@"foo", [values stringForKey:@"@count"]);
+}
+
+#pragma mark - Borrowed dictionaries
+
+- (void)testBorrowedDictionaryIsNotCopied {
+    NSMutableDictionary *dictionary = [[NSMutableDictionary alloc] init];
+    
+    XExtensionItemTypeSafeDictionaryValues *borrowed = [[XExtensionItemTypeSafeDictionaryValues alloc] initWithDictionaryNoCopy:dictionary];
+    XExtensionItemTypeSafeDictionaryValues *copied = [[XExtensionItemTypeSafeDictionaryValues alloc] initWithDictionary:dictionary];
+    
+    dictionary[Key] = @"string";
+    
+    XCTAssertEqualObjects(@"string", [borrowed stringForKey:Key]);
+    XCTAssertNil([copied stringForKey:Key]);
+}
+
+#pragma mark - Batched lookups
+
+- (void)testValuesForSchema {
+    NSURL *URL = [NSURL URLWithString:@"http://tumblr.com"];
+    
+    XExtensionItemTypeSafeDictionaryValues *values = [[XExtensionItemTypeSafeDictionaryValues alloc] initWithDictionaryNoCopy:@{
+        @"string": @"foo",
+        @"url": URL,
+        @"mistyped": @1,
+        @"unrequested": @"bar"
+    }];
+    
+    NSDictionary *resolved = [values valuesForSchema:@{
+        @"string": [NSString class],
+        @"url": [NSURL class],
+        @"mistyped": [NSString class],
+        @"missing": [NSNumber class]
+    }];
+    
+    XCTAssertEqualObjects((@{ @"string": @"foo", @"url": URL }), resolved);
+}
+
 #pragma mark - Private
 
 static XExtensionItemTypeSafeDictionaryValues *safeDictionaryValuesWithSingleEntryForKeyConstant(id value) {
@@ -1,30 +1,45 @@
 #import "XExtensionItemTumblrParameters.h"
-#import "XExtensionItemTypeSafeDictionaryValues.h"
+#import "XExtensionItemParameterSchema.h"
 
+static NSString * const ParameterKeyNamespace = @"com.tumblr.tumblr.";
 static NSString * const ParameterKeyCustomURLPathComponent = @"com.tumblr.tumblr.custom-url-path";
 static NSString * const ParameterKeyRequestedPostType = @"com.tumblr.tumblr.requested-post-type";
 static NSString * const ParameterKeyConsumerKey = @"com.tumblr.tumblr.consumer-key";
 static NSString * const ParameterKeyCorrelationIdentifier = @"com.tumblr.tumblr.correlation-identifier";
 
+@interface XExtensionItemTumblrParameters () <XExtensionItemSchemaParameters>
+@end
+
 @implementation XExtensionItemTumblrParameters
 
 #pragma mark - Initialization
 
 - (instancetype)initWithCustomURLPathComponent:(NSString *)customURLPathComponent
                                    consumerKey:(NSString *)consumerKey {
-    return [self initWithCustomURLPathComponent:nil
+    return [self initWithCustomURLPathComponent:customURLPathComponent
                               requestedPostType:XExtensionItemTumblrPostTypeAny
-                                    consumerKey:nil];
+                                    consumerKey:consumerKey];
 }
 
 - (instancetype)initWithCustomURLPathComponent:(NSString *)customURLPathComponent
                              requestedPostType:(XExtensionItemTumblrPostType)requestedPostType
                                    consumerKey:(NSString *)consumerKey {
+    return [self initWithCustomURLPathComponent:customURLPathComponent
+                              requestedPostType:requestedPostType
+                                    consumerKey:consumerKey
+                          correlationIdentifier:nil];
+}
+
+- (instancetype)initWithCustomURLPathComponent:(NSString *)customURLPathComponent
+                             requestedPostType:(XExtensionItemTumblrPostType)requestedPostType
+                                   consumerKey:(NSString *)consumerKey
+                         correlationIdentifier:(NSString *)correlationIdentifier {
     self = [super init];
     if (self) {
         _customURLPathComponent = [customURLPathComponent copy];
         _requestedPostType = requestedPostType;
         _consumerKey = [consumerKey copy];
+        _correlationIdentifier = [correlationIdentifier copy];
     }
     
     return self;
@@ -33,25 +48,49 @@ static NSString * const ParameterKeyCorrelationIdentifier = @"com.tumblr.tumblr.
 - (instancetype)init {
     return [self initWithCustomURLPathComponent:nil
                               requestedPostType:XExtensionItemTumblrPostTypeAny
-                                    consumerKey:nil];
+                                    consumerKey:nil
+                          correlationIdentifier:nil];
+}
+
+#pragma mark - XExtensionItemCustomParameters
+
++ (NSString *)keyNamespace {
+    return ParameterKeyNamespace;
+}
+
+#pragma mark - XExtensionItemSchemaParameters
+
++ (NSArray *)parameterFields {
+    return @[
+        [XExtensionItemParameterField optionalFieldWithKey:ParameterKeyCustomURLPathComponent
+                                              propertyName:@"customURLPathComponent"
+                                                      type:XExtensionItemParameterTypeString],
+        [XExtensionItemParameterField optionalFieldWithKey:ParameterKeyRequestedPostType
+                                              propertyName:@"requestedPostType"
+                                                      type:XExtensionItemParameterTypeUnsignedInteger
+                                              defaultValue:@(XExtensionItemTumblrPostTypeAny)],
+        [XExtensionItemParameterField optionalFieldWithKey:ParameterKeyConsumerKey
+                                              propertyName:@"consumerKey"
+                                                      type:XExtensionItemParameterTypeString],
+        [XExtensionItemParameterField optionalFieldWithKey:ParameterKeyCorrelationIdentifier
+                                              propertyName:@"correlationIdentifier"
+                                                      type:XExtensionItemParameterTypeString],
+    ];
 }
 
 #pragma mark - XExtensionItemDictionarySerializing
 
 - (instancetype)initWithDictionary:(NSDictionary *)dictionary {
-    XExtensionItemTypeSafeDictionaryValues *dictionaryValues = [[XExtensionItemTypeSafeDictionaryValues alloc] initWithDictionary:dictionary];
+    self = [self init];
+    if (self) {
+        [parameterSchema() decodeDictionary:dictionary intoObject:self];
+    }
     
-    return [self initWithCustomURLPathComponent:[dictionaryValues stringForKey:ParameterKeyCustomURLPathComponent]
-                              requestedPostType:[dictionaryValues unsignedIntegerForKey:ParameterKeyRequestedPostType]
-                                    consumerKey:[dictionaryValues stringForKey:ParameterKeyConsumerKey]];
+    return self;
 }
 
 - (NSDictionary *)dictionaryRepresentation {
-    NSMutableDictionary *mutableParameters = [[NSMutableDictionary alloc] init];
-    [mutableParameters setValue:self.customURLPathComponent forKey:ParameterKeyCustomURLPathComponent];
-    [mutableParameters setValue:@(self.requestedPostType) forKey:ParameterKeyRequestedPostType];
-    [mutableParameters setValue:self.consumerKey forKey:ParameterKeyConsumerKey];
-    return [mutableParameters copy];
+    return [parameterSchema() dictionaryRepresentationOfObject:self];
 }
 
 #pragma mark - NSObject
@@ -71,32 +110,33 @@ static NSString * const ParameterKeyCorrelationIdentifier = @"com.tumblr.tumblr.
         [descriptionComponents addObject:[NSString stringWithFormat:@"consumerKey: %@", self.consumerKey]];
     }
     
+    if (self.correlationIdentifier) {
+        [descriptionComponents addObject:[NSString stringWithFormat:@"correlationIdentifier: %@", self.correlationIdentifier]];
+    }
+    
     [mutableDescription appendFormat:@"{ %@ }", [descriptionComponents componentsJoinedByString:@", "]];
     
     return [mutableDescription copy];
 }
 
 - (BOOL)isEqual:(id)object {
-    if (object == self) {
-        return YES;
-    }
-    
-    if (![object isKindOfClass:[XExtensionItemTumblrParameters class]]) {
-        return NO;
-    }
-    
-    XExtensionItemTumblrParameters *other = (XExtensionItemTumblrParameters *)object;
-    
-    return [self.customURLPathComponent isEqual:other.customURLPathComponent] && self.requestedPostType == other.requestedPostType && [self.consumerKey isEqual:other.consumerKey];
+    return [parameterSchema() isObject:self equalToObject:object];
 }
 
 - (NSUInteger)hash {
-    NSUInteger hash = 15;
-    hash += self.customURLPathComponent.hash;
-    hash += self.requestedPostType;
-    hash += self.consumerKey.hash;
+    return [parameterSchema() hashOfObject:self];
+}
+
+#pragma mark - Private
+
+static XExtensionItemParameterSchema *parameterSchema(void) {
+    static XExtensionItemParameterSchema *schema;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        schema = [XExtensionItemParameterSchema schemaForClass:[XExtensionItemTumblrParameters class]];
+    });
     
-    return hash * 41;
+    return schema;
 }
 
 @end
@@ -39,6 +39,12 @@ typedef NS_ENUM(NSUInteger, XExtensionItemTumblrPostType) {
  */
 @property (nonatomic, readonly) NSString *consumerKey;
 
+/**
+ Identifier that Tumblr logs the share with, allowing it to be correlated with your own logs. Typically the item source’s 
+ `traceCorrelationIdentifier`, so that it matches the extension item’s `trace` as well.
+ */
+@property (nonatomic, readonly) NSString *correlationIdentifier;
+
 /**
  Convenience initializer that calls the designated initializer with a requested post type value of `XExtensionItemTumblrPostTypeAny`.
  
@@ -50,17 +56,32 @@ typedef NS_ENUM(NSUInteger, XExtensionItemTumblrPostType) {
 - (instancetype)initWithCustomURLPathComponent:(NSString *)customURLPathComponent
                                    consumerKey:(NSString *)consumerKey;
 
+/**
+ Convenience initializer that calls the designated initializer with no correlation identifier.
+ 
+ @param customURLPathComponent (Optional) See `customURLPathComponent` property documentation.
+ @param requestedPostType      See `requestedPostType` property documentation. Default value: `XExtensionItemTumblrPostTypeAny`
+ @param consumerKey            (Optional) See `consumerKey` property documentation.
+ 
+ @return New parameters instance.
+ */
+- (instancetype)initWithCustomURLPathComponent:(NSString *)customURLPathComponent
+                             requestedPostType:(XExtensionItemTumblrPostType)requestedPostType
+                                   consumerKey:(NSString *)consumerKey;
+
 /**
  Initializes a custom Tumblr parameters object.
  
  @param customURLPathComponent (Optional) See `customURLPathComponent` property documentation.
  @param requestedPostType      See `requestedPostType` property documentation. Default value: `XExtensionItemTumblrPostTypeAny`
  @param consumerKey            (Optional) See `consumerKey` property documentation.
+ @param correlationIdentifier  (Optional) See `correlationIdentifier` property documentation.
  
  @return New parameters instance.
  */
 - (instancetype)initWithCustomURLPathComponent:(NSString *)customURLPathComponent
                              requestedPostType:(XExtensionItemTumblrPostType)requestedPostType
-                                   consumerKey:(NSString *)consumerKey NS_DESIGNATED_INITIALIZER;
+                                   consumerKey:(NSString *)consumerKey
+                         correlationIdentifier:(NSString *)correlationIdentifier NS_DESIGNATED_INITIALIZER;
 
 @end
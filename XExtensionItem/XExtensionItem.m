@@ -1,22 +1,49 @@
 #import "XExtensionItem.h"
+#import "XExtensionItemAsynchronousItemLoader.h"
+#import "XExtensionItemAttachmentDeduplicator.h"
+#import "XExtensionItemBinaryCoder.h"
+#import "XExtensionItemCustomParametersRegistry.h"
+#import "XExtensionItemDecodingLimitsEnforcement.h"
+#import "XExtensionItemInstrumentation.h"
+#import "XExtensionItemParameterKeys.h"
 #import "XExtensionItemReferrer.h"
-#import "XExtensionItemTypeSafeDictionaryValues.h"
+#import "XExtensionItemSharedParameters.h"
+#import "XExtensionItemSourceSnapshot.h"
+#import "XExtensionItemThumbnailCache.h"
+#import "XExtensionItemTraceRecording.h"
+#import "XExtensionItemTypeIdentifierCache.h"
 #import <MobileCoreServices/MobileCoreServices.h>
 
-static NSString * const ParameterKeyXExtensionItem = @"x-extension-item";
-static NSString * const ParameterKeySourceURL = @"source-url";
-static NSString * const ParameterKeyTags = @"tags";
 static NSString * const ActivityTypeCatchAll = @"*";
+static NSTimeInterval const DefaultAsynchronousItemTimeout = 1;
+static NSUInteger const DefaultPreparationMemoryBudget = 16 * 1024 * 1024;
+static XExtensionItemAttachmentDeduplication const DefaultAttachmentDeduplication = XExtensionItemAttachmentDeduplicationIdentity | XExtensionItemAttachmentDeduplicationFilePath;
 
 @interface XExtensionItemSource ()
 
 @property (nonatomic) id placeholderItem;
 @property (nonatomic, copy) XExtensionItemProvidingBlock activityItemBlock;
 @property (nonatomic, copy) NSString *typeIdentifier;
+@property (nonatomic) XExtensionItemAsynchronousItemLoader *asynchronousItemLoader;
+@property (nonatomic) XExtensionItemStreamingAttachment *streamingAttachment;
 
-@property (nonatomic) NSMutableDictionary *additionalAttachmentsByActivityType;
-@property (nonatomic) NSMutableDictionary *attributedContentTextByActivityType;
-@property (nonatomic) NSMutableDictionary *customParameters;
+/*
+ Values of every property that can change after initialization. Replaced rather than mutated (see `updateSnapshot:`), 
+ so that readers on any thread can build an extension item from a consistent set of values without locking.
+ */
+@property (atomic) XExtensionItemSourceSnapshot *snapshot;
+
+/*
+ Incremented whenever preparation is started or cancelled, so that preparation in progress can tell it’s been superseded.
+ */
+@property (atomic) NSUInteger preparationGeneration;
+
+/*
+ When the activity sheet last asked for the placeholder item, and when each extension item was built, for traces. Build 
+ times are guarded by `@synchronized (self.itemBuildTimes)`.
+ */
+@property (atomic) NSTimeInterval sheetOpenTime;
+@property (nonatomic) NSMapTable *itemBuildTimes;
 
 @end
 
@@ -41,9 +68,25 @@ static NSString * const ActivityTypeCatchAll = @"*";
             }
         }();
         
-        _additionalAttachmentsByActivityType = [[NSMutableDictionary alloc] init];
-        _attributedContentTextByActivityType = [[NSMutableDictionary alloc] init];
-        _customParameters = [[NSMutableDictionary alloc] init];
+        _snapshot = [[XExtensionItemSourceSnapshot alloc] init];
+        _snapshot.asynchronousItemTimeout = DefaultAsynchronousItemTimeout;
+        _snapshot.preparationMemoryBudget = DefaultPreparationMemoryBudget;
+        _snapshot.attachmentDeduplication = DefaultAttachmentDeduplication;
+        _snapshot.payloadCompactionSteps = defaultPayloadCompactionSteps();
+        _thumbnailCache = [[XExtensionItemThumbnailCache alloc] init];
+        _traceCorrelationIdentifier = [NSUUID UUID].UUIDString;
+        _itemBuildTimes = [NSMapTable weakToStrongObjectsMapTable];
+    }
+    
+    return self;
+}
+
+- (instancetype)initWithPlaceholderItem:(id)placeholderItem typeIdentifier:(NSString *)typeIdentifier asynchronousItemBlock:(XExtensionItemAsynchronousProvidingBlock)itemBlock {
+    NSParameterAssert(itemBlock);
+    
+    self = [self initWithPlaceholderItem:placeholderItem typeIdentifier:typeIdentifier itemBlock:nil];
+    if (self) {
+        _asynchronousItemLoader = [[XExtensionItemAsynchronousItemLoader alloc] initWithBlock:itemBlock];
     }
     
     return self;
@@ -75,6 +118,19 @@ static NSString * const ActivityTypeCatchAll = @"*";
                                itemBlock:nil];
 }
 
+- (instancetype)initWithStreamingAttachment:(XExtensionItemStreamingAttachment *)streamingAttachment {
+    NSParameterAssert(streamingAttachment);
+    
+    self = [self initWithPlaceholderItem:streamingAttachment.fileURL
+                          typeIdentifier:streamingAttachment.typeIdentifier
+                               itemBlock:nil];
+    if (self) {
+        _streamingAttachment = streamingAttachment;
+    }
+    
+    return self;
+}
+
 - (instancetype)init {
     return [self initWithPlaceholderItem:nil
                           typeIdentifier:nil
@@ -83,8 +139,141 @@ static NSString * const ActivityTypeCatchAll = @"*";
 
 #pragma mark - XExtensionItemSource
 
+- (XExtensionItemActivityRoutingTable *)activityRoutingTable {
+    return self.snapshot.activityRoutingTable ?: [XExtensionItemActivityRoutingTable defaultTable];
+}
+
+- (void)setActivityRoutingTable:(XExtensionItemActivityRoutingTable *)activityRoutingTable {
+    [self updateSnapshot:^(XExtensionItemSourceSnapshot *snapshot) {
+        snapshot.activityRoutingTable = activityRoutingTable;
+    }];
+}
+
 - (void)addCustomParameters:(id<XExtensionItemCustomParameters>)customParameters {
-    [self.customParameters addEntriesFromDictionary:customParameters.dictionaryRepresentation];
+    NSDictionary *dictionaryRepresentation = customParameters.dictionaryRepresentation;
+    
+    __block XExtensionItemParameterCollisionHandler collisionHandler;
+    __block NSArray *collidingKeys;
+    
+    [self updateSnapshot:^(XExtensionItemSourceSnapshot *snapshot) {
+        collisionHandler = snapshot.parameterCollisionHandler;
+        
+        if (collisionHandler) {
+            collidingKeys = collidingKeysInDictionary(dictionaryRepresentation, snapshot.customParameters);
+        }
+        
+        NSMutableDictionary *mutableCustomParameters = [snapshot.customParameters mutableCopy] ?: [[NSMutableDictionary alloc] init];
+        [mutableCustomParameters addEntriesFromDictionary:dictionaryRepresentation];
+        
+        snapshot.customParameters = mutableCustomParameters;
+        invalidateExtensionItemUserInfo(snapshot);
+    }];
+    
+    // Called outside of the lock, in case the handler touches this instance
+    if (collidingKeys.count > 0) {
+        collisionHandler(collidingKeys);
+    }
+}
+
+- (NSString *)title {
+    return self.snapshot.title;
+}
+
+- (void)setTitle:(NSString *)title {
+    [self updateSnapshot:^(XExtensionItemSourceSnapshot *snapshot) {
+        snapshot.title = title;
+        invalidateExtensionItemsForActivityType(snapshot, nil);
+    }];
+}
+
+- (NSArray *)tags {
+    return self.snapshot.tags;
+}
+
+- (void)setTags:(NSArray *)tags {
+    [self updateSnapshot:^(XExtensionItemSourceSnapshot *snapshot) {
+        snapshot.tags = tags;
+        invalidateExtensionItemUserInfo(snapshot);
+    }];
+}
+
+- (NSURL *)sourceURL {
+    return self.snapshot.sourceURL;
+}
+
+- (void)setSourceURL:(NSURL *)sourceURL {
+    [self updateSnapshot:^(XExtensionItemSourceSnapshot *snapshot) {
+        snapshot.sourceURL = sourceURL;
+        invalidateExtensionItemUserInfo(snapshot);
+    }];
+}
+
+- (XExtensionItemReferrer *)referrer {
+    return self.snapshot.referrer;
+}
+
+- (void)setReferrer:(XExtensionItemReferrer *)referrer {
+    [self updateSnapshot:^(XExtensionItemSourceSnapshot *snapshot) {
+        snapshot.referrer = referrer;
+        invalidateExtensionItemUserInfo(snapshot);
+    }];
+}
+
+- (NSDictionary *)userInfo {
+    return self.snapshot.userInfo;
+}
+
+- (void)setUserInfo:(NSDictionary *)userInfo {
+    [self updateSnapshot:^(XExtensionItemSourceSnapshot *snapshot) {
+        snapshot.userInfo = userInfo;
+        invalidateExtensionItemUserInfo(snapshot);
+    }];
+}
+
+- (XExtensionItemParameterCollisionHandler)parameterCollisionHandler {
+    return self.snapshot.parameterCollisionHandler;
+}
+
+- (void)setParameterCollisionHandler:(XExtensionItemParameterCollisionHandler)parameterCollisionHandler {
+    [self updateSnapshot:^(XExtensionItemSourceSnapshot *snapshot) {
+        snapshot.parameterCollisionHandler = parameterCollisionHandler;
+    }];
+}
+
+- (XExtensionItemParameterEncoding)parameterEncoding {
+    return self.snapshot.parameterEncoding;
+}
+
+- (void)setParameterEncoding:(XExtensionItemParameterEncoding)parameterEncoding {
+    [self updateSnapshot:^(XExtensionItemSourceSnapshot *snapshot) {
+        snapshot.parameterEncoding = parameterEncoding;
+        invalidateExtensionItemUserInfo(snapshot);
+    }];
+}
+
+- (NSTimeInterval)asynchronousItemTimeout {
+    return self.snapshot.asynchronousItemTimeout;
+}
+
+- (void)setAsynchronousItemTimeout:(NSTimeInterval)asynchronousItemTimeout {
+    [self updateSnapshot:^(XExtensionItemSourceSnapshot *snapshot) {
+        snapshot.asynchronousItemTimeout = asynchronousItemTimeout;
+    }];
+}
+
+- (XExtensionItemThumbnailProvidingBlock)thumbnailProvider {
+    return self.snapshot.thumbnailProvider;
+}
+
+- (void)setThumbnailProvider:(XExtensionItemThumbnailProvidingBlock)thumbnailProvider {
+    [self updateSnapshot:^(XExtensionItemSourceSnapshot *snapshot) {
+        snapshot.thumbnailProvider = thumbnailProvider;
+        snapshot.thumbnailProviderGeneration++;
+        invalidateExtensionItemsForActivityType(snapshot, nil);
+    }];
+    
+    // Only frees memory, since the new generation already keeps the old provider’s thumbnails from being served
+    [self.thumbnailCache removeAllThumbnails];
 }
 
 - (void)setAttributedContentText:(NSAttributedString *)attributedContentText {
@@ -92,18 +281,19 @@ static NSString * const ActivityTypeCatchAll = @"*";
 }
 
 - (NSAttributedString *)attributedContentText {
-    return [self attributedContentTextForActivityType:nil];
+    return valueForActivityType(self.snapshot.attributedContentTextByActivityType, nil);
 }
 
 - (void)setAttributedContentText:(NSAttributedString *)attributedContentText forActivityType:(NSString *)activityType {
     activityType = activityType ?: ActivityTypeCatchAll;
     
-    if (attributedContentText) {
-        self.attributedContentTextByActivityType[activityType] = attributedContentText;
-    }
-    else {
-        [self.attributedContentTextByActivityType removeObjectForKey:activityType];
-    }
+    [self updateSnapshot:^(XExtensionItemSourceSnapshot *snapshot) {
+        NSMutableDictionary *mutableContentText = [snapshot.attributedContentTextByActivityType mutableCopy] ?: [[NSMutableDictionary alloc] init];
+        [mutableContentText setValue:attributedContentText forKey:activityType];
+        
+        snapshot.attributedContentTextByActivityType = mutableContentText;
+        invalidateExtensionItemsForActivityType(snapshot, activityType);
+    }];
 }
 
 - (void)setAdditionalAttachments:(NSArray *)attachments {
@@ -116,18 +306,179 @@ static NSString * const ActivityTypeCatchAll = @"*";
 
 - (void)setAdditionalAttachments:(NSArray *)attachments forActivityType:(NSString *)activityType {
     activityType = activityType ?: ActivityTypeCatchAll;
+    attachments = [attachments copy];
+    
+    [self updateSnapshot:^(XExtensionItemSourceSnapshot *snapshot) {
+        NSMutableDictionary *mutableAttachments = [snapshot.additionalAttachmentsByActivityType mutableCopy] ?: [[NSMutableDictionary alloc] init];
+        [mutableAttachments setValue:attachments forKey:activityType];
+        
+        snapshot.additionalAttachmentsByActivityType = mutableAttachments;
+        invalidateExtensionItemsForActivityType(snapshot, activityType);
+    }];
+}
+
+- (XExtensionItemAttachmentDeduplication)attachmentDeduplication {
+    return self.snapshot.attachmentDeduplication;
+}
+
+- (void)setAttachmentDeduplication:(XExtensionItemAttachmentDeduplication)attachmentDeduplication {
+    [self updateSnapshot:^(XExtensionItemSourceSnapshot *snapshot) {
+        snapshot.attachmentDeduplication = attachmentDeduplication;
+        [snapshot removeAllCachedExtensionItems];
+    }];
+}
+
+- (NSUInteger)preparationMemoryBudget {
+    return self.snapshot.preparationMemoryBudget;
+}
+
+- (void)setPreparationMemoryBudget:(NSUInteger)preparationMemoryBudget {
+    [self updateSnapshot:^(XExtensionItemSourceSnapshot *snapshot) {
+        snapshot.preparationMemoryBudget = preparationMemoryBudget;
+    }];
+}
+
+- (void)prepareForActivityTypes:(NSArray *)activityTypes thumbnailSize:(CGSize)thumbnailSize completion:(XExtensionItemPreparationCompletionBlock)completion {
+    NSUInteger generation = [self incrementPreparationGeneration];
+    activityTypes = [activityTypes copy];
+    
+    [self prefetchAsynchronousItem];
+    
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        uint64_t span = metricsBeginSpan(XExtensionItemMetricsSpanPreparation);
+        NSArray *preparedActivityTypes = [self prepareForActivityTypes:activityTypes thumbnailSize:thumbnailSize generation:generation];
+        metricsEndSpan(XExtensionItemMetricsSpanPreparation, span);
+        
+        if (completion) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completion(preparedActivityTypes);
+            });
+        }
+    });
+}
+
+- (void)cancelPreparation {
+    [self incrementPreparationGeneration];
+}
+
+- (NSUInteger)payloadByteBudget {
+    return [valueForActivityType(self.snapshot.payloadByteBudgetsByActivityType, nil) unsignedIntegerValue];
+}
+
+- (void)setPayloadByteBudget:(NSUInteger)payloadByteBudget {
+    [self setPayloadByteBudget:payloadByteBudget forActivityType:nil];
+}
+
+- (void)setPayloadByteBudget:(NSUInteger)byteBudget forActivityType:(NSString *)activityType {
+    activityType = activityType ?: ActivityTypeCatchAll;
+    
+    [self updateSnapshot:^(XExtensionItemSourceSnapshot *snapshot) {
+        NSMutableDictionary *mutableBudgets = [snapshot.payloadByteBudgetsByActivityType mutableCopy] ?: [[NSMutableDictionary alloc] init];
+        mutableBudgets[activityType] = @(byteBudget);
+        
+        snapshot.payloadByteBudgetsByActivityType = mutableBudgets;
+        invalidateExtensionItemsForActivityType(snapshot, activityType);
+    }];
+}
+
+- (NSArray *)payloadCompactionSteps {
+    return self.snapshot.payloadCompactionSteps;
+}
+
+- (void)setPayloadCompactionSteps:(NSArray *)payloadCompactionSteps {
+    [self updateSnapshot:^(XExtensionItemSourceSnapshot *snapshot) {
+        snapshot.payloadCompactionSteps = payloadCompactionSteps ?: defaultPayloadCompactionSteps();
+        [snapshot removeAllCachedExtensionItems];
+    }];
+}
+
+- (XExtensionItemPayloadCompactionHandler)payloadCompactionHandler {
+    return self.snapshot.payloadCompactionHandler;
+}
+
+- (void)setPayloadCompactionHandler:(XExtensionItemPayloadCompactionHandler)payloadCompactionHandler {
+    [self updateSnapshot:^(XExtensionItemSourceSnapshot *snapshot) {
+        snapshot.payloadCompactionHandler = payloadCompactionHandler;
+    }];
+}
+
+- (NSUInteger)estimatedPayloadByteCountForActivityType:(NSString *)activityType {
+    XExtensionItemSourceSnapshot *snapshot = self.snapshot;
+    
+    return (NSUInteger)[self payloadForActivityType:activityType snapshot:snapshot userInfo:[self extensionItemUserInfoFromSnapshot:snapshot]].estimatedByteCount;
+}
+
+- (BOOL)isTracingEnabled {
+    return self.snapshot.isTracingEnabled;
+}
+
+- (void)setTracingEnabled:(BOOL)tracingEnabled {
+    // Traces are added as items are handed out, so cached items are still valid
+    [self updateSnapshot:^(XExtensionItemSourceSnapshot *snapshot) {
+        snapshot.tracingEnabled = tracingEnabled;
+    }];
+}
+
+- (NSExtensionItem *)extensionItemForActivityType:(NSString *)activityType {
+    // Everything below reads from this one snapshot, so writers on other threads can’t produce a half-updated item
+    return [self extensionItemForActivityType:activityType snapshot:self.snapshot];
+}
+
+- (NSExtensionItem *)extensionItemForActivityType:(NSString *)activityType snapshot:(XExtensionItemSourceSnapshot *)snapshot {
+    NSString *cacheKey = activityType ?: ActivityTypeCatchAll;
+    NSExtensionItem *item = [snapshot cachedExtensionItemForActivityType:cacheKey];
     
-    if (attachments) {
-        self.additionalAttachmentsByActivityType[activityType] = attachments;
+    if (!item) {
+        // Don’t cache a payload built around the placeholder item if the asynchronous item simply wasn’t ready yet
+        BOOL cacheable = !self.asynchronousItemLoader || self.asynchronousItemLoader.isFinished;
+        
+        item = [self buildExtensionItemForActivityType:activityType snapshot:snapshot];
+        
+        if (snapshot.isTracingEnabled) {
+            @synchronized (self.itemBuildTimes) {
+                [self.itemBuildTimes setObject:@(traceCurrentTime()) forKey:item];
+            }
+        }
+        
+        if (cacheable) {
+            [snapshot cacheExtensionItem:item forActivityType:cacheKey];
+        }
     }
-    else {
-        [self.additionalAttachmentsByActivityType removeObjectForKey:activityType];
+    
+    return item;
+}
+
+- (void)removeCachedExtensionItems {
+    [self updateSnapshot:^(XExtensionItemSourceSnapshot *snapshot) {
+        invalidateExtensionItemUserInfo(snapshot);
+    }];
+}
+
+- (void)prefetchAsynchronousItem {
+    [self.asynchronousItemLoader start];
+}
+
+- (void)cancelAsynchronousItem {
+    if (self.asynchronousItemLoader) {
+        [self.asynchronousItemLoader cancel];
+        
+        // The item will be loaded again next time, so payloads built around the previous one shouldn’t be reused
+        [self updateSnapshot:^(XExtensionItemSourceSnapshot *snapshot) {
+            invalidateExtensionItemsForActivityType(snapshot, nil);
+        }];
     }
 }
 
 #pragma mark - UIActivityItemSource
 
 - (id)activityViewControllerPlaceholderItem:(UIActivityViewController *)activityViewController {
+    if (self.tracingEnabled) {
+        self.sheetOpenTime = traceCurrentTime();
+    }
+    
+    // Get a head start on the real item while the user is choosing an activity
+    [self prefetchAsynchronousItem];
+    
     return self.placeholderItem;
 }
 
@@ -136,10 +487,14 @@ static NSString * const ActivityTypeCatchAll = @"*";
 }
 
 - (UIImage *)activityViewController:(UIActivityViewController *)activityViewController thumbnailImageForActivityType:(NSString *)activityType suggestedSize:(CGSize)size {
-    XExtensionItemThumbnailProvidingBlock thumbnailBlock = self.thumbnailProvider;
+    XExtensionItemSourceSnapshot *snapshot = self.snapshot;
+    XExtensionItemThumbnailProvidingBlock thumbnailBlock = snapshot.thumbnailProvider;
     
     if (thumbnailBlock) {
-        return thumbnailBlock(size, activityType);
+        return [self.thumbnailCache thumbnailForActivityType:activityType
+                                                        size:size
+                                          providerGeneration:snapshot.thumbnailProviderGeneration
+                                                    provider:thumbnailBlock];
     }
     else {
         return nil;
@@ -151,141 +506,481 @@ static NSString * const ActivityTypeCatchAll = @"*";
 }
 
 - (id)activityViewController:(UIActivityViewController *)activityViewController itemForActivityType:(NSString *)activityType {
-    if (isExtensionItemInputAcceptedByActivityType(activityType)) {
+    uint64_t span = metricsBeginSpan(XExtensionItemMetricsSpanItemForActivityType);
+    id activityItem = [self itemForActivityType:activityType];
+    metricsEndSpan(XExtensionItemMetricsSpanItemForActivityType, span);
+    
+    if (metricsEnabled() && [activityItem isKindOfClass:[NSExtensionItem class]]) {
+        NSExtensionItem *extensionItem = (NSExtensionItem *)activityItem;
+        metricsRecordCounter(XExtensionItemMetricsCounterPayloadKeyCount, (int64_t)extensionItem.userInfo.count);
+        metricsRecordCounter(XExtensionItemMetricsCounterAttachmentCount, (int64_t)extensionItem.attachments.count);
+    }
+    
+    if (self.tracingEnabled && [activityItem isKindOfClass:[NSExtensionItem class]]) {
+        activityItem = [self tracedExtensionItem:activityItem activityType:activityType];
+    }
+    
+    return activityItem;
+}
+
+#pragma mark - Private
+
+- (XExtensionItemSharedParameters *)sharedParameters {
+    return self.snapshot.sharedParameters;
+}
+
+- (void)setSharedParameters:(XExtensionItemSharedParameters *)sharedParameters {
+    [self updateSnapshot:^(XExtensionItemSourceSnapshot *snapshot) {
+        snapshot.sharedParameters = sharedParameters;
+        invalidateExtensionItemUserInfo(snapshot);
+    }];
+}
+
+/*
+ Publish a copy of the current snapshot with the block’s changes applied. Writers are serialized so that concurrent 
+ changes aren’t lost; readers never wait on them.
+ */
+- (void)updateSnapshot:(void (^)(XExtensionItemSourceSnapshot *snapshot))updates {
+    @synchronized (self) {
+        XExtensionItemSourceSnapshot *snapshot = [self.snapshot copy];
+        updates(snapshot);
+        self.snapshot = snapshot;
+    }
+}
+
+- (NSUInteger)incrementPreparationGeneration {
+    @synchronized (self) {
+        self.preparationGeneration++;
+        return self.preparationGeneration;
+    }
+}
+
+/*
+ Must be called on a background queue. Returns the activity types that were prepared.
+ */
+- (NSArray *)prepareForActivityTypes:(NSArray *)activityTypes thumbnailSize:(CGSize)thumbnailSize generation:(NSUInteger)generation {
+    NSMutableArray *preparedActivityTypes = [[NSMutableArray alloc] initWithCapacity:activityTypes.count];
+    NSUInteger preparedByteCount = 0;
+    
+    for (NSString *activityType in activityTypes) {
+        if (self.preparationGeneration != generation) {
+            break;
+        }
+        
+        XExtensionItemSourceSnapshot *snapshot = self.snapshot;
+        NSExtensionItem *item;
+        BOOL wasCached = NO;
+        NSUInteger byteCount = 0;
+        
+        if (isExtensionItemInputAcceptedByActivityType(activityType, snapshot.activityRoutingTable ?: [XExtensionItemActivityRoutingTable defaultTable])) {
+            wasCached = [snapshot cachedExtensionItemForActivityType:activityType] != nil;
+            item = [self extensionItemForActivityType:activityType snapshot:snapshot];
+            
+            byteCount += (NSUInteger)[XExtensionItemPayload estimatedByteCountOfValue:item.userInfo];
+            byteCount += (NSUInteger)[XExtensionItemPayload estimatedByteCountOfValue:valueForActivityType(snapshot.additionalAttachmentsByActivityType, activityType)];
+        }
+        else if (self.streamingAttachment) {
+            // Spooled here, on disk, so that the activity can be handed the file itself
+            [self.streamingAttachment spooledFileURLWithError:nil];
+        }
+        
+        if (snapshot.thumbnailProvider && thumbnailSize.width > 0 && thumbnailSize.height > 0) {
+            UIImage *thumbnail = [self.thumbnailCache thumbnailForActivityType:activityType
+                                                                          size:thumbnailSize
+                                                            providerGeneration:snapshot.thumbnailProviderGeneration
+                                                                      provider:snapshot.thumbnailProvider];
+            byteCount += (NSUInteger)[XExtensionItemPayload estimatedByteCountOfValue:thumbnail];
+        }
+        
+        if (preparedByteCount + byteCount > snapshot.preparationMemoryBudget) {
+            if (item && !wasCached) {
+                [snapshot removeCachedExtensionItemForActivityType:activityType];
+            }
+            
+            break;
+        }
+        
+        /*
+         If this instance was changed in a way that affects the item while it was being built, the item was cached on a 
+         snapshot that has since been replaced, and won’t be used.
+         */
+        if (item && [self.snapshot cachedExtensionItemForActivityType:activityType] != item) {
+            continue;
+        }
+        
+        preparedByteCount += byteCount;
+        [preparedActivityTypes addObject:activityType];
+    }
+    
+    return [preparedActivityTypes copy];
+}
+
+- (id)itemForActivityType:(NSString *)activityType {
+    if (isExtensionItemInputAcceptedByActivityType(activityType, self.activityRoutingTable)) {
         /*
          Share extensions take `NSExtensionItem` instances as input, and *some* system activities do as well, but some 
          do not. Unfortunately we need to maintain a hardcoded list of which system activities we can pass extension 
-         items to.
+         items to (see `XExtensionItemActivityRoutingTable`).
          
          Trying to pass an extension item into a system activity that doesn’t know how to process it will result in no 
          data making it’s way through. In these cases, we’ll pass the placeholder item that this instance was 
          initialized with instead.
          */
         
-        NSExtensionItem *item = [[NSExtensionItem alloc] init];
-        item.userInfo = ({
-            NSMutableDictionary *mutableUserInfo = [[NSMutableDictionary alloc] init];
-            [mutableUserInfo addEntriesFromDictionary:self.customParameters];
-            [mutableUserInfo addEntriesFromDictionary:self.userInfo];
-            
-            NSMutableDictionary *mutableParameters = [[NSMutableDictionary alloc] init];
-            [mutableParameters setValue:self.tags forKey:ParameterKeyTags];
-            [mutableParameters setValue:self.sourceURL forKey:ParameterKeySourceURL];
-            [mutableParameters addEntriesFromDictionary:self.referrer.dictionaryRepresentation];
-            
-            if (mutableParameters.count > 0) {
-                mutableUserInfo[ParameterKeyXExtensionItem] = [mutableParameters copy];
-            }
-            
-            mutableUserInfo;
-        });
+        return [self extensionItemForActivityType:activityType];
+    }
+    else {
+        return [self activityItemForActivityType:activityType];
+    }
+}
+
+- (NSExtensionItem *)buildExtensionItemForActivityType:(NSString *)activityType snapshot:(XExtensionItemSourceSnapshot *)snapshot {
+    NSExtensionItem *item = [[NSExtensionItem alloc] init];
+    item.userInfo = [self extensionItemUserInfoFromSnapshot:snapshot];
+    
+    /*
+     The `userInfo` setter *must* be called before the following three setters, which merely provide syntactic sugar for
+     populating the `userInfo` dictionary with the following keys:
+     
+     * `NSExtensionItemAttributedTitleKey`,
+     * `NSExtensionItemAttributedContentTextKey`
+     * `NSExtensionItemAttachmentsKey`.
+     
+     */
+    
+    XExtensionItemPayload *payload = [self payloadForActivityType:activityType snapshot:snapshot userInfo:item.userInfo];
+    [self compactPayload:payload snapshot:snapshot];
         
-        /*
-         The `userInfo` setter *must* be called before the following three setters, which merely provide syntactic sugar for
-         populating the `userInfo` dictionary with the following keys:
-         
-         * `NSExtensionItemAttributedTitleKey`,
-         * `NSExtensionItemAttributedContentTextKey`
-         * `NSExtensionItemAttachmentsKey`.
-         
-         */
-            
-        item.attachments = ({
-            id activityItem = [self activityItemForActivityType:activityType];
-            
-            NSString *typeIdentifier = ^NSString *{
-                BOOL classHasChanged = ![activityItem isKindOfClass:[self.placeholderItem class]];
-                
-                // Always re-check the type of URL objects, because they could be either file or regular URLs
-                BOOL isURL = [activityItem isKindOfClass:[NSURL class]];
+    item.attachments = ({
+        NSItemProvider *mainAttachment = [self mainAttachmentForActivityItem:payload.mainItem typeIdentifier:payload.typeIdentifier];
+        XExtensionItemThumbnailProvidingBlock thumbnailProvider = snapshot.thumbnailProvider;
+        XExtensionItemThumbnailCache *thumbnailCache = self.thumbnailCache;
+        NSUInteger thumbnailProviderGeneration = snapshot.thumbnailProviderGeneration;
+
+        if (thumbnailProvider) {
+            // Capture the block and cache rather than `self`, since cached item providers would otherwise create a retain cycle
+            mainAttachment.previewImageHandler = ^(NSItemProviderCompletionHandler completionHandler, Class expectedValueClass, NSDictionary *options) {
+                CGSize preferredImageSize = [[options objectForKey:NSItemProviderPreferredImageSizeKey] CGSizeValue];
+                UIImage *thumbnail = [thumbnailCache thumbnailForActivityType:activityType
+                                                                         size:preferredImageSize
+                                                           providerGeneration:thumbnailProviderGeneration
+                                                                     provider:thumbnailProvider];
+                completionHandler(thumbnail, nil);
+            };
+        }
+        
+        NSMutableArray *attachments = [[NSMutableArray alloc] initWithObjects:mainAttachment, nil];
+
+        NSArray *additionalAttachments = payload.additionalAttachments;
+        NSDictionary *fileTypeIdentifiers = [[XExtensionItemTypeIdentifierCache sharedCache] typeIdentifiersForFileURLsInArray:additionalAttachments];
+        
+        for (id attachmentItem in additionalAttachments) {
+            if ([attachmentItem isKindOfClass:[NSItemProvider class]]) {
+                [attachments addObject:attachmentItem];
+            }
+            else if ([attachmentItem isKindOfClass:[XExtensionItemStreamingAttachment class]]) {
+                [attachments addObject:((XExtensionItemStreamingAttachment *)attachmentItem).itemProvider];
+            }
+            else {
+                NSString *additionalAttachmentTypeIdentifier = fileTypeIdentifiers[attachmentItem] ?: typeIdentifierForActivityItem(attachmentItem);
                 
-                if (classHasChanged || isURL) {
-                    NSString *derivedTypeIdentifier = typeIdentifierForActivityItem(activityItem);
-                    
-                    if (derivedTypeIdentifier) {
-                        return derivedTypeIdentifier;
-                    }
+                if (additionalAttachmentTypeIdentifier) {
+                    NSItemProvider *attachmentProvider = [[NSItemProvider alloc] initWithItem:attachmentItem
+                                                                               typeIdentifier:additionalAttachmentTypeIdentifier];
+                    [attachments addObject:attachmentProvider];
                 }
-                
-                return self.typeIdentifier;
-            }();
-            
-            NSItemProvider *mainAttachment = [[NSItemProvider alloc] initWithItem:activityItem typeIdentifier:typeIdentifier];
-            
-            if (self.thumbnailProvider) {
-                mainAttachment.previewImageHandler = ^(NSItemProviderCompletionHandler completionHandler, Class expectedValueClass, NSDictionary *options) {
-                    CGSize preferredImageSize = [[options objectForKey:NSItemProviderPreferredImageSizeKey] CGSizeValue];
-                    UIImage *thumbnail = self.thumbnailProvider(preferredImageSize, activityType);
-                    completionHandler(thumbnail, nil);
-                };
             }
-            
-            NSMutableArray *attachments = [[NSMutableArray alloc] initWithObjects:mainAttachment, nil];
+        }
+        
+        attachments;
+    });
+    
+    item.attributedContentText = payload.attributedContentText;
+    
+    if (snapshot.title) {
+        item.attributedTitle = [[NSAttributedString alloc] initWithString:snapshot.title];
+    }
+    
+    return item;
+}
 
-            for (id attachmentItem in [self additionalAttachmentsForActivityType:activityType]) {
-                if ([attachmentItem isKindOfClass:[NSItemProvider class]]) {
-                    [attachments addObject:attachmentItem];
-                }
-                else {
-                    NSString *additionalAttachmentTypeIdentifier = typeIdentifierForActivityItem(attachmentItem);
-                    
-                    if (typeIdentifier) {
-                        NSItemProvider *attachmentProvider = [[NSItemProvider alloc] initWithItem:attachmentItem
-                                                                                   typeIdentifier:additionalAttachmentTypeIdentifier];
-                        [attachments addObject:attachmentProvider];
-                    }
-                }
-            }
-            
-            attachments;
-        });
+/*
+ Everything that goes into the extension item’s attachments and content text, before it’s compacted.
+ */
+- (XExtensionItemPayload *)payloadForActivityType:(NSString *)activityType snapshot:(XExtensionItemSourceSnapshot *)snapshot userInfo:(NSDictionary *)userInfo {
+    id mainItem = self.streamingAttachment ?: [self activityItemForActivityType:activityType];
+    
+    NSArray *additionalAttachments = deduplicatedAttachments(valueForActivityType(snapshot.additionalAttachmentsByActivityType, activityType),
+                                                             mainItem, snapshot.attachmentDeduplication);
+    
+    NSAttributedString *attributedContentText = valueForActivityType(snapshot.attributedContentTextByActivityType, activityType)
+        ?: valueForActivityType(snapshot.sharedParameters.attributedContentTextByActivityType, activityType);
+    
+    return [[XExtensionItemPayload alloc] initWithActivityType:activityType
+                                                      mainItem:mainItem
+                                                typeIdentifier:[self typeIdentifierForMainItem:mainItem]
+                                         additionalAttachments:additionalAttachments
+                                         attributedContentText:attributedContentText
+                                                      userInfo:userInfo];
+}
+
+- (void)compactPayload:(XExtensionItemPayload *)payload snapshot:(XExtensionItemSourceSnapshot *)snapshot {
+    NSUInteger byteBudget = [valueForActivityType(snapshot.payloadByteBudgetsByActivityType, payload.activityType) unsignedIntegerValue];
+    
+    if (byteBudget == 0) {
+        return;
+    }
+    
+    XExtensionItemPayloadCompactionReport *report = [payload compactToByteBudget:byteBudget steps:snapshot.payloadCompactionSteps];
+    XExtensionItemPayloadCompactionHandler compactionHandler = snapshot.payloadCompactionHandler;
+    
+    if (report && compactionHandler) {
+        compactionHandler(report);
+    }
+}
+
+- (NSString *)typeIdentifierForMainItem:(id)activityItem {
+    if ([activityItem isKindOfClass:[XExtensionItemStreamingAttachment class]]) {
+        return ((XExtensionItemStreamingAttachment *)activityItem).typeIdentifier;
+    }
+    
+    BOOL classHasChanged = ![activityItem isKindOfClass:[self.placeholderItem class]];
+    
+    // Always re-check the type of URL objects, because they could be either file or regular URLs
+    BOOL isURL = [activityItem isKindOfClass:[NSURL class]];
+    
+    if (classHasChanged || isURL) {
+        NSString *derivedTypeIdentifier = typeIdentifierForActivityItem(activityItem);
         
-        item.attributedContentText = [self attributedContentTextForActivityType:activityType];
+        if (derivedTypeIdentifier) {
+            return derivedTypeIdentifier;
+        }
+    }
+    
+    return self.typeIdentifier;
+}
+
+- (NSItemProvider *)mainAttachmentForActivityItem:(id)activityItem typeIdentifier:(NSString *)typeIdentifier {
+    if ([activityItem isKindOfClass:[XExtensionItemStreamingAttachment class]]) {
+        // Registered as a file representation, so nothing is read or spooled until the extension loads it
+        return ((XExtensionItemStreamingAttachment *)activityItem).itemProvider;
+    }
+    
+    return [[NSItemProvider alloc] initWithItem:activityItem typeIdentifier:typeIdentifier];
+}
+
+- (NSDictionary *)extensionItemUserInfoFromSnapshot:(XExtensionItemSourceSnapshot *)snapshot {
+    /*
+     The user info dictionary doesn’t vary by activity type, so it’s built once and shared by every cached extension item
+     until one of its inputs changes.
+     */
+    NSDictionary *extensionItemUserInfo = snapshot.extensionItemUserInfo;
+    
+    if (!extensionItemUserInfo) {
+        XExtensionItemSharedParameters *sharedParameters = snapshot.sharedParameters;
         
-        if (self.title) {
-            item.attributedTitle = [[NSAttributedString alloc] initWithString:self.title];
+        if (sharedParameters && !overridesSharedParameters(snapshot)) {
+            // Nothing differs from the rest of the group, so every such item source can share a single dictionary
+            extensionItemUserInfo = sharedParameters.extensionItemUserInfo;
+            
+            if (!extensionItemUserInfo) {
+                extensionItemUserInfo = [self buildExtensionItemUserInfoFromSnapshot:snapshot];
+                sharedParameters.extensionItemUserInfo = extensionItemUserInfo;
+            }
+        }
+        else {
+            extensionItemUserInfo = [self buildExtensionItemUserInfoFromSnapshot:snapshot];
         }
         
-        return item;
-    }
-    else {
-        return [self activityItemForActivityType:activityType];
+        snapshot.extensionItemUserInfo = extensionItemUserInfo;
     }
+    
+    return extensionItemUserInfo;
 }
 
-#pragma mark - Private
+- (NSDictionary *)buildExtensionItemUserInfoFromSnapshot:(XExtensionItemSourceSnapshot *)snapshot {
+    XExtensionItemSharedParameters *sharedParameters = snapshot.sharedParameters;
+    
+    NSMutableDictionary *mutableUserInfo = [[NSMutableDictionary alloc] init];
+    [mutableUserInfo addEntriesFromDictionary:sharedParameters.customParameters];
+    [mutableUserInfo addEntriesFromDictionary:snapshot.customParameters];
+    
+    if (snapshot.parameterCollisionHandler) {
+        NSArray *collidingKeys = collidingKeysInDictionary(snapshot.userInfo, mutableUserInfo);
+        
+        if (collidingKeys.count > 0) {
+            snapshot.parameterCollisionHandler(collidingKeys);
+        }
+    }
+    
+    [mutableUserInfo addEntriesFromDictionary:snapshot.userInfo];
+    
+    NSMutableDictionary *mutableParameters = [[NSMutableDictionary alloc] init];
+    [mutableParameters setValue:snapshot.tags ?: sharedParameters.tags forKey:ParameterKeyTags];
+    [mutableParameters setValue:snapshot.sourceURL forKey:ParameterKeySourceURL];
+    [mutableParameters addEntriesFromDictionary:(snapshot.referrer ?: sharedParameters.referrer).dictionaryRepresentation];
+    
+    if (mutableParameters.count > 0) {
+        mutableUserInfo[ParameterKeyXExtensionItem] = [mutableParameters copy];
+    }
+    
+    if (snapshot.parameterEncoding != XExtensionItemParameterEncodingDictionary) {
+        NSArray *unencodableKeys;
+        NSData *binaryParameters = [XExtensionItemBinaryCoder dataWithDictionary:mutableUserInfo unencodableKeys:&unencodableKeys];
+        
+        if (binaryParameters) {
+            if (snapshot.parameterEncoding == XExtensionItemParameterEncodingBinary) {
+                NSMutableArray *encodedKeys = [mutableUserInfo.allKeys mutableCopy];
+                [encodedKeys removeObjectsInArray:unencodableKeys];
+                [mutableUserInfo removeObjectsForKeys:encodedKeys];
+            }
+            
+            mutableUserInfo[ParameterKeyXExtensionItemBinary] = binaryParameters;
+        }
+    }
+    
+    return [mutableUserInfo copy];
+}
 
 - (id)activityItemForActivityType:(NSString *)activityType {
-    if (self.activityItemBlock) {
-        return self.activityItemBlock(activityType);
+    if (self.streamingAttachment) {
+        /*
+         Activities that don’t accept extension items get the file itself once it has been spooled, e.g. by preparation.
+         Until then they get an item provider that spools it when loaded, since spooling here would copy the entire
+         stream on the main thread.
+         */
+        XExtensionItemStreamingAttachment *streamingAttachment = self.streamingAttachment;
+        
+        return streamingAttachment.isSpooled ? streamingAttachment.fileURL : streamingAttachment.itemProvider;
+    }
+    else if (self.asynchronousItemLoader) {
+        return [self.asynchronousItemLoader itemWaitingForTimeout:self.asynchronousItemTimeout] ?: self.placeholderItem;
+    }
+    else if (self.activityItemBlock) {
+        uint64_t span = metricsBeginSpan(XExtensionItemMetricsSpanActivityItemBlock);
+        id activityItem = self.activityItemBlock(activityType);
+        metricsEndSpan(XExtensionItemMetricsSpanActivityItemBlock, span);
+        
+        return activityItem;
     }
     else {
         return self.placeholderItem;
     }
 }
 
-- (NSAttributedString *)attributedContentTextForActivityType:(NSString *)activityType {
+- (NSArray *)additionalAttachmentsForActivityType:(NSString *)activityType {
+    return valueForActivityType(self.snapshot.additionalAttachmentsByActivityType, activityType);
+}
+
+/*
+ Returns a copy of an extension item, which may be cached and handed to other activities, with a trace added to its user 
+ info.
+ */
+- (NSExtensionItem *)tracedExtensionItem:(NSExtensionItem *)extensionItem activityType:(NSString *)activityType {
+    XExtensionItemTrace *trace = [[XExtensionItemTrace alloc] init];
+    trace.correlationIdentifier = self.traceCorrelationIdentifier;
+    trace.activityType = activityType;
+    trace.sheetOpenTime = self.sheetOpenTime;
+    
+    @synchronized (self.itemBuildTimes) {
+        trace.itemBuiltTime = [[self.itemBuildTimes objectForKey:extensionItem] doubleValue];
+    }
+    
+    trace.providerDoneTime = traceCurrentTime();
+    
+    NSMutableDictionary *userInfo = [extensionItem.userInfo mutableCopy];
+    userInfo[ParameterKeyXExtensionItemTrace] = trace.dictionaryRepresentation;
+    
+    // The title, content text, and attachments are stored in `userInfo`, so they’re copied along with it
+    NSExtensionItem *tracedExtensionItem = [[NSExtensionItem alloc] init];
+    tracedExtensionItem.userInfo = userInfo;
+    
+    return tracedExtensionItem;
+}
+
+/*
+ Value set for the given activity type, falling back to the value set for all activity types.
+ */
+static id valueForActivityType(NSDictionary *valuesByActivityType, NSString *activityType) {
     if (activityType) {
-        NSAttributedString *contentTextForActivity = self.attributedContentTextByActivityType[activityType];
+        id valueForActivity = valuesByActivityType[activityType];
         
-        if (contentTextForActivity) {
-            return contentTextForActivity;
+        if (valueForActivity) {
+            return valueForActivity;
         }
     }
     
-    return self.attributedContentTextByActivityType[ActivityTypeCatchAll];
+    return valuesByActivityType[ActivityTypeCatchAll];
 }
 
-- (NSArray *)additionalAttachmentsForActivityType:(NSString *)activityType {
-    if (activityType) {
-        NSArray *attachmentsForActivity = self.additionalAttachmentsByActivityType[activityType];
+static NSArray *defaultPayloadCompactionSteps(void) {
+    return @[[[XExtensionItemDropAttachmentsCompactionStep alloc] init], [[XExtensionItemTruncateTextCompactionStep alloc] init]];
+}
+
+/*
+ Additional attachments without those that duplicate the main item or an earlier additional attachment.
+ */
+static NSArray *deduplicatedAttachments(NSArray *attachments, id mainItem, XExtensionItemAttachmentDeduplication options) {
+    if (attachments.count == 0 || options == XExtensionItemAttachmentDeduplicationNone) {
+        return attachments;
+    }
+    
+    NSArray *candidates = mainItem ? [@[mainItem] arrayByAddingObjectsFromArray:attachments] : attachments;
+    NSUInteger offset = candidates.count - attachments.count;
+    
+    NSIndexSet *duplicateIndexes = [[XExtensionItemAttachmentDeduplicator sharedDeduplicator] indexesOfDuplicatesInAttachments:candidates options:options];
+    
+    if (duplicateIndexes.count == 0) {
+        return attachments;
+    }
+    
+    NSMutableArray *uniqueAttachments = [[NSMutableArray alloc] init];
+    
+    [attachments enumerateObjectsUsingBlock:^(id attachment, NSUInteger index, BOOL *stop) {
+        if (![duplicateIndexes containsIndex:index + offset]) {
+            [uniqueAttachments addObject:attachment];
+        }
+    }];
+    
+    return [uniqueAttachments copy];
+}
+
+static BOOL overridesSharedParameters(XExtensionItemSourceSnapshot *snapshot) {
+    return snapshot.tags || snapshot.sourceURL || snapshot.referrer || snapshot.userInfo.count > 0 || snapshot.customParameters.count > 0
+        || snapshot.parameterEncoding != XExtensionItemParameterEncodingDictionary;
+}
+
+static void invalidateExtensionItemsForActivityType(XExtensionItemSourceSnapshot *snapshot, NSString *activityType) {
+    if (activityType && ![activityType isEqualToString:ActivityTypeCatchAll]) {
+        [snapshot removeCachedExtensionItemForActivityType:activityType];
+    }
+    else {
+        // Catch-all values can be used by any activity type
+        [snapshot removeAllCachedExtensionItems];
+    }
+}
+
+static void invalidateExtensionItemUserInfo(XExtensionItemSourceSnapshot *snapshot) {
+    snapshot.extensionItemUserInfo = nil;
+    invalidateExtensionItemsForActivityType(snapshot, nil);
+}
+
+/*
+ Keys of `dictionary` that would overwrite values in `existingDictionary`, or that are reserved for this library’s 
+ internal use.
+ */
+static NSArray *collidingKeysInDictionary(NSDictionary *dictionary, NSDictionary *existingDictionary) {
+    NSMutableArray *collidingKeys = [[NSMutableArray alloc] init];
+    
+    for (id key in dictionary) {
+        BOOL isReservedKey = [key isKindOfClass:[NSString class]] && [key hasPrefix:ParameterKeyXExtensionItem];
         
-        if (attachmentsForActivity) {
-            return attachmentsForActivity;
+        if (existingDictionary[key] || isReservedKey) {
+            [collidingKeys addObject:key];
         }
     }
     
-    return self.additionalAttachmentsByActivityType[ActivityTypeCatchAll];
+    return [collidingKeys copy];
 }
 
 static NSString *typeIdentifierForActivityItem(id item) {
@@ -293,9 +988,7 @@ static NSString *typeIdentifierForActivityItem(id item) {
         NSURL *URL = (NSURL *)item;
         
         if (URL.isFileURL) {
-            NSString *typeIdentifier = nil;
-            [item getResourceValue:&typeIdentifier forKey:NSURLTypeIdentifierKey error:nil];
-            return typeIdentifier;
+            return [[XExtensionItemTypeIdentifierCache sharedCache] typeIdentifierForFileURL:URL];
         }
         
         return (NSString *)kUTTypeURL;
@@ -311,49 +1004,12 @@ static NSString *typeIdentifierForActivityItem(id item) {
     }
 }
 
-static BOOL isExtensionItemInputAcceptedByActivityType(NSString *activityType) {
+static BOOL isExtensionItemInputAcceptedByActivityType(NSString *activityType, XExtensionItemActivityRoutingTable *routingTable) {
     if (![NSExtensionItem class])
         return NO;
     
-    NSSet *unacceptingTypes = [[NSSet alloc] initWithArray:@[
-                                                             UIActivityTypeMessage,
-                                                             UIActivityTypeMail,
-                                                             UIActivityTypePrint,
-                                                             UIActivityTypeCopyToPasteboard,
-                                                             UIActivityTypeAssignToContact,
-                                                             UIActivityTypeSaveToCameraRoll,
-                                                             UIActivityTypeAddToReadingList,
-                                                             UIActivityTypeAirDrop,
-                                                             ]];
-    
-    /*
-     The following activities are capable of taking `NSExtensionItem` instances as input. They display system share 
-     sheets that consume the extension item’s `attributedContentText` value.
-     */
-    NSSet *acceptingTypes = [[NSSet alloc] initWithArray:@[
-                                                           UIActivityTypePostToTwitter,
-                                                           UIActivityTypePostToVimeo,
-                                                           UIActivityTypePostToWeibo,
-                                                           UIActivityTypePostToTencentWeibo,
-                                                           
-                                                           /*
-                                                            If the official Facebook or Flickr apps are installed, they 
-                                                            take precedent over the system sheets and do *not* consume 
-                                                            `attributedContentText`.
-                                                            */
-                                                           UIActivityTypePostToFacebook,
-                                                           UIActivityTypePostToFlickr,
-                                                           ]];
-    
-    if ([unacceptingTypes containsObject:activityType]) {
-        return NO;
-    }
-    else if ([acceptingTypes containsObject:activityType]) {
-        return YES;
-    }
-    else {
-        return YES;
-    }
+    // Activities that the table doesn’t know about (e.g. third-party share extensions) are assumed to accept extension items
+    return [routingTable routeForActivityType:activityType] != XExtensionItemActivityRouteRawItem;
 }
 
 @end
@@ -408,6 +1064,24 @@ static BOOL isExtensionItemInputAcceptedByActivityType(NSString *activityType) {
 
 @property (nonatomic) NSExtensionItem *extensionItem;
 @property (nonatomic) NSExtensionItem *item;
+@property (nonatomic, copy) XExtensionItemDecodingLimits *decodingLimits;
+@property (nonatomic) NSMutableArray *mutableDecodingIssues;
+
+@property (nonatomic, copy) NSDictionary *userInfo;
+@property (nonatomic, copy) NSArray *tags;
+@property (nonatomic, copy) NSURL *sourceURL;
+@property (nonatomic) XExtensionItemReferrer *referrer;
+
+@property (nonatomic, getter=isUserInfoDecoded) BOOL userInfoDecoded;
+@property (nonatomic, getter=areParametersDecoded) BOOL parametersDecoded;
+@property (nonatomic) NSMapTable *customParametersByClass;
+@property (nonatomic, copy) NSDictionary *userInfoByKeyNamespace;
+@property (nonatomic) NSUInteger userInfoPartitionGeneration;
+
+@property (nonatomic) NSTimeInterval receiveTime;
+@property (nonatomic) NSTimeInterval attachmentsLoadedTime;
+@property (nonatomic) XExtensionItemTrace *trace;
+@property (nonatomic, getter=isTraceDecoded) BOOL traceDecoded;
 
 @end
 
@@ -415,28 +1089,342 @@ static BOOL isExtensionItemInputAcceptedByActivityType(NSString *activityType) {
 
 #pragma mark - Initialization
 
-- (instancetype)initWithExtensionItem:(NSExtensionItem *)extensionItem {
+- (instancetype)initWithExtensionItem:(NSExtensionItem *)extensionItem decodingLimits:(XExtensionItemDecodingLimits *)decodingLimits {
     NSParameterAssert(extensionItem);
     
     self = [super init];
     if (self) {
+        // Nothing is decoded until it’s first read, since many extensions only need the attachments and title
         _extensionItem = extensionItem;
+        _decodingLimits = [decodingLimits copy] ?: [XExtensionItemDecodingLimits defaultLimits];
+        _mutableDecodingIssues = [[NSMutableArray alloc] init];
+        _customParametersByClass = [NSMapTable strongToStrongObjectsMapTable];
         
-        NSDictionary *dictionary = [[[XExtensionItemTypeSafeDictionaryValues alloc] initWithDictionary:extensionItem.userInfo]
-                                    dictionaryForKey:ParameterKeyXExtensionItem];
-        
-        XExtensionItemTypeSafeDictionaryValues *dictionaryValues = [[XExtensionItemTypeSafeDictionaryValues alloc] initWithDictionary:dictionary];
-        
-        _tags = [[dictionaryValues arrayForKey:ParameterKeyTags] copy];
-        _sourceURL = [[dictionaryValues URLForKey:ParameterKeySourceURL] copy];
-        _referrer = [[XExtensionItemReferrer alloc] initWithDictionary:dictionary];
+        // Recorded now, since the trace itself isn’t decoded until it’s read
+        _receiveTime = traceCurrentTime();
     }
     
     return self;
 }
 
+- (instancetype)initWithExtensionItem:(NSExtensionItem *)extensionItem {
+    return [self initWithExtensionItem:extensionItem decodingLimits:nil];
+}
+
 - (instancetype)init {
-    return [self initWithExtensionItem:nil];
+    return [self initWithExtensionItem:nil decodingLimits:nil];
+}
+
+#pragma mark - XExtensionItem
+
+- (NSDictionary *)userInfo {
+    @synchronized (self) {
+        if (!self.userInfoDecoded) {
+            uint64_t span = metricsBeginSpan(XExtensionItemMetricsSpanDecoding);
+            NSDictionary *userInfo = [self userInfoDecodingBinaryParameters:self.extensionItem.userInfo];
+            _userInfo = [self.decodingLimits boundedUserInfo:userInfo issues:self.mutableDecodingIssues];
+            metricsEndSpan(XExtensionItemMetricsSpanDecoding, span);
+            
+            if (metricsEnabled()) {
+                metricsRecordCounter(XExtensionItemMetricsCounterPayloadKeyCount, (int64_t)self.extensionItem.userInfo.count);
+                metricsRecordCounter(XExtensionItemMetricsCounterAttachmentCount, (int64_t)self.extensionItem.attachments.count);
+            }
+            
+            self.userInfoDecoded = YES;
+        }
+        
+        return _userInfo;
+    }
+}
+
+- (NSArray *)tags {
+    @synchronized (self) {
+        [self decodeParametersIfNeeded];
+        return _tags;
+    }
+}
+
+- (NSURL *)sourceURL {
+    @synchronized (self) {
+        [self decodeParametersIfNeeded];
+        return _sourceURL;
+    }
+}
+
+- (XExtensionItemReferrer *)referrer {
+    @synchronized (self) {
+        [self decodeParametersIfNeeded];
+        return _referrer;
+    }
+}
+
+- (NSArray *)decodingIssues {
+    @synchronized (self) {
+        [self decodeParametersIfNeeded];
+        return [self.mutableDecodingIssues copy];
+    }
+}
+
+- (XExtensionItemTrace *)trace {
+    @synchronized (self) {
+        if (!self.traceDecoded) {
+            _trace = [[XExtensionItemTrace alloc] initWithDictionary:valueOfClass(self.userInfo[ParameterKeyXExtensionItemTrace], [NSDictionary class])];
+            _trace.receiveTime = self.receiveTime;
+            _trace.attachmentsLoadedTime = self.attachmentsLoadedTime;
+            self.traceDecoded = YES;
+        }
+        
+        return _trace;
+    }
+}
+
+- (id)customParametersOfClass:(Class)customParametersClass {
+    NSParameterAssert([customParametersClass conformsToProtocol:@protocol(XExtensionItemCustomParameters)]);
+    
+    @synchronized (self) {
+        id customParameters = [self.customParametersByClass objectForKey:customParametersClass];
+        
+        if (!customParameters) {
+            NSDictionary *dictionary = [self userInfoForCustomParametersClass:customParametersClass];
+            
+            uint64_t span = metricsBeginSpan(XExtensionItemMetricsSpanDecoding);
+            customParameters = [[customParametersClass alloc] initWithDictionary:dictionary];
+            metricsEndSpan(XExtensionItemMetricsSpanDecoding, span);
+            
+            if (customParameters) {
+                [self.customParametersByClass setObject:customParameters forKey:customParametersClass];
+            }
+        }
+        
+        return customParameters;
+    }
+}
+
+#pragma mark - Decoding
+
+/*
+ The slice of `userInfo` in the class’s registered key namespace, or all of `userInfo` if the class doesn’t have one. 
+ `userInfo` is partitioned by every registered namespace at once, and only partitioned again if another namespace has 
+ been registered since. Must be called while synchronized on `self`.
+ */
+- (NSDictionary *)userInfoForCustomParametersClass:(Class)customParametersClass {
+    XExtensionItemCustomParametersRegistry *registry = [XExtensionItemCustomParametersRegistry defaultRegistry];
+    NSString *keyNamespace = [registry keyNamespaceForClass:customParametersClass];
+    
+    if (!keyNamespace) {
+        return self.userInfo;
+    }
+    
+    if (!self.userInfoByKeyNamespace || self.userInfoPartitionGeneration != registry.generation) {
+        self.userInfoPartitionGeneration = registry.generation;
+        self.userInfoByKeyNamespace = [registry partitionDictionary:self.userInfo];
+    }
+    
+    return self.userInfoByKeyNamespace[keyNamespace] ?: @{};
+}
+
+/*
+ Must be called while synchronized on `self`.
+ */
+- (void)decodeParametersIfNeeded {
+    if (!self.parametersDecoded) {
+        NSDictionary *userInfo = self.userInfo;
+        
+        uint64_t span = metricsBeginSpan(XExtensionItemMetricsSpanDecoding);
+        [self decodeParameters:userInfo[ParameterKeyXExtensionItem]];
+        metricsEndSpan(XExtensionItemMetricsSpanDecoding, span);
+        
+        self.parametersDecoded = YES;
+    }
+}
+
+typedef NS_ENUM(NSUInteger, ParameterField) {
+    ParameterFieldTags = 1,
+    ParameterFieldSourceURL,
+    ParameterFieldReferrerName,
+    ParameterFieldReferrerAppStoreID,
+    ParameterFieldReferrerGooglePlayID,
+    ParameterFieldReferrerWebURL,
+    ParameterFieldReferreriOSAppURL,
+    ParameterFieldReferrerAndroidAppURL,
+};
+
+/*
+ Reads every value out of the `x-extension-item` dictionary in a single enumeration, without wrapping or copying the 
+ (already immutable) incoming dictionary. Values of unexpected types are ignored.
+ */
+- (void)decodeParameters:(id)parameters {
+    static NSDictionary *fieldsByKey;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        fieldsByKey = @{
+            ParameterKeyTags: @(ParameterFieldTags),
+            ParameterKeySourceURL: @(ParameterFieldSourceURL),
+            ParameterKeyReferrerName: @(ParameterFieldReferrerName),
+            ParameterKeyReferrerAppStoreID: @(ParameterFieldReferrerAppStoreID),
+            ParameterKeyReferrerGooglePlayID: @(ParameterFieldReferrerGooglePlayID),
+            ParameterKeyReferrerWebURL: @(ParameterFieldReferrerWebURL),
+            ParameterKeyReferreriOSAppURL: @(ParameterFieldReferreriOSAppURL),
+            ParameterKeyReferrerAndroidAppURL: @(ParameterFieldReferrerAndroidAppURL),
+        };
+    });
+    
+    __block NSArray *tags;
+    __block NSURL *sourceURL;
+    __block NSString *referrerName, *referrerAppStoreID, *referrerGooglePlayID;
+    __block NSURL *referrerWebURL, *referreriOSAppURL, *referrerAndroidAppURL;
+    
+    if ([parameters isKindOfClass:[NSDictionary class]]) {
+        [(NSDictionary *)parameters enumerateKeysAndObjectsUsingBlock:^(id key, id value, BOOL *stop) {
+            switch ((ParameterField)[fieldsByKey[key] unsignedIntegerValue]) {
+                case ParameterFieldTags:
+                    tags = valueOfClass(value, [NSArray class]);
+                    break;
+                case ParameterFieldSourceURL:
+                    sourceURL = valueOfClass(value, [NSURL class]);
+                    break;
+                case ParameterFieldReferrerName:
+                    referrerName = valueOfClass(value, [NSString class]);
+                    break;
+                case ParameterFieldReferrerAppStoreID:
+                    referrerAppStoreID = valueOfClass(value, [NSString class]);
+                    break;
+                case ParameterFieldReferrerGooglePlayID:
+                    referrerGooglePlayID = valueOfClass(value, [NSString class]);
+                    break;
+                case ParameterFieldReferrerWebURL:
+                    referrerWebURL = valueOfClass(value, [NSURL class]);
+                    break;
+                case ParameterFieldReferreriOSAppURL:
+                    referreriOSAppURL = valueOfClass(value, [NSURL class]);
+                    break;
+                case ParameterFieldReferrerAndroidAppURL:
+                    referrerAndroidAppURL = valueOfClass(value, [NSURL class]);
+                    break;
+                default:
+                    // Unknown key, most likely written by a newer version of this library
+                    break;
+            }
+        }];
+    }
+    
+    _tags = [[self.decodingLimits boundedTags:tags
+                                      keyPath:[@[ParameterKeyXExtensionItem, ParameterKeyTags] componentsJoinedByString:@"."]
+                                       issues:self.mutableDecodingIssues] copy];
+    _sourceURL = [sourceURL copy];
+    _referrer = [[XExtensionItemReferrer alloc] initWithAppName:referrerName
+                                                     appStoreID:referrerAppStoreID
+                                                   googlePlayID:referrerGooglePlayID
+                                                         webURL:referrerWebURL
+                                                      iOSAppURL:referreriOSAppURL
+                                                  androidAppURL:referrerAndroidAppURL];
+}
+
+/*
+ If the item carries the binary encoding of its parameters, returns the user info with the binary entry replaced by the
+ entries it decodes to. Otherwise (including when the binary entry was written by an unsupported format version, or is 
+ too large to decode) returns the user info as-is, so that the plain dictionary entries are used.
+ */
+- (NSDictionary *)userInfoDecodingBinaryParameters:(NSDictionary *)userInfo {
+    id binaryParameters = userInfo[ParameterKeyXExtensionItemBinary];
+    
+    if (![binaryParameters isKindOfClass:[NSData class]]) {
+        return userInfo;
+    }
+    
+    if (![self.decodingLimits acceptsBinaryParametersOfLength:((NSData *)binaryParameters).length
+                                                      keyPath:ParameterKeyXExtensionItemBinary
+                                                       issues:self.mutableDecodingIssues]) {
+        return userInfo;
+    }
+    
+    NSDictionary *decodedParameters = [XExtensionItemBinaryCoder dictionaryWithData:binaryParameters];
+    
+    if (!decodedParameters) {
+        return userInfo;
+    }
+    
+    NSMutableDictionary *mutableUserInfo = [userInfo mutableCopy];
+    [mutableUserInfo removeObjectForKey:ParameterKeyXExtensionItemBinary];
+    [mutableUserInfo addEntriesFromDictionary:decodedParameters];
+    return [mutableUserInfo copy];
+}
+
+static id valueOfClass(id value, Class class) {
+    return [value isKindOfClass:class] ? value : nil;
+}
+
+#pragma mark - Loading attachments
+
+- (XExtensionItemAttachmentLoader *)loadAttachmentsWithPreferredTypeIdentifiers:(NSArray *)preferredTypeIdentifiers
+                                                                  resultHandler:(XExtensionItemAttachmentLoadResultHandler)resultHandler
+                                                              completionHandler:(XExtensionItemAttachmentLoadCompletionHandler)completionHandler {
+    XExtensionItemAttachmentLoader *loader = [[XExtensionItemAttachmentLoader alloc] initWithItemProviders:self.attachments ?: @[]
+                                                                                  preferredTypeIdentifiers:preferredTypeIdentifiers];
+    [loader loadWithResultHandler:resultHandler completionHandler:^(NSArray *results, NSTimeInterval duration) {
+        [self recordAttachmentsLoaded];
+        
+        if (completionHandler) {
+            completionHandler(results, duration);
+        }
+    }];
+    
+    return loader;
+}
+
+- (void)recordAttachmentsLoaded {
+    @synchronized (self) {
+        if (self.attachmentsLoadedTime == 0) {
+            self.attachmentsLoadedTime = traceCurrentTime();
+            _trace.attachmentsLoadedTime = self.attachmentsLoadedTime;
+        }
+    }
+}
+
+#pragma mark - Streaming attachments
+
+- (BOOL)loadInputStreamForTypeIdentifier:(NSString *)typeIdentifier
+                       completionHandler:(void (^)(NSInputStream *inputStream, NSError *error))completionHandler {
+    NSParameterAssert(typeIdentifier);
+    NSParameterAssert(completionHandler);
+    
+    for (NSItemProvider *itemProvider in self.attachments) {
+        if (![itemProvider hasItemConformingToTypeIdentifier:typeIdentifier]) {
+            continue;
+        }
+        
+        uint64_t span = metricsBeginSpan(XExtensionItemMetricsSpanAttachmentLoad);
+        
+        [itemProvider loadFileRepresentationForTypeIdentifier:typeIdentifier completionHandler:^(NSURL *fileURL, NSError *error) {
+            metricsEndSpan(XExtensionItemMetricsSpanAttachmentLoad, span);
+            
+            NSInputStream *inputStream = nil;
+            
+            if (fileURL) {
+                /*
+                 The file is deleted as soon as this block returns, but a stream that has already been opened keeps its
+                 contents readable until it’s closed.
+                 */
+                inputStream = [[NSInputStream alloc] initWithURL:fileURL];
+                [inputStream open];
+                
+                if (inputStream.streamStatus == NSStreamStatusError) {
+                    error = inputStream.streamError;
+                    inputStream = nil;
+                }
+            }
+            
+            if (inputStream) {
+                [self recordAttachmentsLoaded];
+            }
+            
+            completionHandler(inputStream, error);
+        }];
+        
+        return YES;
+    }
+    
+    return NO;
 }
 
 #pragma mark - Proxied NSExtensionItem getters
@@ -453,10 +1441,6 @@ static BOOL isExtensionItemInputAcceptedByActivityType(NSString *activityType) {
     return self.extensionItem.attributedContentText;
 }
 
-- (NSDictionary *)userInfo {
-    return self.extensionItem.userInfo;
-}
-
 #pragma mark - NSObject
 
 - (NSString *)description {
@@ -493,6 +1477,8 @@ static BOOL isExtensionItemInputAcceptedByActivityType(NSString *activityType) {
             
             // Remove values used internally by this class
             [mutableUserInfo removeObjectForKey:ParameterKeyXExtensionItem];
+            [mutableUserInfo removeObjectForKey:ParameterKeyXExtensionItemBinary];
+            [mutableUserInfo removeObjectForKey:ParameterKeyXExtensionItemTrace];
             
             [mutableUserInfo copy];
         })];
@@ -0,0 +1,99 @@
+#import "XExtensionItemActivityRoutingTable.h"
+#import <UIKit/UIKit.h>
+
+@interface XExtensionItemActivityRoutingTable ()
+
+@property (nonatomic, copy) NSDictionary *routes;
+
+@end
+
+@implementation XExtensionItemActivityRoutingTable
+
+#pragma mark - Initialization
+
++ (instancetype)defaultTable {
+    static XExtensionItemActivityRoutingTable *defaultTable;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSNumber *rawItem = @(XExtensionItemActivityRouteRawItem);
+        NSNumber *extensionItem = @(XExtensionItemActivityRouteExtensionItem);
+
+        defaultTable = [[self alloc] initWithRoutes:@{
+            UIActivityTypeMessage: rawItem,
+            UIActivityTypeMail: rawItem,
+            UIActivityTypePrint: rawItem,
+            UIActivityTypeCopyToPasteboard: rawItem,
+            UIActivityTypeAssignToContact: rawItem,
+            UIActivityTypeSaveToCameraRoll: rawItem,
+            UIActivityTypeAddToReadingList: rawItem,
+            UIActivityTypeAirDrop: rawItem,
+
+            /*
+             The following activities are capable of taking `NSExtensionItem` instances as input. They display system
+             share sheets that consume the extension item’s `attributedContentText` value.
+             */
+            UIActivityTypePostToTwitter: extensionItem,
+            UIActivityTypePostToVimeo: extensionItem,
+            UIActivityTypePostToWeibo: extensionItem,
+            UIActivityTypePostToTencentWeibo: extensionItem,
+
+            /*
+             If the official Facebook or Flickr apps are installed, they take precedent over the system sheets and do
+             *not* consume `attributedContentText`.
+             */
+            UIActivityTypePostToFacebook: extensionItem,
+            UIActivityTypePostToFlickr: extensionItem,
+        }];
+    });
+
+    return defaultTable;
+}
+
+- (instancetype)initWithRoutes:(NSDictionary *)routes {
+    self = [super init];
+    if (self) {
+        _routes = [routes copy] ?: @{};
+    }
+
+    return self;
+}
+
+- (instancetype)init {
+    return [self initWithRoutes:nil];
+}
+
+#pragma mark - XExtensionItemActivityRoutingTable
+
+- (XExtensionItemActivityRoute)routeForActivityType:(NSString *)activityType {
+    if (!activityType) {
+        return XExtensionItemActivityRouteUnknown;
+    }
+
+    NSNumber *route = self.routes[activityType];
+
+    if (route) {
+        return (XExtensionItemActivityRoute)route.integerValue;
+    }
+    else {
+        return XExtensionItemActivityRouteUnknown;
+    }
+}
+
+- (instancetype)tableByAddingRoutes:(NSDictionary *)routes {
+    if (routes.count == 0) {
+        return self;
+    }
+
+    NSMutableDictionary *mutableRoutes = [self.routes mutableCopy];
+    [mutableRoutes addEntriesFromDictionary:routes];
+
+    return [[[self class] alloc] initWithRoutes:mutableRoutes];
+}
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"%@ { routes: %@ }", [super description], self.routes];
+}
+
+@end
@@ -0,0 +1,18 @@
+#import <UIKit/UIKit.h>
+
+/**
+ @return Classes that values archived by this library may be made of: attachments and content text (including its
+ attributes) in the handoff queue, and `userInfo` in corpus recordings. Used with `NSKeyedUnarchiver`’s secure decoding.
+ */
+static inline NSSet *archivedClasses(void) {
+    static NSSet *classes;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        classes = [NSSet setWithObjects:[NSString class], [NSAttributedString class], [NSURL class], [NSData class], [NSNumber class],
+                   [NSValue class], [NSDate class], [NSUUID class], [NSNull class], [NSArray class], [NSDictionary class],
+                   [NSSet class], [NSOrderedSet class], [UIImage class], [UIFont class], [UIColor class], [NSParagraphStyle class],
+                   nil];
+    });
+
+    return classes;
+}
@@ -0,0 +1,36 @@
+#import "XExtensionItem.h"
+
+/**
+ Drives an `XExtensionItemAsynchronousProvidingBlock` on a background queue and lets callers wait for its result with a
+ deadline. Used internally by `XExtensionItemSource`.
+ */
+@interface XExtensionItemAsynchronousItemLoader : NSObject
+
+- (instancetype)initWithBlock:(XExtensionItemAsynchronousProvidingBlock)block NS_DESIGNATED_INITIALIZER;
+
+/**
+ Whether the current load has produced an item.
+ */
+@property (nonatomic, readonly, getter=isFinished) BOOL finished;
+
+/**
+ Start loading the item on a background queue. Does nothing if a load is already in progress or has finished.
+ */
+- (void)start;
+
+/**
+ Cancel the current load, if any. The providing block is told that it’s been cancelled and its eventual result is
+ discarded. A subsequent call to `start` begins a fresh load.
+ */
+- (void)cancel;
+
+/**
+ Start loading if needed, then block the calling thread until the item is available or the timeout elapses.
+
+ @param timeout Maximum number of seconds to wait.
+
+ @return The loaded item, or `nil` if the load didn’t finish in time, was cancelled, or produced `nil`.
+ */
+- (id)itemWaitingForTimeout:(NSTimeInterval)timeout;
+
+@end
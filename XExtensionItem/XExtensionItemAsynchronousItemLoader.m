@@ -0,0 +1,158 @@
+#import "XExtensionItemAsynchronousItemLoader.h"
+
+/**
+ State for a single invocation of the providing block. A new load is created each time the loader is started after
+ having been cancelled, so that late completions from a cancelled load can’t leak into a subsequent one.
+ */
+@interface XExtensionItemAsynchronousLoad : NSObject
+
+@property (nonatomic, readonly) dispatch_group_t group;
+@property (atomic, readonly) id item;
+@property (atomic, readonly, getter=isFinished) BOOL finished;
+@property (atomic, readonly, getter=isCancelled) BOOL cancelled;
+
+- (void)finishWithItem:(id)item;
+
+- (void)cancel;
+
+@end
+
+@implementation XExtensionItemAsynchronousLoad
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _group = dispatch_group_create();
+        dispatch_group_enter(_group);
+    }
+
+    return self;
+}
+
+- (void)finishWithItem:(id)item {
+    @synchronized (self) {
+        // Providers may misbehave and call their completion block more than once; only the first call counts
+        if (_finished) {
+            return;
+        }
+
+        _item = item;
+        _finished = YES;
+    }
+
+    dispatch_group_leave(self.group);
+}
+
+- (void)cancel {
+    @synchronized (self) {
+        _cancelled = YES;
+
+        if (_finished) {
+            return;
+        }
+
+        // Wake up any waiters immediately rather than leaving them blocked until their timeout elapses
+        _finished = YES;
+    }
+
+    dispatch_group_leave(self.group);
+}
+
+@end
+
+@interface XExtensionItemAsynchronousItemLoader ()
+
+@property (nonatomic, copy) XExtensionItemAsynchronousProvidingBlock block;
+@property (nonatomic) XExtensionItemAsynchronousLoad *currentLoad;
+
+@end
+
+@implementation XExtensionItemAsynchronousItemLoader
+
+#pragma mark - Initialization
+
+- (instancetype)initWithBlock:(XExtensionItemAsynchronousProvidingBlock)block {
+    NSParameterAssert(block);
+
+    self = [super init];
+    if (self) {
+        _block = [block copy];
+    }
+
+    return self;
+}
+
+- (instancetype)init {
+    return [self initWithBlock:nil];
+}
+
+- (void)dealloc {
+    [_currentLoad cancel];
+}
+
+#pragma mark - XExtensionItemAsynchronousItemLoader
+
+- (BOOL)isFinished {
+    @synchronized (self) {
+        return self.currentLoad.isFinished;
+    }
+}
+
+- (void)start {
+    [self startIfNeeded];
+}
+
+- (void)cancel {
+    XExtensionItemAsynchronousLoad *load;
+
+    @synchronized (self) {
+        load = self.currentLoad;
+        self.currentLoad = nil;
+    }
+
+    [load cancel];
+}
+
+- (id)itemWaitingForTimeout:(NSTimeInterval)timeout {
+    XExtensionItemAsynchronousLoad *load = [self startIfNeeded];
+
+    if (!load.isFinished) {
+        dispatch_group_wait(load.group, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(MAX(timeout, 0) * NSEC_PER_SEC)));
+    }
+
+    if (load.isFinished && !load.isCancelled) {
+        return load.item;
+    }
+    else {
+        return nil;
+    }
+}
+
+#pragma mark - Private
+
+- (XExtensionItemAsynchronousLoad *)startIfNeeded {
+    XExtensionItemAsynchronousLoad *load;
+
+    @synchronized (self) {
+        if (self.currentLoad) {
+            return self.currentLoad;
+        }
+
+        load = [[XExtensionItemAsynchronousLoad alloc] init];
+        self.currentLoad = load;
+    }
+
+    XExtensionItemAsynchronousProvidingBlock block = self.block;
+
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        block(^(id item) {
+            [load finishWithItem:item];
+        }, ^BOOL{
+            return load.isCancelled;
+        });
+    });
+
+    return load;
+}
+
+@end
@@ -0,0 +1,297 @@
+#import "XExtensionItemAttachmentDeduplicator.h"
+#import "XExtensionItemInstrumentation.h"
+#import "XExtensionItemStreamingAttachment.h"
+#import <CommonCrypto/CommonDigest.h>
+#import <sys/stat.h>
+
+static unsigned long long const DefaultMaximumHashedByteCount = 64 * 1024 * 1024;
+static NSUInteger const FileHashCountLimit = 256;
+static NSUInteger const HashChunkLength = 1024 * 1024;
+
+@interface XExtensionItemAttachmentDeduplicator ()
+
+@property (nonatomic) NSMapTable *hashesByData;
+@property (nonatomic) NSCache *hashesByFileKey;
+
+@property (atomic) NSUInteger duplicateCount;
+@property (atomic) unsigned long long savedByteCount;
+@property (atomic) NSUInteger hashCount;
+
+@end
+
+@implementation XExtensionItemAttachmentDeduplicator
+
+#pragma mark - Initialization
+
++ (instancetype)sharedDeduplicator {
+    static XExtensionItemAttachmentDeduplicator *sharedDeduplicator;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedDeduplicator = [[self alloc] init];
+    });
+
+    return sharedDeduplicator;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _maximumHashedByteCount = DefaultMaximumHashedByteCount;
+
+        _hashesByData = [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsWeakMemory | NSPointerFunctionsObjectPointerPersonality
+                                                  valueOptions:NSPointerFunctionsStrongMemory
+                                                      capacity:0];
+
+        _hashesByFileKey = [[NSCache alloc] init];
+        _hashesByFileKey.countLimit = FileHashCountLimit;
+    }
+
+    return self;
+}
+
+#pragma mark - XExtensionItemAttachmentDeduplicator
+
+- (NSIndexSet *)indexesOfDuplicatesInAttachments:(NSArray *)attachments options:(XExtensionItemAttachmentDeduplication)options {
+    NSMutableIndexSet *duplicateIndexes = [[NSMutableIndexSet alloc] init];
+
+    if (attachments.count < 2 || options == XExtensionItemAttachmentDeduplicationNone) {
+        return duplicateIndexes;
+    }
+
+    NSMutableSet *seenKeys = [[NSMutableSet alloc] init];
+
+    [attachments enumerateObjectsUsingBlock:^(id attachment, NSUInteger index, BOOL *stop) {
+        NSArray *keys = [self keysForAttachment:attachment options:options];
+
+        for (id key in keys) {
+            if ([seenKeys containsObject:key]) {
+                [duplicateIndexes addIndex:index];
+                return;
+            }
+        }
+
+        [seenKeys addObjectsFromArray:keys];
+    }];
+
+    if (options & XExtensionItemAttachmentDeduplicationContentHash) {
+        [duplicateIndexes addIndexes:[self indexesOfDuplicateContentsInAttachments:attachments excludingIndexes:duplicateIndexes]];
+    }
+
+    if (duplicateIndexes.count > 0) {
+        __block unsigned long long savedByteCount = 0;
+
+        [duplicateIndexes enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+            savedByteCount += attachmentByteCount(attachments[index]);
+        }];
+
+        @synchronized (self) {
+            self.duplicateCount += duplicateIndexes.count;
+            self.savedByteCount += savedByteCount;
+        }
+
+        if (metricsEnabled()) {
+            metricsRecordCounter(XExtensionItemMetricsCounterDeduplicatedBytes, (int64_t)savedByteCount);
+        }
+    }
+
+    return duplicateIndexes;
+}
+
+- (void)removeAllHashes {
+    @synchronized (self.hashesByData) {
+        [self.hashesByData removeAllObjects];
+    }
+
+    [self.hashesByFileKey removeAllObjects];
+}
+
+#pragma mark - Private
+
+/*
+ Keys that are cheap to compute. An attachment is a duplicate if any of its keys were seen earlier.
+ */
+- (NSArray *)keysForAttachment:(id)attachment options:(XExtensionItemAttachmentDeduplication)options {
+    NSMutableArray *keys = [[NSMutableArray alloc] init];
+
+    if (options & XExtensionItemAttachmentDeduplicationIdentity) {
+        [keys addObject:[NSValue valueWithNonretainedObject:attachment]];
+    }
+
+    if (options & XExtensionItemAttachmentDeduplicationFilePath) {
+        NSURL *fileURL = attachmentFileURL(attachment);
+
+        if (fileURL) {
+            [keys addObject:fileURL.URLByStandardizingPath.path];
+        }
+    }
+
+    return keys;
+}
+
+/*
+ Only attachments that are the same size as another one can have the same contents, so attachments with a unique size
+ are never hashed.
+ */
+- (NSIndexSet *)indexesOfDuplicateContentsInAttachments:(NSArray *)attachments excludingIndexes:(NSIndexSet *)excludedIndexes {
+    NSMutableDictionary *indexesBySize = [[NSMutableDictionary alloc] init];
+    unsigned long long maximumHashedByteCount = self.maximumHashedByteCount;
+
+    [attachments enumerateObjectsUsingBlock:^(id attachment, NSUInteger index, BOOL *stop) {
+        if ([excludedIndexes containsIndex:index] || !([attachment isKindOfClass:[NSData class]] || attachmentFileURL(attachment))) {
+            return;
+        }
+
+        unsigned long long byteCount = attachmentByteCount(attachment);
+
+        if (byteCount > maximumHashedByteCount) {
+            return;
+        }
+
+        NSMutableIndexSet *indexes = indexesBySize[@(byteCount)] ?: [[NSMutableIndexSet alloc] init];
+        [indexes addIndex:index];
+        indexesBySize[@(byteCount)] = indexes;
+    }];
+
+    NSMutableIndexSet *duplicateIndexes = [[NSMutableIndexSet alloc] init];
+
+    for (NSIndexSet *indexes in indexesBySize.allValues) {
+        if (indexes.count < 2) {
+            continue;
+        }
+
+        NSMutableSet *seenHashes = [[NSMutableSet alloc] init];
+
+        [indexes enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+            NSData *hash = [self contentHashOfAttachment:attachments[index]];
+
+            if (!hash) {
+                return;
+            }
+
+            if ([seenHashes containsObject:hash]) {
+                [duplicateIndexes addIndex:index];
+            }
+            else {
+                [seenHashes addObject:hash];
+            }
+        }];
+    }
+
+    return duplicateIndexes;
+}
+
+- (NSData *)contentHashOfAttachment:(id)attachment {
+    if ([attachment isKindOfClass:[NSData class]]) {
+        // Mutable data can change after it’s been hashed, so its hash isn’t cached
+        BOOL cacheable = ![attachment isKindOfClass:[NSMutableData class]];
+
+        if (cacheable) {
+            @synchronized (self.hashesByData) {
+                NSData *hash = [self.hashesByData objectForKey:attachment];
+
+                if (hash) {
+                    return hash;
+                }
+            }
+        }
+
+        NSData *hash = [self hashOfData:attachment];
+
+        if (cacheable) {
+            @synchronized (self.hashesByData) {
+                [self.hashesByData setObject:hash forKey:attachment];
+            }
+        }
+
+        return hash;
+    }
+
+    NSURL *fileURL = attachmentFileURL(attachment);
+    NSString *fileKey = fileKeyForFileURL(fileURL);
+
+    if (!fileKey) {
+        return nil;
+    }
+
+    NSData *hash = [self.hashesByFileKey objectForKey:fileKey];
+
+    if (!hash) {
+        NSData *data = [NSData dataWithContentsOfURL:fileURL options:NSDataReadingMappedIfSafe error:nil];
+
+        if (!data) {
+            return nil;
+        }
+
+        hash = [self hashOfData:data];
+        [self.hashesByFileKey setObject:hash forKey:fileKey];
+    }
+
+    return hash;
+}
+
+- (NSData *)hashOfData:(NSData *)data {
+    @synchronized (self) {
+        self.hashCount++;
+    }
+
+    CC_SHA256_CTX context;
+    CC_SHA256_Init(&context);
+
+    // Hashed in chunks, since the digest functions take 32-bit lengths
+    for (NSUInteger offset = 0; offset < data.length; offset += HashChunkLength) {
+        CC_SHA256_Update(&context, (const uint8_t *)data.bytes + offset, (CC_LONG)MIN(HashChunkLength, data.length - offset));
+    }
+
+    NSMutableData *hash = [[NSMutableData alloc] initWithLength:CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256_Final(hash.mutableBytes, &context);
+
+    return [hash copy];
+}
+
+static NSURL *attachmentFileURL(id attachment) {
+    if ([attachment isKindOfClass:[NSURL class]]) {
+        return ((NSURL *)attachment).isFileURL ? attachment : nil;
+    }
+    else if ([attachment isKindOfClass:[XExtensionItemStreamingAttachment class]]) {
+        return ((XExtensionItemStreamingAttachment *)attachment).fileURL;
+    }
+    else {
+        return nil;
+    }
+}
+
+static unsigned long long attachmentByteCount(id attachment) {
+    if ([attachment isKindOfClass:[NSData class]]) {
+        return ((NSData *)attachment).length;
+    }
+    else if ([attachment isKindOfClass:[NSString class]]) {
+        return ((NSString *)attachment).length * sizeof(unichar);
+    }
+
+    NSURL *fileURL = attachmentFileURL(attachment);
+    struct stat fileStatus;
+
+    if (fileURL && stat(fileURL.fileSystemRepresentation, &fileStatus) == 0) {
+        return (unsigned long long)fileStatus.st_size;
+    }
+
+    return 0;
+}
+
+static NSString *fileKeyForFileURL(NSURL *fileURL) {
+    struct stat fileStatus;
+
+    if (!fileURL || stat(fileURL.fileSystemRepresentation, &fileStatus) != 0) {
+        return nil;
+    }
+
+    return [NSString stringWithFormat:@"%@|%llu|%llu|%lld|%ld.%09ld",
+            fileURL.path,
+            (unsigned long long)fileStatus.st_dev,
+            (unsigned long long)fileStatus.st_ino,
+            (long long)fileStatus.st_size,
+            (long)fileStatus.st_mtimespec.tv_sec,
+            (long)fileStatus.st_mtimespec.tv_nsec];
+}
+
+@end
@@ -0,0 +1,194 @@
+#import "XExtensionItemAttachmentLoader.h"
+#import "XExtensionItemInstrumentation.h"
+
+static NSUInteger const DefaultMaximumConcurrentLoads = 2;
+
+@interface XExtensionItemAttachmentLoadResult ()
+
+@property (nonatomic) NSUInteger index;
+@property (nonatomic) NSItemProvider *itemProvider;
+@property (nonatomic, copy) NSString *typeIdentifier;
+@property (nonatomic) id <NSSecureCoding> item;
+@property (nonatomic) NSError *error;
+@property (nonatomic) NSTimeInterval loadDuration;
+@property (nonatomic) NSTimeInterval waitDuration;
+
+@end
+
+@implementation XExtensionItemAttachmentLoadResult
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"%@ { index: %lu, typeIdentifier: %@, item: %@, error: %@, waitDuration: %.3f, loadDuration: %.3f }",
+            [super description], (unsigned long)self.index, self.typeIdentifier, self.item, self.error, self.waitDuration, self.loadDuration];
+}
+
+@end
+
+@interface XExtensionItemAttachmentLoader ()
+
+@property (nonatomic, copy) NSArray *itemProviders;
+@property (nonatomic, copy) NSArray *preferredTypeIdentifiers;
+@property (atomic, getter=isCancelled) BOOL cancelled;
+@property (nonatomic, getter=isStarted) BOOL started;
+
+@end
+
+@implementation XExtensionItemAttachmentLoader
+
+#pragma mark - Initialization
+
+- (instancetype)initWithItemProviders:(NSArray *)itemProviders preferredTypeIdentifiers:(NSArray *)preferredTypeIdentifiers {
+    NSParameterAssert(itemProviders);
+    NSParameterAssert(preferredTypeIdentifiers);
+
+    self = [super init];
+    if (self) {
+        _itemProviders = [itemProviders copy];
+        _preferredTypeIdentifiers = [preferredTypeIdentifiers copy];
+        _maximumConcurrentLoads = DefaultMaximumConcurrentLoads;
+        _callbackQueue = dispatch_get_main_queue();
+    }
+
+    return self;
+}
+
+- (instancetype)init {
+    return [self initWithItemProviders:nil preferredTypeIdentifiers:nil];
+}
+
+#pragma mark - XExtensionItemAttachmentLoader
+
+- (void)loadWithResultHandler:(XExtensionItemAttachmentLoadResultHandler)resultHandler
+            completionHandler:(XExtensionItemAttachmentLoadCompletionHandler)completionHandler {
+    NSAssert(!self.started, @"An attachment loader can only be started once");
+    self.started = YES;
+
+    NSArray *requests = [self loadRequests];
+    NSDictionary *options = self.options;
+    dispatch_queue_t callbackQueue = self.callbackQueue;
+
+    dispatch_group_t group = dispatch_group_create();
+    dispatch_semaphore_t slots = dispatch_semaphore_create((long)MAX(self.maximumConcurrentLoads, 1));
+    dispatch_queue_t schedulingQueue = dispatch_queue_create("com.tumblr.XExtensionItem.AttachmentLoader", DISPATCH_QUEUE_SERIAL);
+
+    NSMutableArray *results = [[NSMutableArray alloc] initWithCapacity:requests.count];
+    NSTimeInterval startTime = currentTime();
+
+    for (NSUInteger i = 0; i < requests.count; i++) {
+        dispatch_group_enter(group);
+    }
+
+    // Loads are started in attachment order, each one waiting on the scheduling queue until a slot frees up
+    dispatch_async(schedulingQueue, ^{
+        for (XExtensionItemAttachmentLoadResult *result in requests) {
+            NSTimeInterval waitStartTime = currentTime();
+            dispatch_semaphore_wait(slots, DISPATCH_TIME_FOREVER);
+
+            if (self.cancelled) {
+                dispatch_semaphore_signal(slots);
+                dispatch_group_leave(group);
+                continue;
+            }
+
+            NSTimeInterval loadStartTime = currentTime();
+            result.waitDuration = loadStartTime - waitStartTime;
+
+            uint64_t span = metricsBeginSpan(XExtensionItemMetricsSpanAttachmentLoad);
+
+            [result.itemProvider loadItemForTypeIdentifier:result.typeIdentifier options:options completionHandler:^(id <NSSecureCoding> item, NSError *error) {
+                result.loadDuration = currentTime() - loadStartTime;
+                result.item = item;
+                result.error = error;
+
+                metricsEndSpan(XExtensionItemMetricsSpanAttachmentLoad, span);
+
+                if (metricsEnabled()) {
+                    metricsRecordCounter(XExtensionItemMetricsCounterBytes, byteCountOfLoadedItem(item));
+                }
+
+                dispatch_semaphore_signal(slots);
+
+                dispatch_async(callbackQueue, ^{
+                    if (!self.cancelled) {
+                        [results addObject:result];
+
+                        if (resultHandler) {
+                            resultHandler(result);
+                        }
+                    }
+
+                    dispatch_group_leave(group);
+                });
+            }];
+        }
+    });
+
+    dispatch_group_notify(group, callbackQueue, ^{
+        if (!self.cancelled && completionHandler) {
+            completionHandler([results copy], currentTime() - startTime);
+        }
+    });
+}
+
+- (void)cancel {
+    self.cancelled = YES;
+}
+
+#pragma mark - Private
+
+/*
+ One (not yet loaded) result per distinct item provider that conforms to a preferred type identifier, as the most
+ preferred type identifier that it conforms to.
+ */
+- (NSArray *)loadRequests {
+    NSMutableArray *requests = [[NSMutableArray alloc] initWithCapacity:self.itemProviders.count];
+    NSHashTable *seenItemProviders = [NSHashTable hashTableWithOptions:NSPointerFunctionsObjectPointerPersonality];
+
+    [self.itemProviders enumerateObjectsUsingBlock:^(NSItemProvider *itemProvider, NSUInteger index, BOOL *stop) {
+        if (![itemProvider isKindOfClass:[NSItemProvider class]] || [seenItemProviders containsObject:itemProvider]) {
+            return;
+        }
+
+        [seenItemProviders addObject:itemProvider];
+
+        for (NSString *typeIdentifier in self.preferredTypeIdentifiers) {
+            if ([itemProvider hasItemConformingToTypeIdentifier:typeIdentifier]) {
+                XExtensionItemAttachmentLoadResult *request = [[XExtensionItemAttachmentLoadResult alloc] init];
+                request.index = index;
+                request.itemProvider = itemProvider;
+                request.typeIdentifier = typeIdentifier;
+
+                [requests addObject:request];
+                break;
+            }
+        }
+    }];
+
+    return [requests copy];
+}
+
+/*
+ Size of an attachment loaded as data or as a file, or `0` for anything else.
+ */
+static int64_t byteCountOfLoadedItem(id item) {
+    if ([item isKindOfClass:[NSData class]]) {
+        return (int64_t)((NSData *)item).length;
+    }
+    else if ([item isKindOfClass:[NSURL class]] && ((NSURL *)item).isFileURL) {
+        NSNumber *fileSize;
+        [(NSURL *)item getResourceValue:&fileSize forKey:NSURLFileSizeKey error:nil];
+
+        return fileSize.longLongValue;
+    }
+    else {
+        return 0;
+    }
+}
+
+static NSTimeInterval currentTime(void) {
+    return [NSProcessInfo processInfo].systemUptime;
+}
+
+@end
@@ -0,0 +1,31 @@
+#import <Foundation/Foundation.h>
+
+/**
+ Converts parameter dictionaries to and from a compact, versioned binary representation. Used internally by
+ `XExtensionItemSource`, which writes it, and `XExtensionItem`, which reads it.
+
+ @discussion Supports `NSString`, `NSURL`, `NSNumber`, `NSData`, `NSDate`, and arrays and dictionaries (with string keys)
+ of those types. Repeated strings, including the keys used by this library, are written once and referenced by index 
+ afterwards.
+ */
+@interface XExtensionItemBinaryCoder : NSObject
+
+/**
+ Encode as many top-level entries of a dictionary as possible.
+
+ @param dictionary      Dictionary to encode.
+ @param unencodableKeys If non-`NULL`, set to the keys whose values contain types that can’t be encoded. These entries 
+ are left out of the returned data.
+
+ @return Encoded data, or `nil` if no entries could be encoded.
+ */
++ (NSData *)dataWithDictionary:(NSDictionary *)dictionary unencodableKeys:(NSArray **)unencodableKeys;
+
+/**
+ @param data Data produced by `dataWithDictionary:unencodableKeys:`.
+
+ @return Decoded dictionary, or `nil` if the data is malformed or was written by an unsupported version of the format.
+ */
++ (NSDictionary *)dictionaryWithData:(NSData *)data;
+
+@end
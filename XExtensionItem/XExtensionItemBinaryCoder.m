@@ -0,0 +1,497 @@
+#import "XExtensionItemBinaryCoder.h"
+#import "XExtensionItemParameterKeys.h"
+
+/*
+ Format, version 1:
+
+     payload := 'X' 'E' 'I' version:u8 dictionary-value
+     value   := tag:u8 body
+
+ Lengths, counts, and string indices are unsigned LEB128 varints. Integers are zigzag-encoded varints. Doubles are
+ little-endian IEEE 754.
+
+ The string table starts out containing `WellKnownStrings()`, in order. Every `TagString` appends its string to the
+ table, and later occurrences are written as a `TagStringReference` to its index instead. Changing the well-known
+ strings requires bumping `FormatVersion`.
+ */
+
+static const uint8_t FormatMagic[3] = { 'X', 'E', 'I' };
+static const uint8_t FormatVersion = 1;
+
+static const NSUInteger MaximumNestingDepth = 32;
+
+typedef NS_ENUM(uint8_t, Tag) {
+    TagString = 0x01,          // length, UTF-8 bytes
+    TagStringReference = 0x02, // index into the string table
+    TagURL = 0x03,             // string value of `absoluteString`
+    TagInteger = 0x04,         // zigzag varint
+    TagDouble = 0x05,          // 8 bytes
+    TagTrue = 0x06,
+    TagFalse = 0x07,
+    TagArray = 0x08,           // count, values
+    TagDictionary = 0x09,      // count, (string value, value) pairs
+    TagData = 0x0A,            // length, bytes
+    TagDate = 0x0B,            // 8 bytes, seconds since the reference date
+};
+
+static NSArray *WellKnownStrings(void) {
+    return @[
+        ParameterKeyXExtensionItem,
+        ParameterKeyTags,
+        ParameterKeySourceURL,
+        ParameterKeyReferrerName,
+        ParameterKeyReferrerAppStoreID,
+        ParameterKeyReferrerGooglePlayID,
+        ParameterKeyReferrerWebURL,
+        ParameterKeyReferreriOSAppURL,
+        ParameterKeyReferrerAndroidAppURL,
+    ];
+}
+
+#pragma mark - Writing
+
+@interface XExtensionItemBinaryWriter : NSObject
+
+@property (nonatomic, readonly) NSMutableData *data;
+@property (nonatomic, readonly) NSMutableDictionary *stringIndices;
+
+@end
+
+@implementation XExtensionItemBinaryWriter
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _data = [[NSMutableData alloc] initWithBytes:FormatMagic length:sizeof(FormatMagic)];
+        [_data appendBytes:&FormatVersion length:sizeof(FormatVersion)];
+
+        NSArray *wellKnownStrings = WellKnownStrings();
+        _stringIndices = [[NSMutableDictionary alloc] initWithCapacity:wellKnownStrings.count];
+
+        [wellKnownStrings enumerateObjectsUsingBlock:^(NSString *string, NSUInteger index, BOOL *stop) {
+            _stringIndices[string] = @(index);
+        }];
+    }
+
+    return self;
+}
+
+- (BOOL)canWriteValue:(id)value depth:(NSUInteger)depth {
+    if (depth > MaximumNestingDepth) {
+        return NO;
+    }
+
+    if ([value isKindOfClass:[NSArray class]]) {
+        for (id element in (NSArray *)value) {
+            if (![self canWriteValue:element depth:depth + 1]) {
+                return NO;
+            }
+        }
+
+        return YES;
+    }
+
+    if ([value isKindOfClass:[NSDictionary class]]) {
+        __block BOOL canWrite = YES;
+
+        [(NSDictionary *)value enumerateKeysAndObjectsUsingBlock:^(id key, id element, BOOL *stop) {
+            if (![key isKindOfClass:[NSString class]] || ![self canWriteValue:element depth:depth + 1]) {
+                canWrite = NO;
+                *stop = YES;
+            }
+        }];
+
+        return canWrite;
+    }
+
+    if ([value isKindOfClass:[NSNumber class]]) {
+        return isBoolean(value) || isFloatingPoint(value) || integerFits(value);
+    }
+
+    return [value isKindOfClass:[NSString class]]
+        || [value isKindOfClass:[NSURL class]]
+        || [value isKindOfClass:[NSData class]]
+        || [value isKindOfClass:[NSDate class]];
+}
+
+- (void)writeValue:(id)value {
+    if ([value isKindOfClass:[NSString class]]) {
+        [self writeString:value];
+    }
+    else if ([value isKindOfClass:[NSURL class]]) {
+        [self writeTag:TagURL];
+        [self writeString:((NSURL *)value).absoluteString];
+    }
+    else if ([value isKindOfClass:[NSNumber class]]) {
+        NSNumber *number = value;
+
+        if (isBoolean(number)) {
+            [self writeTag:number.boolValue ? TagTrue : TagFalse];
+        }
+        else if (isFloatingPoint(number)) {
+            [self writeTag:TagDouble];
+            [self writeDouble:number.doubleValue];
+        }
+        else {
+            int64_t integer = number.longLongValue;
+
+            [self writeTag:TagInteger];
+            [self writeVarint:((uint64_t)integer << 1) ^ (uint64_t)(integer >> 63)];
+        }
+    }
+    else if ([value isKindOfClass:[NSArray class]]) {
+        [self writeTag:TagArray];
+        [self writeVarint:((NSArray *)value).count];
+
+        for (id element in (NSArray *)value) {
+            [self writeValue:element];
+        }
+    }
+    else if ([value isKindOfClass:[NSDictionary class]]) {
+        [self writeTag:TagDictionary];
+        [self writeVarint:((NSDictionary *)value).count];
+
+        [(NSDictionary *)value enumerateKeysAndObjectsUsingBlock:^(NSString *key, id element, BOOL *stop) {
+            [self writeString:key];
+            [self writeValue:element];
+        }];
+    }
+    else if ([value isKindOfClass:[NSData class]]) {
+        [self writeTag:TagData];
+        [self writeVarint:((NSData *)value).length];
+        [self.data appendData:value];
+    }
+    else if ([value isKindOfClass:[NSDate class]]) {
+        [self writeTag:TagDate];
+        [self writeDouble:((NSDate *)value).timeIntervalSinceReferenceDate];
+    }
+}
+
+- (void)writeString:(NSString *)string {
+    NSNumber *index = self.stringIndices[string];
+
+    if (index) {
+        [self writeTag:TagStringReference];
+        [self writeVarint:index.unsignedIntegerValue];
+    }
+    else {
+        NSData *bytes = [string dataUsingEncoding:NSUTF8StringEncoding];
+
+        [self writeTag:TagString];
+        [self writeVarint:bytes.length];
+        [self.data appendData:bytes];
+
+        self.stringIndices[string] = @(self.stringIndices.count);
+    }
+}
+
+- (void)writeTag:(Tag)tag {
+    [self.data appendBytes:&tag length:sizeof(tag)];
+}
+
+- (void)writeVarint:(uint64_t)value {
+    uint8_t buffer[10];
+    NSUInteger length = 0;
+
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        buffer[length++] = value ? (byte | 0x80) : byte;
+    } while (value);
+
+    [self.data appendBytes:buffer length:length];
+}
+
+- (void)writeDouble:(double)value {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint64_t littleEndian = CFSwapInt64HostToLittle(bits);
+    [self.data appendBytes:&littleEndian length:sizeof(littleEndian)];
+}
+
+static BOOL isBoolean(NSNumber *number) {
+    return CFGetTypeID((__bridge CFTypeRef)number) == CFBooleanGetTypeID();
+}
+
+static BOOL isFloatingPoint(NSNumber *number) {
+    return CFNumberIsFloatType((__bridge CFNumberRef)number);
+}
+
+static BOOL integerFits(NSNumber *number) {
+    // Unsigned 64-bit values above `INT64_MAX` would silently wrap
+    return strcmp(number.objCType, @encode(unsigned long long)) != 0 || number.unsignedLongLongValue <= INT64_MAX;
+}
+
+@end
+
+#pragma mark - Reading
+
+typedef struct {
+    const uint8_t *bytes;
+    NSUInteger length;
+    NSUInteger position;
+    __unsafe_unretained NSMutableArray *strings;
+} Reader;
+
+static BOOL readByte(Reader *reader, uint8_t *byte) {
+    if (reader->position >= reader->length) {
+        return NO;
+    }
+
+    *byte = reader->bytes[reader->position++];
+    return YES;
+}
+
+static BOOL readVarint(Reader *reader, uint64_t *value) {
+    uint64_t result = 0;
+
+    for (NSUInteger shift = 0; shift < 64; shift += 7) {
+        uint8_t byte;
+
+        if (!readByte(reader, &byte)) {
+            return NO;
+        }
+
+        result |= (uint64_t)(byte & 0x7F) << shift;
+
+        if (!(byte & 0x80)) {
+            *value = result;
+            return YES;
+        }
+    }
+
+    return NO;
+}
+
+static BOOL readLength(Reader *reader, NSUInteger *length) {
+    uint64_t value;
+
+    // Every element occupies at least one byte, so a length or count can never exceed what’s left
+    if (!readVarint(reader, &value) || value > reader->length - reader->position) {
+        return NO;
+    }
+
+    *length = (NSUInteger)value;
+    return YES;
+}
+
+static BOOL readDouble(Reader *reader, double *value) {
+    if (reader->length - reader->position < sizeof(uint64_t)) {
+        return NO;
+    }
+
+    uint64_t littleEndian;
+    memcpy(&littleEndian, reader->bytes + reader->position, sizeof(littleEndian));
+    reader->position += sizeof(littleEndian);
+
+    uint64_t bits = CFSwapInt64LittleToHost(littleEndian);
+    memcpy(value, &bits, sizeof(bits));
+    return YES;
+}
+
+static id readValue(Reader *reader, NSUInteger depth);
+
+static NSString *readString(Reader *reader) {
+    uint8_t tag;
+
+    if (!readByte(reader, &tag)) {
+        return nil;
+    }
+
+    if (tag == TagStringReference) {
+        uint64_t index;
+
+        if (!readVarint(reader, &index) || index >= reader->strings.count) {
+            return nil;
+        }
+
+        return reader->strings[(NSUInteger)index];
+    }
+
+    if (tag == TagString) {
+        NSUInteger length;
+
+        if (!readLength(reader, &length)) {
+            return nil;
+        }
+
+        NSString *string = [[NSString alloc] initWithBytes:reader->bytes + reader->position length:length encoding:NSUTF8StringEncoding];
+        reader->position += length;
+
+        if (string) {
+            [reader->strings addObject:string];
+        }
+
+        return string;
+    }
+
+    return nil;
+}
+
+static id readValue(Reader *reader, NSUInteger depth) {
+    if (depth > MaximumNestingDepth || reader->position >= reader->length) {
+        return nil;
+    }
+
+    Tag tag = reader->bytes[reader->position];
+
+    switch (tag) {
+        case TagString:
+        case TagStringReference:
+            return readString(reader);
+        default:
+            reader->position++;
+            break;
+    }
+
+    switch (tag) {
+        case TagURL: {
+            NSString *string = readString(reader);
+            return string ? [NSURL URLWithString:string] : nil;
+        }
+        case TagInteger: {
+            uint64_t zigzag;
+
+            if (!readVarint(reader, &zigzag)) {
+                return nil;
+            }
+
+            return @((int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1));
+        }
+        case TagDouble: {
+            double value;
+            return readDouble(reader, &value) ? @(value) : nil;
+        }
+        case TagTrue:
+            return @YES;
+        case TagFalse:
+            return @NO;
+        case TagArray: {
+            NSUInteger count;
+
+            if (!readLength(reader, &count)) {
+                return nil;
+            }
+
+            NSMutableArray *array = [[NSMutableArray alloc] initWithCapacity:count];
+
+            for (NSUInteger i = 0; i < count; i++) {
+                id element = readValue(reader, depth + 1);
+
+                if (!element) {
+                    return nil;
+                }
+
+                [array addObject:element];
+            }
+
+            return [array copy];
+        }
+        case TagDictionary: {
+            NSUInteger count;
+
+            if (!readLength(reader, &count)) {
+                return nil;
+            }
+
+            NSMutableDictionary *dictionary = [[NSMutableDictionary alloc] initWithCapacity:count];
+
+            for (NSUInteger i = 0; i < count; i++) {
+                NSString *key = readString(reader);
+                id element = key ? readValue(reader, depth + 1) : nil;
+
+                if (!element) {
+                    return nil;
+                }
+
+                dictionary[key] = element;
+            }
+
+            return [dictionary copy];
+        }
+        case TagData: {
+            NSUInteger length;
+
+            if (!readLength(reader, &length)) {
+                return nil;
+            }
+
+            NSData *data = [[NSData alloc] initWithBytes:reader->bytes + reader->position length:length];
+            reader->position += length;
+            return data;
+        }
+        case TagDate: {
+            double value;
+            return readDouble(reader, &value) ? [NSDate dateWithTimeIntervalSinceReferenceDate:value] : nil;
+        }
+        default:
+            return nil;
+    }
+}
+
+#pragma mark -
+
+@implementation XExtensionItemBinaryCoder
+
++ (NSData *)dataWithDictionary:(NSDictionary *)dictionary unencodableKeys:(NSArray **)unencodableKeys {
+    XExtensionItemBinaryWriter *writer = [[XExtensionItemBinaryWriter alloc] init];
+
+    NSMutableDictionary *encodableEntries = [[NSMutableDictionary alloc] initWithCapacity:dictionary.count];
+    NSMutableArray *mutableUnencodableKeys = [[NSMutableArray alloc] init];
+
+    [dictionary enumerateKeysAndObjectsUsingBlock:^(id key, id value, BOOL *stop) {
+        if ([key isKindOfClass:[NSString class]] && [writer canWriteValue:value depth:1]) {
+            encodableEntries[key] = value;
+        }
+        else {
+            [mutableUnencodableKeys addObject:key];
+        }
+    }];
+
+    if (unencodableKeys) {
+        *unencodableKeys = [mutableUnencodableKeys copy];
+    }
+
+    if (encodableEntries.count == 0) {
+        return nil;
+    }
+
+    [writer writeValue:encodableEntries];
+
+    return [writer.data copy];
+}
+
++ (NSDictionary *)dictionaryWithData:(NSData *)data {
+    NSUInteger headerLength = sizeof(FormatMagic) + sizeof(FormatVersion);
+
+    if (![data isKindOfClass:[NSData class]] || data.length < headerLength) {
+        return nil;
+    }
+
+    const uint8_t *bytes = data.bytes;
+
+    if (memcmp(bytes, FormatMagic, sizeof(FormatMagic)) != 0 || bytes[sizeof(FormatMagic)] != FormatVersion) {
+        return nil;
+    }
+
+    NSMutableArray *strings = [WellKnownStrings() mutableCopy];
+
+    Reader reader = {
+        .bytes = bytes,
+        .length = data.length,
+        .position = headerLength,
+        .strings = strings,
+    };
+
+    id value = readValue(&reader, 0);
+
+    // Trailing bytes mean the payload wasn’t written by this version of the format
+    if (![value isKindOfClass:[NSDictionary class]] || reader.position != reader.length) {
+        return nil;
+    }
+
+    return value;
+}
+
+@end
@@ -0,0 +1,278 @@
+#import "XExtensionItem.h"
+#import "XExtensionItemArchivedClasses.h"
+#import "XExtensionItemBinaryCoder.h"
+#import "XExtensionItemCorpus.h"
+
+static NSString * const RecordingPathExtension = @"xeitem";
+
+/*
+ Every recording is a dictionary written by `XExtensionItemBinaryCoder`. Recordings of any other format version are
+ skipped when reading, so the version has to be bumped whenever a key is removed or changes meaning.
+ */
+static NSInteger const RecordingFormatVersion = 1;
+
+static NSString * const RecordingKeyFormatVersion = @"format-version";
+static NSString * const RecordingKeyDirection = @"direction";
+static NSString * const RecordingKeyActivityType = @"activity-type";
+static NSString * const RecordingKeyRecordDate = @"record-date";
+static NSString * const RecordingKeyUserInfo = @"user-info";
+static NSString * const RecordingKeyAttachments = @"attachments";
+
+static NSString * const RecordingDirectionSent = @"sent";
+static NSString * const RecordingDirectionReceived = @"received";
+
+@interface XExtensionItemCorpusRecording ()
+
+@property (nonatomic) NSURL *fileURL;
+@property (nonatomic) XExtensionItemCorpusDirection direction;
+@property (nonatomic, copy) NSString *activityType;
+@property (nonatomic) NSDate *recordDate;
+@property (nonatomic) NSExtensionItem *extensionItem;
+@property (nonatomic) NSUInteger byteCount;
+
+@end
+
+@implementation XExtensionItemCorpusRecording
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"%@ { fileURL: %@, direction: %ld, activityType: %@, byteCount: %lu }",
+            [super description], self.fileURL, (long)self.direction, self.activityType, (unsigned long)self.byteCount];
+}
+
+@end
+
+@implementation XExtensionItemCorpus
+
+#pragma mark - Initialization
+
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL {
+    NSParameterAssert(directoryURL.isFileURL);
+
+    self = [super init];
+    if (self) {
+        _directoryURL = [directoryURL copy];
+    }
+
+    return self;
+}
+
+- (instancetype)init {
+    return [self initWithDirectoryURL:nil];
+}
+
+#pragma mark - XExtensionItemCorpus
+
+- (NSArray *)recordItemSource:(XExtensionItemSource *)itemSource activityTypes:(NSArray *)activityTypes error:(NSError **)error {
+    NSParameterAssert(itemSource);
+    NSParameterAssert(activityTypes);
+
+    NSMutableArray *recordings = [[NSMutableArray alloc] init];
+
+    for (NSString *activityType in activityTypes) {
+        id item = [itemSource activityViewController:nil itemForActivityType:activityType];
+
+        if (![item isKindOfClass:[NSExtensionItem class]]) {
+            continue;
+        }
+
+        XExtensionItemCorpusRecording *recording = [self recordExtensionItem:item
+                                                                activityType:activityType
+                                                                   direction:XExtensionItemCorpusDirectionSent
+                                                                       error:error];
+
+        if (!recording) {
+            return nil;
+        }
+
+        [recordings addObject:recording];
+    }
+
+    return [recordings copy];
+}
+
+- (XExtensionItemCorpusRecording *)recordExtensionItem:(NSExtensionItem *)extensionItem
+                                          activityType:(NSString *)activityType
+                                             direction:(XExtensionItemCorpusDirection)direction
+                                                 error:(NSError **)error {
+    NSParameterAssert(extensionItem);
+
+    uint64_t timestamp = recordTimestamp();
+    NSDate *recordDate = [NSDate dateWithTimeIntervalSince1970:timestamp / (NSTimeInterval)USEC_PER_SEC];
+
+    NSData *data = recordingData(extensionItem, activityType, direction, recordDate, error);
+
+    if (!data) {
+        return nil;
+    }
+
+    if (![[NSFileManager defaultManager] createDirectoryAtURL:self.directoryURL withIntermediateDirectories:YES attributes:nil error:error]) {
+        return nil;
+    }
+
+    // Zero-padded, so that name order is record order
+    NSString *fileName = [NSString stringWithFormat:@"%017llu-%@.%@", timestamp, [NSUUID UUID].UUIDString, RecordingPathExtension];
+    NSURL *fileURL = [self.directoryURL URLByAppendingPathComponent:fileName isDirectory:NO];
+
+    // Written atomically, so that a recording being written by another process is never read half-written
+    if (![data writeToURL:fileURL options:NSDataWritingAtomic error:error]) {
+        return nil;
+    }
+
+    return recordingWithData(data, fileURL);
+}
+
+- (NSArray *)recordings {
+    NSArray *fileURLs = [[NSFileManager defaultManager] contentsOfDirectoryAtURL:self.directoryURL
+                                                      includingPropertiesForKeys:nil
+                                                                         options:NSDirectoryEnumerationSkipsHiddenFiles
+                                                                           error:nil];
+
+    fileURLs = [fileURLs sortedArrayUsingComparator:^NSComparisonResult(NSURL *URL1, NSURL *URL2) {
+        return [URL1.lastPathComponent compare:URL2.lastPathComponent];
+    }];
+
+    NSMutableArray *recordings = [[NSMutableArray alloc] init];
+
+    for (NSURL *fileURL in fileURLs) {
+        if (![fileURL.pathExtension isEqualToString:RecordingPathExtension]) {
+            continue;
+        }
+
+        NSData *data = [NSData dataWithContentsOfURL:fileURL options:NSDataReadingMappedIfSafe error:nil];
+        XExtensionItemCorpusRecording *recording = data ? recordingWithData(data, fileURL) : nil;
+
+        if (recording) {
+            [recordings addObject:recording];
+        }
+    }
+
+    return [recordings copy];
+}
+
+#pragma mark - Private
+
+static id valueOfClass(id value, Class class) {
+    return [value isKindOfClass:class] ? value : nil;
+}
+
+static NSString *directionString(XExtensionItemCorpusDirection direction) {
+    switch (direction) {
+        case XExtensionItemCorpusDirectionSent:
+            return RecordingDirectionSent;
+        case XExtensionItemCorpusDirectionReceived:
+            return RecordingDirectionReceived;
+    }
+}
+
+/*
+ Microseconds since 1970. Never returns the same value twice in a process, so that recordings made in quick succession
+ still sort in the order they were made.
+ */
+static uint64_t recordTimestamp(void) {
+    static uint64_t lastTimestamp;
+
+    uint64_t timestamp = (uint64_t)([NSDate date].timeIntervalSince1970 * USEC_PER_SEC);
+
+    @synchronized([XExtensionItemCorpus class]) {
+        timestamp = MAX(timestamp, lastTimestamp + 1);
+        lastTimestamp = timestamp;
+    }
+
+    return timestamp;
+}
+
+static NSData *recordingData(NSExtensionItem *extensionItem, NSString *activityType, XExtensionItemCorpusDirection direction,
+                             NSDate *recordDate, NSError **error) {
+    // Attachments are recorded separately, as their type identifiers
+    NSMutableDictionary *userInfo = [extensionItem.userInfo mutableCopy] ?: [[NSMutableDictionary alloc] init];
+    [userInfo removeObjectForKey:NSExtensionItemAttachmentsKey];
+
+    NSData *archivedUserInfo = [NSKeyedArchiver archivedDataWithRootObject:userInfo requiringSecureCoding:YES error:error];
+
+    // Checked now, so that a recording that couldn’t be read back fails to record instead of being skipped when replayed
+    if (!archivedUserInfo || ![NSKeyedUnarchiver unarchivedObjectOfClasses:archivedClasses() fromData:archivedUserInfo error:error]) {
+        return nil;
+    }
+
+    NSMutableArray *attachments = [[NSMutableArray alloc] init];
+
+    for (id attachment in extensionItem.attachments) {
+        [attachments addObject:[valueOfClass(attachment, [NSItemProvider class]) registeredTypeIdentifiers] ?: @[]];
+    }
+
+    NSMutableDictionary *recording = [@{
+        RecordingKeyFormatVersion: @(RecordingFormatVersion),
+        RecordingKeyDirection: directionString(direction),
+        RecordingKeyRecordDate: recordDate,
+        RecordingKeyUserInfo: archivedUserInfo,
+        RecordingKeyAttachments: attachments,
+    } mutableCopy];
+
+    recording[RecordingKeyActivityType] = activityType;
+
+    return [XExtensionItemBinaryCoder dataWithDictionary:recording unencodableKeys:NULL];
+}
+
+/*
+ Returns `nil` if the data isn’t a recording of the current format version.
+ */
+static XExtensionItemCorpusRecording *recordingWithData(NSData *data, NSURL *fileURL) {
+    NSDictionary *dictionary = [XExtensionItemBinaryCoder dictionaryWithData:data];
+
+    if (![valueOfClass(dictionary[RecordingKeyFormatVersion], [NSNumber class]) isEqualToNumber:@(RecordingFormatVersion)]) {
+        return nil;
+    }
+
+    NSString *direction = valueOfClass(dictionary[RecordingKeyDirection], [NSString class]);
+
+    if (![direction isEqualToString:RecordingDirectionSent] && ![direction isEqualToString:RecordingDirectionReceived]) {
+        return nil;
+    }
+
+    NSData *archivedUserInfo = valueOfClass(dictionary[RecordingKeyUserInfo], [NSData class]);
+    NSDictionary *userInfo = archivedUserInfo ? valueOfClass([NSKeyedUnarchiver unarchivedObjectOfClasses:archivedClasses() fromData:archivedUserInfo error:nil],
+                                                             [NSDictionary class]) : nil;
+
+    if (!userInfo) {
+        return nil;
+    }
+
+    NSMutableArray *itemProviders = [[NSMutableArray alloc] init];
+
+    for (id typeIdentifiers in valueOfClass(dictionary[RecordingKeyAttachments], [NSArray class])) {
+        NSItemProvider *itemProvider = [[NSItemProvider alloc] init];
+
+        for (id typeIdentifier in valueOfClass(typeIdentifiers, [NSArray class])) {
+            if (![typeIdentifier isKindOfClass:[NSString class]]) {
+                continue;
+            }
+
+            // Contents aren’t recorded
+            [itemProvider registerItemForTypeIdentifier:typeIdentifier loadHandler:^(NSItemProviderCompletionHandler completionHandler, Class expectedClass, NSDictionary *options) {
+                completionHandler([NSData data], nil);
+            }];
+        }
+
+        [itemProviders addObject:itemProvider];
+    }
+
+    NSExtensionItem *item = [[NSExtensionItem alloc] init];
+
+    // As with `XExtensionItemSource`, `userInfo` has to be set before the properties that are stored in it
+    item.userInfo = userInfo;
+    item.attachments = itemProviders;
+
+    XExtensionItemCorpusRecording *recording = [[XExtensionItemCorpusRecording alloc] init];
+    recording.fileURL = fileURL;
+    recording.direction = [direction isEqualToString:RecordingDirectionSent] ? XExtensionItemCorpusDirectionSent : XExtensionItemCorpusDirectionReceived;
+    recording.activityType = valueOfClass(dictionary[RecordingKeyActivityType], [NSString class]);
+    recording.recordDate = valueOfClass(dictionary[RecordingKeyRecordDate], [NSDate class]);
+    recording.extensionItem = item;
+    recording.byteCount = data.length;
+
+    return recording;
+}
+
+@end
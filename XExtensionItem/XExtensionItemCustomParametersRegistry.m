@@ -0,0 +1,141 @@
+#import "XExtensionItemCustomParametersRegistry.h"
+#import "XExtensionItemCustomParameters.h"
+
+static unichar const KeyNamespaceTerminator = '.';
+
+@interface XExtensionItemCustomParametersRegistry ()
+
+@property (nonatomic) NSMutableDictionary *classesByKeyNamespace;
+@property (nonatomic) NSMapTable *keyNamespacesByClass;
+
+/*
+ Distinct lengths of the registered namespaces, longest first, so that a key only has to be checked against the lengths
+ at which it could end in a namespace rather than against every namespace.
+ */
+@property (nonatomic, copy) NSArray *keyNamespaceLengths;
+
+@property (atomic) NSUInteger generation;
+
+@end
+
+@implementation XExtensionItemCustomParametersRegistry
+
+#pragma mark - Initialization
+
++ (instancetype)defaultRegistry {
+    static XExtensionItemCustomParametersRegistry *defaultRegistry;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        defaultRegistry = [[self alloc] init];
+    });
+
+    return defaultRegistry;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _classesByKeyNamespace = [[NSMutableDictionary alloc] init];
+        _keyNamespacesByClass = [NSMapTable strongToStrongObjectsMapTable];
+        _keyNamespaceLengths = @[];
+    }
+
+    return self;
+}
+
+#pragma mark - XExtensionItemCustomParametersRegistry
+
+- (void)registerClass:(Class)customParametersClass forKeyNamespace:(NSString *)keyNamespace {
+    NSParameterAssert([customParametersClass conformsToProtocol:@protocol(XExtensionItemCustomParameters)]);
+    NSParameterAssert([keyNamespace hasSuffix:@"."]);
+
+    @synchronized (self) {
+        Class previousClass = self.classesByKeyNamespace[keyNamespace];
+
+        if (previousClass) {
+            [self.keyNamespacesByClass removeObjectForKey:previousClass];
+        }
+
+        self.classesByKeyNamespace[keyNamespace] = customParametersClass;
+        [self.keyNamespacesByClass setObject:[keyNamespace copy] forKey:customParametersClass];
+
+        NSSet *lengths = [NSSet setWithArray:[self.classesByKeyNamespace.allKeys valueForKey:@"length"]];
+        self.keyNamespaceLengths = [lengths.allObjects sortedArrayUsingDescriptors:@[[NSSortDescriptor sortDescriptorWithKey:@"self" ascending:NO]]];
+
+        self.generation++;
+    }
+}
+
+- (NSString *)keyNamespaceForClass:(Class)customParametersClass {
+    @synchronized (self) {
+        NSString *keyNamespace = [self.keyNamespacesByClass objectForKey:customParametersClass];
+
+        if (!keyNamespace && [customParametersClass respondsToSelector:@selector(keyNamespace)]) {
+            keyNamespace = [(Class <XExtensionItemCustomParameters>)customParametersClass keyNamespace];
+
+            if (keyNamespace) {
+                [self registerClass:customParametersClass forKeyNamespace:keyNamespace];
+            }
+        }
+
+        return keyNamespace;
+    }
+}
+
+- (NSDictionary *)partitionDictionary:(NSDictionary *)dictionary {
+    NSDictionary *classesByKeyNamespace;
+    NSArray *keyNamespaceLengths;
+
+    @synchronized (self) {
+        classesByKeyNamespace = [self.classesByKeyNamespace copy];
+        keyNamespaceLengths = self.keyNamespaceLengths;
+    }
+
+    NSMutableDictionary *partitions = [[NSMutableDictionary alloc] init];
+
+    [dictionary enumerateKeysAndObjectsUsingBlock:^(id key, id value, BOOL *stop) {
+        if (![key isKindOfClass:[NSString class]]) {
+            return;
+        }
+
+        NSString *keyNamespace = keyNamespaceForKey(key, keyNamespaceLengths, classesByKeyNamespace);
+
+        if (keyNamespace) {
+            NSMutableDictionary *partition = partitions[keyNamespace];
+
+            if (!partition) {
+                partition = [[NSMutableDictionary alloc] init];
+                partitions[keyNamespace] = partition;
+            }
+
+            partition[key] = value;
+        }
+    }];
+
+    return [partitions copy];
+}
+
+#pragma mark - Private
+
+static NSString *keyNamespaceForKey(NSString *key, NSArray *keyNamespaceLengths, NSDictionary *classesByKeyNamespace) {
+    NSUInteger keyLength = key.length;
+
+    for (NSNumber *lengthNumber in keyNamespaceLengths) {
+        NSUInteger length = lengthNumber.unsignedIntegerValue;
+
+        // Only keys that continue past the namespace, and have its terminator in the right place, can belong to it
+        if (length >= keyLength || [key characterAtIndex:length - 1] != KeyNamespaceTerminator) {
+            continue;
+        }
+
+        NSString *candidate = [key substringToIndex:length];
+
+        if (classesByKeyNamespace[candidate]) {
+            return candidate;
+        }
+    }
+
+    return nil;
+}
+
+@end
@@ -0,0 +1,339 @@
+#import "XExtensionItemDecodingLimitsEnforcement.h"
+
+static NSUInteger const DefaultMaximumUserInfoByteCount = 1024 * 1024;
+static NSUInteger const DefaultMaximumBinaryParametersByteCount = 256 * 1024;
+static NSUInteger const DefaultMaximumNestingDepth = 8;
+static NSUInteger const DefaultMaximumCollectionCount = 1000;
+static NSUInteger const DefaultMaximumStringLength = 10000;
+static NSUInteger const DefaultMaximumTagCount = 250;
+
+@implementation XExtensionItemDecodingIssue
+
+#pragma mark - Initialization
+
+- (instancetype)initWithKind:(XExtensionItemDecodingIssueKind)kind keyPath:(NSString *)keyPath limit:(NSUInteger)limit count:(NSUInteger)count {
+    self = [super init];
+    if (self) {
+        _kind = kind;
+        _keyPath = [keyPath copy];
+        _limit = limit;
+        _count = count;
+    }
+
+    return self;
+}
+
+- (instancetype)init {
+    return [self initWithKind:XExtensionItemDecodingIssueKindTruncated keyPath:nil limit:0 count:0];
+}
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    static NSArray *kindNames;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        kindNames = @[@"truncated", @"dropped", @"rejected"];
+    });
+
+    NSString *count = self.count == NSNotFound ? @"?" : [NSString stringWithFormat:@"%lu", (unsigned long)self.count];
+
+    return [NSString stringWithFormat:@"<%@: %p; %@ “%@”, %@ > %lu>", NSStringFromClass([self class]), self,
+            kindNames[self.kind], self.keyPath, count, (unsigned long)self.limit];
+}
+
+@end
+
+@implementation XExtensionItemDecodingLimits
+
+#pragma mark - Initialization
+
++ (instancetype)defaultLimits {
+    return [[self alloc] init];
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _maximumUserInfoByteCount = DefaultMaximumUserInfoByteCount;
+        _maximumBinaryParametersByteCount = DefaultMaximumBinaryParametersByteCount;
+        _maximumNestingDepth = DefaultMaximumNestingDepth;
+        _maximumCollectionCount = DefaultMaximumCollectionCount;
+        _maximumStringLength = DefaultMaximumStringLength;
+        _maximumTagCount = DefaultMaximumTagCount;
+    }
+
+    return self;
+}
+
+#pragma mark - NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    XExtensionItemDecodingLimits *limits = [[[self class] allocWithZone:zone] init];
+    limits.maximumUserInfoByteCount = self.maximumUserInfoByteCount;
+    limits.maximumBinaryParametersByteCount = self.maximumBinaryParametersByteCount;
+    limits.maximumNestingDepth = self.maximumNestingDepth;
+    limits.maximumCollectionCount = self.maximumCollectionCount;
+    limits.maximumStringLength = self.maximumStringLength;
+    limits.maximumTagCount = self.maximumTagCount;
+
+    return limits;
+}
+
+@end
+
+#pragma mark - Enforcement
+
+/*
+ A key path is only turned into a string when an issue is reported, so it’s built up on the stack as the payload is
+ walked rather than by allocating a string for every value.
+ */
+typedef struct KeyPathComponent {
+    __unsafe_unretained id key;
+    NSUInteger index;
+    const struct KeyPathComponent *parent;
+} KeyPathComponent;
+
+typedef struct {
+    __unsafe_unretained XExtensionItemDecodingLimits *limits;
+    __unsafe_unretained NSMutableArray *issues;
+    NSUInteger byteCount;
+    BOOL exceeded;
+} Bounding;
+
+@implementation XExtensionItemDecodingLimits (Enforcement)
+
+- (NSDictionary *)boundedUserInfo:(NSDictionary *)userInfo issues:(NSMutableArray *)issues {
+    if (![userInfo isKindOfClass:[NSDictionary class]]) {
+        return userInfo;
+    }
+
+    NSUInteger issueCount = issues.count;
+    Bounding bounding = { self, issues, 0, NO };
+    NSDictionary *boundedUserInfo = boundedValue(userInfo, NULL, 1, &bounding);
+
+    if (bounding.exceeded) {
+        // None of the values found so far are kept, so issues with them no longer apply
+        [issues removeObjectsInRange:NSMakeRange(issueCount, issues.count - issueCount)];
+        addIssue(&bounding, XExtensionItemDecodingIssueKindRejected, NULL, self.maximumUserInfoByteCount, NSNotFound);
+        return @{};
+    }
+
+    return boundedUserInfo ?: @{};
+}
+
+- (BOOL)acceptsBinaryParametersOfLength:(NSUInteger)length keyPath:(NSString *)keyPath issues:(NSMutableArray *)issues {
+    if (length <= self.maximumBinaryParametersByteCount) {
+        return YES;
+    }
+
+    [issues addObject:[[XExtensionItemDecodingIssue alloc] initWithKind:XExtensionItemDecodingIssueKindRejected
+                                                                keyPath:keyPath
+                                                                  limit:self.maximumBinaryParametersByteCount
+                                                                  count:length]];
+    return NO;
+}
+
+- (NSArray *)boundedTags:(NSArray *)tags keyPath:(NSString *)keyPath issues:(NSMutableArray *)issues {
+    if (tags.count <= self.maximumTagCount) {
+        return tags;
+    }
+
+    [issues addObject:[[XExtensionItemDecodingIssue alloc] initWithKind:XExtensionItemDecodingIssueKindTruncated
+                                                                keyPath:keyPath
+                                                                  limit:self.maximumTagCount
+                                                                  count:tags.count]];
+
+    return [tags subarrayWithRange:NSMakeRange(0, self.maximumTagCount)];
+}
+
+#pragma mark - Private
+
+static NSString *keyPathString(const KeyPathComponent *keyPath) {
+    NSMutableArray *components = [[NSMutableArray alloc] init];
+
+    for (const KeyPathComponent *component = keyPath; component; component = component->parent) {
+        NSString *string = component->key ? [component->key description] : [NSString stringWithFormat:@"%lu", (unsigned long)component->index];
+        [components insertObject:string atIndex:0];
+    }
+
+    return [components componentsJoinedByString:@"."];
+}
+
+static void addIssue(Bounding *bounding, XExtensionItemDecodingIssueKind kind, const KeyPathComponent *keyPath, NSUInteger limit, NSUInteger count) {
+    [bounding->issues addObject:[[XExtensionItemDecodingIssue alloc] initWithKind:kind
+                                                                          keyPath:keyPathString(keyPath)
+                                                                            limit:limit
+                                                                            count:count]];
+}
+
+static BOOL addBytes(Bounding *bounding, NSUInteger byteCount) {
+    bounding->byteCount += byteCount;
+
+    if (bounding->byteCount > bounding->limits.maximumUserInfoByteCount) {
+        bounding->exceeded = YES;
+    }
+
+    return !bounding->exceeded;
+}
+
+static id boundedValue(id value, const KeyPathComponent *keyPath, NSUInteger depth, Bounding *bounding);
+
+static NSArray *boundedArray(NSArray *array, const KeyPathComponent *keyPath, NSUInteger depth, Bounding *bounding) {
+    NSUInteger count = array.count;
+    NSUInteger boundedCount = MIN(count, bounding->limits.maximumCollectionCount);
+
+    if (boundedCount < count) {
+        addIssue(bounding, XExtensionItemDecodingIssueKindTruncated, keyPath, bounding->limits.maximumCollectionCount, count);
+    }
+
+    // Only copied once something actually changes
+    NSMutableArray *mutableArray;
+
+    for (NSUInteger i = 0; i < boundedCount; i++) {
+        id element = array[i];
+        KeyPathComponent component = { nil, i, keyPath };
+
+        if (!addBytes(bounding, sizeof(id))) {
+            return nil;
+        }
+
+        id boundedElement = boundedValue(element, &component, depth + 1, bounding);
+
+        if (bounding->exceeded) {
+            return nil;
+        }
+
+        if (boundedElement != element && !mutableArray) {
+            mutableArray = [[array subarrayWithRange:NSMakeRange(0, i)] mutableCopy];
+        }
+
+        if (mutableArray && boundedElement) {
+            [mutableArray addObject:boundedElement];
+        }
+    }
+
+    if (mutableArray) {
+        return [mutableArray copy];
+    }
+    else if (boundedCount < count) {
+        return [array subarrayWithRange:NSMakeRange(0, boundedCount)];
+    }
+    else {
+        return array;
+    }
+}
+
+static NSDictionary *boundedDictionary(NSDictionary *dictionary, const KeyPathComponent *keyPath, NSUInteger depth, Bounding *bounding) {
+    NSUInteger count = dictionary.count;
+    NSUInteger maximumCount = bounding->limits.maximumCollectionCount;
+    BOOL truncated = count > maximumCount;
+
+    if (truncated) {
+        addIssue(bounding, XExtensionItemDecodingIssueKindTruncated, keyPath, maximumCount, count);
+    }
+
+    // Built up from scratch if truncated, or only copied once something actually changes otherwise
+    __block NSMutableDictionary *mutableDictionary = truncated ? [[NSMutableDictionary alloc] initWithCapacity:maximumCount] : nil;
+    __block NSUInteger index = 0;
+
+    [dictionary enumerateKeysAndObjectsUsingBlock:^(id key, id element, BOOL *stop) {
+        if (index++ >= maximumCount) {
+            *stop = YES;
+            return;
+        }
+
+        KeyPathComponent component = { key, 0, keyPath };
+        id boundedElement = nil;
+
+        // Keys aren’t truncated, since that could make them collide with other keys
+        if ([key isKindOfClass:[NSString class]] && ((NSString *)key).length > bounding->limits.maximumStringLength) {
+            addIssue(bounding, XExtensionItemDecodingIssueKindDropped, &component, bounding->limits.maximumStringLength, ((NSString *)key).length);
+        }
+        else if (addBytes(bounding, sizeof(id)) && boundedValue(key, NULL, depth, bounding)) {
+            boundedElement = boundedValue(element, &component, depth + 1, bounding);
+        }
+
+        if (bounding->exceeded) {
+            *stop = YES;
+            return;
+        }
+
+        if (boundedElement != element && !mutableDictionary) {
+            mutableDictionary = [dictionary mutableCopy];
+        }
+
+        if (boundedElement) {
+            mutableDictionary[key] = boundedElement;
+        }
+        else {
+            [mutableDictionary removeObjectForKey:key];
+        }
+    }];
+
+    if (bounding->exceeded) {
+        return nil;
+    }
+
+    return mutableDictionary ? [mutableDictionary copy] : dictionary;
+}
+
+/*
+ Returns the value with every limit applied, which is the same instance if it’s already within them, or `nil` if it
+ should be left out. Returns `nil` and sets `exceeded` as soon as the total size goes over the limit, without looking at
+ the rest of the payload.
+ */
+static id boundedValue(id value, const KeyPathComponent *keyPath, NSUInteger depth, Bounding *bounding) {
+    XExtensionItemDecodingLimits *limits = bounding->limits;
+
+    if ([value isKindOfClass:[NSString class]]) {
+        NSString *string = value;
+        NSUInteger length = string.length;
+
+        if (length > limits.maximumStringLength) {
+            // Don’t split a composed character sequence (e.g. a surrogate pair) in half
+            NSUInteger end = limits.maximumStringLength > 0 ? [string rangeOfComposedCharacterSequenceAtIndex:limits.maximumStringLength].location : 0;
+            string = [string substringToIndex:end];
+
+            addIssue(bounding, XExtensionItemDecodingIssueKindTruncated, keyPath, limits.maximumStringLength, length);
+        }
+
+        return addBytes(bounding, string.length * sizeof(unichar)) ? string : nil;
+    }
+    else if ([value isKindOfClass:[NSURL class]]) {
+        NSUInteger length = ((NSURL *)value).absoluteString.length;
+
+        // A truncated URL would point somewhere else entirely
+        if (length > limits.maximumStringLength) {
+            addIssue(bounding, XExtensionItemDecodingIssueKindDropped, keyPath, limits.maximumStringLength, length);
+            return nil;
+        }
+
+        return addBytes(bounding, length * sizeof(unichar)) ? value : nil;
+    }
+    else if ([value isKindOfClass:[NSData class]]) {
+        return addBytes(bounding, ((NSData *)value).length) ? value : nil;
+    }
+    else if ([value isKindOfClass:[NSAttributedString class]]) {
+        return addBytes(bounding, ((NSAttributedString *)value).length * sizeof(unichar)) ? value : nil;
+    }
+    else if ([value isKindOfClass:[NSArray class]] || [value isKindOfClass:[NSDictionary class]]) {
+        if (depth > limits.maximumNestingDepth) {
+            addIssue(bounding, XExtensionItemDecodingIssueKindDropped, keyPath, limits.maximumNestingDepth, depth);
+            return nil;
+        }
+
+        if ([value isKindOfClass:[NSArray class]]) {
+            return boundedArray(value, keyPath, depth, bounding);
+        }
+        else {
+            return boundedDictionary(value, keyPath, depth, bounding);
+        }
+    }
+    else {
+        // Numbers, dates, and anything else that isn’t variable-length
+        return addBytes(bounding, sizeof(double)) ? value : nil;
+    }
+}
+
+@end
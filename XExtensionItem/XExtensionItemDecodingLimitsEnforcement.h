@@ -0,0 +1,33 @@
+#import "XExtensionItemDecodingLimits.h"
+
+@interface XExtensionItemDecodingIssue ()
+
+- (instancetype)initWithKind:(XExtensionItemDecodingIssueKind)kind keyPath:(NSString *)keyPath limit:(NSUInteger)limit count:(NSUInteger)count NS_DESIGNATED_INITIALIZER;
+
+@end
+
+/**
+ Applies decoding limits. Used by `XExtensionItem`.
+ */
+@interface XExtensionItemDecodingLimits (Enforcement)
+
+/**
+ @param userInfo Incoming `userInfo` dictionary.
+ @param issues   Array that any issues are added to.
+
+ @return The dictionary with every limit applied: the same instance if it’s already within them, or an empty dictionary
+ if it’s too large.
+ */
+- (NSDictionary *)boundedUserInfo:(NSDictionary *)userInfo issues:(NSMutableArray *)issues;
+
+/**
+ @return `NO` if binary parameters of this size should be rejected without being parsed, in which case an issue is added.
+ */
+- (BOOL)acceptsBinaryParametersOfLength:(NSUInteger)length keyPath:(NSString *)keyPath issues:(NSMutableArray *)issues;
+
+/**
+ @return Tags truncated to `maximumTagCount`.
+ */
+- (NSArray *)boundedTags:(NSArray *)tags keyPath:(NSString *)keyPath issues:(NSMutableArray *)issues;
+
+@end
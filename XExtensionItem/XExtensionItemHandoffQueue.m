@@ -0,0 +1,655 @@
+#import "XExtensionItem.h"
+#import "XExtensionItemArchivedClasses.h"
+#import "XExtensionItemBinaryCoder.h"
+#import "XExtensionItemHandoffQueue.h"
+#import <MobileCoreServices/MobileCoreServices.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+NSString * const XExtensionItemHandoffQueueUnencodableKeysErrorKey = @"XExtensionItemHandoffQueueUnencodableKeys";
+
+static NSString * const DefaultDirectoryName = @"XExtensionItemHandoffQueue";
+static NSString * const LogFileName = @"queue.log";
+static NSString * const AttachmentsDirectoryName = @"Attachments";
+
+/*
+ Every record is a 32-bit little-endian payload length, followed by a 32-bit little-endian checksum of the payload,
+ followed by the payload: a dictionary written by `XExtensionItemBinaryCoder`.
+ */
+static NSUInteger const RecordHeaderLength = 2 * sizeof(uint32_t);
+
+/*
+ How long an attachments directory that no record refers to is kept. Enqueues copy attachments before appending their
+ record, without holding the lock, so a recent one may belong to an enqueue that is still in progress.
+ */
+static NSTimeInterval const AbandonedAttachmentsGracePeriod = 24 * 60 * 60;
+
+static NSString * const RecordKeyType = @"type";
+static NSString * const RecordKeyIdentifier = @"identifier";
+static NSString * const RecordKeyEnqueueDate = @"enqueue-date";
+static NSString * const RecordKeyTitle = @"title";
+static NSString * const RecordKeyContentText = @"content-text";
+static NSString * const RecordKeyUserInfo = @"user-info";
+static NSString * const RecordKeyAttachments = @"attachments";
+
+static NSString * const RecordTypeEntry = @"entry";
+static NSString * const RecordTypeRemoval = @"removal";
+
+static NSString * const AttachmentKeyFileName = @"file-name";
+static NSString * const AttachmentKeyTypeIdentifier = @"type-identifier";
+static NSString * const AttachmentKeyArchived = @"archived";
+
+@interface XExtensionItemHandoffEntry ()
+
+@property (nonatomic, copy) NSString *identifier;
+@property (nonatomic) NSDate *enqueueDate;
+@property (nonatomic) XExtensionItem *extensionItem;
+@property (nonatomic, copy) NSArray *attachmentFileURLs;
+
+@end
+
+@implementation XExtensionItemHandoffEntry
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"%@ { identifier: %@, enqueueDate: %@, extensionItem: %@ }",
+            [super description], self.identifier, self.enqueueDate, self.extensionItem];
+}
+
+@end
+
+@interface XExtensionItemHandoffQueue ()
+
+@property (nonatomic) NSURL *logFileURL;
+@property (nonatomic) NSURL *attachmentsDirectoryURL;
+@property (nonatomic) dispatch_queue_t writeQueue;
+
+@end
+
+@implementation XExtensionItemHandoffQueue
+
+#pragma mark - Initialization
+
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL {
+    NSParameterAssert(directoryURL.isFileURL);
+
+    self = [super init];
+    if (self) {
+        _directoryURL = [directoryURL copy];
+        _logFileURL = [directoryURL URLByAppendingPathComponent:LogFileName isDirectory:NO];
+        _attachmentsDirectoryURL = [directoryURL URLByAppendingPathComponent:AttachmentsDirectoryName isDirectory:YES];
+        _writeQueue = dispatch_queue_create("com.tumblr.XExtensionItem.HandoffQueue",
+                                            dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_USER_INITIATED, 0));
+    }
+
+    return self;
+}
+
+- (instancetype)initWithApplicationGroupIdentifier:(NSString *)applicationGroupIdentifier {
+    NSParameterAssert(applicationGroupIdentifier);
+
+    NSURL *containerURL = [[NSFileManager defaultManager] containerURLForSecurityApplicationGroupIdentifier:applicationGroupIdentifier];
+
+    return [self initWithDirectoryURL:[containerURL URLByAppendingPathComponent:DefaultDirectoryName isDirectory:YES]];
+}
+
+- (instancetype)init {
+    return [self initWithDirectoryURL:nil];
+}
+
+#pragma mark - XExtensionItemHandoffQueue
+
+- (void)enqueueExtensionItem:(XExtensionItem *)extensionItem
+    preferredTypeIdentifiers:(NSArray *)preferredTypeIdentifiers
+           completionHandler:(XExtensionItemHandoffCompletionHandler)completionHandler {
+    NSParameterAssert(extensionItem);
+    NSParameterAssert(preferredTypeIdentifiers);
+
+    // Checked before any attachments are copied, since an entry missing some of its parameters isn’t the original item
+    NSError *userInfoError;
+    NSData *userInfoData = encodedUserInfo(extensionItem, &userInfoError);
+
+    if (userInfoError) {
+        if (completionHandler) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completionHandler(nil, userInfoError);
+            });
+        }
+
+        return;
+    }
+
+    NSString *identifier = [NSUUID UUID].UUIDString;
+    NSURL *entryDirectoryURL = [self.attachmentsDirectoryURL URLByAppendingPathComponent:identifier isDirectory:YES];
+
+    XExtensionItemAttachmentLoader *loader = [[XExtensionItemAttachmentLoader alloc] initWithItemProviders:extensionItem.attachments
+                                                                                  preferredTypeIdentifiers:preferredTypeIdentifiers];
+    loader.callbackQueue = self.writeQueue;
+
+    // Only touched on the write queue
+    NSMutableDictionary *attachmentsByIndex = [[NSMutableDictionary alloc] init];
+    __block NSError *attachmentError;
+
+    [loader loadWithResultHandler:^(XExtensionItemAttachmentLoadResult *result) {
+        if (attachmentError) {
+            return;
+        }
+
+        // Copied as soon as each attachment loads, so that at most one loaded item per concurrent load is held in memory
+        NSError *error;
+        NSDictionary *attachment = copyAttachment(result, entryDirectoryURL, &error);
+
+        if (attachment) {
+            attachmentsByIndex[@(result.index)] = attachment;
+        }
+        else {
+            attachmentError = error;
+        }
+    } completionHandler:^(NSArray *results, NSTimeInterval duration) {
+        NSError *error = attachmentError;
+        XExtensionItemHandoffEntry *entry;
+
+        if (!error) {
+            NSArray *attachments = [attachmentsByIndex objectsForKeys:[attachmentsByIndex.allKeys sortedArrayUsingSelector:@selector(compare:)]
+                                                       notFoundMarker:[NSNull null]];
+            NSDictionary *record = entryRecord(identifier, extensionItem, userInfoData, attachments);
+
+            if ([self appendRecord:record error:&error]) {
+                entry = [self entryWithRecord:record];
+            }
+        }
+
+        // The entry’s record was never appended, so nothing refers to its attachments
+        if (!entry) {
+            [[NSFileManager defaultManager] removeItemAtURL:entryDirectoryURL error:nil];
+        }
+
+        if (completionHandler) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completionHandler(entry, error);
+            });
+        }
+    }];
+}
+
+- (NSArray *)pendingEntries {
+    __block NSArray *records;
+
+    [self performWithLockedLog:^BOOL(int fileDescriptor, NSError **error) {
+        records = pendingEntryRecords(readRecords(fileDescriptor, NULL, error));
+        return records != nil;
+    } error:nil];
+
+    NSMutableArray *entries = [[NSMutableArray alloc] initWithCapacity:records.count];
+
+    for (NSDictionary *record in records) {
+        XExtensionItemHandoffEntry *entry = [self entryWithRecord:record];
+
+        if (entry) {
+            [entries addObject:entry];
+        }
+    }
+
+    return [entries copy];
+}
+
+- (BOOL)removeEntry:(XExtensionItemHandoffEntry *)entry error:(NSError **)error {
+    NSParameterAssert(entry);
+
+    NSString *identifier = entry.identifier;
+
+    return [self performWithLockedLog:^BOOL(int fileDescriptor, NSError **error) {
+        off_t validLength;
+        NSArray *records = pendingEntryRecords(readRecords(fileDescriptor, &validLength, error));
+
+        if (!records) {
+            return NO;
+        }
+
+        NSFileManager *fileManager = [NSFileManager defaultManager];
+
+        if (![[records valueForKey:RecordKeyIdentifier] containsObject:identifier]) {
+            [fileManager removeItemAtURL:[self.attachmentsDirectoryURL URLByAppendingPathComponent:identifier isDirectory:YES] error:nil];
+            return YES;
+        }
+
+        if (records.count == 1) {
+            // Once the last entry is removed, the log is emptied rather than appended to, so that it doesn’t grow forever
+            if (ftruncate(fileDescriptor, 0) != 0 || fsync(fileDescriptor) != 0) {
+                return setPOSIXError(error);
+            }
+
+            [fileManager removeItemAtURL:[self.attachmentsDirectoryURL URLByAppendingPathComponent:identifier isDirectory:YES] error:nil];
+            removeAbandonedAttachments(self.attachmentsDirectoryURL);
+            return YES;
+        }
+
+        if (!appendRecordToLog(fileDescriptor, validLength, @{ RecordKeyType: RecordTypeRemoval, RecordKeyIdentifier: identifier }, error)) {
+            return NO;
+        }
+
+        [fileManager removeItemAtURL:[self.attachmentsDirectoryURL URLByAppendingPathComponent:identifier isDirectory:YES] error:nil];
+        return YES;
+    } error:error];
+}
+
+- (NSUInteger)drainWithHandler:(XExtensionItemHandoffDrainHandler)handler {
+    NSParameterAssert(handler);
+
+    NSUInteger removedCount = 0;
+
+    // The log isn’t locked while the handler runs, so that extensions can keep enqueueing in the meantime
+    for (XExtensionItemHandoffEntry *entry in [self pendingEntries]) {
+        if (handler(entry) && [self removeEntry:entry error:nil]) {
+            removedCount++;
+        }
+    }
+
+    return removedCount;
+}
+
+#pragma mark - Private
+
+- (BOOL)appendRecord:(NSDictionary *)record error:(NSError **)error {
+    return [self performWithLockedLog:^BOOL(int fileDescriptor, NSError **error) {
+        off_t validLength;
+
+        if (!readRecords(fileDescriptor, &validLength, error)) {
+            return NO;
+        }
+
+        return appendRecordToLog(fileDescriptor, validLength, record, error);
+    } error:error];
+}
+
+/*
+ Calls the block with the log open and exclusively locked. The lock is an advisory `flock`, which excludes other threads
+ and other processes (i.e. the extension and its containing application) alike.
+ */
+- (BOOL)performWithLockedLog:(BOOL (^)(int fileDescriptor, NSError **error))block error:(NSError **)error {
+    if (![[NSFileManager defaultManager] createDirectoryAtURL:self.directoryURL withIntermediateDirectories:YES attributes:nil error:error]) {
+        return NO;
+    }
+
+    int fileDescriptor = open(self.logFileURL.fileSystemRepresentation, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+    if (fileDescriptor < 0) {
+        return setPOSIXError(error);
+    }
+
+    if (flock(fileDescriptor, LOCK_EX) != 0) {
+        BOOL success = setPOSIXError(error);
+        close(fileDescriptor);
+        return success;
+    }
+
+    BOOL success = block(fileDescriptor, error);
+
+    flock(fileDescriptor, LOCK_UN);
+    close(fileDescriptor);
+
+    return success;
+}
+
+- (XExtensionItemHandoffEntry *)entryWithRecord:(NSDictionary *)record {
+    NSString *identifier = valueOfClass(record[RecordKeyIdentifier], [NSString class]);
+
+    if (!identifier) {
+        return nil;
+    }
+
+    NSURL *entryDirectoryURL = [self.attachmentsDirectoryURL URLByAppendingPathComponent:identifier isDirectory:YES];
+    NSMutableArray *attachmentFileURLs = [[NSMutableArray alloc] init];
+    NSMutableArray *itemProviders = [[NSMutableArray alloc] init];
+
+    for (NSDictionary *attachment in valueOfClass(record[RecordKeyAttachments], [NSArray class])) {
+        NSString *fileName = valueOfClass(attachment, [NSDictionary class])[AttachmentKeyFileName];
+        NSString *typeIdentifier = attachment[AttachmentKeyTypeIdentifier];
+
+        if (![fileName isKindOfClass:[NSString class]] || ![typeIdentifier isKindOfClass:[NSString class]]) {
+            continue;
+        }
+
+        NSURL *fileURL = [entryDirectoryURL URLByAppendingPathComponent:fileName isDirectory:NO];
+        [attachmentFileURLs addObject:fileURL];
+
+        if ([attachment[AttachmentKeyArchived] boolValue]) {
+            NSItemProvider *itemProvider = [[NSItemProvider alloc] init];
+
+            // Not unarchived until it’s loaded
+            [itemProvider registerItemForTypeIdentifier:typeIdentifier loadHandler:^(NSItemProviderCompletionHandler completionHandler, Class expectedClass, NSDictionary *options) {
+                NSError *error;
+                id item = unarchivedAttachmentItem(fileURL, &error);
+
+                completionHandler(item, error);
+            }];
+
+            [itemProviders addObject:itemProvider];
+        }
+        else {
+            [itemProviders addObject:[[XExtensionItemStreamingAttachment alloc] initWithFileURL:fileURL typeIdentifier:typeIdentifier].itemProvider];
+        }
+    }
+
+    NSExtensionItem *item = [[NSExtensionItem alloc] init];
+
+    // As with `XExtensionItemSource`, `userInfo` has to be set before the properties that are stored in it
+    item.userInfo = [XExtensionItemBinaryCoder dictionaryWithData:valueOfClass(record[RecordKeyUserInfo], [NSData class])];
+
+    NSString *title = valueOfClass(record[RecordKeyTitle], [NSString class]);
+    item.attributedTitle = title ? [[NSAttributedString alloc] initWithString:title] : nil;
+
+    NSData *contentText = valueOfClass(record[RecordKeyContentText], [NSData class]);
+    item.attributedContentText = contentText ? valueOfClass([NSKeyedUnarchiver unarchivedObjectOfClasses:archivedClasses() fromData:contentText error:nil],
+                                                            [NSAttributedString class]) : nil;
+
+    item.attachments = itemProviders;
+
+    XExtensionItemHandoffEntry *entry = [[XExtensionItemHandoffEntry alloc] init];
+    entry.identifier = identifier;
+    entry.enqueueDate = valueOfClass(record[RecordKeyEnqueueDate], [NSDate class]);
+    entry.extensionItem = [[XExtensionItem alloc] initWithExtensionItem:item];
+    entry.attachmentFileURLs = attachmentFileURLs;
+
+    return entry;
+}
+
+static id valueOfClass(id value, Class class) {
+    return [value isKindOfClass:class] ? value : nil;
+}
+
+static BOOL setPOSIXError(NSError **error) {
+    if (error) {
+        *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+    }
+
+    return NO;
+}
+
+static NSDictionary *entryRecord(NSString *identifier, XExtensionItem *extensionItem, NSData *userInfoData, NSArray *attachments) {
+    NSMutableDictionary *record = [@{
+        RecordKeyType: RecordTypeEntry,
+        RecordKeyIdentifier: identifier,
+        RecordKeyEnqueueDate: [NSDate date],
+        RecordKeyAttachments: attachments,
+    } mutableCopy];
+
+    record[RecordKeyTitle] = extensionItem.title;
+
+    if (extensionItem.attributedContentText) {
+        record[RecordKeyContentText] = [NSKeyedArchiver archivedDataWithRootObject:extensionItem.attributedContentText requiringSecureCoding:YES error:nil];
+    }
+
+    record[RecordKeyUserInfo] = userInfoData;
+
+    return [record copy];
+}
+
+/*
+ The item’s `userInfo`, without the values that are stored separately. Sets `error` if any value can’t be encoded.
+ */
+static NSData *encodedUserInfo(XExtensionItem *extensionItem, NSError **error) {
+    NSMutableDictionary *userInfo = [extensionItem.userInfo mutableCopy];
+
+    for (NSString *key in @[NSExtensionItemAttributedTitleKey, NSExtensionItemAttributedContentTextKey, NSExtensionItemAttachmentsKey]) {
+        [userInfo removeObjectForKey:key];
+    }
+
+    NSArray *unencodableKeys;
+    NSData *data = [XExtensionItemBinaryCoder dataWithDictionary:userInfo unencodableKeys:&unencodableKeys];
+
+    if (unencodableKeys.count > 0) {
+        if (error) {
+            NSString *description = [NSString stringWithFormat:@"The values for %@ can’t be stored in a handoff queue.",
+                                     [unencodableKeys componentsJoinedByString:@", "]];
+
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSCoderInvalidValueError userInfo:@{
+                NSLocalizedDescriptionKey: description,
+                XExtensionItemHandoffQueueUnencodableKeysErrorKey: unencodableKeys
+            }];
+        }
+
+        return nil;
+    }
+
+    return data;
+}
+
+/*
+ Copies a loaded attachment into the entry’s directory: file URLs as the file itself, data as a file, and anything else
+ (e.g. web URLs, strings, and images) archived.
+ */
+static NSDictionary *copyAttachment(XExtensionItemAttachmentLoadResult *result, NSURL *entryDirectoryURL, NSError **error) {
+    if (!result.item) {
+        if (error) {
+            *error = result.error ?: [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadUnknownError userInfo:nil];
+        }
+
+        return nil;
+    }
+
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+
+    if (![fileManager createDirectoryAtURL:entryDirectoryURL withIntermediateDirectories:YES attributes:nil error:error]) {
+        return nil;
+    }
+
+    id item = result.item;
+    BOOL archived = !([item isKindOfClass:[NSURL class]] && ((NSURL *)item).isFileURL) && ![item isKindOfClass:[NSData class]];
+
+    NSString *fileName = [NSString stringWithFormat:@"%lu", (unsigned long)result.index];
+    NSString *pathExtension = archived ? nil : (__bridge_transfer NSString *)UTTypeCopyPreferredTagWithClass((__bridge CFStringRef)result.typeIdentifier, kUTTagClassFilenameExtension);
+
+    if (pathExtension) {
+        fileName = [fileName stringByAppendingPathExtension:pathExtension];
+    }
+
+    NSURL *fileURL = [entryDirectoryURL URLByAppendingPathComponent:fileName isDirectory:NO];
+    BOOL copied;
+
+    if ([item isKindOfClass:[NSURL class]] && !archived) {
+        copied = [fileManager copyItemAtURL:item toURL:fileURL error:error];
+    }
+    else {
+        NSData *data = archived ? [NSKeyedArchiver archivedDataWithRootObject:item requiringSecureCoding:YES error:error] : item;
+        copied = data && [data writeToURL:fileURL options:NSDataWritingAtomic error:error];
+    }
+
+    if (!copied) {
+        return nil;
+    }
+
+    return @{
+        AttachmentKeyFileName: fileName,
+        AttachmentKeyTypeIdentifier: result.typeIdentifier,
+        AttachmentKeyArchived: @(archived),
+    };
+}
+
+/*
+ Removes attachments left behind by enqueues that never finished. Only called once the log is empty, so no record refers
+ to any of the remaining directories.
+ */
+static void removeAbandonedAttachments(NSURL *attachmentsDirectoryURL) {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSDate *cutoffDate = [NSDate dateWithTimeIntervalSinceNow:-AbandonedAttachmentsGracePeriod];
+
+    for (NSURL *entryDirectoryURL in [fileManager contentsOfDirectoryAtURL:attachmentsDirectoryURL
+                                                includingPropertiesForKeys:@[NSURLContentModificationDateKey]
+                                                                   options:0
+                                                                     error:nil]) {
+        NSDate *modificationDate;
+        [entryDirectoryURL getResourceValue:&modificationDate forKey:NSURLContentModificationDateKey error:nil];
+
+        if (modificationDate && [modificationDate compare:cutoffDate] == NSOrderedAscending) {
+            [fileManager removeItemAtURL:entryDirectoryURL error:nil];
+        }
+    }
+}
+
+static id unarchivedAttachmentItem(NSURL *fileURL, NSError **error) {
+    NSData *data = [NSData dataWithContentsOfURL:fileURL options:0 error:error];
+
+    return data ? [NSKeyedUnarchiver unarchivedObjectOfClasses:archivedClasses() fromData:data error:error] : nil;
+}
+
+/*
+ 32-bit FNV-1a. Records only need to be checked for torn and partial writes, not tampering.
+ */
+static uint32_t checksumOfBytes(const uint8_t *bytes, NSUInteger length) {
+    uint32_t hash = 2166136261u;
+
+    for (NSUInteger i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/*
+ Reads every complete record from the start of the log. Reading stops at the first record that is incomplete, fails its
+ checksum, or can’t be decoded, since that (and anything after it) can only have been left by a write that didn’t finish.
+
+ Returns `nil` only if the log couldn’t be read at all. If `validLength` is non-`NULL`, it’s set to the length of the
+ records that were read, which is where the next record should be written.
+ */
+static NSArray *readRecords(int fileDescriptor, off_t *validLength, NSError **error) {
+    struct stat fileStatus;
+
+    if (fstat(fileDescriptor, &fileStatus) != 0) {
+        setPOSIXError(error);
+        return nil;
+    }
+
+    NSMutableData *data = [[NSMutableData alloc] initWithLength:(NSUInteger)fileStatus.st_size];
+    NSUInteger length = 0;
+
+    while (length < data.length) {
+        ssize_t bytesRead = pread(fileDescriptor, (uint8_t *)data.mutableBytes + length, data.length - length, (off_t)length);
+
+        if (bytesRead < 0) {
+            setPOSIXError(error);
+            return nil;
+        }
+        else if (bytesRead == 0) {
+            break;
+        }
+
+        length += (NSUInteger)bytesRead;
+    }
+
+    const uint8_t *bytes = data.bytes;
+    NSMutableArray *records = [[NSMutableArray alloc] init];
+    NSUInteger offset = 0;
+
+    while (length - offset >= RecordHeaderLength) {
+        uint32_t payloadLength, checksum;
+        memcpy(&payloadLength, bytes + offset, sizeof(uint32_t));
+        memcpy(&checksum, bytes + offset + sizeof(uint32_t), sizeof(uint32_t));
+        payloadLength = CFSwapInt32LittleToHost(payloadLength);
+        checksum = CFSwapInt32LittleToHost(checksum);
+
+        if (payloadLength > length - offset - RecordHeaderLength) {
+            break;
+        }
+
+        NSRange payloadRange = NSMakeRange(offset + RecordHeaderLength, payloadLength);
+
+        if (checksumOfBytes(bytes + payloadRange.location, payloadRange.length) != checksum) {
+            break;
+        }
+
+        NSDictionary *record = [XExtensionItemBinaryCoder dictionaryWithData:[data subdataWithRange:payloadRange]];
+
+        if (!record) {
+            break;
+        }
+
+        [records addObject:record];
+        offset = NSMaxRange(payloadRange);
+    }
+
+    if (validLength) {
+        *validLength = (off_t)offset;
+    }
+
+    return [records copy];
+}
+
+/*
+ Entry records that haven’t been followed by a removal record, in the order in which they were appended.
+ */
+static NSArray *pendingEntryRecords(NSArray *records) {
+    if (!records) {
+        return nil;
+    }
+
+    NSMutableSet *removedIdentifiers = [[NSMutableSet alloc] init];
+
+    for (NSDictionary *record in records) {
+        if ([record[RecordKeyType] isEqual:RecordTypeRemoval] && record[RecordKeyIdentifier]) {
+            [removedIdentifiers addObject:record[RecordKeyIdentifier]];
+        }
+    }
+
+    NSMutableArray *entryRecords = [[NSMutableArray alloc] init];
+
+    for (NSDictionary *record in records) {
+        if ([record[RecordKeyType] isEqual:RecordTypeEntry] && ![removedIdentifiers containsObject:record[RecordKeyIdentifier]]) {
+            [entryRecords addObject:record];
+        }
+    }
+
+    return [entryRecords copy];
+}
+
+/*
+ Writes a record at `validLength`, first discarding anything after it (i.e. a partly written record left behind by a
+ crash), and flushes it to disk. Until the write completes, the record fails its checksum and is ignored by readers.
+ */
+static BOOL appendRecordToLog(int fileDescriptor, off_t validLength, NSDictionary *record, NSError **error) {
+    NSData *payload = [XExtensionItemBinaryCoder dataWithDictionary:record unencodableKeys:NULL];
+
+    if (!payload || payload.length > UINT32_MAX) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileWriteUnknownError userInfo:nil];
+        }
+
+        return NO;
+    }
+
+    uint32_t header[2] = {
+        CFSwapInt32HostToLittle((uint32_t)payload.length),
+        CFSwapInt32HostToLittle(checksumOfBytes(payload.bytes, payload.length)),
+    };
+
+    NSMutableData *recordData = [[NSMutableData alloc] initWithBytes:header length:RecordHeaderLength];
+    [recordData appendData:payload];
+
+    if (ftruncate(fileDescriptor, validLength) != 0) {
+        return setPOSIXError(error);
+    }
+
+    for (NSUInteger bytesWritten = 0; bytesWritten < recordData.length;) {
+        ssize_t result = pwrite(fileDescriptor, (const uint8_t *)recordData.bytes + bytesWritten, recordData.length - bytesWritten,
+                                validLength + (off_t)bytesWritten);
+
+        if (result < 0) {
+            return setPOSIXError(error);
+        }
+
+        bytesWritten += (NSUInteger)result;
+    }
+
+    if (fsync(fileDescriptor) != 0) {
+        return setPOSIXError(error);
+    }
+
+    return YES;
+}
+
+@end
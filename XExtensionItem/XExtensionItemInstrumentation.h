@@ -0,0 +1,48 @@
+#import "XExtensionItemMetrics.h"
+#import <stdatomic.h>
+
+/*
+ Helpers used to instrument the library’s hot paths. Each checks whether a sink is installed first, so that with none
+ installed (the default) a span or counter costs a single atomic load and branch.
+ */
+
+extern atomic_bool XExtensionItemMetricsSinkInstalled;
+
+/*
+ Returns a strong reference to the installed sink, or `nil`. Takes a lock, so only call it once `metricsEnabled` is true.
+ */
+id <XExtensionItemMetricsSink> XExtensionItemMetricsCurrentSink(void);
+
+uint64_t XExtensionItemMetricsNextSpanIdentifier(void);
+
+static inline BOOL metricsEnabled(void) {
+    return atomic_load_explicit(&XExtensionItemMetricsSinkInstalled, memory_order_relaxed);
+}
+
+/*
+ Returns the span’s identifier, to be passed to `metricsEndSpan`, or `0` if instrumentation is disabled.
+ */
+static inline uint64_t metricsBeginSpan(NSString *name) {
+    id <XExtensionItemMetricsSink> sink = metricsEnabled() ? XExtensionItemMetricsCurrentSink() : nil;
+
+    if (!sink) {
+        return 0;
+    }
+
+    uint64_t identifier = XExtensionItemMetricsNextSpanIdentifier();
+    [sink beginSpan:name identifier:identifier];
+
+    return identifier;
+}
+
+static inline void metricsEndSpan(NSString *name, uint64_t identifier) {
+    if (identifier != 0) {
+        [XExtensionItemMetricsCurrentSink() endSpan:name identifier:identifier];
+    }
+}
+
+static inline void metricsRecordCounter(NSString *name, int64_t value) {
+    if (metricsEnabled()) {
+        [XExtensionItemMetricsCurrentSink() recordCounter:name value:value];
+    }
+}
@@ -0,0 +1,52 @@
+#import "XExtensionItemInstrumentation.h"
+#import <stdatomic.h>
+
+NSString * const XExtensionItemMetricsSpanActivityItemBlock = @"activity-item-block";
+NSString * const XExtensionItemMetricsSpanThumbnailProvider = @"thumbnail-provider";
+NSString * const XExtensionItemMetricsSpanItemForActivityType = @"item-for-activity-type";
+NSString * const XExtensionItemMetricsSpanPreparation = @"preparation";
+NSString * const XExtensionItemMetricsSpanDecoding = @"decoding";
+NSString * const XExtensionItemMetricsSpanAttachmentLoad = @"attachment-load";
+
+NSString * const XExtensionItemMetricsCounterPayloadKeyCount = @"payload-key-count";
+NSString * const XExtensionItemMetricsCounterAttachmentCount = @"attachment-count";
+NSString * const XExtensionItemMetricsCounterBytes = @"bytes";
+NSString * const XExtensionItemMetricsCounterDeduplicatedBytes = @"deduplicated-bytes";
+
+atomic_bool XExtensionItemMetricsSinkInstalled;
+
+/*
+ Only accessed while synchronized on `XExtensionItemMetrics`, since it may be replaced on one thread while another is
+ sending it an event. `XExtensionItemMetricsSinkInstalled` mirrors whether it’s set, so that hot paths don’t take the lock
+ when no sink is installed.
+ */
+static id <XExtensionItemMetricsSink> installedSink;
+
+static atomic_uint_fast64_t lastSpanIdentifier;
+
+id <XExtensionItemMetricsSink> XExtensionItemMetricsCurrentSink(void) {
+    @synchronized ([XExtensionItemMetrics class]) {
+        return installedSink;
+    }
+}
+
+uint64_t XExtensionItemMetricsNextSpanIdentifier(void) {
+    return (uint64_t)atomic_fetch_add_explicit(&lastSpanIdentifier, 1, memory_order_relaxed) + 1;
+}
+
+@implementation XExtensionItemMetrics
+
+#pragma mark - XExtensionItemMetrics
+
++ (id <XExtensionItemMetricsSink>)sink {
+    return XExtensionItemMetricsCurrentSink();
+}
+
++ (void)setSink:(id <XExtensionItemMetricsSink>)sink {
+    @synchronized ([XExtensionItemMetrics class]) {
+        installedSink = sink;
+        atomic_store_explicit(&XExtensionItemMetricsSinkInstalled, sink != nil, memory_order_relaxed);
+    }
+}
+
+@end
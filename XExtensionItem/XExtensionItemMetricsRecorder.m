@@ -0,0 +1,149 @@
+#import "XExtensionItemMetricsRecorder.h"
+
+@interface XExtensionItemMetricsEvent ()
+
+@property (nonatomic) XExtensionItemMetricsEventType type;
+@property (nonatomic, copy) NSString *name;
+@property (nonatomic) uint64_t identifier;
+@property (nonatomic) int64_t value;
+@property (nonatomic) NSTimeInterval timestamp;
+
+@end
+
+@implementation XExtensionItemMetricsEvent
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"%@ { type: %ld, name: %@, identifier: %llu, value: %lld, timestamp: %.6f }",
+            [super description], (long)self.type, self.name, self.identifier, self.value, self.timestamp];
+}
+
+@end
+
+@interface XExtensionItemMetricsRecorder ()
+
+@property (nonatomic) NSMutableArray *mutableEvents;
+
+@end
+
+@implementation XExtensionItemMetricsRecorder
+
+#pragma mark - Initialization
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _mutableEvents = [[NSMutableArray alloc] init];
+    }
+
+    return self;
+}
+
+#pragma mark - XExtensionItemMetricsSink
+
+- (void)beginSpan:(NSString *)name identifier:(uint64_t)identifier {
+    [self recordEventWithType:XExtensionItemMetricsEventTypeBeginSpan name:name identifier:identifier value:0];
+}
+
+- (void)endSpan:(NSString *)name identifier:(uint64_t)identifier {
+    [self recordEventWithType:XExtensionItemMetricsEventTypeEndSpan name:name identifier:identifier value:0];
+}
+
+- (void)recordCounter:(NSString *)name value:(int64_t)value {
+    [self recordEventWithType:XExtensionItemMetricsEventTypeCounter name:name identifier:0 value:value];
+}
+
+#pragma mark - XExtensionItemMetricsRecorder
+
+- (NSArray *)events {
+    @synchronized (self) {
+        return [self.mutableEvents copy];
+    }
+}
+
+- (NSArray *)completedSpanNames {
+    NSMutableArray *names = [[NSMutableArray alloc] init];
+
+    for (NSArray *span in [self completedSpanEventPairs]) {
+        [names addObject:[span.firstObject name]];
+    }
+
+    return [names copy];
+}
+
+- (NSArray *)durationsForSpan:(NSString *)name {
+    NSMutableArray *durations = [[NSMutableArray alloc] init];
+
+    for (NSArray *span in [self completedSpanEventPairs]) {
+        XExtensionItemMetricsEvent *beginEvent = span.firstObject;
+        XExtensionItemMetricsEvent *endEvent = span.lastObject;
+
+        if ([beginEvent.name isEqualToString:name]) {
+            [durations addObject:@(endEvent.timestamp - beginEvent.timestamp)];
+        }
+    }
+
+    return [durations copy];
+}
+
+- (int64_t)totalForCounter:(NSString *)name {
+    int64_t total = 0;
+
+    for (XExtensionItemMetricsEvent *event in self.events) {
+        if (event.type == XExtensionItemMetricsEventTypeCounter && [event.name isEqualToString:name]) {
+            total += event.value;
+        }
+    }
+
+    return total;
+}
+
+- (void)removeAllEvents {
+    @synchronized (self) {
+        [self.mutableEvents removeAllObjects];
+    }
+}
+
+#pragma mark - Private
+
+- (void)recordEventWithType:(XExtensionItemMetricsEventType)type name:(NSString *)name identifier:(uint64_t)identifier value:(int64_t)value {
+    XExtensionItemMetricsEvent *event = [[XExtensionItemMetricsEvent alloc] init];
+    event.type = type;
+    event.name = name;
+    event.identifier = identifier;
+    event.value = value;
+    event.timestamp = [NSProcessInfo processInfo].systemUptime;
+
+    @synchronized (self) {
+        [self.mutableEvents addObject:event];
+    }
+}
+
+/*
+ `[begin, end]` event pairs of completed spans, in the order that they began.
+ */
+- (NSArray *)completedSpanEventPairs {
+    NSArray *events = self.events;
+    NSMutableDictionary *endEventsByIdentifier = [[NSMutableDictionary alloc] init];
+
+    for (XExtensionItemMetricsEvent *event in events) {
+        if (event.type == XExtensionItemMetricsEventTypeEndSpan) {
+            endEventsByIdentifier[@(event.identifier)] = event;
+        }
+    }
+
+    NSMutableArray *pairs = [[NSMutableArray alloc] init];
+
+    for (XExtensionItemMetricsEvent *event in events) {
+        XExtensionItemMetricsEvent *endEvent = endEventsByIdentifier[@(event.identifier)];
+
+        if (event.type == XExtensionItemMetricsEventTypeBeginSpan && endEvent) {
+            [pairs addObject:@[event, endEvent]];
+        }
+    }
+
+    return [pairs copy];
+}
+
+@end
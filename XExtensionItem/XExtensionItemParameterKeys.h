@@ -0,0 +1,23 @@
+#import <Foundation/Foundation.h>
+
+/*
+ Keys used inside the `x-extension-item` dictionary. Shared between `XExtensionItemSource`, which writes them, and 
+ `XExtensionItem`/`XExtensionItemReferrer`, which read them.
+ */
+
+static NSString * const ParameterKeyXExtensionItem = @"x-extension-item";
+static NSString * const ParameterKeySourceURL = @"source-url";
+static NSString * const ParameterKeyTags = @"tags";
+
+static NSString * const ParameterKeyReferrerName = @"referrer-name";
+static NSString * const ParameterKeyReferrerAppStoreID = @"referrer-app-store-id";
+static NSString * const ParameterKeyReferrerGooglePlayID = @"referrer-google-play-id";
+static NSString * const ParameterKeyReferrerWebURL = @"referrer-web-url";
+static NSString * const ParameterKeyReferreriOSAppURL = @"referrer-ios-app-url";
+static NSString * const ParameterKeyReferrerAndroidAppURL = @"referrer-android-app-url";
+
+/*
+ Top-level `userInfo` key holding the compact binary encoding of the parameters, written alongside (or instead of) the
+ dictionary form. See `XExtensionItemBinaryCoder`.
+ */
+static NSString * const ParameterKeyXExtensionItemBinary = @"x-extension-item-binary";
@@ -0,0 +1,299 @@
+#import "XExtensionItemParameterSchema.h"
+#import <objc/runtime.h>
+
+/**
+ Everything needed to read and write a single field, resolved once when the schema is created so that encoding and
+ decoding never need to go through the runtime or KVC.
+ */
+typedef struct {
+    __unsafe_unretained NSString *key;
+    __unsafe_unretained id defaultValue;
+    __unsafe_unretained Class valueClass;
+    XExtensionItemParameterType type;
+    BOOL required;
+    Ivar ivar;
+    ptrdiff_t offset;
+} XExtensionItemResolvedField;
+
+@implementation XExtensionItemParameterField
+
+#pragma mark - Initialization
+
+- (instancetype)initWithKey:(NSString *)key
+               propertyName:(NSString *)propertyName
+                       type:(XExtensionItemParameterType)type
+                   required:(BOOL)required
+               defaultValue:(id)defaultValue {
+    self = [super init];
+    if (self) {
+        _key = [key copy];
+        _propertyName = [propertyName copy];
+        _type = type;
+        _required = required;
+        _defaultValue = defaultValue;
+    }
+
+    return self;
+}
+
+- (instancetype)init {
+    return [self initWithKey:nil propertyName:nil type:XExtensionItemParameterTypeString required:NO defaultValue:nil];
+}
+
++ (instancetype)optionalFieldWithKey:(NSString *)key propertyName:(NSString *)propertyName type:(XExtensionItemParameterType)type {
+    return [[self alloc] initWithKey:key propertyName:propertyName type:type required:NO defaultValue:nil];
+}
+
++ (instancetype)optionalFieldWithKey:(NSString *)key propertyName:(NSString *)propertyName type:(XExtensionItemParameterType)type defaultValue:(id)defaultValue {
+    return [[self alloc] initWithKey:key propertyName:propertyName type:type required:NO defaultValue:defaultValue];
+}
+
++ (instancetype)requiredFieldWithKey:(NSString *)key propertyName:(NSString *)propertyName type:(XExtensionItemParameterType)type {
+    return [[self alloc] initWithKey:key propertyName:propertyName type:type required:YES defaultValue:nil];
+}
+
+@end
+
+@interface XExtensionItemParameterSchema ()
+
+@property (nonatomic, copy) NSArray *fields;
+
+@end
+
+@implementation XExtensionItemParameterSchema {
+    XExtensionItemResolvedField *_resolvedFields;
+    NSUInteger _resolvedFieldCount;
+}
+
+#pragma mark - Initialization
+
++ (instancetype)schemaForClass:(Class)class {
+    static NSMapTable *schemasByClass;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        schemasByClass = [NSMapTable strongToStrongObjectsMapTable];
+    });
+
+    @synchronized (schemasByClass) {
+        XExtensionItemParameterSchema *schema = [schemasByClass objectForKey:class];
+
+        if (!schema) {
+            schema = [[self alloc] initWithClass:class];
+            [schemasByClass setObject:schema forKey:class];
+        }
+
+        return schema;
+    }
+}
+
+- (instancetype)initWithClass:(Class)class {
+    NSParameterAssert([class conformsToProtocol:@protocol(XExtensionItemSchemaParameters)]);
+
+    self = [super init];
+    if (self) {
+        _fields = [[(Class<XExtensionItemSchemaParameters>)class parameterFields] copy];
+        _resolvedFieldCount = _fields.count;
+        _resolvedFields = calloc(_resolvedFieldCount, sizeof(XExtensionItemResolvedField));
+
+        [_fields enumerateObjectsUsingBlock:^(XExtensionItemParameterField *field, NSUInteger index, BOOL *stop) {
+            _resolvedFields[index] = resolvedField(class, field);
+        }];
+    }
+
+    return self;
+}
+
+- (void)dealloc {
+    free(_resolvedFields);
+}
+
+#pragma mark - XExtensionItemParameterSchema
+
+- (BOOL)decodeDictionary:(NSDictionary *)dictionary intoObject:(id)object {
+    BOOL valid = YES;
+
+    for (NSUInteger index = 0; index < _resolvedFieldCount; index++) {
+        XExtensionItemResolvedField field = _resolvedFields[index];
+
+        id value = [dictionary objectForKey:field.key];
+
+        if (![value isKindOfClass:field.valueClass]) {
+            value = nil;
+        }
+
+        if (!value) {
+            if (field.required) {
+                valid = NO;
+            }
+
+            value = field.defaultValue;
+        }
+
+        switch (field.type) {
+            case XExtensionItemParameterTypeUnsignedInteger:
+                *(NSUInteger *)fieldPointer(object, field) = [value unsignedIntegerValue];
+                break;
+            case XExtensionItemParameterTypeBool:
+                *(BOOL *)fieldPointer(object, field) = [value boolValue];
+                break;
+            default:
+                // Matches the `copy` semantics of the initializers, and is free for the immutable values in a dictionary
+                object_setIvarWithStrongDefault(object, field.ivar, [value copy]);
+                break;
+        }
+    }
+
+    return valid;
+}
+
+- (NSDictionary *)dictionaryRepresentationOfObject:(id)object {
+    NSMutableDictionary *mutableDictionary = [[NSMutableDictionary alloc] initWithCapacity:_resolvedFieldCount];
+
+    for (NSUInteger index = 0; index < _resolvedFieldCount; index++) {
+        XExtensionItemResolvedField field = _resolvedFields[index];
+
+        id value = fieldValue(object, field);
+
+        if (value) {
+            mutableDictionary[field.key] = value;
+        }
+    }
+
+    return [mutableDictionary copy];
+}
+
+- (BOOL)isObject:(id)object equalToObject:(id)otherObject {
+    if (object == otherObject) {
+        return YES;
+    }
+
+    if (![otherObject isKindOfClass:[object class]]) {
+        return NO;
+    }
+
+    for (NSUInteger index = 0; index < _resolvedFieldCount; index++) {
+        XExtensionItemResolvedField field = _resolvedFields[index];
+
+        switch (field.type) {
+            case XExtensionItemParameterTypeUnsignedInteger:
+                if (*(NSUInteger *)fieldPointer(object, field) != *(NSUInteger *)fieldPointer(otherObject, field)) {
+                    return NO;
+                }
+                break;
+            case XExtensionItemParameterTypeBool:
+                if (!*(BOOL *)fieldPointer(object, field) != !*(BOOL *)fieldPointer(otherObject, field)) {
+                    return NO;
+                }
+                break;
+            default: {
+                id value = object_getIvar(object, field.ivar);
+                id otherValue = object_getIvar(otherObject, field.ivar);
+
+                if (value != otherValue && ![value isEqual:otherValue]) {
+                    return NO;
+                }
+                break;
+            }
+        }
+    }
+
+    return YES;
+}
+
+- (NSUInteger)hashOfObject:(id)object {
+    NSUInteger hash = 17;
+
+    for (NSUInteger index = 0; index < _resolvedFieldCount; index++) {
+        XExtensionItemResolvedField field = _resolvedFields[index];
+
+        NSUInteger fieldHash;
+
+        switch (field.type) {
+            case XExtensionItemParameterTypeUnsignedInteger:
+                fieldHash = *(NSUInteger *)fieldPointer(object, field);
+                break;
+            case XExtensionItemParameterTypeBool:
+                fieldHash = *(BOOL *)fieldPointer(object, field) ? 1 : 0;
+                break;
+            default:
+                fieldHash = [object_getIvar(object, field.ivar) hash];
+                break;
+        }
+
+        hash = hash * 31 + fieldHash;
+    }
+
+    return hash;
+}
+
+#pragma mark - Private
+
+static XExtensionItemResolvedField resolvedField(Class class, XExtensionItemParameterField *field) {
+    NSCParameterAssert(field.key);
+    NSCParameterAssert(field.propertyName);
+
+    Ivar ivar = class_getInstanceVariable(class, [@"_" stringByAppendingString:field.propertyName].UTF8String);
+    NSCAssert(ivar, @"%@ has no instance variable backing its “%@” property", class, field.propertyName);
+
+    const char *typeEncoding = ivar_getTypeEncoding(ivar);
+
+    switch (field.type) {
+        case XExtensionItemParameterTypeUnsignedInteger:
+            NSCAssert(strcmp(typeEncoding, @encode(NSUInteger)) == 0, @"“%@” is not an NSUInteger", field.propertyName);
+            break;
+        case XExtensionItemParameterTypeBool:
+            NSCAssert(strcmp(typeEncoding, @encode(BOOL)) == 0, @"“%@” is not a BOOL", field.propertyName);
+            break;
+        default:
+            NSCAssert(typeEncoding[0] == _C_ID, @"“%@” is not an object", field.propertyName);
+            break;
+    }
+
+    return (XExtensionItemResolvedField) {
+        .key = field.key,
+        .defaultValue = field.defaultValue,
+        .valueClass = valueClassForType(field.type),
+        .type = field.type,
+        .required = field.required,
+        .ivar = ivar,
+        .offset = ivar_getOffset(ivar),
+    };
+}
+
+static Class valueClassForType(XExtensionItemParameterType type) {
+    switch (type) {
+        case XExtensionItemParameterTypeString:
+            return [NSString class];
+        case XExtensionItemParameterTypeURL:
+            return [NSURL class];
+        case XExtensionItemParameterTypeArray:
+            return [NSArray class];
+        case XExtensionItemParameterTypeDictionary:
+            return [NSDictionary class];
+        case XExtensionItemParameterTypeData:
+            return [NSData class];
+        case XExtensionItemParameterTypeDate:
+            return [NSDate class];
+        case XExtensionItemParameterTypeNumber:
+        case XExtensionItemParameterTypeUnsignedInteger:
+        case XExtensionItemParameterTypeBool:
+            return [NSNumber class];
+    }
+}
+
+static void *fieldPointer(id object, XExtensionItemResolvedField field) {
+    return (uint8_t *)(__bridge void *)object + field.offset;
+}
+
+static id fieldValue(id object, XExtensionItemResolvedField field) {
+    switch (field.type) {
+        case XExtensionItemParameterTypeUnsignedInteger:
+            return @(*(NSUInteger *)fieldPointer(object, field));
+        case XExtensionItemParameterTypeBool:
+            return @(*(BOOL *)fieldPointer(object, field));
+        default:
+            return object_getIvar(object, field.ivar);
+    }
+}
+
+@end
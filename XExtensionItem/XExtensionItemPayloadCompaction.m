@@ -0,0 +1,382 @@
+#import "XExtensionItemPayloadCompaction.h"
+#import "XExtensionItemStreamingAttachment.h"
+#import <UIKit/UIKit.h>
+
+static NSUInteger const DefaultMinimumTranscodedByteCount = 64 * 1024;
+static NSString * const DefaultTruncationString = @"…";
+
+@interface XExtensionItemPayloadCompactionReport ()
+
+- (instancetype)initWithActivityType:(NSString *)activityType
+                          byteBudget:(unsigned long long)byteBudget
+                   originalByteCount:(unsigned long long)originalByteCount
+                           byteCount:(unsigned long long)byteCount
+                             actions:(NSArray *)actions NS_DESIGNATED_INITIALIZER;
+
+@end
+
+@implementation XExtensionItemPayloadCompactionAction
+
+#pragma mark - Initialization
+
+- (instancetype)initWithKind:(XExtensionItemPayloadCompactionActionKind)kind item:(id)item originalByteCount:(unsigned long long)originalByteCount byteCount:(unsigned long long)byteCount {
+    self = [super init];
+    if (self) {
+        _kind = kind;
+        _item = item;
+        _originalByteCount = originalByteCount;
+        _byteCount = byteCount;
+    }
+
+    return self;
+}
+
+- (instancetype)init {
+    return [self initWithKind:XExtensionItemPayloadCompactionActionKindDroppedAttachment item:nil originalByteCount:0 byteCount:0];
+}
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    static NSArray *kindNames;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        kindNames = @[@"dropped attachment", @"transcoded data", @"truncated text"];
+    });
+
+    return [NSString stringWithFormat:@"<%@: %p; %@, %llu → %llu bytes>", NSStringFromClass([self class]), self,
+            kindNames[self.kind], self.originalByteCount, self.byteCount];
+}
+
+@end
+
+@implementation XExtensionItemPayloadCompactionReport
+
+#pragma mark - Initialization
+
+- (instancetype)initWithActivityType:(NSString *)activityType byteBudget:(unsigned long long)byteBudget originalByteCount:(unsigned long long)originalByteCount byteCount:(unsigned long long)byteCount actions:(NSArray *)actions {
+    self = [super init];
+    if (self) {
+        _activityType = [activityType copy];
+        _byteBudget = byteBudget;
+        _originalByteCount = originalByteCount;
+        _byteCount = byteCount;
+        _actions = [actions copy];
+    }
+
+    return self;
+}
+
+- (instancetype)init {
+    return [self initWithActivityType:nil byteBudget:0 originalByteCount:0 byteCount:0 actions:@[]];
+}
+
+#pragma mark - XExtensionItemPayloadCompactionReport
+
+- (BOOL)isWithinBudget {
+    return self.byteCount <= self.byteBudget;
+}
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p; activityType: %@, %llu → %llu of %llu bytes, actions: %@>", NSStringFromClass([self class]), self,
+            self.activityType, self.originalByteCount, self.byteCount, self.byteBudget, self.actions];
+}
+
+@end
+
+@implementation XExtensionItemPayload
+
+#pragma mark - Initialization
+
+- (instancetype)initWithActivityType:(NSString *)activityType mainItem:(id)mainItem typeIdentifier:(NSString *)typeIdentifier additionalAttachments:(NSArray *)additionalAttachments attributedContentText:(NSAttributedString *)attributedContentText userInfo:(NSDictionary *)userInfo {
+    self = [super init];
+    if (self) {
+        _activityType = [activityType copy];
+        _mainItem = mainItem;
+        _typeIdentifier = [typeIdentifier copy];
+        _additionalAttachments = [additionalAttachments copy];
+        _attributedContentText = [attributedContentText copy];
+        _userInfo = [userInfo copy];
+    }
+
+    return self;
+}
+
+- (instancetype)init {
+    return [self initWithActivityType:nil mainItem:nil typeIdentifier:nil additionalAttachments:nil attributedContentText:nil userInfo:nil];
+}
+
+#pragma mark - XExtensionItemPayload
+
++ (unsigned long long)estimatedByteCountOfValue:(id)value {
+    if ([value isKindOfClass:[NSData class]]) {
+        return ((NSData *)value).length;
+    }
+    else if ([value isKindOfClass:[NSString class]]) {
+        return ((NSString *)value).length * sizeof(unichar);
+    }
+    else if ([value isKindOfClass:[NSAttributedString class]]) {
+        return ((NSAttributedString *)value).length * sizeof(unichar);
+    }
+    else if ([value isKindOfClass:[NSURL class]]) {
+        return ((NSURL *)value).absoluteString.length * sizeof(unichar);
+    }
+    else if ([value isKindOfClass:[XExtensionItemStreamingAttachment class]]) {
+        return [self estimatedByteCountOfValue:((XExtensionItemStreamingAttachment *)value).fileURL];
+    }
+    else if ([value isKindOfClass:[UIImage class]]) {
+        CGImageRef image = ((UIImage *)value).CGImage;
+
+        return image ? CGImageGetBytesPerRow(image) * CGImageGetHeight(image) : 0;
+    }
+    else if ([value isKindOfClass:[NSArray class]]) {
+        unsigned long long byteCount = 0;
+
+        for (id element in (NSArray *)value) {
+            byteCount += [self estimatedByteCountOfValue:element];
+        }
+
+        return byteCount;
+    }
+    else if ([value isKindOfClass:[NSDictionary class]]) {
+        __block unsigned long long byteCount = 0;
+
+        [(NSDictionary *)value enumerateKeysAndObjectsUsingBlock:^(id key, id object, BOOL *stop) {
+            byteCount += [self estimatedByteCountOfValue:key] + [self estimatedByteCountOfValue:object];
+        }];
+
+        return byteCount;
+    }
+    else {
+        return 0;
+    }
+}
+
+- (unsigned long long)estimatedByteCount {
+    Class class = [self class];
+
+    return [class estimatedByteCountOfValue:self.mainItem]
+        + [class estimatedByteCountOfValue:self.additionalAttachments]
+        + [class estimatedByteCountOfValue:self.attributedContentText]
+        + [class estimatedByteCountOfValue:self.userInfo];
+}
+
+- (XExtensionItemPayloadCompactionReport *)compactToByteBudget:(unsigned long long)byteBudget steps:(NSArray *)steps {
+    unsigned long long originalByteCount = self.estimatedByteCount;
+
+    if (originalByteCount <= byteBudget) {
+        return nil;
+    }
+
+    NSMutableArray *actions = [[NSMutableArray alloc] init];
+    unsigned long long byteCount = originalByteCount;
+
+    for (id <XExtensionItemPayloadCompactionStep> step in steps) {
+        [actions addObjectsFromArray:[step compactPayload:self byteBudget:byteBudget] ?: @[]];
+
+        byteCount = self.estimatedByteCount;
+
+        if (byteCount <= byteBudget) {
+            break;
+        }
+    }
+
+    return [[XExtensionItemPayloadCompactionReport alloc] initWithActivityType:self.activityType
+                                                                    byteBudget:byteBudget
+                                                             originalByteCount:originalByteCount
+                                                                     byteCount:byteCount
+                                                                       actions:actions];
+}
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p; activityType: %@, mainItem: %@, additionalAttachments: %@, estimatedByteCount: %llu>",
+            NSStringFromClass([self class]), self, self.activityType, self.mainItem, self.additionalAttachments, self.estimatedByteCount];
+}
+
+@end
+
+@implementation XExtensionItemDropAttachmentsCompactionStep
+
+#pragma mark - XExtensionItemPayloadCompactionStep
+
+- (NSArray *)compactPayload:(XExtensionItemPayload *)payload byteBudget:(unsigned long long)byteBudget {
+    NSMutableArray *actions = [[NSMutableArray alloc] init];
+    NSMutableArray *attachments = [payload.additionalAttachments mutableCopy];
+    unsigned long long byteCount = payload.estimatedByteCount;
+
+    for (NSUInteger index = attachments.count; index > 0 && byteCount > byteBudget; index--) {
+        id attachment = attachments[index - 1];
+        unsigned long long attachmentByteCount = [XExtensionItemPayload estimatedByteCountOfValue:attachment];
+
+        // Leaving it out wouldn’t bring the payload any closer to its budget, e.g. for item providers
+        if (attachmentByteCount == 0) {
+            continue;
+        }
+
+        [attachments removeObjectAtIndex:index - 1];
+        byteCount -= MIN(attachmentByteCount, byteCount);
+
+        [actions addObject:[[XExtensionItemPayloadCompactionAction alloc] initWithKind:XExtensionItemPayloadCompactionActionKindDroppedAttachment
+                                                                                 item:attachment
+                                                                    originalByteCount:attachmentByteCount
+                                                                            byteCount:0]];
+    }
+
+    if (actions.count > 0) {
+        payload.additionalAttachments = attachments;
+    }
+
+    return [actions copy];
+}
+
+@end
+
+@implementation XExtensionItemTranscodeDataCompactionStep
+
+#pragma mark - Initialization
+
+- (instancetype)initWithTranscoder:(XExtensionItemDataTranscodingBlock)transcoder {
+    self = [super init];
+    if (self) {
+        _transcoder = [transcoder copy];
+        _minimumByteCount = DefaultMinimumTranscodedByteCount;
+    }
+
+    return self;
+}
+
+- (instancetype)init {
+    return [self initWithTranscoder:nil];
+}
+
+#pragma mark - XExtensionItemPayloadCompactionStep
+
+- (NSArray *)compactPayload:(XExtensionItemPayload *)payload byteBudget:(unsigned long long)byteBudget {
+    if (!self.transcoder) {
+        return @[];
+    }
+
+    /*
+     Indexes of data to transcode, largest first. `NSNotFound` stands for the main item, and the rest for additional
+     attachments.
+     */
+    NSMutableArray *indexes = [[NSMutableArray alloc] init];
+
+    if ([payload.mainItem isKindOfClass:[NSData class]] && ((NSData *)payload.mainItem).length >= self.minimumByteCount) {
+        [indexes addObject:@(NSNotFound)];
+    }
+
+    [payload.additionalAttachments enumerateObjectsUsingBlock:^(id attachment, NSUInteger index, BOOL *stop) {
+        if ([attachment isKindOfClass:[NSData class]] && ((NSData *)attachment).length >= self.minimumByteCount) {
+            [indexes addObject:@(index)];
+        }
+    }];
+
+    NSData *(^dataAtIndex)(NSUInteger) = ^NSData *(NSUInteger index) {
+        return index == NSNotFound ? payload.mainItem : payload.additionalAttachments[index];
+    };
+
+    [indexes sortUsingComparator:^NSComparisonResult(NSNumber *index1, NSNumber *index2) {
+        return [@(dataAtIndex(index2.unsignedIntegerValue).length) compare:@(dataAtIndex(index1.unsignedIntegerValue).length)];
+    }];
+
+    NSMutableArray *actions = [[NSMutableArray alloc] init];
+    NSMutableArray *attachments = [payload.additionalAttachments mutableCopy];
+    unsigned long long byteCount = payload.estimatedByteCount;
+
+    for (NSNumber *indexNumber in indexes) {
+        if (byteCount <= byteBudget) {
+            break;
+        }
+
+        NSUInteger index = indexNumber.unsignedIntegerValue;
+        NSData *data = dataAtIndex(index);
+        unsigned long long excessByteCount = byteCount - byteBudget;
+        unsigned long long maximumByteCount = data.length > excessByteCount ? data.length - excessByteCount : 0;
+
+        NSData *transcodedData = self.transcoder(data, index == NSNotFound ? payload.typeIdentifier : nil, maximumByteCount);
+
+        if (!transcodedData || transcodedData.length >= data.length) {
+            continue;
+        }
+
+        if (index == NSNotFound) {
+            payload.mainItem = transcodedData;
+        }
+        else {
+            attachments[index] = transcodedData;
+        }
+
+        byteCount -= data.length - transcodedData.length;
+
+        [actions addObject:[[XExtensionItemPayloadCompactionAction alloc] initWithKind:XExtensionItemPayloadCompactionActionKindTranscodedData
+                                                                                 item:data
+                                                                    originalByteCount:data.length
+                                                                            byteCount:transcodedData.length]];
+    }
+
+    if (attachments) {
+        payload.additionalAttachments = attachments;
+    }
+
+    return [actions copy];
+}
+
+@end
+
+@implementation XExtensionItemTruncateTextCompactionStep
+
+#pragma mark - Initialization
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _truncationString = DefaultTruncationString;
+    }
+
+    return self;
+}
+
+#pragma mark - XExtensionItemPayloadCompactionStep
+
+- (NSArray *)compactPayload:(XExtensionItemPayload *)payload byteBudget:(unsigned long long)byteBudget {
+    NSAttributedString *text = payload.attributedContentText;
+    unsigned long long byteCount = payload.estimatedByteCount;
+
+    if (text.length == 0 || byteCount <= byteBudget) {
+        return @[];
+    }
+
+    unsigned long long excessLength = (byteCount - byteBudget + sizeof(unichar) - 1) / sizeof(unichar);
+    NSString *truncationString = self.truncationString ?: @"";
+    NSAttributedString *truncatedText;
+
+    if (excessLength + truncationString.length < text.length) {
+        NSUInteger length = text.length - (NSUInteger)excessLength - truncationString.length;
+
+        // Don’t split a surrogate pair or a character and its combining marks
+        length = [text.string rangeOfComposedCharacterSequenceAtIndex:length].location;
+
+        NSMutableAttributedString *mutableText = [[text attributedSubstringFromRange:NSMakeRange(0, length)] mutableCopy];
+
+        if (length > 0) {
+            NSDictionary *attributes = [text attributesAtIndex:length - 1 effectiveRange:NULL];
+            [mutableText appendAttributedString:[[NSAttributedString alloc] initWithString:truncationString attributes:attributes]];
+        }
+
+        truncatedText = [mutableText copy];
+    }
+
+    payload.attributedContentText = truncatedText;
+
+    return @[[[XExtensionItemPayloadCompactionAction alloc] initWithKind:XExtensionItemPayloadCompactionActionKindTruncatedText
+                                                                   item:text
+                                                      originalByteCount:[XExtensionItemPayload estimatedByteCountOfValue:text]
+                                                              byteCount:[XExtensionItemPayload estimatedByteCountOfValue:truncatedText]]];
+}
+
+@end
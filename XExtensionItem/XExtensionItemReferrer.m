@@ -1,14 +1,17 @@
 #import "XExtensionItemReferrer.h"
-#import "XExtensionItemTypeSafeDictionaryValues.h"
+#import "XExtensionItemParameterKeys.h"
+#import "XExtensionItemParameterSchema.h"
 
 static NSString * const InfoPlistBundleDisplayNameKey = @"CFBundleDisplayName";
 
-static NSString * const ParameterKeyReferrerName = @"referrer-name";
-static NSString * const ParameterKeyReferrerAppStoreID = @"referrer-app-store-id";
-static NSString * const ParameterKeyReferrerGooglePlayID = @"referrer-google-play-id";
-static NSString * const ParameterKeyReferrerWebURL = @"referrer-web-url";
-static NSString * const ParameterKeyReferreriOSAppURL = @"referrer-ios-app-url";
-static NSString * const ParameterKeyReferrerAndroidAppURL = @"referrer-android-app-url";
+@interface XExtensionItemReferrer () <XExtensionItemSchemaParameters>
+
+@property (nonatomic) NSUInteger precomputedHash;
+@property (nonatomic, copy) NSDictionary *precomputedDictionaryRepresentation;
+
+- (instancetype)initWithDictionary:(NSDictionary *)dictionary NS_DESIGNATED_INITIALIZER;
+
+@end
 
 @implementation XExtensionItemReferrer
 
@@ -20,9 +23,7 @@ static NSString * const ParameterKeyReferrerAndroidAppURL = @"referrer-android-a
                                    webURL:(NSURL *)webURL
                                 iOSAppURL:(NSURL *)iOSAppURL
                             androidAppURL:(NSURL *)androidAppURL {
-    NSString *displayName = bundle.infoDictionary[InfoPlistBundleDisplayNameKey] ?: bundle.infoDictionary[(NSString *)kCFBundleNameKey];
-                                
-    return [self initWithAppName:displayName
+    return [self initWithAppName:displayNameForBundle(bundle)
                       appStoreID:appStoreID
                     googlePlayID:googlePlayID
                           webURL:webURL
@@ -45,7 +46,7 @@ static NSString * const ParameterKeyReferrerAndroidAppURL = @"referrer-android-a
         _androidAppURL = [androidAppURL copy];
     }
     
-    return self;
+    return [self internedReferrer];
 }
 
 - (instancetype)init {
@@ -57,28 +58,32 @@ static NSString * const ParameterKeyReferrerAndroidAppURL = @"referrer-android-a
                    androidAppURL:nil];
 }
 
+#pragma mark - XExtensionItemSchemaParameters
+
++ (NSArray *)parameterFields {
+    return @[
+        [XExtensionItemParameterField optionalFieldWithKey:ParameterKeyReferrerName propertyName:@"appName" type:XExtensionItemParameterTypeString],
+        [XExtensionItemParameterField optionalFieldWithKey:ParameterKeyReferrerAppStoreID propertyName:@"appStoreID" type:XExtensionItemParameterTypeString],
+        [XExtensionItemParameterField optionalFieldWithKey:ParameterKeyReferrerGooglePlayID propertyName:@"googlePlayID" type:XExtensionItemParameterTypeString],
+        [XExtensionItemParameterField optionalFieldWithKey:ParameterKeyReferrerWebURL propertyName:@"webURL" type:XExtensionItemParameterTypeURL],
+        [XExtensionItemParameterField optionalFieldWithKey:ParameterKeyReferreriOSAppURL propertyName:@"iOSAppURL" type:XExtensionItemParameterTypeURL],
+        [XExtensionItemParameterField optionalFieldWithKey:ParameterKeyReferrerAndroidAppURL propertyName:@"androidAppURL" type:XExtensionItemParameterTypeURL],
+    ];
+}
+
 #pragma mark - XExtensionItemDictionarySerializing
 
 - (instancetype)initWithDictionary:(NSDictionary *)dictionary {
-    XExtensionItemTypeSafeDictionaryValues *dictionaryValues = [[XExtensionItemTypeSafeDictionaryValues alloc] initWithDictionary:dictionary];
-    
-    return [self initWithAppName:[dictionaryValues stringForKey:ParameterKeyReferrerName]
-                      appStoreID:[dictionaryValues stringForKey:ParameterKeyReferrerAppStoreID]
-                    googlePlayID:[dictionaryValues stringForKey:ParameterKeyReferrerGooglePlayID]
-                          webURL:[dictionaryValues URLForKey:ParameterKeyReferrerWebURL]
-                       iOSAppURL:[dictionaryValues URLForKey:ParameterKeyReferreriOSAppURL]
-                   androidAppURL:[dictionaryValues URLForKey:ParameterKeyReferrerAndroidAppURL]];
+    self = [super init];
+    if (self) {
+        [parameterSchema() decodeDictionary:dictionary intoObject:self];
+    }
+    
+    return [self internedReferrer];
 }
 
 - (NSDictionary *)dictionaryRepresentation {
-    NSMutableDictionary *mutableParameters = [[NSMutableDictionary alloc] init];
-    [mutableParameters setValue:self.appName forKey:ParameterKeyReferrerName];
-    [mutableParameters setValue:self.appStoreID forKey:ParameterKeyReferrerAppStoreID];
-    [mutableParameters setValue:self.googlePlayID forKey:ParameterKeyReferrerGooglePlayID];
-    [mutableParameters setValue:self.webURL forKey:ParameterKeyReferrerWebURL];
-    [mutableParameters setValue:self.iOSAppURL forKey:ParameterKeyReferreriOSAppURL];
-    [mutableParameters setValue:self.androidAppURL forKey:ParameterKeyReferrerAndroidAppURL];
-    return [mutableParameters copy];
+    return self.precomputedDictionaryRepresentation;
 }
 
 #pragma mark - NSObject
@@ -124,25 +129,81 @@ static NSString * const ParameterKeyReferrerAndroidAppURL = @"referrer-android-a
         return YES;
     }
     
-    if (![object isKindOfClass:[XExtensionItemReferrer class]]) {
+    if (![object isKindOfClass:[XExtensionItemReferrer class]] || ((XExtensionItemReferrer *)object).hash != self.hash) {
         return NO;
     }
     
-    XExtensionItemReferrer *other = (XExtensionItemReferrer *)object;
-    
-    return [self.appName isEqual:other.appName] && [self.appStoreID isEqual:other.appStoreID];
+    return [parameterSchema() isObject:self equalToObject:object];
 }
 
 - (NSUInteger)hash {
-    NSUInteger hash = 17;
-    hash += self.appName.hash;
-    hash += self.appStoreID.hash;
-    hash += self.googlePlayID.hash;
-    hash += self.webURL.hash;
-    hash += self.iOSAppURL.hash;
-    hash += self.androidAppURL.hash;
-
-    return hash * 39;
+    return self.precomputedHash;
+}
+
+#pragma mark - Private
+
+/*
+ Referrers are immutable, and apps tend to attach the same one to every share, so equal referrers are interned: the
+ first instance with a given set of values is returned in place of any equal instances created while it’s still alive.
+ The hash and dictionary representation are computed once, when an instance is first interned.
+ */
+- (instancetype)internedReferrer {
+    self.precomputedHash = [parameterSchema() hashOfObject:self];
+    
+    static NSHashTable *internedReferrers;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        internedReferrers = [NSHashTable weakObjectsHashTable];
+    });
+    
+    @synchronized (internedReferrers) {
+        XExtensionItemReferrer *internedReferrer = [internedReferrers member:self];
+        
+        if (internedReferrer) {
+            return internedReferrer;
+        }
+        
+        self.precomputedDictionaryRepresentation = [parameterSchema() dictionaryRepresentationOfObject:self];
+        [internedReferrers addObject:self];
+    }
+    
+    return self;
+}
+
+/*
+ Bundles’ info dictionaries don’t change at runtime, so each bundle’s display name only needs to be looked up once.
+ */
+static NSString *displayNameForBundle(NSBundle *bundle) {
+    if (!bundle) {
+        return nil;
+    }
+    
+    static NSMapTable *displayNamesByBundle;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        displayNamesByBundle = [NSMapTable weakToStrongObjectsMapTable];
+    });
+    
+    @synchronized (displayNamesByBundle) {
+        id displayName = [displayNamesByBundle objectForKey:bundle];
+        
+        if (!displayName) {
+            displayName = bundle.infoDictionary[InfoPlistBundleDisplayNameKey] ?: bundle.infoDictionary[(NSString *)kCFBundleNameKey] ?: [NSNull null];
+            [displayNamesByBundle setObject:displayName forKey:bundle];
+        }
+        
+        return displayName == [NSNull null] ? nil : displayName;
+    }
+}
+
+static XExtensionItemParameterSchema *parameterSchema(void) {
+    static XExtensionItemParameterSchema *schema;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        schema = [XExtensionItemParameterSchema schemaForClass:[XExtensionItemReferrer class]];
+    });
+    
+    return schema;
 }
 
 @end
@@ -0,0 +1,33 @@
+#import "XExtensionItem.h"
+
+/**
+ Parameters shared by every item source in an `XExtensionItemSourceGroup`. Never changed once item sources refer to
+ them: the group changes a copy and points its item sources at that instead, so item sources can hold on to them without
+ copying, and read them from any thread.
+ */
+@interface XExtensionItemSharedParameters : NSObject <NSCopying>
+
+@property (nonatomic, copy) NSArray *tags;
+@property (nonatomic) XExtensionItemReferrer *referrer;
+@property (nonatomic, copy) NSDictionary *customParameters;
+@property (nonatomic, copy) NSDictionary *attributedContentTextByActivityType;
+
+/**
+ The `userInfo` dictionary of any item source in the group that doesn’t override a parameter, built by the first such
+ item source and reused by the rest. Unlike the values above, this is set by item sources after they refer to the
+ instance, and isn’t copied.
+ */
+@property (atomic, copy) NSDictionary *extensionItemUserInfo;
+
+@end
+
+@interface XExtensionItemSource ()
+
+/**
+ Parameters of the group that the item source belongs to, if any. Setting this discards cached extension items.
+ */
+@property (nonatomic) XExtensionItemSharedParameters *sharedParameters;
+
+- (NSArray *)additionalAttachmentsForActivityType:(NSString *)activityType;
+
+@end
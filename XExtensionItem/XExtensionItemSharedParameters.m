@@ -0,0 +1,17 @@
+#import "XExtensionItemSharedParameters.h"
+
+@implementation XExtensionItemSharedParameters
+
+#pragma mark - NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    XExtensionItemSharedParameters *sharedParameters = [[[self class] allocWithZone:zone] init];
+    sharedParameters->_tags = _tags;
+    sharedParameters->_referrer = _referrer;
+    sharedParameters->_customParameters = _customParameters;
+    sharedParameters->_attributedContentTextByActivityType = _attributedContentTextByActivityType;
+
+    return sharedParameters;
+}
+
+@end
@@ -0,0 +1,49 @@
+#import "XExtensionItemSignpostMetricsSink.h"
+#import <os/signpost.h>
+
+@interface XExtensionItemSignpostMetricsSink ()
+
+@property (nonatomic) os_log_t log;
+
+@end
+
+@implementation XExtensionItemSignpostMetricsSink
+
+#pragma mark - Initialization
+
+- (instancetype)initWithSubsystem:(NSString *)subsystem category:(NSString *)category {
+    NSParameterAssert(subsystem);
+    NSParameterAssert(category);
+
+    self = [super init];
+    if (self) {
+        _log = os_log_create(subsystem.UTF8String, category.UTF8String);
+    }
+
+    return self;
+}
+
+- (instancetype)init {
+    return [self initWithSubsystem:nil category:nil];
+}
+
+#pragma mark - XExtensionItemMetricsSink
+
+/*
+ Signpost names have to be string literals, so every span shares one name and is told apart by its message. Span
+ identifiers are never `0`, which is `OS_SIGNPOST_ID_NULL`, so they can be used as signpost identifiers directly.
+ */
+
+- (void)beginSpan:(NSString *)name identifier:(uint64_t)identifier {
+    os_signpost_interval_begin(self.log, (os_signpost_id_t)identifier, "XExtensionItem", "%{public}@", name);
+}
+
+- (void)endSpan:(NSString *)name identifier:(uint64_t)identifier {
+    os_signpost_interval_end(self.log, (os_signpost_id_t)identifier, "XExtensionItem", "%{public}@", name);
+}
+
+- (void)recordCounter:(NSString *)name value:(int64_t)value {
+    os_signpost_event_emit(self.log, OS_SIGNPOST_ID_EXCLUSIVE, "XExtensionItemCounter", "%{public}@: %lld", name, value);
+}
+
+@end
@@ -0,0 +1,141 @@
+#import "XExtensionItemSourceGroup.h"
+#import "XExtensionItemSharedParameters.h"
+
+static NSString * const ActivityTypeCatchAll = @"*";
+
+@interface XExtensionItemSourceGroup ()
+
+@property (nonatomic) NSMutableArray *mutableItemSources;
+@property (nonatomic) XExtensionItemSharedParameters *sharedParameters;
+
+@end
+
+@implementation XExtensionItemSourceGroup
+
+#pragma mark - Initialization
+
+- (instancetype)initWithItemSources:(NSArray *)itemSources {
+    self = [super init];
+    if (self) {
+        _mutableItemSources = [[NSMutableArray alloc] initWithCapacity:itemSources.count];
+        _sharedParameters = [[XExtensionItemSharedParameters alloc] init];
+
+        for (XExtensionItemSource *itemSource in itemSources) {
+            [self addItemSource:itemSource];
+        }
+    }
+
+    return self;
+}
+
+- (instancetype)init {
+    return [self initWithItemSources:nil];
+}
+
+#pragma mark - XExtensionItemSourceGroup
+
+- (NSArray *)itemSources {
+    return [self.mutableItemSources copy];
+}
+
+- (void)addItemSource:(XExtensionItemSource *)itemSource {
+    NSParameterAssert(itemSource);
+
+    [self.mutableItemSources addObject:itemSource];
+
+    itemSource.sharedParameters = self.sharedParameters;
+}
+
+- (NSArray *)tags {
+    return self.sharedParameters.tags;
+}
+
+- (void)setTags:(NSArray *)tags {
+    [self updateSharedParameters:^(XExtensionItemSharedParameters *sharedParameters) {
+        sharedParameters.tags = tags;
+    }];
+}
+
+- (XExtensionItemReferrer *)referrer {
+    return self.sharedParameters.referrer;
+}
+
+- (void)setReferrer:(XExtensionItemReferrer *)referrer {
+    [self updateSharedParameters:^(XExtensionItemSharedParameters *sharedParameters) {
+        sharedParameters.referrer = referrer;
+    }];
+}
+
+- (NSAttributedString *)attributedContentText {
+    return self.sharedParameters.attributedContentTextByActivityType[ActivityTypeCatchAll];
+}
+
+- (void)setAttributedContentText:(NSAttributedString *)attributedContentText {
+    [self setAttributedContentText:attributedContentText forActivityType:nil];
+}
+
+- (void)setAttributedContentText:(NSAttributedString *)attributedContentText forActivityType:(NSString *)activityType {
+    [self updateSharedParameters:^(XExtensionItemSharedParameters *sharedParameters) {
+        NSMutableDictionary *mutableContentText = [sharedParameters.attributedContentTextByActivityType mutableCopy] ?: [[NSMutableDictionary alloc] init];
+        [mutableContentText setValue:attributedContentText forKey:activityType ?: ActivityTypeCatchAll];
+
+        sharedParameters.attributedContentTextByActivityType = mutableContentText;
+    }];
+}
+
+- (void)addCustomParameters:(id <XExtensionItemCustomParameters>)customParameters {
+    [self updateSharedParameters:^(XExtensionItemSharedParameters *sharedParameters) {
+        NSMutableDictionary *mutableCustomParameters = [sharedParameters.customParameters mutableCopy] ?: [[NSMutableDictionary alloc] init];
+        [mutableCustomParameters addEntriesFromDictionary:customParameters.dictionaryRepresentation];
+
+        sharedParameters.customParameters = mutableCustomParameters;
+    }];
+}
+
+- (NSArray *)extensionItemsForActivityType:(NSString *)activityType {
+    NSArray *itemSources = self.itemSources;
+
+    /*
+     Resolve every file URL attachment in the group up front, so that building each item below only hits the type
+     identifier cache rather than the file system.
+     */
+    NSMutableArray *additionalAttachments = [[NSMutableArray alloc] init];
+
+    for (XExtensionItemSource *itemSource in itemSources) {
+        [additionalAttachments addObjectsFromArray:[itemSource additionalAttachmentsForActivityType:activityType]];
+    }
+
+    [[XExtensionItemTypeIdentifierCache sharedCache] typeIdentifiersForFileURLsInArray:additionalAttachments];
+
+    NSMutableArray *extensionItems = [[NSMutableArray alloc] initWithCapacity:itemSources.count];
+
+    for (XExtensionItemSource *itemSource in itemSources) {
+        [extensionItems addObject:[itemSource extensionItemForActivityType:activityType]];
+    }
+
+    return [extensionItems copy];
+}
+
+#pragma mark - Private
+
+/*
+ Point the group’s item sources at a changed copy of its parameters. The current parameters are never changed, since an
+ item source may be building a `userInfo` dictionary from them, and would otherwise store it for the whole group after
+ the change.
+ */
+- (void)updateSharedParameters:(void (^)(XExtensionItemSharedParameters *sharedParameters))updates {
+    XExtensionItemSharedParameters *previousSharedParameters = self.sharedParameters;
+    XExtensionItemSharedParameters *sharedParameters = [previousSharedParameters copy];
+    updates(sharedParameters);
+
+    self.sharedParameters = sharedParameters;
+
+    for (XExtensionItemSource *itemSource in self.mutableItemSources) {
+        // Item sources that have since moved to another group aren’t affected by this one’s parameters
+        if (itemSource.sharedParameters == previousSharedParameters) {
+            itemSource.sharedParameters = sharedParameters;
+        }
+    }
+}
+
+@end
@@ -0,0 +1,72 @@
+#import "XExtensionItem.h"
+
+@class XExtensionItemSharedParameters;
+
+/**
+ Everything about an `XExtensionItemSource` that can change after it has been initialized.
+
+ @discussion A snapshot is never changed once it has been published. Writers copy the current snapshot, change the copy,
+ and publish it in its place, so a reader that grabs the current snapshot sees a consistent set of values without
+ taking the writers’ lock, no matter what other threads do in the meantime.
+
+ Extension items built from a snapshot are cached on it. Copies start out with the same cached items, and writers
+ discard the ones that their change affects.
+ */
+@interface XExtensionItemSourceSnapshot : NSObject <NSCopying>
+
+@property (nonatomic, copy) NSString *title;
+@property (nonatomic, copy) NSArray *tags;
+@property (nonatomic, copy) NSURL *sourceURL;
+@property (nonatomic) XExtensionItemReferrer *referrer;
+@property (nonatomic, copy) NSDictionary *userInfo;
+@property (nonatomic, copy) NSDictionary *customParameters;
+@property (nonatomic) XExtensionItemParameterEncoding parameterEncoding;
+@property (nonatomic, copy) NSDictionary *attributedContentTextByActivityType;
+@property (nonatomic, copy) NSDictionary *additionalAttachmentsByActivityType;
+@property (nonatomic) XExtensionItemAttachmentDeduplication attachmentDeduplication;
+@property (nonatomic, copy) XExtensionItemThumbnailProvidingBlock thumbnailProvider;
+
+/**
+ Increased along with every change to `thumbnailProvider`, so that the thumbnail cache can tell renderings by a replaced
+ provider apart from current ones.
+ */
+@property (nonatomic) NSUInteger thumbnailProviderGeneration;
+
+@property (nonatomic) XExtensionItemActivityRoutingTable *activityRoutingTable;
+@property (nonatomic, copy) XExtensionItemParameterCollisionHandler parameterCollisionHandler;
+@property (nonatomic) NSTimeInterval asynchronousItemTimeout;
+@property (nonatomic) NSUInteger preparationMemoryBudget;
+@property (nonatomic, copy) NSDictionary *payloadByteBudgetsByActivityType;
+@property (nonatomic, copy) NSArray *payloadCompactionSteps;
+@property (nonatomic, copy) XExtensionItemPayloadCompactionHandler payloadCompactionHandler;
+@property (nonatomic, getter=isTracingEnabled) BOOL tracingEnabled;
+
+/**
+ Parameters of the item source’s group. Groups replace these rather than changing them, so like every other value here,
+ they can’t change while an extension item is being built from the snapshot.
+ */
+@property (nonatomic) XExtensionItemSharedParameters *sharedParameters;
+
+/**
+ The `userInfo` dictionary shared by every extension item built from this snapshot. Unlike the values above, this may be
+ set by readers after the snapshot has been published.
+ */
+@property (atomic, copy) NSDictionary *extensionItemUserInfo;
+
+/**
+ @param activityType Activity type, or the catch-all key.
+
+ @return Extension item cached for the activity type, or `nil`. Safe to call from any thread.
+ */
+- (NSExtensionItem *)cachedExtensionItemForActivityType:(NSString *)activityType;
+
+/**
+ Cache an extension item built from this snapshot. Safe to call from any thread.
+ */
+- (void)cacheExtensionItem:(NSExtensionItem *)extensionItem forActivityType:(NSString *)activityType;
+
+- (void)removeCachedExtensionItemForActivityType:(NSString *)activityType;
+
+- (void)removeAllCachedExtensionItems;
+
+@end
@@ -0,0 +1,87 @@
+#import "XExtensionItemSourceSnapshot.h"
+
+@interface XExtensionItemSourceSnapshot ()
+
+/*
+ Guarded by `@synchronized (self)`, since readers on different threads may cache items at the same time.
+ */
+@property (nonatomic) NSMutableDictionary *extensionItemsByActivityType;
+
+@end
+
+@implementation XExtensionItemSourceSnapshot
+
+#pragma mark - Initialization
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _extensionItemsByActivityType = [[NSMutableDictionary alloc] init];
+    }
+
+    return self;
+}
+
+#pragma mark - XExtensionItemSourceSnapshot
+
+- (NSExtensionItem *)cachedExtensionItemForActivityType:(NSString *)activityType {
+    @synchronized (self) {
+        return self.extensionItemsByActivityType[activityType];
+    }
+}
+
+- (void)cacheExtensionItem:(NSExtensionItem *)extensionItem forActivityType:(NSString *)activityType {
+    @synchronized (self) {
+        self.extensionItemsByActivityType[activityType] = extensionItem;
+    }
+}
+
+- (void)removeCachedExtensionItemForActivityType:(NSString *)activityType {
+    @synchronized (self) {
+        [self.extensionItemsByActivityType removeObjectForKey:activityType];
+    }
+}
+
+- (void)removeAllCachedExtensionItems {
+    @synchronized (self) {
+        [self.extensionItemsByActivityType removeAllObjects];
+    }
+}
+
+#pragma mark - NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    XExtensionItemSourceSnapshot *snapshot = [[[self class] allocWithZone:zone] init];
+
+    // Every value is immutable, so copies can share them
+    snapshot->_title = _title;
+    snapshot->_tags = _tags;
+    snapshot->_sourceURL = _sourceURL;
+    snapshot->_referrer = _referrer;
+    snapshot->_userInfo = _userInfo;
+    snapshot->_customParameters = _customParameters;
+    snapshot->_parameterEncoding = _parameterEncoding;
+    snapshot->_attributedContentTextByActivityType = _attributedContentTextByActivityType;
+    snapshot->_additionalAttachmentsByActivityType = _additionalAttachmentsByActivityType;
+    snapshot->_attachmentDeduplication = _attachmentDeduplication;
+    snapshot->_thumbnailProvider = _thumbnailProvider;
+    snapshot->_thumbnailProviderGeneration = _thumbnailProviderGeneration;
+    snapshot->_activityRoutingTable = _activityRoutingTable;
+    snapshot->_parameterCollisionHandler = _parameterCollisionHandler;
+    snapshot->_asynchronousItemTimeout = _asynchronousItemTimeout;
+    snapshot->_preparationMemoryBudget = _preparationMemoryBudget;
+    snapshot->_payloadByteBudgetsByActivityType = _payloadByteBudgetsByActivityType;
+    snapshot->_payloadCompactionSteps = _payloadCompactionSteps;
+    snapshot->_payloadCompactionHandler = _payloadCompactionHandler;
+    snapshot->_tracingEnabled = _tracingEnabled;
+    snapshot->_sharedParameters = _sharedParameters;
+    snapshot.extensionItemUserInfo = self.extensionItemUserInfo;
+
+    @synchronized (self) {
+        [snapshot.extensionItemsByActivityType addEntriesFromDictionary:self.extensionItemsByActivityType];
+    }
+
+    return snapshot;
+}
+
+@end
@@ -0,0 +1,164 @@
+#import "XExtensionItemStreamingAttachment.h"
+#import "XExtensionItemTypeIdentifierCache.h"
+#import <MobileCoreServices/MobileCoreServices.h>
+
+NSUInteger const XExtensionItemStreamingAttachmentChunkSize = 256 * 1024;
+
+static NSString * const SpoolDirectoryName = @"XExtensionItemStreamingAttachments";
+
+@interface XExtensionItemStreamingAttachment ()
+
+@property (nonatomic, copy) XExtensionItemInputStreamProvidingBlock inputStreamProvider;
+@property (atomic, getter=isSpooled) BOOL spooled;
+
+@end
+
+@implementation XExtensionItemStreamingAttachment
+
+#pragma mark - Initialization
+
+- (instancetype)initWithFileURL:(NSURL *)fileURL typeIdentifier:(NSString *)typeIdentifier {
+    NSParameterAssert(fileURL.isFileURL);
+
+    self = [super init];
+    if (self) {
+        _fileURL = [fileURL copy];
+        _typeIdentifier = [typeIdentifier copy]
+            ?: [[XExtensionItemTypeIdentifierCache sharedCache] typeIdentifierForFileURL:fileURL]
+            ?: (NSString *)kUTTypeData;
+        _spooled = YES;
+    }
+
+    return self;
+}
+
+- (instancetype)initWithInputStreamProvider:(XExtensionItemInputStreamProvidingBlock)inputStreamProvider
+                             typeIdentifier:(NSString *)typeIdentifier {
+    NSParameterAssert(inputStreamProvider);
+    NSParameterAssert(typeIdentifier);
+
+    self = [super init];
+    if (self) {
+        _inputStreamProvider = [inputStreamProvider copy];
+        _typeIdentifier = [typeIdentifier copy];
+        _fileURL = spoolFileURL(typeIdentifier);
+    }
+
+    return self;
+}
+
+- (instancetype)init {
+    return [self initWithFileURL:nil typeIdentifier:nil];
+}
+
+- (void)dealloc {
+    // Only files that this instance spooled are removed; files passed in by the application are left alone
+    if (_inputStreamProvider) {
+        [[NSFileManager defaultManager] removeItemAtURL:_fileURL error:nil];
+    }
+}
+
+#pragma mark - XExtensionItemStreamingAttachment
+
+- (NSItemProvider *)itemProvider {
+    NSItemProvider *itemProvider = [[NSItemProvider alloc] init];
+    itemProvider.suggestedName = self.fileURL.lastPathComponent;
+
+    [itemProvider registerFileRepresentationForTypeIdentifier:self.typeIdentifier
+                                                  fileOptions:0
+                                                   visibility:NSItemProviderRepresentationVisibilityAll
+                                                  loadHandler:^NSProgress *(void (^completionHandler)(NSURL *, BOOL, NSError *)) {
+        dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+            NSError *error;
+            NSURL *fileURL = [self spooledFileURLWithError:&error];
+
+            completionHandler(fileURL, NO, error);
+        });
+
+        return nil;
+    }];
+
+    return itemProvider;
+}
+
+- (NSURL *)spooledFileURLWithError:(NSError **)error {
+    @synchronized (self) {
+        if (!self.spooled) {
+            self.spooled = spoolInputStreamToFile(self.inputStreamProvider(), self.fileURL, error);
+        }
+
+        return self.spooled ? self.fileURL : nil;
+    }
+}
+
+#pragma mark - Private
+
+static NSURL *spoolFileURL(NSString *typeIdentifier) {
+    NSURL *directoryURL = [[NSURL fileURLWithPath:NSTemporaryDirectory() isDirectory:YES] URLByAppendingPathComponent:SpoolDirectoryName isDirectory:YES];
+    NSURL *fileURL = [directoryURL URLByAppendingPathComponent:[NSUUID UUID].UUIDString isDirectory:NO];
+
+    NSString *pathExtension = (__bridge_transfer NSString *)UTTypeCopyPreferredTagWithClass((__bridge CFStringRef)typeIdentifier, kUTTagClassFilenameExtension);
+
+    return pathExtension ? [fileURL URLByAppendingPathExtension:pathExtension] : fileURL;
+}
+
+/*
+ Copies the stream to the file one chunk at a time, so that no more than `XExtensionItemStreamingAttachmentChunkSize`
+ bytes of the attachment are ever held in memory. A partially written file is removed if anything goes wrong.
+ */
+static BOOL spoolInputStreamToFile(NSInputStream *inputStream, NSURL *fileURL, NSError **error) {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+
+    if (![fileManager createDirectoryAtURL:fileURL.URLByDeletingLastPathComponent withIntermediateDirectories:YES attributes:nil error:error]) {
+        return NO;
+    }
+
+    NSOutputStream *outputStream = [[NSOutputStream alloc] initWithURL:fileURL append:NO];
+
+    [inputStream open];
+    [outputStream open];
+
+    uint8_t *buffer = malloc(XExtensionItemStreamingAttachmentChunkSize);
+    NSError *streamError = nil;
+    BOOL failed = !inputStream;
+
+    while (!failed) {
+        NSInteger bytesRead = [inputStream read:buffer maxLength:XExtensionItemStreamingAttachmentChunkSize];
+
+        if (bytesRead <= 0) {
+            failed = bytesRead < 0;
+            streamError = inputStream.streamError;
+            break;
+        }
+
+        for (NSInteger bytesWritten = 0; bytesWritten < bytesRead && !failed;) {
+            NSInteger result = [outputStream write:buffer + bytesWritten maxLength:(NSUInteger)(bytesRead - bytesWritten)];
+
+            if (result <= 0) {
+                failed = YES;
+                streamError = outputStream.streamError;
+            }
+            else {
+                bytesWritten += result;
+            }
+        }
+    }
+
+    free(buffer);
+    [inputStream close];
+    [outputStream close];
+
+    if (failed) {
+        [fileManager removeItemAtURL:fileURL error:nil];
+
+        if (error) {
+            *error = streamError ?: [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadUnknownError userInfo:nil];
+        }
+
+        return NO;
+    }
+
+    return YES;
+}
+
+@end
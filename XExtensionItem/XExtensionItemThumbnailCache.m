@@ -0,0 +1,212 @@
+#import "XExtensionItemThumbnailCache.h"
+#import "XExtensionItemInstrumentation.h"
+
+static NSUInteger const DefaultTotalCostLimit = 8 * 1024 * 1024;
+static NSString * const ActivityTypeNone = @"*";
+
+@interface XExtensionItemThumbnailCache ()
+
+@property (nonatomic) NSCache *imagesByKey;
+@property (nonatomic) NSMutableDictionary *largestBucketByActivityType;
+@property (nonatomic) NSUInteger latestProviderGeneration;
+
+@property (atomic) NSUInteger hitCount;
+@property (atomic) NSUInteger missCount;
+@property (atomic) NSUInteger downscaleCount;
+
+@end
+
+@implementation XExtensionItemThumbnailCache
+
+#pragma mark - Initialization
+
+- (instancetype)initWithTotalCostLimit:(NSUInteger)totalCostLimit {
+    self = [super init];
+    if (self) {
+        _totalCostLimit = totalCostLimit;
+
+        _imagesByKey = [[NSCache alloc] init];
+        _imagesByKey.totalCostLimit = totalCostLimit;
+
+        _largestBucketByActivityType = [[NSMutableDictionary alloc] init];
+
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(removeAllThumbnails)
+                                                     name:UIApplicationDidReceiveMemoryWarningNotification
+                                                   object:nil];
+    }
+
+    return self;
+}
+
+- (instancetype)init {
+    return [self initWithTotalCostLimit:DefaultTotalCostLimit];
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+#pragma mark - XExtensionItemThumbnailCache
+
+- (UIImage *)thumbnailForActivityType:(NSString *)activityType
+                                 size:(CGSize)size
+                             provider:(UIImage *(^)(CGSize suggestedSize, NSString *activityType))provider {
+    return [self thumbnailForActivityType:activityType size:size providerGeneration:0 provider:provider];
+}
+
+- (UIImage *)thumbnailForActivityType:(NSString *)activityType
+                                 size:(CGSize)size
+                   providerGeneration:(NSUInteger)providerGeneration
+                             provider:(UIImage *(^)(CGSize suggestedSize, NSString *activityType))provider {
+    CGSize bucket = CGSizeMake(bucketForDimension(size.width), bucketForDimension(size.height));
+    NSString *activityKey = [NSString stringWithFormat:@"%lu|%@", (unsigned long)providerGeneration, activityType ?: ActivityTypeNone];
+    NSString *key = cacheKey(activityKey, bucket);
+
+    UIImage *image = [self.imagesByKey objectForKey:key];
+
+    if (image) {
+        @synchronized (self) {
+            self.hitCount++;
+        }
+
+        return image;
+    }
+
+    @synchronized (self) {
+        self.missCount++;
+        self.latestProviderGeneration = MAX(self.latestProviderGeneration, providerGeneration);
+    }
+
+    UIImage *largerImage = [self largestImageForActivityType:activityKey coveringBucket:bucket];
+
+    if (largerImage) {
+        image = downscaledImage(largerImage, bucket);
+
+        @synchronized (self) {
+            self.downscaleCount++;
+        }
+    }
+    else if (provider) {
+        uint64_t span = metricsBeginSpan(XExtensionItemMetricsSpanThumbnailProvider);
+        image = provider(bucket, activityType);
+        metricsEndSpan(XExtensionItemMetricsSpanThumbnailProvider, span);
+    }
+
+    BOOL isLatestProviderGeneration;
+
+    @synchronized (self) {
+        isLatestProviderGeneration = providerGeneration >= self.latestProviderGeneration;
+    }
+
+    // A rendering by a provider that has since been replaced would only take up room that current thumbnails need
+    if (image && isLatestProviderGeneration) {
+        [self.imagesByKey setObject:image forKey:key cost:costForImage(image)];
+
+        if (!largerImage) {
+            [self recordRenderedBucket:bucket forActivityType:activityKey];
+        }
+    }
+
+    return image;
+}
+
+- (void)removeAllThumbnails {
+    [self.imagesByKey removeAllObjects];
+
+    @synchronized (self) {
+        [self.largestBucketByActivityType removeAllObjects];
+    }
+}
+
+#pragma mark - Private
+
+- (UIImage *)largestImageForActivityType:(NSString *)activityKey coveringBucket:(CGSize)bucket {
+    NSValue *largestBucketValue;
+
+    @synchronized (self) {
+        largestBucketValue = self.largestBucketByActivityType[activityKey];
+    }
+
+    if (!largestBucketValue) {
+        return nil;
+    }
+
+    CGSize largestBucket = largestBucketValue.CGSizeValue;
+
+    if (largestBucket.width < bucket.width || largestBucket.height < bucket.height) {
+        return nil;
+    }
+
+    // May have been evicted since it was recorded, in which case we’ll have to render again
+    UIImage *image = [self.imagesByKey objectForKey:cacheKey(activityKey, largestBucket)];
+
+    // Providers may return images of any size, so the rendering itself has to be large enough as well
+    if (image.size.width < bucket.width || image.size.height < bucket.height) {
+        return nil;
+    }
+
+    return image;
+}
+
+- (void)recordRenderedBucket:(CGSize)bucket forActivityType:(NSString *)activityKey {
+    @synchronized (self) {
+        NSValue *largestBucketValue = self.largestBucketByActivityType[activityKey];
+        CGSize largestBucket = largestBucketValue.CGSizeValue;
+
+        if (!largestBucketValue || bucket.width * bucket.height > largestBucket.width * largestBucket.height) {
+            self.largestBucketByActivityType[activityKey] = [NSValue valueWithCGSize:bucket];
+        }
+    }
+}
+
+static CGFloat bucketForDimension(CGFloat dimension) {
+    if (dimension <= 0) {
+        return 0;
+    }
+
+    CGFloat bucket = 1;
+
+    while (bucket < dimension) {
+        bucket *= 2;
+    }
+
+    return bucket;
+}
+
+static NSString *cacheKey(NSString *activityKey, CGSize bucket) {
+    return [NSString stringWithFormat:@"%@|%.0fx%.0f", activityKey, bucket.width, bucket.height];
+}
+
+static NSUInteger costForImage(UIImage *image) {
+    CGFloat scale = image.scale;
+
+    return (NSUInteger)(image.size.width * scale * image.size.height * scale * 4);
+}
+
+static UIImage *downscaledImage(UIImage *image, CGSize bucket) {
+    CGSize imageSize = image.size;
+
+    if (imageSize.width <= 0 || imageSize.height <= 0 || bucket.width <= 0 || bucket.height <= 0) {
+        return image;
+    }
+
+    // The smallest size that keeps the aspect ratio and still covers the bucket, never upscaling
+    CGFloat ratio = MIN(1, MAX(bucket.width / imageSize.width, bucket.height / imageSize.height));
+    CGSize targetSize = CGSizeMake(round(imageSize.width * ratio), round(imageSize.height * ratio));
+
+    if (ratio == 1) {
+        return image;
+    }
+
+    UIGraphicsImageRendererFormat *format = [UIGraphicsImageRendererFormat preferredFormat];
+    format.scale = image.scale;
+
+    UIGraphicsImageRenderer *renderer = [[UIGraphicsImageRenderer alloc] initWithSize:targetSize format:format];
+
+    return [renderer imageWithActions:^(UIGraphicsImageRendererContext *context) {
+        [image drawInRect:CGRectMake(0, 0, targetSize.width, targetSize.height)];
+    }];
+}
+
+@end
@@ -0,0 +1,61 @@
+#import "XExtensionItemTraceRecording.h"
+
+static NSString * const TraceKeyCorrelationIdentifier = @"correlation-identifier";
+static NSString * const TraceKeyActivityType = @"activity-type";
+static NSString * const TraceKeySheetOpenTime = @"sheet-open";
+static NSString * const TraceKeyItemBuiltTime = @"item-built";
+static NSString * const TraceKeyProviderDoneTime = @"provider-done";
+
+@implementation XExtensionItemTrace
+
+#pragma mark - Initialization
+
+- (instancetype)initWithDictionary:(NSDictionary *)dictionary {
+    NSString *correlationIdentifier = valueOfClass(dictionary[TraceKeyCorrelationIdentifier], [NSString class]);
+
+    if (!correlationIdentifier) {
+        return nil;
+    }
+
+    self = [super init];
+    if (self) {
+        _correlationIdentifier = [correlationIdentifier copy];
+        _activityType = [valueOfClass(dictionary[TraceKeyActivityType], [NSString class]) copy];
+        _sheetOpenTime = [valueOfClass(dictionary[TraceKeySheetOpenTime], [NSNumber class]) doubleValue];
+        _itemBuiltTime = [valueOfClass(dictionary[TraceKeyItemBuiltTime], [NSNumber class]) doubleValue];
+        _providerDoneTime = [valueOfClass(dictionary[TraceKeyProviderDoneTime], [NSNumber class]) doubleValue];
+    }
+
+    return self;
+}
+
+#pragma mark - XExtensionItemTrace
+
+- (NSDictionary *)dictionaryRepresentation {
+    NSMutableDictionary *dictionary = [[NSMutableDictionary alloc] init];
+    dictionary[TraceKeyCorrelationIdentifier] = self.correlationIdentifier;
+    dictionary[TraceKeyActivityType] = self.activityType;
+
+    // Phases that weren’t recorded are left out
+    dictionary[TraceKeySheetOpenTime] = self.sheetOpenTime > 0 ? @(self.sheetOpenTime) : nil;
+    dictionary[TraceKeyItemBuiltTime] = self.itemBuiltTime > 0 ? @(self.itemBuiltTime) : nil;
+    dictionary[TraceKeyProviderDoneTime] = self.providerDoneTime > 0 ? @(self.providerDoneTime) : nil;
+
+    return [dictionary copy];
+}
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"%@ { correlationIdentifier: %@, activityType: %@, sheetOpenTime: %.3f, itemBuiltTime: %.3f, providerDoneTime: %.3f, receiveTime: %.3f, attachmentsLoadedTime: %.3f }",
+            [super description], self.correlationIdentifier, self.activityType, self.sheetOpenTime, self.itemBuiltTime,
+            self.providerDoneTime, self.receiveTime, self.attachmentsLoadedTime];
+}
+
+#pragma mark - Private
+
+static id valueOfClass(id value, Class class) {
+    return [value isKindOfClass:class] ? value : nil;
+}
+
+@end
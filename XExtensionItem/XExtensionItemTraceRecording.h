@@ -0,0 +1,40 @@
+#import "XExtensionItemTrace.h"
+
+/*
+ Top-level `userInfo` key holding the producer-side values of an `XExtensionItemTrace`.
+ */
+static NSString * const ParameterKeyXExtensionItemTrace = @"x-extension-item-trace";
+
+/**
+ Records traces. Used by `XExtensionItemSource`, which writes them, and `XExtensionItem`, which reads them.
+ */
+@interface XExtensionItemTrace ()
+
+@property (nonatomic, copy) NSString *correlationIdentifier;
+@property (nonatomic, copy) NSString *activityType;
+@property (nonatomic) NSTimeInterval sheetOpenTime;
+@property (nonatomic) NSTimeInterval itemBuiltTime;
+@property (nonatomic) NSTimeInterval providerDoneTime;
+@property (nonatomic) NSTimeInterval receiveTime;
+@property (atomic) NSTimeInterval attachmentsLoadedTime;
+
+/**
+ @param dictionary Dictionary written by `dictionaryRepresentation`.
+
+ @return New trace with the dictionary’s producer-side values, or `nil` if it doesn’t have a correlation identifier.
+ */
+- (instancetype)initWithDictionary:(NSDictionary *)dictionary;
+
+/**
+ @return The producer-side values, to be written to the extension item’s `userInfo`.
+ */
+- (NSDictionary *)dictionaryRepresentation;
+
+@end
+
+/**
+ @return The current time on the clock that traces are recorded with.
+ */
+static inline NSTimeInterval traceCurrentTime(void) {
+    return [NSProcessInfo processInfo].systemUptime;
+}
@@ -0,0 +1,158 @@
+#import "XExtensionItemTypeIdentifierCache.h"
+#import <MobileCoreServices/MobileCoreServices.h>
+#import <sys/stat.h>
+
+static NSUInteger const FileEntryCountLimit = 2048;
+static NSString * const DynamicTypeIdentifierPrefix = @"dyn.";
+
+@interface XExtensionItemTypeIdentifierCache ()
+
+@property (nonatomic) NSCache *typeIdentifiersByExtension;
+@property (nonatomic) NSCache *typeIdentifiersByFileKey;
+
+@property (atomic) NSUInteger extensionHitCount;
+@property (atomic) NSUInteger fileHitCount;
+@property (atomic) NSUInteger missCount;
+
+@end
+
+@implementation XExtensionItemTypeIdentifierCache
+
+#pragma mark - Initialization
+
++ (instancetype)sharedCache {
+    static XExtensionItemTypeIdentifierCache *sharedCache;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedCache = [[self alloc] init];
+    });
+
+    return sharedCache;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _typeIdentifiersByExtension = [[NSCache alloc] init];
+
+        _typeIdentifiersByFileKey = [[NSCache alloc] init];
+        _typeIdentifiersByFileKey.countLimit = FileEntryCountLimit;
+    }
+
+    return self;
+}
+
+#pragma mark - XExtensionItemTypeIdentifierCache
+
+- (NSString *)typeIdentifierForFileURL:(NSURL *)fileURL {
+    if (![fileURL isKindOfClass:[NSURL class]] || !fileURL.isFileURL) {
+        return nil;
+    }
+
+    NSString *typeIdentifier = [self typeIdentifierForPathExtension:fileURL.pathExtension];
+
+    if (typeIdentifier) {
+        @synchronized (self) {
+            self.extensionHitCount++;
+        }
+
+        return typeIdentifier;
+    }
+
+    NSString *fileKey = fileKeyForFileURL(fileURL);
+
+    if (!fileKey) {
+        return nil;
+    }
+
+    typeIdentifier = [self.typeIdentifiersByFileKey objectForKey:fileKey];
+
+    if (typeIdentifier) {
+        @synchronized (self) {
+            self.fileHitCount++;
+        }
+
+        return typeIdentifier;
+    }
+
+    @synchronized (self) {
+        self.missCount++;
+    }
+
+    // A fresh URL instance, so that a value cached by `NSURL` itself can’t mask a change to the file
+    NSURL *uncachedFileURL = [NSURL fileURLWithPath:fileURL.path];
+    [uncachedFileURL getResourceValue:&typeIdentifier forKey:NSURLTypeIdentifierKey error:nil];
+
+    if (typeIdentifier) {
+        [self.typeIdentifiersByFileKey setObject:typeIdentifier forKey:fileKey];
+    }
+
+    return typeIdentifier;
+}
+
+- (NSDictionary *)typeIdentifiersForFileURLsInArray:(NSArray *)items {
+    NSMutableDictionary *typeIdentifiers = [[NSMutableDictionary alloc] init];
+
+    for (id item in items) {
+        if (![item isKindOfClass:[NSURL class]] || !((NSURL *)item).isFileURL || typeIdentifiers[item]) {
+            continue;
+        }
+
+        NSString *typeIdentifier = [self typeIdentifierForFileURL:item];
+
+        if (typeIdentifier) {
+            typeIdentifiers[item] = typeIdentifier;
+        }
+    }
+
+    return [typeIdentifiers copy];
+}
+
+- (void)removeAllTypeIdentifiers {
+    [self.typeIdentifiersByExtension removeAllObjects];
+    [self.typeIdentifiersByFileKey removeAllObjects];
+}
+
+#pragma mark - Private
+
+/*
+ Type identifier declared for the extension, if any. Undeclared extensions produce dynamic identifiers, which say
+ nothing about the file’s contents, so those files fall back to a file system lookup.
+ */
+- (NSString *)typeIdentifierForPathExtension:(NSString *)pathExtension {
+    if (pathExtension.length == 0) {
+        return nil;
+    }
+
+    NSString *lowercaseExtension = pathExtension.lowercaseString;
+    id typeIdentifier = [self.typeIdentifiersByExtension objectForKey:lowercaseExtension];
+
+    if (!typeIdentifier) {
+        typeIdentifier = (__bridge_transfer NSString *)UTTypeCreatePreferredIdentifierForTag(kUTTagClassFilenameExtension, (__bridge CFStringRef)lowercaseExtension, NULL);
+
+        if (!typeIdentifier || [typeIdentifier hasPrefix:DynamicTypeIdentifierPrefix]) {
+            typeIdentifier = [NSNull null];
+        }
+
+        [self.typeIdentifiersByExtension setObject:typeIdentifier forKey:lowercaseExtension];
+    }
+
+    return typeIdentifier == [NSNull null] ? nil : typeIdentifier;
+}
+
+static NSString *fileKeyForFileURL(NSURL *fileURL) {
+    struct stat fileStatus;
+
+    if (stat(fileURL.fileSystemRepresentation, &fileStatus) != 0) {
+        return nil;
+    }
+
+    return [NSString stringWithFormat:@"%@|%llu|%llu|%ld.%09ld",
+            fileURL.path,
+            (unsigned long long)fileStatus.st_dev,
+            (unsigned long long)fileStatus.st_ino,
+            (long)fileStatus.st_mtimespec.tv_sec,
+            (long)fileStatus.st_mtimespec.tv_nsec];
+}
+
+@end
@@ -2,7 +2,7 @@
 
 @interface XExtensionItemTypeSafeDictionaryValues()
 
-@property (nonatomic, copy) NSDictionary *dictionary;
+@property (nonatomic) NSDictionary *dictionary;
 
 @end
 
@@ -11,15 +11,19 @@
 #pragma mark - Initialization
 
 - (instancetype)initWithDictionary:(NSDictionary *)dictionary {
+    return [self initWithDictionaryNoCopy:[dictionary copy]];
+}
+
+- (instancetype)initWithDictionaryNoCopy:(NSDictionary *)dictionary {
     if (self = [super init]) {
-        _dictionary = [dictionary copy];
+        _dictionary = dictionary;
     }
     
     return self;
 }
 
 - (instancetype)init {
-    return [self initWithDictionary:nil];
+    return [self initWithDictionaryNoCopy:nil];
 }
 
 #pragma mark - Type-safe accessors
@@ -59,10 +63,54 @@
     }
 }
 
+- (BOOL)boolForKey:(NSString *)key defaultValue:(BOOL)defaultValue {
+    NSNumber *number = [self numberForKey:key];
+    
+    if (number) {
+        return number.boolValue;
+    }
+    else {
+        return defaultValue;
+    }
+}
+
+- (double)doubleForKey:(NSString *)key defaultValue:(double)defaultValue {
+    NSNumber *number = [self numberForKey:key];
+    
+    if (number) {
+        return number.doubleValue;
+    }
+    else {
+        return defaultValue;
+    }
+}
+
+- (NSDate *)dateForKey:(NSString *)key {
+    return [self valueForKey:key ofType:[NSDate class]];
+}
+
+#pragma mark - Batched lookups
+
+- (NSDictionary *)valuesForSchema:(NSDictionary *)schema {
+    NSDictionary *dictionary = self.dictionary;
+    NSMutableDictionary *values = [[NSMutableDictionary alloc] initWithCapacity:schema.count];
+    
+    [schema enumerateKeysAndObjectsUsingBlock:^(NSString *key, Class class, BOOL *stop) {
+        id value = dictionary[key];
+        
+        if ([value isKindOfClass:class]) {
+            values[key] = value;
+        }
+    }];
+    
+    return [values copy];
+}
+
 #pragma mark - Private
 
 - (id)valueForKey:(NSString *)key ofType:(Class)class {
-    id value = [self.dictionary valueForKey:key];
+    // `objectForKey:` rather than `valueForKey:`, which goes through KVC and treats keys starting with `@` specially
+    id value = [self.dictionary objectForKey:key];
     
     if ([value isKindOfClass:class]) {
         return value;
@@ -1,8 +1,49 @@
 #import <UIKit/UIKit.h>
+#import "XExtensionItemActivityRoutingTable.h"
+#import "XExtensionItemAttachmentDeduplicator.h"
+#import "XExtensionItemAttachmentLoader.h"
+#import "XExtensionItemCorpus.h"
+#import "XExtensionItemHandoffQueue.h"
+#import "XExtensionItemMetrics.h"
+#import "XExtensionItemMetricsRecorder.h"
+#import "XExtensionItemPayloadCompaction.h"
 #import "XExtensionItemReferrer.h"
+#import "XExtensionItemSignpostMetricsSink.h"
+#import "XExtensionItemSourceGroup.h"
+#import "XExtensionItemStreamingAttachment.h"
+#import "XExtensionItemThumbnailCache.h"
+#import "XExtensionItemTrace.h"
+#import "XExtensionItemTypeIdentifierCache.h"
 #import "XExtensionItemCustomParameters.h"
+#import "XExtensionItemCustomParametersRegistry.h"
+#import "XExtensionItemDecodingLimits.h"
+#import "XExtensionItemParameterSchema.h"
 #import "XExtensionItemTypeSafeDictionaryValues.h"
 
+/**
+ How an `XExtensionItemSource` writes its parameters (tags, source URL, referrer, custom parameters, and `userInfo`) 
+ into the extension item’s `userInfo` dictionary.
+ */
+typedef NS_ENUM(NSInteger, XExtensionItemParameterEncoding) {
+    /**
+     Parameters are written as plain dictionary entries, readable by every version of this library. The default.
+     */
+    XExtensionItemParameterEncodingDictionary,
+
+    /**
+     Parameters are written both as plain dictionary entries and as a single compact binary blob. Newer versions of 
+     `XExtensionItem` read the binary form, while older consumers fall back to the dictionary form.
+     */
+    XExtensionItemParameterEncodingDictionaryAndBinary,
+
+    /**
+     Parameters are written only as a compact binary blob, which is smaller and faster to pass across the process 
+     boundary. Consumers using a version of this library that predates the binary format will not see the parameters. 
+     Values of types that the binary format can’t represent are still written as plain dictionary entries.
+     */
+    XExtensionItemParameterEncodingBinary
+};
+
 /**
  A data structure that application developers can use to pass well-defined data structures into iOS 8 extensions 
  (extension developers can then use the `XExtensionItem` class to read this data).
@@ -22,6 +63,11 @@
  input these values without knowing the specific implementation details of the app/extension on the other side of the 
  handshake.
  
+ An `XExtensionItemSource` can be changed from any thread, including while an activity controller is already being 
+ presented (e.g. once a network request for the item’s metadata finishes). Each change is published as a new immutable 
+ snapshot of the instance’s values, and every extension item is built from a single snapshot, so it never mixes values 
+ from before and after a change. Reading never waits for a change to finish.
+ 
  Here’s how to use `XExtensionItemSource` when presenting a `UIActivityViewController`:
  
  ```objc
@@ -65,6 +111,23 @@ typedef id (^XExtensionItemProvidingBlock)(NSString *activityType);
  */
 typedef UIImage *(^XExtensionItemThumbnailProvidingBlock)(CGSize suggestedSize, NSString *activityType);
 
+/**
+ A block that is called with an asynchronously provided item once it has been loaded.
+ 
+ @param item Item to be provided to the activity.
+ */
+typedef void (^XExtensionItemAsynchronousItemCompletionBlock)(id item);
+
+/**
+ A block that can provide an item asynchronously. It is invoked on a background queue and may finish its work on any 
+ queue, as long as it eventually calls the completion block exactly once.
+ 
+ @param completion  Block to call with the item once it has been loaded.
+ @param isCancelled Block that returns `YES` once the item is no longer needed (e.g. because the activity controller 
+ was dismissed). Long-running providers should check it periodically and bail out early.
+ */
+typedef void (^XExtensionItemAsynchronousProvidingBlock)(XExtensionItemAsynchronousItemCompletionBlock completion, BOOL (^isCancelled)(void));
+
 /**
  An optional title for the item. Also used as the subject for activities that support it (i.e. Mail and Messages)
  
@@ -94,7 +157,8 @@ typedef UIImage *(^XExtensionItemThumbnailProvidingBlock)(CGSize suggestedSize,
 
 /**
  An array of additional media associated with the extension item. These items must be of type `NSString`, `NSURL`,
- `UIImage`, or `NSItemProvider` and will be passed to the selected activity/extension. For example, you could add
+ `UIImage`, `NSItemProvider`, or `XExtensionItemStreamingAttachment` and will be passed to the selected 
+ activity/extension. For example, you could add
  an image attachment to be shared alongside a URL.
  
  Calling this setter is analogous to calling `setAdditionalAttachments:forActivityType:` with a `nil` activity type, 
@@ -113,6 +177,16 @@ typedef UIImage *(^XExtensionItemThumbnailProvidingBlock)(CGSize suggestedSize,
  */
 - (void)setAdditionalAttachments:(NSArray *)attachments forActivityType:(NSString *)activityType;
 
+/**
+ How additional attachments that duplicate the main item or an earlier additional attachment are found, so that they 
+ can be left out of the extension item. Defaults to `XExtensionItemAttachmentDeduplicationIdentity | 
+ XExtensionItemAttachmentDeduplicationFilePath`; add `XExtensionItemAttachmentDeduplicationContentHash` to also leave 
+ out data and files whose contents match.
+ 
+ @see `XExtensionItemAttachmentDeduplicator`
+ */
+@property (nonatomic) XExtensionItemAttachmentDeduplication attachmentDeduplication;
+
 /**
  An optional array of tag metadata, like on Twitter/Instagram/Tumblr.
  */
@@ -135,9 +209,33 @@ typedef UIImage *(^XExtensionItemThumbnailProvidingBlock)(CGSize suggestedSize,
  A block that will be called with the suggested size for the thumbnail image, in points, and the activity type chosen by 
  the user. It should return an image using the appropriate scale for the screen. Images provided at the suggested size 
  will result in the best experience.
+ 
+ The suggested size isn’t the size that UIKit or the extension asked for, but that size rounded up to the next power of 
+ two in each dimension (e.g. 128 × 128 points for a request of 120 × 100), so that one rendering can be cached and 
+ served for every request in between. Thumbnails handed out may therefore be somewhat larger than requested, but never 
+ smaller.
  */
 @property (nonatomic, copy) XExtensionItemThumbnailProvidingBlock thumbnailProvider;
 
+/**
+ Cache of thumbnails rendered by `thumbnailProvider`. Thumbnails are cached per activity type and size bucket, so the 
+ provider is typically only called once per activity type even though thumbnails are requested both by the activity 
+ controller and by the selected extension. Setting a new `thumbnailProvider` empties the cache, and thumbnails that the 
+ previous provider is still rendering at the time are neither cached nor served for the new one.
+ 
+ @see `XExtensionItemThumbnailCache`
+ */
+@property (nonatomic, readonly) XExtensionItemThumbnailCache *thumbnailCache;
+
+/**
+ The table used to determine which activities are passed an `NSExtensionItem` and which are passed the raw activity 
+ item. Defaults to `[XExtensionItemActivityRoutingTable defaultTable]`; setting this property to `nil` restores the 
+ default.
+ 
+ @see `XExtensionItemActivityRoutingTable`
+ */
+@property (nonatomic) XExtensionItemActivityRoutingTable *activityRoutingTable;
+
 /**
  Add parameters from a custom parameters object.
  
@@ -161,10 +259,202 @@ typedef UIImage *(^XExtensionItemThumbnailProvidingBlock)(CGSize suggestedSize,
  
  Custom user info keys should *not* start with `x-extension-item`, as those are used internally by this library. Custom 
  user info keys are also at risk of colliding with keys found in the dictionary representations of custom parameters 
- objects added via `addCustomParameters:`.
+ objects added via `addCustomParameters:`. Set `parameterCollisionHandler` to find out when this happens.
  */
 @property (nonatomic, copy) NSDictionary *userInfo;
 
+/**
+ A block that is called with the keys of parameters that were overwritten by another parameter with the same key.
+ 
+ @param keys Keys that collided.
+ */
+typedef void (^XExtensionItemParameterCollisionHandler)(NSArray /* <NSString *> */ *keys);
+
+/**
+ An optional block that is called when parameters collide:
+ 
+ * When `addCustomParameters:` is passed an object whose dictionary representation contains keys that were already added 
+ by another custom parameters object. The new values replace the previous ones.
+ * When an extension item is built and `userInfo` contains keys that were also added by a custom parameters object, or 
+ that start with `x-extension-item`. The `userInfo` values replace the custom parameters, and are replaced by this 
+ library’s internal values.
+ 
+ Collisions aren’t checked for when no handler is set.
+ */
+@property (nonatomic, copy) XExtensionItemParameterCollisionHandler parameterCollisionHandler;
+
+/**
+ How parameters are written into the extension item’s `userInfo` dictionary. Defaults to 
+ `XExtensionItemParameterEncodingDictionary`. `XExtensionItem` reads every encoding transparently.
+ 
+ @see `XExtensionItemParameterEncoding`
+ */
+@property (nonatomic) XExtensionItemParameterEncoding parameterEncoding;
+
+#pragma mark - Asynchronous items
+
+/**
+ The maximum number of seconds that `activityViewController:itemForActivityType:` will wait for an asynchronous item 
+ provider to finish before falling back to the placeholder item. Defaults to 1 second. Only applies to instances created 
+ using `initWithPlaceholderItem:typeIdentifier:asynchronousItemBlock:`.
+ */
+@property (nonatomic) NSTimeInterval asynchronousItemTimeout;
+
+/**
+ Start loading the asynchronous item on a background queue, if it isn’t already being loaded. This is called 
+ automatically when the activity controller requests the placeholder item, but can be called earlier to get a head start.
+ */
+- (void)prefetchAsynchronousItem;
+
+/**
+ Cancel loading the asynchronous item and discard its result. Call this from your activity controller’s 
+ `completionWithItemsHandler` so that work isn’t wasted once the controller has been dismissed. The item will be loaded 
+ again the next time it’s needed.
+ */
+- (void)cancelAsynchronousItem;
+
+#pragma mark - Preparation
+
+/**
+ A block that is called once preparation has finished, or stopped early.
+ 
+ @param preparedActivityTypes Activity types whose payloads were prepared and are still cached, in the order given.
+ */
+typedef void (^XExtensionItemPreparationCompletionBlock)(NSArray /* <NSString *> */ *preparedActivityTypes);
+
+/**
+ The maximum number of bytes that `prepareForActivityTypes:thumbnailSize:completion:` will hold on to in prepared 
+ payloads and thumbnails. Sizes are estimated from attachments, parameters, content text, and thumbnail bitmaps. 
+ Defaults to 16 MB.
+ */
+@property (nonatomic) NSUInteger preparationMemoryBudget;
+
+/**
+ Speculatively build and cache payloads for the activity types that the user is most likely to choose, on a background 
+ queue, so that `activityViewController:itemForActivityType:` doesn’t have to when the activity controller asks for them.
+ 
+ @discussion Call this when a share button becomes visible. For each activity type, in order, the extension item is 
+ built and cached (resolving the type identifiers of file URL attachments, and waiting up to `asynchronousItemTimeout` 
+ for an asynchronous item, which is prefetched immediately), and a thumbnail is rendered into `thumbnailCache`. This 
+ means that `itemBlock` and `thumbnailProvider` may be called on a background queue.
+ 
+ Preparation stops at the first activity type whose payload would take the prepared total over 
+ `preparationMemoryBudget`; that payload is discarded. Payloads that are invalidated by a change to this instance while 
+ they are being prepared are discarded as well, and preparation moves on to the next activity type using the new 
+ values.
+ 
+ Calling this method again, or calling `cancelPreparation`, stops any preparation that is already under way.
+ 
+ @param activityTypes Activity types to prepare, most likely first.
+ @param thumbnailSize Size that thumbnails will be requested at, in points, or `CGSizeZero` to skip thumbnails.
+ @param completion    Optional block, called on the main queue.
+ */
+- (void)prepareForActivityTypes:(NSArray /* <NSString *> */ *)activityTypes
+                  thumbnailSize:(CGSize)thumbnailSize
+                     completion:(XExtensionItemPreparationCompletionBlock)completion;
+
+/**
+ Stop preparation that was started by `prepareForActivityTypes:thumbnailSize:completion:` after the activity type that 
+ is currently being prepared. Payloads that have already been prepared stay cached.
+ */
+- (void)cancelPreparation;
+
+#pragma mark - Payload budget
+
+/**
+ The maximum estimated size, in bytes, of the payload handed to any activity, or `0` for no budget, which is the 
+ default. Payloads over budget are shrunk by `payloadCompactionSteps`.
+ 
+ Calling this setter is analogous to calling `setPayloadByteBudget:forActivityType:` with a `nil` activity type.
+ 
+ @see `XExtensionItemPayload` for how sizes are estimated.
+ */
+@property (nonatomic) NSUInteger payloadByteBudget;
+
+/**
+ Specify a payload budget for a specific activity type only, e.g. a smaller one for an extension known to run with
+ little memory. Passing `nil` for the activity type will cause the budget to be used for all types.
+ 
+ @param byteBudget   Maximum estimated size of the payload, in bytes, or `0` for no budget.
+ @param activityType Activity type to use the budget for.
+ */
+- (void)setPayloadByteBudget:(NSUInteger)byteBudget forActivityType:(NSString *)activityType;
+
+/**
+ Objects conforming to `XExtensionItemPayloadCompactionStep`, which are run in order on payloads that are over budget 
+ until they fit. Defaults to dropping additional attachments, then truncating the attributed content text; setting this 
+ property to `nil` restores the default. To transcode large data before resorting to truncation:
+ 
+ ```objc
+ itemSource.payloadCompactionSteps = @[[[XExtensionItemDropAttachmentsCompactionStep alloc] init],
+                                       [[XExtensionItemTranscodeDataCompactionStep alloc] initWithTranscoder:transcoder],
+                                       [[XExtensionItemTruncateTextCompactionStep alloc] init]];
+ ```
+ */
+@property (nonatomic, copy) NSArray /* <id <XExtensionItemPayloadCompactionStep>> */ *payloadCompactionSteps;
+
+/**
+ A block that is called with what was done to a payload that was over budget.
+ 
+ @param report Report of the compaction.
+ */
+typedef void (^XExtensionItemPayloadCompactionHandler)(XExtensionItemPayloadCompactionReport *report);
+
+/**
+ An optional block that is called whenever a payload that is over budget is built, on the thread it’s built on, which 
+ may be a background thread during preparation. Payloads are cached once built, so this is called once per payload.
+ */
+@property (nonatomic, copy) XExtensionItemPayloadCompactionHandler payloadCompactionHandler;
+
+/**
+ @param activityType Activity type, or `nil`.
+ 
+ @return Estimated size, in bytes, of the payload that would be handed to the activity, before any compaction. Calls the 
+ item block, if there is one.
+ */
+- (NSUInteger)estimatedPayloadByteCountForActivityType:(NSString *)activityType;
+
+#pragma mark - Tracing
+
+/**
+ Whether extension items handed to activities are stamped with `traceCorrelationIdentifier` and the times at which the 
+ activity sheet opened, the item was built, and the item was returned, so that the receiving extension can measure the 
+ share’s latency. Defaults to `NO`.
+ 
+ @see `XExtensionItemTrace`
+ */
+@property (nonatomic, getter=isTracingEnabled) BOOL tracingEnabled;
+
+/**
+ Identifier that every extension item handed out by this instance is traced with. To correlate shares with server-side 
+ logs as well, pass it along in custom parameters (e.g. `XExtensionItemTumblrParameters`’s `correlationIdentifier`).
+ */
+@property (nonatomic, readonly, copy) NSString *traceCorrelationIdentifier;
+
+#pragma mark - Extension items
+
+/**
+ The extension item that will be provided to share extensions and activities that accept extension items for the given 
+ activity type.
+ 
+ @discussion Extension items are built lazily and cached per activity type. Setting a property on this instance only 
+ discards the cached items that the property affects, so presenting an activity controller repeatedly doesn’t rebuild 
+ identical payloads. As a result, the `itemBlock` provided at initialization is only invoked once per activity type 
+ until the cache is invalidated; call `removeCachedExtensionItems` if the block’s output changes for reasons that this 
+ instance can’t observe.
+ 
+ @param activityType Activity type to provide an extension item for. Passing `nil` returns the item built from values 
+ set for all activity types.
+ 
+ @return Cached extension item instance.
+ */
+- (NSExtensionItem *)extensionItemForActivityType:(NSString *)activityType;
+
+/**
+ Discard all cached extension items, causing them to be rebuilt the next time they’re requested.
+ */
+- (void)removeCachedExtensionItems;
+
 #pragma mark - Initialization
 
 /**
@@ -197,6 +487,9 @@ typedef UIImage *(^XExtensionItemThumbnailProvidingBlock)(CGSize suggestedSize,
 /**
  Initialize an item source with data.
  
+ @discussion The data is held in memory until the item source is deallocated, and is copied again by the receiving 
+ extension. For large payloads such as videos, use `initWithStreamingAttachment:` instead.
+ 
  @param data           (Required) Data to be shared.
  @param typeIdentifier (Required) Type of data.
  
@@ -204,6 +497,20 @@ typedef UIImage *(^XExtensionItemThumbnailProvidingBlock)(CGSize suggestedSize,
  */
 - (instancetype)initWithData:(NSData *)data typeIdentifier:(NSString *)typeIdentifier;
 
+/**
+ Initialize an item source with a large, file-backed attachment. Extensions receive it as a file representation that 
+ isn’t read until they load it. Activities that don’t accept extension items receive its file URL if it has been spooled
+ (which `prepareForActivityTypes:thumbnailSize:completion:` does for them), or an item provider that spools it when 
+ loaded otherwise.
+ 
+ @param streamingAttachment (Required) Attachment to be shared.
+ 
+ @return New item source instance.
+ 
+ @see `XExtensionItemStreamingAttachment`
+ */
+- (instancetype)initWithStreamingAttachment:(XExtensionItemStreamingAttachment *)streamingAttachment;
+
 /**
  Initialize a new instance with a placeholder item, whose type will be used by the activity controller to determine
  which activities and extensions are displayed.
@@ -219,6 +526,26 @@ typedef UIImage *(^XExtensionItemThumbnailProvidingBlock)(CGSize suggestedSize,
                          typeIdentifier:(NSString *)typeIdentifier
                               itemBlock:(XExtensionItemProvidingBlock)itemBlock NS_DESIGNATED_INITIALIZER;
 
+/**
+ Initialize a new instance with a placeholder item and a block that can provide the actual item asynchronously. Use this 
+ instead of a synchronous item block when providing the item is expensive (e.g. rendering an image or writing a file), 
+ so that the work doesn’t block the activity controller.
+ 
+ @discussion Loading begins as soon as the activity controller requests the placeholder item. When an activity is 
+ chosen, the instance waits up to `asynchronousItemTimeout` seconds for the item, and provides the placeholder item if 
+ it isn’t ready in time.
+ 
+ @param placeholderItem (Required) A placeholder item whose type will be used by the activity controller to determine
+ which activities and extensions are displayed. Also provided if the asynchronous item isn’t ready in time.
+ @param typeIdentifier  (Optional) A uniform type identifier describing the type of content being shared.
+ @param itemBlock       (Required) A block that can asynchronously provide the item to be shared.
+ 
+ @return New item source instance.
+ */
+- (instancetype)initWithPlaceholderItem:(id)placeholderItem
+                         typeIdentifier:(NSString *)typeIdentifier
+                  asynchronousItemBlock:(XExtensionItemAsynchronousProvidingBlock)itemBlock;
+
 @end
 
 /**
@@ -298,6 +625,12 @@ typedef UIImage *(^XExtensionItemThumbnailProvidingBlock)(CGSize suggestedSize,
     NSString *customTumblrURL = extensionItem.userInfo[@"tumblr-custom-url"];
  }
  ```
+ 
+ Parameters are decoded the first time they’re read, rather than when the instance is created, so an extension that only 
+ needs the attachments and title doesn’t pay for the rest. Reading parameters is thread-safe.
+ 
+ Parameters come from another application, so they’re decoded within `decodingLimits`, and anything that doesn’t fit is 
+ truncated or left out and reported in `decodingIssues`.
  */
 @interface XExtensionItem : NSObject
 
@@ -337,12 +670,85 @@ typedef UIImage *(^XExtensionItemThumbnailProvidingBlock)(CGSize suggestedSize,
 @property (nonatomic, readonly) NSDictionary *userInfo;
 
 /**
- Inialize a new instance with an incoming `NSExtensionItem` from the share extension’s extension context.
+ Decode a custom parameters object from this item’s `userInfo` dictionary, e.g.
+ `[extensionItem customParametersOfClass:[XExtensionItemTumblrParameters class]]`.
+
+ @discussion The object is only decoded the first time it’s requested, and the same instance is returned after that.
+
+ @param customParametersClass A class that conforms to `XExtensionItemCustomParameters`.
+
+ @return Custom parameters object.
+ */
+- (id)customParametersOfClass:(Class)customParametersClass;
+
+/**
+ The limits that parameters are decoded within.
+ */
+@property (nonatomic, readonly, copy) XExtensionItemDecodingLimits *decodingLimits;
+
+/**
+ Values in `userInfo` that weren’t decoded in full because they exceeded `decodingLimits`. Reading this decodes 
+ `userInfo`, `tags`, `sourceURL`, and `referrer` if they haven’t been already.
+ */
+@property (nonatomic, readonly) NSArray /* <XExtensionItemDecodingIssue *> */ *decodingIssues;
+
+/**
+ Timestamps of this share, or `nil` if the application that shared it didn’t enable tracing.
+ 
+ @see `-[XExtensionItemSource tracingEnabled]`
+ */
+@property (nonatomic, readonly) XExtensionItemTrace *trace;
+
+/**
+ Inialize a new instance with an incoming `NSExtensionItem` from the share extension’s extension context, using the 
+ default decoding limits.
  
  @param extensionItem Extension item retrieved from the share extension’s extension context.
  
  @return New instance populated with values from the extension item.
  */
-- (instancetype)initWithExtensionItem:(NSExtensionItem *)extensionItem NS_DESIGNATED_INITIALIZER;
+- (instancetype)initWithExtensionItem:(NSExtensionItem *)extensionItem;
+
+/**
+ Inialize a new instance with an incoming `NSExtensionItem` from the share extension’s extension context.
+ 
+ @param extensionItem  Extension item retrieved from the share extension’s extension context.
+ @param decodingLimits Limits to decode parameters within, or `nil` for `[XExtensionItemDecodingLimits defaultLimits]`.
+ 
+ @return New instance populated with values from the extension item.
+ */
+- (instancetype)initWithExtensionItem:(NSExtensionItem *)extensionItem
+                       decodingLimits:(XExtensionItemDecodingLimits *)decodingLimits NS_DESIGNATED_INITIALIZER;
+
+/**
+ Load the item’s attachments, each as the most preferred type identifier that it conforms to, using an 
+ `XExtensionItemAttachmentLoader` with its default concurrency limit. Prefer this to loading every registered type 
+ identifier of every attachment, which decodes representations that will never be used.
+ 
+ @param preferredTypeIdentifiers (Required) Type identifiers to load, most preferred first.
+ @param resultHandler            (Optional) Block called on the main queue with each result as soon as it’s available.
+ @param completionHandler        (Optional) Block called on the main queue once every attachment has been loaded.
+ 
+ @return The loader, which can be used to cancel loading.
+ 
+ @see `XExtensionItemAttachmentLoader`
+ */
+- (XExtensionItemAttachmentLoader *)loadAttachmentsWithPreferredTypeIdentifiers:(NSArray /* <NSString *> */ *)preferredTypeIdentifiers
+                                                                  resultHandler:(XExtensionItemAttachmentLoadResultHandler)resultHandler
+                                                              completionHandler:(XExtensionItemAttachmentLoadCompletionHandler)completionHandler;
+
+/**
+ Open an input stream over the first attachment that conforms to a type identifier, without loading it into memory. 
+ Intended for large attachments, such as those provided using `XExtensionItemStreamingAttachment`, but works with any 
+ attachment.
+ 
+ @param typeIdentifier    Type identifier to load.
+ @param completionHandler Block called on an arbitrary queue with an input stream that has already been opened, or with 
+ an error. The stream remains readable after the block returns, and should be closed once it has been read.
+ 
+ @return `NO` if no attachment conforms to the type identifier, in which case the completion handler is not called.
+ */
+- (BOOL)loadInputStreamForTypeIdentifier:(NSString *)typeIdentifier
+                       completionHandler:(void (^)(NSInputStream *inputStream, NSError *error))completionHandler;
 
 @end
@@ -0,0 +1,73 @@
+#import <Foundation/Foundation.h>
+
+/**
+ Describes what kind of item should be handed to a given activity.
+ */
+typedef NS_ENUM(NSInteger, XExtensionItemActivityRoute) {
+    /**
+     The activity type isn’t known to the routing table. `XExtensionItemSource` treats these activities – third-party
+     share extensions, for example – as being capable of processing `NSExtensionItem` input.
+     */
+    XExtensionItemActivityRouteUnknown,
+
+    /**
+     The activity is known to accept `NSExtensionItem` instances as input.
+     */
+    XExtensionItemActivityRouteExtensionItem,
+
+    /**
+     The activity is known to *not* accept `NSExtensionItem` instances as input, and should instead be passed the raw
+     activity item.
+     */
+    XExtensionItemActivityRouteRawItem
+};
+
+/**
+ An immutable lookup table that determines whether an activity should receive an `NSExtensionItem` or the raw activity
+ item that an `XExtensionItemSource` was initialized with.
+
+ @discussion Share extensions take `NSExtensionItem` instances as input, and *some* system activities do as well, but
+ some do not. Unfortunately we need to maintain a hardcoded list of which system activities we can pass extension items
+ to. The default table contains this list, and is built once per process.
+
+ Applications that need to route additional activities (e.g. their own `UIActivity` subclasses) can create a table
+ containing their overrides and assign it to `XExtensionItemSource`’s `activityRoutingTable` property:
+
+ ```objc
+ XExtensionItemActivityRoutingTable *table = [[XExtensionItemActivityRoutingTable defaultTable] tableByAddingRoutes:@{
+     MyCustomActivityType: @(XExtensionItemActivityRouteRawItem)
+ }];
+ ```
+ */
+@interface XExtensionItemActivityRoutingTable : NSObject
+
+/**
+ The table containing routes for the system activities that this library knows about. This instance is created once
+ and shared for the lifetime of the process.
+ */
++ (instancetype)defaultTable;
+
+/**
+ @param routes Dictionary mapping activity type strings to `NSNumber`-boxed `XExtensionItemActivityRoute` values.
+
+ @return New routing table instance.
+ */
+- (instancetype)initWithRoutes:(NSDictionary /* <NSString *, NSNumber *> */ *)routes NS_DESIGNATED_INITIALIZER;
+
+/**
+ @param activityType The activity type to look up.
+
+ @return The route for the activity type, or `XExtensionItemActivityRouteUnknown` if the table has no entry for it.
+ */
+- (XExtensionItemActivityRoute)routeForActivityType:(NSString *)activityType;
+
+/**
+ Create a new table containing this table’s routes, with the provided routes taking precedence over existing ones.
+
+ @param routes Dictionary mapping activity type strings to `NSNumber`-boxed `XExtensionItemActivityRoute` values.
+
+ @return New routing table instance.
+ */
+- (instancetype)tableByAddingRoutes:(NSDictionary /* <NSString *, NSNumber *> */ *)routes;
+
+@end
@@ -0,0 +1,81 @@
+#import <Foundation/Foundation.h>
+
+/**
+ Ways in which two attachments can be found to be the same.
+ */
+typedef NS_OPTIONS(NSUInteger, XExtensionItemAttachmentDeduplication) {
+    /**
+     Every attachment is kept.
+     */
+    XExtensionItemAttachmentDeduplicationNone = 0,
+
+    /**
+     Attachments are the same object, e.g. an `NSItemProvider` passed twice.
+     */
+    XExtensionItemAttachmentDeduplicationIdentity = 1 << 0,
+
+    /**
+     Attachments are file URLs or file-backed `XExtensionItemStreamingAttachment`s pointing at the same path.
+     */
+    XExtensionItemAttachmentDeduplicationFilePath = 1 << 1,
+
+    /**
+     Attachments are `NSData` instances or files with the same contents. Only attachments whose sizes match another’s are
+     hashed, and hashes are cached, so this is usually cheap, but it does read files that may otherwise only have been
+     read by the receiving extension.
+     */
+    XExtensionItemAttachmentDeduplicationContentHash = 1 << 2,
+};
+
+/**
+ Finds attachments that duplicate earlier ones, so that `XExtensionItemSource` doesn’t wrap, serialize, and have the
+ receiving extension load the same image or file twice, e.g. when it’s supplied both as the main item and as an
+ additional attachment.
+
+ @discussion Content hashes (SHA-256) are cached per `NSData` instance and per file, the latter against the file’s path,
+ device, inode, size, and modification date, so that modifying the file causes it to be hashed again.
+
+ `NSItemProvider`s are opaque, so they’re only ever found to be duplicates by identity.
+ */
+@interface XExtensionItemAttachmentDeduplicator : NSObject
+
+/**
+ The deduplicator used by `XExtensionItemSource`.
+ */
++ (instancetype)sharedDeduplicator;
+
+/**
+ Attachments larger than this aren’t hashed, and so are only deduplicated by identity or file path. Defaults to 64 MB.
+ */
+@property (atomic) unsigned long long maximumHashedByteCount;
+
+/**
+ Number of duplicate attachments found.
+ */
+@property (atomic, readonly) NSUInteger duplicateCount;
+
+/**
+ Number of bytes in the duplicate attachments found, for those whose size is known (data, strings, and files).
+ */
+@property (atomic, readonly) unsigned long long savedByteCount;
+
+/**
+ Number of attachments whose contents had to be hashed, rather than their hash being found in the cache.
+ */
+@property (atomic, readonly) NSUInteger hashCount;
+
+/**
+ @param attachments Attachments of any type accepted by `-[XExtensionItemSource additionalAttachments]`, or `NSData`.
+ @param options     Ways in which attachments can be the same.
+
+ @return Indexes of the attachments that duplicate an attachment earlier in the array. The first attachment is never a
+ duplicate.
+ */
+- (NSIndexSet *)indexesOfDuplicatesInAttachments:(NSArray *)attachments options:(XExtensionItemAttachmentDeduplication)options;
+
+/**
+ Discard all cached content hashes. Counters are not reset.
+ */
+- (void)removeAllHashes;
+
+@end
@@ -0,0 +1,124 @@
+#import <Foundation/Foundation.h>
+
+/**
+ The outcome of loading a single attachment.
+ */
+@interface XExtensionItemAttachmentLoadResult : NSObject
+
+/**
+ Index of the attachment’s item provider in the array that the loader was initialized with.
+ */
+@property (nonatomic, readonly) NSUInteger index;
+
+/**
+ The item provider that was loaded.
+ */
+@property (nonatomic, readonly) NSItemProvider *itemProvider;
+
+/**
+ The preferred type identifier that the item was loaded as.
+ */
+@property (nonatomic, readonly) NSString *typeIdentifier;
+
+/**
+ The loaded item, or `nil` if loading failed.
+ */
+@property (nonatomic, readonly) id <NSSecureCoding> item;
+
+/**
+ The error that caused loading to fail, if any.
+ */
+@property (nonatomic, readonly) NSError *error;
+
+/**
+ Number of seconds between the load starting (after waiting for a free slot) and the item provider completing.
+ */
+@property (nonatomic, readonly) NSTimeInterval loadDuration;
+
+/**
+ Number of seconds spent waiting for a free slot before the load started.
+ */
+@property (nonatomic, readonly) NSTimeInterval waitDuration;
+
+@end
+
+/**
+ A block called with each attachment’s result, in the order in which loads finish.
+ */
+typedef void (^XExtensionItemAttachmentLoadResultHandler)(XExtensionItemAttachmentLoadResult *result);
+
+/**
+ A block called once every attachment has been loaded.
+
+ @param results  Every result, in the order in which loads finished.
+ @param duration Number of seconds between loading starting and the last load finishing.
+ */
+typedef void (^XExtensionItemAttachmentLoadCompletionHandler)(NSArray /* <XExtensionItemAttachmentLoadResult *> */ *results, NSTimeInterval duration);
+
+/**
+ Loads a set of attachments, choosing a single representation per attachment and limiting how many are loaded at once.
+
+ @discussion Loading every registered type identifier of every attachment, all at once, decodes representations that
+ the extension will never use and can easily exceed an extension’s memory limit. Instead, this class:
+
+ * Loads each item provider at most once (item providers that appear more than once are only loaded the first time),
+ as the first of the preferred type identifiers that it has an item conforming to. Item providers that don’t conform to
+ any preferred type identifier are skipped.
+ * Runs at most `maximumConcurrentLoads` loads at a time, starting them in attachment order.
+ * Delivers each result as soon as its load finishes, followed by a single completion call with every result and the
+ total duration.
+
+ ```objc
+ XExtensionItemAttachmentLoader *loader =
+     [[XExtensionItemAttachmentLoader alloc] initWithItemProviders:xExtensionItem.attachments
+                                          preferredTypeIdentifiers:@[(NSString *)kUTTypeImage, (NSString *)kUTTypeURL]];
+
+ [loader loadWithResultHandler:^(XExtensionItemAttachmentLoadResult *result) {
+     // Display the item
+ } completionHandler:^(NSArray *results, NSTimeInterval duration) {
+     // Everything has loaded
+ }];
+ ```
+ */
+@interface XExtensionItemAttachmentLoader : NSObject
+
+/**
+ @param itemProviders            (Required) Item providers to load, e.g. an `XExtensionItem`’s `attachments`.
+ @param preferredTypeIdentifiers (Required) Type identifiers to load, most preferred first.
+
+ @return New loader instance.
+ */
+- (instancetype)initWithItemProviders:(NSArray /* <NSItemProvider *> */ *)itemProviders
+             preferredTypeIdentifiers:(NSArray /* <NSString *> */ *)preferredTypeIdentifiers NS_DESIGNATED_INITIALIZER;
+
+/**
+ Maximum number of attachments loaded at the same time. Defaults to 2.
+ */
+@property (nonatomic) NSUInteger maximumConcurrentLoads;
+
+/**
+ Options passed to `-[NSItemProvider loadItemForTypeIdentifier:options:completionHandler:]`, e.g.
+ `NSItemProviderPreferredImageSizeKey`.
+ */
+@property (nonatomic, copy) NSDictionary *options;
+
+/**
+ Queue that the result and completion handlers are called on. Defaults to the main queue.
+ */
+@property (nonatomic) dispatch_queue_t callbackQueue;
+
+/**
+ Start loading. May only be called once per loader.
+
+ @param resultHandler     (Optional) Block called with each result as soon as it’s available.
+ @param completionHandler (Optional) Block called once every attachment has been loaded.
+ */
+- (void)loadWithResultHandler:(XExtensionItemAttachmentLoadResultHandler)resultHandler
+            completionHandler:(XExtensionItemAttachmentLoadCompletionHandler)completionHandler;
+
+/**
+ Stop loading. Loads that haven’t started yet are skipped, and neither handler is called again.
+ */
+- (void)cancel;
+
+@end
@@ -0,0 +1,114 @@
+#import <Foundation/Foundation.h>
+
+@class XExtensionItemSource;
+
+typedef NS_ENUM(NSInteger, XExtensionItemCorpusDirection) {
+    /**
+     Handed by an application’s `XExtensionItemSource` to an activity.
+     */
+    XExtensionItemCorpusDirectionSent,
+
+    /**
+     Received by an extension from its host application.
+     */
+    XExtensionItemCorpusDirectionReceived
+};
+
+/**
+ An extension item saved in an `XExtensionItemCorpus`.
+ */
+@interface XExtensionItemCorpusRecording : NSObject
+
+/**
+ File the recording is saved in.
+ */
+@property (nonatomic, readonly) NSURL *fileURL;
+
+@property (nonatomic, readonly) XExtensionItemCorpusDirection direction;
+
+/**
+ Activity type the item was handed to, or `nil` if it isn’t known, e.g. for received items.
+ */
+@property (nonatomic, readonly, copy) NSString *activityType;
+
+@property (nonatomic, readonly) NSDate *recordDate;
+
+/**
+ The extension item as it was recorded. Attachments are item providers that have the recorded type identifiers
+ registered, each providing empty data.
+ */
+@property (nonatomic, readonly) NSExtensionItem *extensionItem;
+
+/**
+ Size of the recording’s file, in bytes.
+ */
+@property (nonatomic, readonly) NSUInteger byteCount;
+
+@end
+
+/**
+ A directory of recorded extension items, used to reproduce the payloads that real applications send and receive, e.g.
+ to check decoding performance against them before upgrading this library.
+
+ @discussion Record the items an application hands out, using `recordItemSource:activityTypes:error:`, and the items an
+ extension receives, using `recordExtensionItem:activityType:direction:error:`. Recordings are meant to be collected in
+ development and test builds and replayed later, e.g. by the `XExtensionItemBenchmarks` target, which reads a corpus from
+ the directory in the `XEXTENSIONITEM_CORPUS` environment variable.
+
+ Each recording is a file of its own, so that an application and its extensions can record into the same directory (e.g.
+ in a shared application group container) at the same time. Files are named after their record date, so that listing
+ them in name order lists them in the order they were recorded.
+
+ The file format is stable: a dictionary written by the same versioned binary coder that parameters can be encoded with,
+ holding the recording’s metadata, the item’s `userInfo` (including its title and content text) as a secure keyed
+ archive, and each attachment’s registered type identifiers. Attachment contents aren’t recorded, both to keep users’
+ photos and files out of corpora and because decoding doesn’t load them.
+ */
+@interface XExtensionItemCorpus : NSObject
+
+/**
+ @param directoryURL Directory to save recordings in. Created when the first item is recorded.
+ */
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly) NSURL *directoryURL;
+
+/**
+ Record the extension items that an item source hands to activities, i.e. the result of calling
+ `activityViewController:itemForActivityType:` for each activity type. Activity types that are handed the raw item
+ instead of an extension item aren’t recorded.
+
+ @param itemSource    Item source to record.
+ @param activityTypes Activity types to record the item source’s extension items for.
+ @param error         Set if an item couldn’t be recorded, in which case recording stops.
+
+ @return The new recordings, or `nil` on failure.
+ */
+- (NSArray /* <XExtensionItemCorpusRecording *> */ *)recordItemSource:(XExtensionItemSource *)itemSource
+                                                        activityTypes:(NSArray /* <NSString *> */ *)activityTypes
+                                                                error:(NSError **)error;
+
+/**
+ Record a single extension item, e.g. one of an extension context’s `inputItems`.
+
+ @param extensionItem Extension item to record.
+ @param activityType  Activity type the item was handed to, or `nil` if it isn’t known.
+ @param direction     Whether the item was sent or received.
+ @param error         Set if the item couldn’t be recorded, i.e. if its `userInfo` contains values other than strings,
+                      attributed strings, numbers, values, dates, URLs, UUIDs, data, null, images, fonts, colors,
+                      paragraph styles, and arrays, dictionaries, sets, and ordered sets of them.
+
+ @return The new recording, or `nil` on failure.
+ */
+- (XExtensionItemCorpusRecording *)recordExtensionItem:(NSExtensionItem *)extensionItem
+                                          activityType:(NSString *)activityType
+                                             direction:(XExtensionItemCorpusDirection)direction
+                                                 error:(NSError **)error;
+
+/**
+ @return Every readable recording in the directory, in the order they were recorded. Files that aren’t recordings, or
+ that can’t be read, are skipped.
+ */
+- (NSArray /* <XExtensionItemCorpusRecording *> */ *)recordings;
+
+@end
@@ -46,4 +46,15 @@
  */
 @property (nonatomic, readonly) NSDictionary *dictionaryRepresentation;
 
+@optional
+
+/**
+ Prefix shared by every key in the class’s dictionary representation, ending with a `.`, e.g. `com.tumblr.tumblr.`. 
+ Classes that implement this are initialized by `-[XExtensionItem customParametersOfClass:]` with only the entries in 
+ their namespace, rather than with the entire `userInfo` dictionary.
+ 
+ @see `XExtensionItemCustomParametersRegistry`
+ */
++ (NSString *)keyNamespace;
+
 @end
@@ -0,0 +1,56 @@
+#import <Foundation/Foundation.h>
+
+/**
+ Maps custom parameters classes to the key namespaces that their dictionary representations use, so that an incoming
+ `userInfo` dictionary can be split into per-class slices in a single pass.
+
+ @discussion Without a registry, every custom parameters class is initialized with the entire `userInfo` dictionary and
+ scans all of it for its own keys. `-[XExtensionItem customParametersOfClass:]` instead partitions `userInfo` once, by
+ namespace, and initializes each class with only the entries in its namespace.
+
+ Classes that implement `+[XExtensionItemCustomParameters keyNamespace]` are registered with the default registry the
+ first time they’re requested, and don’t need to be registered explicitly.
+
+ A key belongs to the longest registered namespace that it starts with. Keys that don’t belong to any namespace aren’t
+ included in any slice.
+ */
+@interface XExtensionItemCustomParametersRegistry : NSObject
+
+/**
+ The registry used by `XExtensionItem`.
+ */
++ (instancetype)defaultRegistry;
+
+/**
+ Number of times a namespace has been registered. Partitions computed before the last registration may be missing
+ slices for newly registered namespaces.
+ */
+@property (atomic, readonly) NSUInteger generation;
+
+/**
+ Register a class whose dictionary representation only uses keys in a given namespace. Registering a namespace that is
+ already registered replaces the previous class.
+
+ @param customParametersClass A class that conforms to `XExtensionItemCustomParameters`.
+ @param keyNamespace          Prefix shared by all of the class’s keys. Must end with a `.`, e.g. `com.tumblr.tumblr.`
+ */
+- (void)registerClass:(Class)customParametersClass forKeyNamespace:(NSString *)keyNamespace;
+
+/**
+ @param customParametersClass A class that conforms to `XExtensionItemCustomParameters`.
+
+ @return Namespace that the class was registered for, registering it first if it implements `keyNamespace`, or `nil`.
+ */
+- (NSString *)keyNamespaceForClass:(Class)customParametersClass;
+
+/**
+ Split a dictionary by registered namespace, in a single pass over its keys.
+
+ @param dictionary Dictionary to split, e.g. an extension item’s `userInfo`.
+
+ @return Dictionary mapping each registered namespace that at least one key belongs to, to the entries in that
+ namespace.
+ */
+- (NSDictionary /* <NSString *, NSDictionary *> */ *)partitionDictionary:(NSDictionary *)dictionary;
+
+@end
@@ -0,0 +1,97 @@
+#import <Foundation/Foundation.h>
+
+typedef NS_ENUM(NSInteger, XExtensionItemDecodingIssueKind) {
+    /**
+     A value was shortened to fit within a limit, e.g. a string that was too long or an array with too many elements.
+     */
+    XExtensionItemDecodingIssueKindTruncated,
+
+    /**
+     A value was left out, e.g. a collection nested too deeply or a URL that was too long to be truncated meaningfully.
+     */
+    XExtensionItemDecodingIssueKindDropped,
+
+    /**
+     A value was rejected without being decoded at all, e.g. a `userInfo` dictionary or binary parameters that were
+     larger than allowed.
+     */
+    XExtensionItemDecodingIssueKindRejected
+};
+
+/**
+ Describes a value that `XExtensionItem` didn’t decode in full because it exceeded one of its `XExtensionItemDecodingLimits`.
+ */
+@interface XExtensionItemDecodingIssue : NSObject
+
+@property (nonatomic, readonly) XExtensionItemDecodingIssueKind kind;
+
+/**
+ Dot-separated path of the value within `userInfo`, e.g. `x-extension-item.tags`. Array elements are identified by their
+ index. Empty for the `userInfo` dictionary itself.
+ */
+@property (nonatomic, readonly, copy) NSString *keyPath;
+
+/**
+ The limit that was exceeded.
+ */
+@property (nonatomic, readonly) NSUInteger limit;
+
+/**
+ The value’s actual length, count, depth, or size, or `NSNotFound` if decoding stopped before it was known.
+ */
+@property (nonatomic, readonly) NSUInteger count;
+
+@end
+
+/**
+ Bounds on how much of an incoming extension item’s `userInfo` dictionary `XExtensionItem` will decode.
+
+ @discussion Extensions decode whatever the host application sends them, with limited time and memory to do it in. These
+ limits are applied as `userInfo` is first read, so that a hostile or buggy host application can’t make an extension
+ spend them on parsing:
+
+ * Binary parameters larger than `maximumBinaryParametersByteCount` are rejected before being parsed.
+ * Decoding stops as soon as `userInfo` is estimated to exceed `maximumUserInfoByteCount`, and `userInfo` is rejected.
+ * Strings, collections, nesting, and tags beyond their limits are truncated or dropped.
+
+ Every value that isn’t decoded in full is reported in `-[XExtensionItem decodingIssues]`. Custom parameters are decoded
+ from the bounded `userInfo`, so they’re covered by the same limits.
+ */
+@interface XExtensionItemDecodingLimits : NSObject <NSCopying>
+
+/**
+ @return New instance with the default limits, which are generous enough for any payload written by `XExtensionItemSource`.
+ */
++ (instancetype)defaultLimits;
+
+/**
+ Estimated size, in bytes, of the decoded `userInfo` dictionary. Defaults to 1 MB.
+ */
+@property (nonatomic) NSUInteger maximumUserInfoByteCount;
+
+/**
+ Size, in bytes, of binary encoded parameters (see `XExtensionItemParameterEncoding`). Defaults to 256 KB.
+ */
+@property (nonatomic) NSUInteger maximumBinaryParametersByteCount;
+
+/**
+ Number of collections that may be nested inside one another, counting `userInfo` itself. Defaults to 8.
+ */
+@property (nonatomic) NSUInteger maximumNestingDepth;
+
+/**
+ Number of elements in any array, or entries in any dictionary, including `userInfo`. Defaults to 1,000.
+ */
+@property (nonatomic) NSUInteger maximumCollectionCount;
+
+/**
+ Length of any string, in UTF-16 code units. Defaults to 10,000.
+ */
+@property (nonatomic) NSUInteger maximumStringLength;
+
+/**
+ Number of tags. Defaults to 250.
+ */
+@property (nonatomic) NSUInteger maximumTagCount;
+
+@end
@@ -0,0 +1,151 @@
+#import <Foundation/Foundation.h>
+
+@class XExtensionItem;
+
+/**
+ Key in the `userInfo` of the error that an enqueue fails with when some of the item’s `userInfo` values can’t be
+ stored. The value is an array of the keys whose values can’t be stored.
+ */
+extern NSString * const XExtensionItemHandoffQueueUnencodableKeysErrorKey;
+
+/**
+ An extension item that was handed off by an extension and is waiting to be processed by its containing application.
+ */
+@interface XExtensionItemHandoffEntry : NSObject
+
+/**
+ Unique identifier assigned when the entry was enqueued.
+ */
+@property (nonatomic, readonly, copy) NSString *identifier;
+
+/**
+ When the entry was enqueued.
+ */
+@property (nonatomic, readonly) NSDate *enqueueDate;
+
+/**
+ The handed off extension item. Its title, content text, and parameters are the original item’s, and its attachments are
+ item providers backed by the copies in the queue’s directory, which remain until the entry is removed.
+ */
+@property (nonatomic, readonly) XExtensionItem *extensionItem;
+
+/**
+ The copied attachments, in the order of the extension item’s `attachments`. Items that weren’t loaded as a file or as
+ data, such as web URLs or strings, are stored archived.
+ */
+@property (nonatomic, readonly) NSArray /* <NSURL *> */ *attachmentFileURLs;
+
+@end
+
+/**
+ A block called once an extension item has been written to a handoff queue.
+
+ @param entry The new entry, or `nil` if the extension item couldn’t be written.
+ @param error The error that caused writing to fail, if any.
+ */
+typedef void (^XExtensionItemHandoffCompletionHandler)(XExtensionItemHandoffEntry *entry, NSError *error);
+
+/**
+ A block called with each pending entry while draining a handoff queue.
+
+ @return `YES` if the entry has been processed and should be removed from the queue, or `NO` to keep it for a later drain.
+ */
+typedef BOOL (^XExtensionItemHandoffDrainHandler)(XExtensionItemHandoffEntry *entry);
+
+/**
+ A queue of extension items, stored on disk, that a share extension hands off to its containing application.
+
+ @discussion Share extensions have little time and memory in which to work, and are terminated once they complete their
+ request. Rather than processing (e.g. uploading) an item itself, an extension can enqueue it in a directory shared with
+ its containing application, complete its request right away, and leave the application to drain the queue later, e.g.
+ from a background task:
+
+ ```objc
+ // In the extension
+ XExtensionItemHandoffQueue *queue = [[XExtensionItemHandoffQueue alloc] initWithApplicationGroupIdentifier:@"group.com.example"];
+
+ [queue enqueueExtensionItem:xExtensionItem
+    preferredTypeIdentifiers:@[(NSString *)kUTTypeImage, (NSString *)kUTTypeURL]
+           completionHandler:^(XExtensionItemHandoffEntry *entry, NSError *error) {
+     [self.extensionContext completeRequestReturningItems:nil completionHandler:nil];
+ }];
+
+ // In the application
+ [queue drainWithHandler:^BOOL(XExtensionItemHandoffEntry *entry) {
+     return [self uploadExtensionItem:entry.extensionItem];
+ }];
+ ```
+
+ Entries are written to an append-only log, one length-prefixed, checksummed record per entry or removal, and flushed to
+ disk before the completion handler is called. A record that was only partly written, e.g. because the extension was
+ terminated while writing it, fails its checksum and is discarded along with anything after it, so a crash can never
+ corrupt entries that were already enqueued. Attachments are copied into the directory before their entry’s record is
+ appended. The log is truncated once every entry has been removed, at which point attachments left behind by enqueues
+ that never finished are deleted if they’re more than a day old.
+
+ Queues are safe to use from multiple threads, and from multiple processes (i.e. an extension and its containing
+ application) sharing the same directory.
+ */
+@interface XExtensionItemHandoffQueue : NSObject
+
+/**
+ @param directoryURL (Required) Directory to store the queue in. Created if it doesn’t exist.
+
+ @return New queue instance.
+ */
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL NS_DESIGNATED_INITIALIZER;
+
+/**
+ @param applicationGroupIdentifier (Required) Application group shared by the extension and its containing application.
+
+ @return New queue instance, stored in the application group’s shared container.
+ */
+- (instancetype)initWithApplicationGroupIdentifier:(NSString *)applicationGroupIdentifier;
+
+/**
+ Directory that the queue is stored in.
+ */
+@property (nonatomic, readonly) NSURL *directoryURL;
+
+/**
+ Copy an extension item’s title, content text, parameters, and attachments into the queue.
+
+ @param extensionItem            (Required) Extension item to enqueue.
+ @param preferredTypeIdentifiers (Required) Type identifiers to load attachments as, most preferred first. Attachments
+ that don’t conform to any of them are left out. See `XExtensionItemAttachmentLoader`.
+ @param completionHandler        (Optional) Block called on the main queue once the entry has been written, or writing
+ failed. If any attachment fails to load, nothing is enqueued. Nothing is enqueued either if the item’s `userInfo` holds
+ values other than strings, numbers, dates, URLs, data, and arrays and dictionaries of them, in which case the error’s
+ `userInfo` names the offending keys under `XExtensionItemHandoffQueueUnencodableKeysErrorKey`.
+ */
+- (void)enqueueExtensionItem:(XExtensionItem *)extensionItem
+    preferredTypeIdentifiers:(NSArray /* <NSString *> */ *)preferredTypeIdentifiers
+           completionHandler:(XExtensionItemHandoffCompletionHandler)completionHandler;
+
+/**
+ Every entry that has been enqueued and not yet removed, oldest first.
+ */
+- (NSArray /* <XExtensionItemHandoffEntry *> */ *)pendingEntries;
+
+/**
+ Remove an entry and delete its attachments.
+
+ @param entry (Required) Entry to remove.
+ @param error If non-`NULL`, set to the error that caused removal to fail.
+
+ @return `YES` if the entry was removed, or had already been.
+ */
+- (BOOL)removeEntry:(XExtensionItemHandoffEntry *)entry error:(NSError **)error;
+
+/**
+ Call a block with each pending entry, oldest first, on the calling thread, and remove the entries that it processes.
+ The queue isn’t locked while the block runs, so entries can be enqueued in the meantime, but only one process should
+ drain a queue at a time.
+
+ @param handler (Required) Block called with each entry.
+
+ @return Number of entries removed.
+ */
+- (NSUInteger)drainWithHandler:(XExtensionItemHandoffDrainHandler)handler;
+
+@end
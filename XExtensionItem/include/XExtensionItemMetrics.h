@@ -0,0 +1,113 @@
+#import <Foundation/Foundation.h>
+
+/**
+ Span around a call to an `XExtensionItemSource`’s item block.
+ */
+extern NSString * const XExtensionItemMetricsSpanActivityItemBlock;
+
+/**
+ Span around a call to an `XExtensionItemSource`’s `thumbnailProvider`. Thumbnails served from the cache don’t call the
+ provider, and so don’t produce this span.
+ */
+extern NSString * const XExtensionItemMetricsSpanThumbnailProvider;
+
+/**
+ Span around `-[XExtensionItemSource activityViewController:itemForActivityType:]`, including assembling the extension
+ item if one needs to be built.
+ */
+extern NSString * const XExtensionItemMetricsSpanItemForActivityType;
+
+/**
+ Span around the background work done by `-[XExtensionItemSource prepareForActivityTypes:thumbnailSize:completion:]`.
+ */
+extern NSString * const XExtensionItemMetricsSpanPreparation;
+
+/**
+ Span around decoding part of an incoming extension item. Decoding is lazy, so this isn’t reported when an `XExtensionItem`
+ is initialized, but on first access to its `userInfo`, on first access to its generic parameters (e.g. `tags` or
+ `referrer`), and on the first `customParametersOfClass:` call for each class, i.e. up to one span per part.
+ */
+extern NSString * const XExtensionItemMetricsSpanDecoding;
+
+/**
+ Span around a single item provider load made by an `XExtensionItemAttachmentLoader`.
+ */
+extern NSString * const XExtensionItemMetricsSpanAttachmentLoad;
+
+/**
+ Number of top-level keys in an extension item’s `userInfo` dictionary, recorded when one is returned to an activity and
+ when one is decoded.
+ */
+extern NSString * const XExtensionItemMetricsCounterPayloadKeyCount;
+
+/**
+ Number of attachments in an extension item, recorded when one is returned to an activity and when one is decoded.
+ */
+extern NSString * const XExtensionItemMetricsCounterAttachmentCount;
+
+/**
+ Number of bytes loaded by an `XExtensionItemAttachmentLoader`, for attachments loaded as data or files.
+ */
+extern NSString * const XExtensionItemMetricsCounterBytes;
+
+/**
+ Number of bytes in duplicate attachments that an `XExtensionItemSource` left out of an extension item, for attachments
+ whose size is known.
+
+ @see `XExtensionItemAttachmentDeduplicator`
+ */
+extern NSString * const XExtensionItemMetricsCounterDeduplicatedBytes;
+
+/**
+ Receives instrumentation events from the producer (`XExtensionItemSource`) and consumer (`XExtensionItem`,
+ `XExtensionItemAttachmentLoader`) hot paths.
+
+ @discussion Events may be delivered on any thread, and spans with the same name may overlap (e.g. concurrent attachment
+ loads), so a span’s begin and end events should be matched using their identifier.
+ */
+@protocol XExtensionItemMetricsSink <NSObject>
+
+/**
+ @param name       One of the `XExtensionItemMetricsSpan*` constants.
+ @param identifier Identifier that the matching `endSpan:identifier:` call will be made with. Never `0`.
+ */
+- (void)beginSpan:(NSString *)name identifier:(uint64_t)identifier;
+
+/**
+ @param name       One of the `XExtensionItemMetricsSpan*` constants.
+ @param identifier Identifier that the matching `beginSpan:identifier:` call was made with.
+ */
+- (void)endSpan:(NSString *)name identifier:(uint64_t)identifier;
+
+/**
+ @param name  One of the `XExtensionItemMetricsCounter*` constants.
+ @param value Value to add to the counter.
+ */
+- (void)recordCounter:(NSString *)name value:(int64_t)value;
+
+@end
+
+/**
+ Installs the sink that instrumentation events are sent to.
+
+ @discussion No sink is installed by default, in which case instrumentation costs a single check per span or counter,
+ and counters that need extra work to compute (e.g. the size of a loaded file) aren’t computed at all.
+
+ The sink can be installed or replaced at any time, from any thread. Events from work already in progress may still be
+ sent to the previous sink, and a span that began with one sink may end with another.
+
+ @see `XExtensionItemMetricsRecorder`, `XExtensionItemSignpostMetricsSink`
+ */
+@interface XExtensionItemMetrics : NSObject
+
+/**
+ The installed sink, or `nil` if instrumentation is disabled.
+ */
++ (id <XExtensionItemMetricsSink>)sink;
+
+/**
+ @param sink Sink to send instrumentation events to, or `nil` to disable instrumentation.
+ */
++ (void)setSink:(id <XExtensionItemMetricsSink>)sink;
+
+@end
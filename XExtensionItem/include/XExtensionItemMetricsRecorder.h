@@ -0,0 +1,72 @@
+#import "XExtensionItemMetrics.h"
+
+typedef NS_ENUM(NSInteger, XExtensionItemMetricsEventType) {
+    XExtensionItemMetricsEventTypeBeginSpan,
+    XExtensionItemMetricsEventTypeEndSpan,
+    XExtensionItemMetricsEventTypeCounter
+};
+
+/**
+ A single event received by an `XExtensionItemMetricsRecorder`.
+ */
+@interface XExtensionItemMetricsEvent : NSObject
+
+@property (nonatomic, readonly) XExtensionItemMetricsEventType type;
+
+/**
+ Span or counter name.
+ */
+@property (nonatomic, readonly, copy) NSString *name;
+
+/**
+ Span identifier, or `0` for counters.
+ */
+@property (nonatomic, readonly) uint64_t identifier;
+
+/**
+ Counter value, or `0` for spans.
+ */
+@property (nonatomic, readonly) int64_t value;
+
+/**
+ Time that the event was received, as system uptime.
+ */
+@property (nonatomic, readonly) NSTimeInterval timestamp;
+
+@end
+
+/**
+ A metrics sink that keeps every event in memory, for tests and debugging.
+ */
+@interface XExtensionItemMetricsRecorder : NSObject <XExtensionItemMetricsSink>
+
+/**
+ Every event received so far, in the order that they were received.
+ */
+@property (nonatomic, readonly) NSArray /* <XExtensionItemMetricsEvent *> */ *events;
+
+/**
+ Names of the spans that have both begun and ended, in the order that they began.
+ */
+@property (nonatomic, readonly) NSArray /* <NSString *> */ *completedSpanNames;
+
+/**
+ @param name Span name.
+
+ @return Durations of every completed span with the given name, in the order that they began.
+ */
+- (NSArray /* <NSNumber *> */ *)durationsForSpan:(NSString *)name;
+
+/**
+ @param name Counter name.
+
+ @return Sum of every value recorded for the given counter.
+ */
+- (int64_t)totalForCounter:(NSString *)name;
+
+/**
+ Discard all recorded events.
+ */
+- (void)removeAllEvents;
+
+@end
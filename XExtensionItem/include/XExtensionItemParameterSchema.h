@@ -0,0 +1,182 @@
+#import "XExtensionItemCustomParameters.h"
+
+/**
+ The type of a custom parameter field, which determines both the class of value accepted in a dictionary representation
+ and how the value is stored on the parameters object.
+ */
+typedef NS_ENUM(NSInteger, XExtensionItemParameterType) {
+    /** `NSString` value, stored in an object property. */
+    XExtensionItemParameterTypeString,
+
+    /** `NSNumber` value, stored in an object property. */
+    XExtensionItemParameterTypeNumber,
+
+    /** `NSURL` value, stored in an object property. */
+    XExtensionItemParameterTypeURL,
+
+    /** `NSArray` value, stored in an object property. */
+    XExtensionItemParameterTypeArray,
+
+    /** `NSDictionary` value, stored in an object property. */
+    XExtensionItemParameterTypeDictionary,
+
+    /** `NSData` value, stored in an object property. */
+    XExtensionItemParameterTypeData,
+
+    /** `NSDate` value, stored in an object property. */
+    XExtensionItemParameterTypeDate,
+
+    /** `NSNumber` value, stored in an `NSUInteger` (or `NSUInteger`-backed enum) property. */
+    XExtensionItemParameterTypeUnsignedInteger,
+
+    /** `NSNumber` value, stored in a `BOOL` property. */
+    XExtensionItemParameterTypeBool
+};
+
+/**
+ Describes a single field of a custom parameters class: the key it’s stored under in the dictionary representation, the
+ property that backs it, its type, and what to do when it’s missing.
+ */
+@interface XExtensionItemParameterField : NSObject
+
+/**
+ Key that the field is stored under in the dictionary representation.
+ */
+@property (nonatomic, readonly) NSString *key;
+
+/**
+ Name of the property that backs the field. The property must be backed by an instance variable of the same name
+ prefixed with an underscore (i.e. the default synthesized instance variable).
+ */
+@property (nonatomic, readonly) NSString *propertyName;
+
+/**
+ Type of the field.
+ */
+@property (nonatomic, readonly) XExtensionItemParameterType type;
+
+/**
+ Whether decoding should fail if the field is missing or has a value of the wrong type.
+ */
+@property (nonatomic, readonly, getter=isRequired) BOOL required;
+
+/**
+ Value to use when an optional field is missing or has a value of the wrong type. For scalar types, an `NSNumber`.
+ */
+@property (nonatomic, readonly) id defaultValue;
+
+/**
+ @param key          (Required) See `key` property.
+ @param propertyName (Required) See `propertyName` property.
+ @param type         See `type` property.
+ @param required     See `required` property.
+ @param defaultValue (Optional) See `defaultValue` property.
+
+ @return New field instance.
+ */
+- (instancetype)initWithKey:(NSString *)key
+               propertyName:(NSString *)propertyName
+                       type:(XExtensionItemParameterType)type
+                   required:(BOOL)required
+               defaultValue:(id)defaultValue NS_DESIGNATED_INITIALIZER;
+
+/**
+ Convenience constructor for an optional field without a default value.
+ */
++ (instancetype)optionalFieldWithKey:(NSString *)key propertyName:(NSString *)propertyName type:(XExtensionItemParameterType)type;
+
+/**
+ Convenience constructor for an optional field with a default value.
+ */
++ (instancetype)optionalFieldWithKey:(NSString *)key propertyName:(NSString *)propertyName type:(XExtensionItemParameterType)type defaultValue:(id)defaultValue;
+
+/**
+ Convenience constructor for a required field.
+ */
++ (instancetype)requiredFieldWithKey:(NSString *)key propertyName:(NSString *)propertyName type:(XExtensionItemParameterType)type;
+
+@end
+
+/**
+ A custom parameters class that declares its fields once, allowing `XExtensionItemParameterSchema` to provide its
+ dictionary encoding, decoding, equality, and hashing.
+ */
+@protocol XExtensionItemSchemaParameters <XExtensionItemCustomParameters>
+
+/**
+ @return Array of `XExtensionItemParameterField` instances describing the class’s fields. Called once per class.
+ */
++ (NSArray /* <XExtensionItemParameterField *> */ *)parameterFields;
+
+@end
+
+/**
+ Encodes, decodes, compares, and hashes instances of a class conforming to `XExtensionItemSchemaParameters`, using
+ metadata that is resolved once per class and cached for the lifetime of the process.
+
+ @discussion Rather than hand-writing `initWithDictionary:`, `dictionaryRepresentation`, `isEqual:`, and `hash`, a
+ custom parameters class can declare its fields and forward to its schema:
+
+ ```objc
+ + (NSArray *)parameterFields {
+     return @[[XExtensionItemParameterField optionalFieldWithKey:@"com.example.app.foo"
+                                                    propertyName:@"foo"
+                                                            type:XExtensionItemParameterTypeString]];
+ }
+
+ - (instancetype)initWithDictionary:(NSDictionary *)dictionary {
+     self = [self init];
+     if (self && ![[XExtensionItemParameterSchema schemaForClass:[self class]] decodeDictionary:dictionary intoObject:self]) {
+         return nil;
+     }
+
+     return self;
+ }
+
+ - (NSDictionary *)dictionaryRepresentation {
+     return [[XExtensionItemParameterSchema schemaForClass:[self class]] dictionaryRepresentationOfObject:self];
+ }
+ ```
+ */
+@interface XExtensionItemParameterSchema : NSObject
+
+/**
+ @param class A class conforming to `XExtensionItemSchemaParameters`.
+
+ @return The cached schema for the class, created the first time it’s requested.
+ */
++ (instancetype)schemaForClass:(Class)class;
+
+/**
+ The fields declared by the class.
+ */
+@property (nonatomic, readonly) NSArray /* <XExtensionItemParameterField *> */ *fields;
+
+/**
+ Populate an object’s fields from a dictionary. Missing or mistyped optional fields are set to their default values.
+
+ @param dictionary Dictionary to read values from.
+ @param object     Instance of the schema’s class.
+
+ @return `NO` if a required field was missing or had a value of the wrong type, `YES` otherwise.
+ */
+- (BOOL)decodeDictionary:(NSDictionary *)dictionary intoObject:(id)object;
+
+/**
+ @param object Instance of the schema’s class.
+
+ @return Dictionary containing a value for each of the object’s non-`nil` fields.
+ */
+- (NSDictionary *)dictionaryRepresentationOfObject:(id)object;
+
+/**
+ @return Whether every field of the two objects is equal. Fields that are `nil` on both objects are considered equal.
+ */
+- (BOOL)isObject:(id)object equalToObject:(id)otherObject;
+
+/**
+ @return A hash combining every field of the object, consistent with `isObject:equalToObject:`.
+ */
+- (NSUInteger)hashOfObject:(id)object;
+
+@end
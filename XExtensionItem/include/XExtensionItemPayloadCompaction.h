@@ -0,0 +1,220 @@
+#import <Foundation/Foundation.h>
+
+typedef NS_ENUM(NSInteger, XExtensionItemPayloadCompactionActionKind) {
+    /**
+     An additional attachment was left out of the payload.
+     */
+    XExtensionItemPayloadCompactionActionKindDroppedAttachment,
+
+    /**
+     Data, either the main item or an additional attachment, was replaced by a smaller transcoded version.
+     */
+    XExtensionItemPayloadCompactionActionKindTranscodedData,
+
+    /**
+     The attributed content text was shortened.
+     */
+    XExtensionItemPayloadCompactionActionKindTruncatedText
+};
+
+/**
+ Describes a change that a compaction step made to a payload.
+ */
+@interface XExtensionItemPayloadCompactionAction : NSObject
+
+/**
+ @param kind              Kind of change.
+ @param item              The item that was changed or left out, as it was before the change.
+ @param originalByteCount Estimated size of the item before the change.
+ @param byteCount         Estimated size of the item after the change, `0` if it was left out.
+ */
+- (instancetype)initWithKind:(XExtensionItemPayloadCompactionActionKind)kind
+                        item:(id)item
+           originalByteCount:(unsigned long long)originalByteCount
+                   byteCount:(unsigned long long)byteCount NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly) XExtensionItemPayloadCompactionActionKind kind;
+
+@property (nonatomic, readonly) id item;
+
+@property (nonatomic, readonly) unsigned long long originalByteCount;
+
+@property (nonatomic, readonly) unsigned long long byteCount;
+
+@end
+
+/**
+ Outcome of compacting a payload that was over its byte budget.
+ */
+@interface XExtensionItemPayloadCompactionReport : NSObject
+
+/**
+ Activity type the payload was built for, or `nil` if it was built for all activity types.
+ */
+@property (nonatomic, readonly, copy) NSString *activityType;
+
+@property (nonatomic, readonly) unsigned long long byteBudget;
+
+/**
+ Estimated size of the payload before compaction.
+ */
+@property (nonatomic, readonly) unsigned long long originalByteCount;
+
+/**
+ Estimated size of the payload after compaction.
+ */
+@property (nonatomic, readonly) unsigned long long byteCount;
+
+/**
+ Changes made by the compaction steps, in the order they were made.
+ */
+@property (nonatomic, readonly) NSArray /* <XExtensionItemPayloadCompactionAction *> */ *actions;
+
+/**
+ Whether compaction brought the payload within its byte budget. If not, the payload is sent as compacted anyway.
+ */
+@property (nonatomic, readonly, getter=isWithinBudget) BOOL withinBudget;
+
+@end
+
+/**
+ The values that make up an extension item’s payload, while it’s being built. Compaction steps shrink a payload by
+ changing these values.
+
+ @discussion Sizes are estimates of the bytes that cross the process boundary: the length of data, of strings (in UTF-16
+ code units), and of URLs; the bitmap size of images; and the sum of the sizes of collections. Files, whether file URLs
+ or streaming attachments, are passed by reference, so only their URL counts. `NSItemProvider`s are opaque and count as
+ nothing.
+ */
+@interface XExtensionItemPayload : NSObject
+
+/**
+ @param value Value of any type.
+
+ @return Estimated size of the value, as described above.
+ */
++ (unsigned long long)estimatedByteCountOfValue:(id)value;
+
+/**
+ @param activityType          Activity type the payload is being built for, or `nil`.
+ @param mainItem              The item that the source was initialized with, or that its item block provided.
+ @param typeIdentifier        Type identifier of the main item.
+ @param additionalAttachments Additional attachments.
+ @param attributedContentText Attributed content text.
+ @param userInfo              Everything else in the extension item’s `userInfo`, i.e. its parameters.
+ */
+- (instancetype)initWithActivityType:(NSString *)activityType
+                            mainItem:(id)mainItem
+                      typeIdentifier:(NSString *)typeIdentifier
+               additionalAttachments:(NSArray *)additionalAttachments
+               attributedContentText:(NSAttributedString *)attributedContentText
+                            userInfo:(NSDictionary *)userInfo NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly, copy) NSString *activityType;
+
+/**
+ The main item. May be replaced with an item of the same type identifier, e.g. transcoded data.
+ */
+@property (nonatomic) id mainItem;
+
+@property (nonatomic, readonly, copy) NSString *typeIdentifier;
+
+@property (nonatomic, copy) NSArray *additionalAttachments;
+
+@property (nonatomic, copy) NSAttributedString *attributedContentText;
+
+/**
+ Everything else in the extension item’s `userInfo`. Can’t be compacted.
+ */
+@property (nonatomic, readonly, copy) NSDictionary *userInfo;
+
+/**
+ Estimated size of the whole payload.
+ */
+@property (nonatomic, readonly) unsigned long long estimatedByteCount;
+
+/**
+ Run compaction steps, in order, until the payload fits within a byte budget or every step has run.
+
+ @param byteBudget Maximum estimated size of the payload.
+ @param steps      Objects conforming to `XExtensionItemPayloadCompactionStep`.
+
+ @return Report of what was done, or `nil` if the payload was already within the budget.
+ */
+- (XExtensionItemPayloadCompactionReport *)compactToByteBudget:(unsigned long long)byteBudget steps:(NSArray *)steps;
+
+@end
+
+/**
+ A step of the pipeline that `XExtensionItemSource` shrinks over-budget payloads with.
+ */
+@protocol XExtensionItemPayloadCompactionStep <NSObject>
+
+/**
+ Shrink a payload towards its byte budget. Only called while the payload is over budget. May be called on any thread.
+
+ @param payload    Payload to change.
+ @param byteBudget Maximum estimated size of the payload.
+
+ @return The changes that were made, in order.
+ */
+- (NSArray /* <XExtensionItemPayloadCompactionAction *> */ *)compactPayload:(XExtensionItemPayload *)payload byteBudget:(unsigned long long)byteBudget;
+
+@end
+
+/**
+ Leaves out additional attachments, starting with the last, until the payload is within budget. The main item is never
+ left out, and neither are attachments with an estimated size of zero (e.g. item providers), since leaving them out
+ wouldn’t make the payload any smaller.
+ */
+@interface XExtensionItemDropAttachmentsCompactionStep : NSObject <XExtensionItemPayloadCompactionStep>
+
+@end
+
+/**
+ A block that makes data smaller, e.g. by re-encoding an image at a lower quality.
+
+ @param data             Data to transcode.
+ @param typeIdentifier   Type identifier of the data, or `nil` if it isn’t known.
+ @param maximumByteCount Size that would bring the payload within budget. May be `0`, if this data alone can’t.
+
+ @return Data of the same type identifier, ideally no larger than `maximumByteCount`, or `nil` to leave the data as is.
+ */
+typedef NSData *(^XExtensionItemDataTranscodingBlock)(NSData *data, NSString *typeIdentifier, unsigned long long maximumByteCount);
+
+/**
+ Hands large data, largest first, to a transcoder until the payload is within budget. Only `NSData` items are
+ transcoded, i.e. a main item passed to `-[XExtensionItemSource initWithData:typeIdentifier:]` or data in additional
+ attachments.
+ */
+@interface XExtensionItemTranscodeDataCompactionStep : NSObject <XExtensionItemPayloadCompactionStep>
+
+/**
+ @param transcoder Block that data is handed to.
+ */
+- (instancetype)initWithTranscoder:(XExtensionItemDataTranscodingBlock)transcoder NS_DESIGNATED_INITIALIZER;
+
+/**
+ Block that data is handed to. Nothing is transcoded if this is `nil`.
+ */
+@property (nonatomic, readonly, copy) XExtensionItemDataTranscodingBlock transcoder;
+
+/**
+ Data smaller than this is left as is. Defaults to 64 KB.
+ */
+@property (nonatomic) NSUInteger minimumByteCount;
+
+@end
+
+/**
+ Shortens the attributed content text, at a composed character boundary, so that the payload fits within budget. The
+ text is left out if the payload can’t be made to fit by shortening it.
+ */
+@interface XExtensionItemTruncateTextCompactionStep : NSObject <XExtensionItemPayloadCompactionStep>
+
+/**
+ Appended to truncated text, with the attributes of the last character kept. Defaults to “…”.
+ */
+@property (nonatomic, copy) NSString *truncationString;
+
+@end
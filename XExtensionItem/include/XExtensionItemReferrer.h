@@ -2,6 +2,10 @@
 
 /**
  A model object containing information about the application where the content is being passed from.
+ 
+ @discussion Referrers are immutable and interned: creating a referrer equal to one that’s still alive returns that 
+ existing instance, so an app that attaches the same referrer to every share only ever builds its dictionary 
+ representation and hash once.
  */
 @interface XExtensionItemReferrer : NSObject <XExtensionItemCustomParameters>
 
@@ -0,0 +1,18 @@
+#import "XExtensionItemMetrics.h"
+
+/**
+ A metrics sink that emits spans as `os_signpost` intervals and counters as signpost events, so that they can be viewed
+ alongside everything else in Instruments.
+ */
+API_AVAILABLE(ios(12.0))
+@interface XExtensionItemSignpostMetricsSink : NSObject <XExtensionItemMetricsSink>
+
+/**
+ @param subsystem Subsystem to log to, e.g. your application’s bundle identifier.
+ @param category  Category to log to.
+
+ @return New signpost sink instance.
+ */
+- (instancetype)initWithSubsystem:(NSString *)subsystem category:(NSString *)category NS_DESIGNATED_INITIALIZER;
+
+@end
@@ -0,0 +1,97 @@
+#import <Foundation/Foundation.h>
+
+@class NSExtensionItem;
+@class XExtensionItemReferrer;
+@class XExtensionItemSource;
+@protocol XExtensionItemCustomParameters;
+
+/**
+ A group of `XExtensionItemSource` instances being shared at the same time – e.g. several posts selected at once – whose
+ common parameters only need to be set, and built into a `userInfo` dictionary, once.
+
+ @discussion Parameters set on the group apply to every item source in it. An item source only needs to set the
+ parameters that differ from the rest of the group, and those take precedence over the group’s values. Item sources
+ that don’t override any parameters all share a single `userInfo` dictionary instead of each building their own copy.
+
+ Pass the group’s `itemSources` to your `UIActivityViewController`, or call `extensionItemsForActivityType:` to build
+ every extension item in one pass:
+
+ ```objc
+ XExtensionItemSourceGroup *group = [[XExtensionItemSourceGroup alloc] initWithItemSources:itemSources];
+ group.referrer = [[XExtensionItemReferrer alloc] initWithAppNameFromBundle:[NSBundle mainBundle]
+                                                                 appStoreID:@"12345"
+                                                               googlePlayID:nil
+                                                                     webURL:nil
+                                                                  iOSAppURL:nil
+                                                              androidAppURL:nil];
+ group.tags = @[@"photography", @"landscape"];
+
+ UIActivityViewController *controller = [[UIActivityViewController alloc] initWithActivityItems:group.itemSources
+                                                                          applicationActivities:nil];
+ ```
+
+ An item source uses the parameters of the group it was most recently added to. Item sources keep their group’s
+ parameters even if the group itself is deallocated.
+ */
+@interface XExtensionItemSourceGroup : NSObject
+
+/**
+ @param itemSources Item sources that should share this group’s parameters.
+
+ @return New group instance.
+ */
+- (instancetype)initWithItemSources:(NSArray /* <XExtensionItemSource *> */ *)itemSources NS_DESIGNATED_INITIALIZER;
+
+/**
+ Item sources in this group, in the order that they were added.
+ */
+@property (nonatomic, readonly) NSArray /* <XExtensionItemSource *> */ *itemSources;
+
+/**
+ Add an item source to this group.
+
+ @param itemSource Item source that should share this group’s parameters.
+ */
+- (void)addItemSource:(XExtensionItemSource *)itemSource;
+
+/**
+ Tags for every item source that doesn’t set its own.
+ */
+@property (nonatomic, copy) NSArray *tags;
+
+/**
+ Referrer for every item source that doesn’t set its own.
+ */
+@property (nonatomic) XExtensionItemReferrer *referrer;
+
+/**
+ Content text for every item source that doesn’t set its own.
+ */
+@property (nonatomic) NSAttributedString *attributedContentText;
+
+/**
+ Set content text for a specific activity type, for every item source that doesn’t set its own.
+
+ @param attributedContentText Content text.
+ @param activityType          Activity type to use content text for.
+ */
+- (void)setAttributedContentText:(NSAttributedString *)attributedContentText forActivityType:(NSString *)activityType;
+
+/**
+ Add parameters from a custom parameters object to every item source in this group. Custom parameters added to an
+ individual item source take precedence over these.
+
+ @param customParameters A custom parameters object.
+ */
+- (void)addCustomParameters:(id <XExtensionItemCustomParameters>)customParameters;
+
+/**
+ Build the extension items for every item source in this group at once.
+
+ @param activityType Activity type to build extension items for, or `nil`.
+
+ @return One extension item per item source, in the same order as `itemSources`.
+ */
+- (NSArray /* <NSExtensionItem *> */ *)extensionItemsForActivityType:(NSString *)activityType;
+
+@end
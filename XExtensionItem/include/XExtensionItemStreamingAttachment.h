@@ -0,0 +1,86 @@
+#import <Foundation/Foundation.h>
+
+/**
+ Number of bytes read from the input stream and written to the temporary file at a time.
+ */
+extern NSUInteger const XExtensionItemStreamingAttachmentChunkSize;
+
+/**
+ A block that returns a new, unopened input stream over an attachment’s contents.
+ */
+typedef NSInputStream *(^XExtensionItemInputStreamProvidingBlock)(void);
+
+/**
+ A large attachment, such as a video or GIF, that is passed to extensions as a file rather than being held in memory.
+
+ @discussion `initWithData:typeIdentifier:` and `initWithDataProvider:typeIdentifier:` require the entire payload to be
+ held in memory as `NSData`, first by the application and then again by the receiving extension. A streaming attachment
+ is instead registered with its item provider as a file representation, so nothing is read until the extension loads it:
+
+ * Attachments created with a file URL hand that file over directly.
+ * Attachments created with an input stream provider copy the stream, in fixed-size chunks, to a temporary file the
+ first time they are loaded, and hand over that file. The temporary file is deleted when the attachment is deallocated.
+
+ Streaming attachments can be used as the main item of an `XExtensionItemSource` (see
+ `initWithStreamingAttachment:`) or included in its `additionalAttachments`. On the receiving side, use
+ `-[XExtensionItem loadInputStreamForTypeIdentifier:completionHandler:]` to read them without loading them into memory.
+ */
+@interface XExtensionItemStreamingAttachment : NSObject
+
+/**
+ Type identifier of the attachment’s contents.
+ */
+@property (nonatomic, readonly) NSString *typeIdentifier;
+
+/**
+ Location of the attachment’s contents. For attachments created with an input stream provider, this is the temporary
+ file that the stream is written to, which won’t exist until the attachment has been spooled.
+ */
+@property (nonatomic, readonly) NSURL *fileURL;
+
+/**
+ Whether the attachment’s contents are in `fileURL`: always for attachments created with a file URL, and once spooled for
+ attachments created with an input stream provider.
+ */
+@property (atomic, readonly, getter=isSpooled) BOOL spooled;
+
+/**
+ A new item provider that loads the attachment as a file representation. Nothing is read or spooled until a consumer
+ loads it.
+ */
+@property (nonatomic, readonly) NSItemProvider *itemProvider;
+
+/**
+ Initialize an attachment backed by an existing file.
+
+ @param fileURL        (Required) File URL of the attachment’s contents.
+ @param typeIdentifier (Optional) Type identifier of the file’s contents. Derived from the file if `nil`.
+
+ @return New attachment instance.
+ */
+- (instancetype)initWithFileURL:(NSURL *)fileURL typeIdentifier:(NSString *)typeIdentifier;
+
+/**
+ Initialize an attachment backed by an input stream, which will be copied to a temporary file the first time the
+ attachment is loaded.
+
+ @param inputStreamProvider (Required) Block returning a new, unopened input stream over the attachment’s contents. It
+ is called on a background queue, at most once per successful spool.
+ @param typeIdentifier      (Required) Type identifier of the stream’s contents.
+
+ @return New attachment instance.
+ */
+- (instancetype)initWithInputStreamProvider:(XExtensionItemInputStreamProvidingBlock)inputStreamProvider
+                             typeIdentifier:(NSString *)typeIdentifier;
+
+/**
+ Return the file containing the attachment’s contents, spooling the input stream to a temporary file first if needed.
+ Blocks the calling thread while spooling. Concurrent callers wait for the same spool rather than starting their own.
+
+ @param error If non-`NULL`, set to the error that caused spooling to fail.
+
+ @return File URL, or `nil` if spooling failed.
+ */
+- (NSURL *)spooledFileURLWithError:(NSError **)error;
+
+@end
@@ -0,0 +1,87 @@
+#import <UIKit/UIKit.h>
+
+/**
+ A bounded cache of thumbnail images rendered by an `XExtensionItemSource`’s `thumbnailProvider`, keyed by activity type
+ and size bucket.
+
+ @discussion Activity controllers and share extensions ask for thumbnails repeatedly, at slightly different sizes.
+ Requested sizes are rounded up to the next power of two (per dimension) so that nearby sizes share a single rendering.
+ When a bucket hasn’t been rendered yet, but a thumbnail for the same activity type that covers it in both dimensions
+ has been, the larger image is downscaled to the smallest size that keeps its aspect ratio and still covers the bucket,
+ instead of calling the provider again.
+
+ Thumbnails are also keyed by the generation of the provider that rendered them, so that once a newer provider has been
+ used, a rendering by an older one that was still in progress can’t be served in its place.
+
+ The cache is bounded by `totalCostLimit` (approximate decoded image size in bytes), is evicted automatically under
+ memory pressure, and is emptied when the application receives a memory warning.
+ */
+@interface XExtensionItemThumbnailCache : NSObject
+
+/**
+ @param totalCostLimit Maximum number of bytes of decoded image data to keep in memory. Pass `0` for no limit.
+
+ @return New thumbnail cache instance.
+ */
+- (instancetype)initWithTotalCostLimit:(NSUInteger)totalCostLimit NS_DESIGNATED_INITIALIZER;
+
+/**
+ Maximum number of bytes of decoded image data to keep in memory. Defaults to 8 MB.
+ */
+@property (nonatomic, readonly) NSUInteger totalCostLimit;
+
+/**
+ Number of lookups that were satisfied by an image already in the cache.
+ */
+@property (atomic, readonly) NSUInteger hitCount;
+
+/**
+ Number of lookups that required either downscaling a cached image or calling the provider.
+ */
+@property (atomic, readonly) NSUInteger missCount;
+
+/**
+ Number of misses that were satisfied by downscaling a larger cached image rather than calling the provider.
+ */
+@property (atomic, readonly) NSUInteger downscaleCount;
+
+/**
+ Return a cached thumbnail for the given activity type and size, rendering one if needed.
+
+ @param activityType Activity type that the thumbnail is for.
+ @param size         Requested thumbnail size, in points.
+ @param provider     Block used to render the thumbnail on a cache miss. Called with the size bucket rather than the
+ requested size.
+
+ @return Thumbnail image, or `nil` if the provider returned `nil`.
+
+ @see `thumbnailForActivityType:size:providerGeneration:provider:`
+ */
+- (UIImage *)thumbnailForActivityType:(NSString *)activityType
+                                 size:(CGSize)size
+                             provider:(UIImage *(^)(CGSize suggestedSize, NSString *activityType))provider;
+
+/**
+ Return a cached thumbnail for the given activity type and size, rendering one if needed.
+
+ @param activityType       Activity type that the thumbnail is for.
+ @param size               Requested thumbnail size, in points.
+ @param providerGeneration Generation of `provider`, which should be increased whenever the provider is replaced. Only
+                           thumbnails rendered by the same generation are returned, and thumbnails rendered by a
+                           generation older than the newest one that has been used aren’t cached.
+ @param provider           Block used to render the thumbnail on a cache miss. Called with the size bucket rather than
+                           the requested size.
+
+ @return Thumbnail image, or `nil` if the provider returned `nil`.
+ */
+- (UIImage *)thumbnailForActivityType:(NSString *)activityType
+                                 size:(CGSize)size
+                   providerGeneration:(NSUInteger)providerGeneration
+                             provider:(UIImage *(^)(CGSize suggestedSize, NSString *activityType))provider;
+
+/**
+ Discard all cached thumbnails. Counters are not reset.
+ */
+- (void)removeAllThumbnails;
+
+@end
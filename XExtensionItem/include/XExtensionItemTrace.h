@@ -0,0 +1,61 @@
+#import <Foundation/Foundation.h>
+
+/**
+ Timestamps of a single share, from the activity sheet opening in the host application to the extension loading the
+ shared item’s attachments.
+
+ @discussion Enable tracing on an `XExtensionItemSource` (see `tracingEnabled`) and every extension item that it hands to
+ an activity is stamped with its `traceCorrelationIdentifier` and the producer-side timestamps below. The receiving
+ extension reads them from `-[XExtensionItem trace]`, which adds the consumer-side timestamps, e.g. to report
+ host-to-extension latency per activity type:
+
+ ```objc
+ XExtensionItemTrace *trace = xExtensionItem.trace;
+ [analytics logLatency:trace.receiveTime - trace.providerDoneTime forActivityType:trace.activityType];
+ ```
+
+ Timestamps are in seconds on the device’s monotonic clock (`-[NSProcessInfo systemUptime]`), which the host
+ application and its extensions share, so timestamps recorded by either side can be compared. A timestamp is `0` if its
+ phase wasn’t recorded.
+ */
+@interface XExtensionItemTrace : NSObject
+
+/**
+ Identifier shared by every extension item that a single item source hands out.
+ */
+@property (nonatomic, readonly, copy) NSString *correlationIdentifier;
+
+/**
+ Activity type that the extension item was handed to.
+ */
+@property (nonatomic, readonly, copy) NSString *activityType;
+
+/**
+ When the activity sheet asked the item source for its placeholder item, i.e. when the sheet opened.
+ */
+@property (nonatomic, readonly) NSTimeInterval sheetOpenTime;
+
+/**
+ When the extension item was built. Earlier than `sheetOpenTime` if it was prepared ahead of time (see
+ `-[XExtensionItemSource prepareForActivityTypes:thumbnailSize:completion:]`).
+ */
+@property (nonatomic, readonly) NSTimeInterval itemBuiltTime;
+
+/**
+ When the item source returned the extension item to the activity sheet.
+ */
+@property (nonatomic, readonly) NSTimeInterval providerDoneTime;
+
+/**
+ When the extension created its `XExtensionItem`.
+ */
+@property (nonatomic, readonly) NSTimeInterval receiveTime;
+
+/**
+ When the extension first finished loading the `XExtensionItem`’s attachments, using
+ `loadAttachmentsWithPreferredTypeIdentifiers:resultHandler:completionHandler:` or
+ `loadInputStreamForTypeIdentifier:completionHandler:`.
+ */
+@property (atomic, readonly) NSTimeInterval attachmentsLoadedTime;
+
+@end
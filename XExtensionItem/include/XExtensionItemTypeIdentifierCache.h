@@ -0,0 +1,56 @@
+#import <Foundation/Foundation.h>
+
+/**
+ Resolves and caches the uniform type identifiers of file URLs, so that `XExtensionItemSource` doesn’t have to query
+ the file system every time an activity item or attachment is inspected.
+
+ @discussion Files whose path extension maps to a declared type identifier are resolved from the extension alone,
+ without touching the disk. Other files are looked up using `NSURLTypeIdentifierKey`, and the result is cached against
+ the file’s path, device, inode, and modification date, so that replacing or modifying the file causes it to be
+ resolved again.
+ */
+@interface XExtensionItemTypeIdentifierCache : NSObject
+
+/**
+ The cache used by `XExtensionItemSource`.
+ */
++ (instancetype)sharedCache;
+
+/**
+ Number of lookups resolved from the path extension alone.
+ */
+@property (atomic, readonly) NSUInteger extensionHitCount;
+
+/**
+ Number of lookups resolved from a cached file system lookup.
+ */
+@property (atomic, readonly) NSUInteger fileHitCount;
+
+/**
+ Number of lookups that required querying the file system for the type identifier.
+ */
+@property (atomic, readonly) NSUInteger missCount;
+
+/**
+ @param fileURL File URL to resolve.
+
+ @return Type identifier of the file, or `nil` if it isn’t a file URL or couldn’t be resolved.
+ */
+- (NSString *)typeIdentifierForFileURL:(NSURL *)fileURL;
+
+/**
+ Resolve several file URLs at once, e.g. every file URL in an array of attachments. Items that aren’t file URLs are
+ ignored.
+
+ @param items Array of items, some of which may be file URLs.
+
+ @return Dictionary mapping each resolved file URL to its type identifier.
+ */
+- (NSDictionary /* <NSURL *, NSString *> */ *)typeIdentifiersForFileURLsInArray:(NSArray *)items;
+
+/**
+ Discard all cached type identifiers. Counters are not reset.
+ */
+- (void)removeAllTypeIdentifiers;
+
+@end
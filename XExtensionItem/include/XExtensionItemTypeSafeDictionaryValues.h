@@ -7,9 +7,20 @@
 @interface XExtensionItemTypeSafeDictionaryValues : NSObject
 
 /**
- @param dictionary Dictionary to read values from.
+ @param dictionary Dictionary to read values from. The dictionary is copied, so later mutations won’t be reflected.
  */
-- (instancetype)initWithDictionary:(NSDictionary *)dictionary NS_DESIGNATED_INITIALIZER;
+- (instancetype)initWithDictionary:(NSDictionary *)dictionary;
+
+/**
+ Create an instance that reads directly from the provided dictionary without copying it. Use this for dictionaries 
+ that are already immutable, such as an `NSExtensionItem`’s `userInfo`, to avoid paying for a defensive copy.
+ 
+ @param dictionary Dictionary to read values from. The caller is responsible for not mutating it while this instance 
+ is in use.
+ 
+ @return New instance borrowing the provided dictionary.
+ */
+- (instancetype)initWithDictionaryNoCopy:(NSDictionary *)dictionary NS_DESIGNATED_INITIALIZER;
 
 #pragma mark - Type-safe accessors
 
@@ -69,4 +80,40 @@
  */
 - (NSUInteger)unsignedIntegerForKey:(NSString *)key;
 
+/**
+ @param key          The key for which to return the corresponding value.
+ @param defaultValue Value to return if the key doesn’t exist or doesn’t map to a number.
+ 
+ @return The boolean associated with the key, or `defaultValue`.
+ */
+- (BOOL)boolForKey:(NSString *)key defaultValue:(BOOL)defaultValue;
+
+/**
+ @param key          The key for which to return the corresponding value.
+ @param defaultValue Value to return if the key doesn’t exist or doesn’t map to a number.
+ 
+ @return The double associated with the key, or `defaultValue`.
+ */
+- (double)doubleForKey:(NSString *)key defaultValue:(double)defaultValue;
+
+/**
+ @param key The key for which to return the corresponding value.
+ 
+ @return The date associated with the key, or `nil` if the key either doesn’t exist in the dictionary or maps to a 
+ value that isn’t a date.
+ */
+- (NSDate *)dateForKey:(NSString *)key;
+
+#pragma mark - Batched lookups
+
+/**
+ Resolve a whole schema of keys in one call.
+ 
+ @param schema Dictionary mapping each key to look up to the class that its value is expected to be an instance of.
+ 
+ @return Dictionary containing an entry for each key in the schema whose value exists and is of the expected class. 
+ Keys with missing or mistyped values are omitted.
+ */
+- (NSDictionary *)valuesForSchema:(NSDictionary /* <NSString *, Class> */ *)schema;
+
 @end